@@ -24,9 +24,16 @@ src/Hal/Buzzer \
 src/Hal/Dc-Motor \
 src/Hal/External-Eeprom \
 src/Mcal/Dio \
+src/Mcal/Power \
 src/Mcal/Pwm \
 src/Mcal/Timer \
 src/Mcal/Twi \
 src/Mcal/Uart \
+src/Service/Event-Queue \
+src/Service/Crc8 \
+src/Service/Link \
+src/Service/Settings \
+src/Service/Soft-Timer \
+src/Service/System-Clock \
 src \
 
@@ -0,0 +1,24 @@
+################################################################################
+# Automatically-generated file. Do not edit!
+################################################################################
+
+# Add inputs and outputs from these tool invocations to the build variables 
+C_SRCS += \
+../src/Service/Crc8/crc8.c 
+
+OBJS += \
+./src/Service/Crc8/crc8.o 
+
+C_DEPS += \
+./src/Service/Crc8/crc8.d 
+
+
+# Each subdirectory must supply rules for building sources it contributes
+src/Service/Crc8/%.o: ../src/Service/Crc8/%.c src/Service/Crc8/subdir.mk
+	@echo 'Building file: $<'
+	@echo 'Invoking: AVR Compiler'
+	avr-gcc -Wall -g2 -gstabs -O3 -fpack-struct -fshort-enums -ffunction-sections -fdata-sections -std=gnu99 -funsigned-char -funsigned-bitfields -mmcu=atmega16 -DF_CPU=8000000UL -MMD -MP -MF"$(@:%.o=%.d)" -MT"$@" -c -o "$@" "$<"
+	@echo 'Finished building: $<'
+	@echo ' '
+
+
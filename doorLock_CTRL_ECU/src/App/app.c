@@ -32,8 +32,17 @@
 /* header file */
 #include "app.h"
 
-/* For using TIMER Module */
-#include "../Mcal/Timer/timer.h"
+/* For using the software timers */
+#include "../Service/Soft-Timer/soft-timer.h"
+
+/* For using the system clock */
+#include "../Service/System-Clock/system-clock.h"
+
+/* For posting and taking the app events */
+#include "../Service/Event-Queue/event-queue.h"
+
+/* For sleeping while there are no events */
+#include "../Mcal/Power/power.h"
 
 /* For initializing the TWI Module */
 #include "../Mcal/Twi/twi.h"
@@ -41,23 +50,83 @@
 /* For using UART Module - communication with the other MCU */
 #include "../Mcal/Uart/uart.h"
 
+/* For sending and receiving frames to and from the other MCU */
+#include "../Service/Link/link.h"
+
 /* For using BUZZER Module */
 #include "../Hal/Buzzer/buzzer.h"
 
 /* For using EXTERNAL EEPROM Module */
 #include "../Hal/External-Eeprom/external-eeprom.h"
 
+/* For using the saved password */
+#include "../Service/Settings/settings.h"
+
 /* For using MOTOR Module */
 #include "../Hal/Dc-Motor/dc-motor.h"
 
+/* For checking the timers of the modules */
+#include "../Mcal/Timer/timer.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if (WARNING_MSG_TIME_MS / LOCK_TIME_STEP_MS) > 255
+#error "the remaining warning time must fit in one byte of the show text command"
+#endif
+
+#if (MOTOR_UNLOCK_TIME_MS / PROGRESS_STEP_MS) > 255 || (MOTOR_LOCK_TIME_MS / PROGRESS_STEP_MS) > 255
+#error "the door progress steps must fit in one byte of the show progress command"
+#endif
+
+/* every timer has one user, the motor pwm on PD5 (OC1A) runs TIMER_1 */
+#if SOFTTIMER_HW_TIMER == SYSCLK_TIMER || SOFTTIMER_HW_TIMER == TIMER_1 || SYSCLK_TIMER == TIMER_1
+#error "the software timers tick, the system clock and the motor pwm must use different timers"
+#endif
+
+#if defined(DELAY_TIMER) && (DELAY_TIMER == SOFTTIMER_HW_TIMER || DELAY_TIMER == SYSCLK_TIMER || DELAY_TIMER == TIMER_1)
+#error "the DELAY_TIMER must not be used by another module"
+#endif
+
 /*******************************************************************************
  *                      Static Functions Prototypes	                           *
  *******************************************************************************/
 
+/*
+ * [Function Name]: runStateStep
+ * [Function Description]: runs the next step of the current state, the step
+ * 						   sets the events it awaits before the next step
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void runStateStep(void);
+
+/*
+ * [Function Name]: processEvent
+ * [Function Description]: clears the awaited events that the event satisfies
+ * [Args]:
+ * [in]: const ST_Event * a_event
+ * 		 event taken from the event queue
+ * [Return]: void
+ */
+static void processEvent(const ST_Event * a_event);
+
+/*
+ * [Function Name]: takeResponse
+ * [Function Description]: takes the awaited response frame if it's received,
+ * 						   every sent frame is answered by exactly one frame from the other MCU
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void takeResponse(void);
+
 /*
  * [Function Name]: uartRxCallback
- * [Function Description]: contains the callback routine when
- * 						   an RX interrupt occurs
+ * [Function Description]: called by the uart rx interrupt, posts a UART_RX_EVENT
+ * 						   if the previous one is processed
  * [Args]:
  * [in]: void
  * [Return]: void
@@ -65,15 +134,108 @@
 static void uartRxCallback(void);
 
 /*
- * [Function Name]: mainTimerCallback
- * [Function Description]: contains the callback routine when
- * 						   the main timer finishes counting,
- * 						   it stops the timer before returning
+ * [Function Name]: msgTimerCallback
+ * [Function Description]: called when the message timer expires, posts its event
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-static void mainTimerCallback(void);
+static void msgTimerCallback(void);
+
+/*
+ * [Function Name]: motorTimerCallback
+ * [Function Description]: called when a motor phase ends, stops the motor
+ * 						   and posts a MOTOR_DONE_EVENT
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void motorTimerCallback(void);
+
+/*
+ * [Function Name]: buzzerTimerCallback
+ * [Function Description]: called when the warning time ends, turns off the buzzer
+ * 						   and posts the timer event
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void buzzerTimerCallback(void);
+
+/*
+ * [Function Name]: progressTimerCallback
+ * [Function Description]: called every progress step while the motor moves the door,
+ * 						   posts the timer event
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void progressTimerCallback(void);
+
+/*
+ * [Function Name]: eepromTimerCallback
+ * [Function Description]: called periodically while the eeprom write cycle is awaited,
+ * 						   posts the timer event so the main program checks the eeprom
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void eepromTimerCallback(void);
+
+/*
+ * [Function Name]: linkTimerCallback
+ * [Function Description]: called every LINK_RESPONSE_TIMEOUT_MS while the last sent frame
+ * 						   isn't confirmed, posts the timer event
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void linkTimerCallback(void);
+
+/*
+ * [Function Name]: sendFrame
+ * [Function Description]: sends a frame to the other MCU and starts waiting for its
+ * 						   confirmation, so it's resent if it's lost
+ * [Args]:
+ * [in]: const uint8_t * a_payload
+ * 		 batch of commands to send
+ * [in]: uint8_t a_size
+ * 		 payload size
+ * [Return]: void
+ */
+static void sendFrame(const uint8_t * a_payload, uint8_t a_size);
+
+/*
+ * [Function Name]: checkLink
+ * [Function Description]: stops waiting for the confirmation of the last sent frame if it's
+ * 						   confirmed, otherwise resends it, and connects to the other MCU
+ * 						   again if it's resent LINK_MAX_RETRIES times without a confirmation,
+ * 						   the running door or warning is finished first
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void checkLink(void);
+
+/*
+ * [Function Name]: isSafetyWorkRunning
+ * [Function Description]: checks if the motor moves or holds the door, or if the warning
+ * 						   of the wrong passwords is running, they're never cut by a link error
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the door or the warning isn't finished yet, FALSE otherwise
+ */
+static boolean isSafetyWorkRunning(void);
+
+/*
+ * [Function Name]: restartConnection
+ * [Function Description]: drops what is awaited from the other MCU and connects to it again
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void restartConnection(void);
 
 /*
  * [Function Name]: setAppState
@@ -116,6 +278,18 @@ static void showMainMenu(void);
  */
 static void changePass(boolean a_isAuthRequired);
 
+/*
+ * [Function Name]: showNewPassError
+ * [Function Description]: shows why the new password isn't changed for some time, then
+ * 						   changePass asks for it again, or returns to the main menu
+ * 						   if NEW_PASSWORD_TRIALS is reached
+ * [Args]:
+ * [in]: EN_TextId a_textId
+ * 		 id of the text
+ * [Return]: void
+ */
+static void showNewPassError(EN_TextId a_textId);
+
 /*
  * [Function Name]: openDoor
  * [Function Description]: responsible for locking and unlocking the door
@@ -138,15 +312,76 @@ static void openDoor(boolean a_isAuthRequired);
  */
 static void auth(void);
 
+/*
+ * [Function Name]: showText
+ * [Function Description]: sends a batch to clear the screen and show a text on the
+ * 						   first line, the other MCU answers with an ACK
+ * [Args]:
+ * [in]: EN_TextId a_textId
+ * 		 id of the text
+ * [in]: const uint8_t * a_args
+ * 		 numeric args of the text
+ * [in]: uint8_t a_argsCount
+ * 		 number of the args, not more than PROTOCOL_MAX_TEXT_ARGS
+ * [Return]: void
+ */
+static void showText(EN_TextId a_textId, const uint8_t * a_args, uint8_t a_argsCount);
+
+/*
+ * [Function Name]: requestPassword
+ * [Function Description]: sends a batch to clear the screen, show a text on the first
+ * 						   line and read a password on the second line,
+ * 						   the other MCU answers with the password when the user submits it
+ * [Args]:
+ * [in]: EN_TextId a_textId
+ * 		 id of the text
+ * [Return]: void
+ */
+static void requestPassword(EN_TextId a_textId);
+
+/*
+ * [Function Name]: showLockTime
+ * [Function Description]: sends the remaining time of the warning to be shown on the
+ * 						   second line, the other MCU answers with an ACK
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void showLockTime(void);
+
+/*
+ * [Function Name]: startDoorProgress
+ * [Function Description]: starts updating the door progress bar every PROGRESS_STEP_MS
+ * 						   during a motor phase, the bar is shown from the first step
+ * 						   so its frame is sent after the answer of the phase text
+ * [Args]:
+ * [in]: uint32_t a_phaseTimeMs
+ * 		 time of the motor phase
+ * [in]: boolean a_isClosing
+ * 		 TRUE if the door is being locked, so the bar is emptied,
+ * 		 FALSE if it's being unlocked, so the bar is filled
+ * [Return]: void
+ */
+static void startDoorProgress(uint32_t a_phaseTimeMs, boolean a_isClosing);
+
+/*
+ * [Function Name]: showDoorProgress
+ * [Function Description]: sends the current step of the door progress bar, its ack
+ * 						   isn't awaited, it's dropped when it's received
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void showDoorProgress(void);
+
 /*
  * [Function Name]: readPassword
- * [Function Description]: read a password from the user and handles user input,
- * 						   whether deleting char, clearing screen, submiting pass and so on
+ * [Function Description]: takes the password from the received frame
  * [Args]:
  * [in]: uint8_t * password
  * 		 empty array to store the password
  * [Return]: boolean
- * 			 TRUE if the user has already finished entering the password
+ * 			 TRUE if the received frame contains a password
  * 			 FALSE otherwise
  */
 static boolean readPassword(uint8_t * password);
@@ -165,37 +400,12 @@ static boolean readPassword(uint8_t * password);
  */
 static boolean comparePasswords(uint8_t * pass1, uint8_t * pass2);
 
-/*
- * [Function Name]: savePassToEeprom
- * [Function Description]: save password to eeprom
- * [Args]:
- * [in]: uint8_t * password
- * 		 password to save
- * [Return]: void
- */
-static void savePassToEeprom(uint8_t * password);
-
-/*
- * [Function Name]: readPassFromEeprom
- * [Function Description]: read password from eeprom
- * [Args]:
- * [in]: uint8_t * password
- * 		 empty array to store the read password
- * [Return]: void
- */
-static void readPassFromEeprom(uint8_t * password);
-
 /*******************************************************************************
  *                        Global Variables	                                   *
  *******************************************************************************/
 
-/* g_isDataReceived => states whether new data has been received or not
- * g_hasMainTimerFinished => states whether the timer has finished counting or not
- * g_firstTime => states whether the app is running for the first time where no pass is set or not
- */
-static volatile boolean g_isDataReceived = FALSE,
-		g_hasMainTimerFinished = FALSE,
-		g_firstTime = FALSE;
+/* g_firstTime => states whether the app is running for the first time where no pass is set or not */
+static boolean g_firstTime = FALSE;
 
 /* g_currentState => current app state
  * g_previousState => previous app state, used when previous states are required to determine the next state
@@ -208,16 +418,48 @@ static EN_AppStates g_currentState = PREPAIRING_CONNECTION_STATE,
  */
 static uint8_t g_innerState = 0, g_passTrials = 0;
 
-/* await option, used to wait at the end of every main iteration
- * tell some event happens then procced
+/* remaining seconds of the warning, shown on the screen */
+static uint8_t g_lockSeconds = 0;
+
+/* step of the door progress bar, steps of the current motor phase,
+ * and whether the bar is emptied while locking or filled while unlocking
+ */
+static uint8_t g_progressStep = 0, g_progressSteps = 1;
+static boolean g_isDoorClosing = FALSE;
+
+/* number of answers of the sent frames that are dropped when they are received,
+ * the other MCU answers the frames in order so they come before the awaited answer
+ */
+static uint8_t g_droppedAnswers = 0;
+
+/* awaited events, bits of EN_AwaitOptions, the next step runs
+ * when all of them happen
+ */
+static uint8_t g_awaitOption = AWAIT_NOTHING;
+
+/* software timer awaited by AWAIT_TIMER and AWAIT_RESPONSE_AND_TIMER */
+static uint8_t g_awaitedTimer = MSG_TIMER_ID;
+
+/* payload of the frame received from the other MCU and its size */
+static uint8_t g_receivedFrame[PROTOCOL_MAX_PAYLOAD_SIZE], g_receivedFrameSize = 0;
+
+/* states whether the saved settings are loaded or not, they're loaded on the first connection
+ * only as a write cycle may be still running when connecting again after a link error
  */
-static EN_AwaitOptions g_awaitOption = AWAIT_NOTHING;
+static boolean g_isSettingsLoaded = FALSE;
 
-/* received data from the other MCU */
-static volatile uint8_t g_receivedData = 0;
+/* states whether the other MCU stopped answering while the door or the warning is running,
+ * the frames are still sent to update the screen but their answers aren't awaited
+ */
+static boolean g_isLinkLost = FALSE;
+
+/* time between the acks sent while connecting to the other MCU */
+static uint16_t g_connectRetryTimeMs = CONNECT_RETRY_MIN_TIME_MS;
 
-/* main timer config structure - with default zero ticks */
-static TIMER_config g_mainTimerConfig = {MAIN_TIMER, MAIN_TIMER_MODE, MAIN_TIMER_PRESCALER, 0, mainTimerCallback};
+/* states whether a UART_RX_EVENT is in the queue or not,
+ * so the uart posts only one event for many received bytes
+ */
+static volatile boolean g_isUartEventPending = FALSE;
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -232,6 +474,9 @@ static TIMER_config g_mainTimerConfig = {MAIN_TIMER, MAIN_TIMER_MODE, MAIN_TIMER
  */
 void app_init(void)
 {
+	/* start the system clock */
+	SYSCLK_init();
+
 	/* init the buzzer */
 	BUZZER_init();
 
@@ -244,7 +489,9 @@ void app_init(void)
 	ST_TwiConfig twiConfig = {
 			0x01,
 			TWI_PRESCALER_1,
-			0x02
+			0x02,
+			SYSCLK_nowMs,
+			TWI_TIMEOUT_MS
 	};
 	TWI_init(&twiConfig);
 
@@ -259,9 +506,19 @@ void app_init(void)
 	};
 	UART_init(&uartConfig);
 
-	/* set uart rx callback */
+	/* initialize the link over the uart */
+	LINK_init();
+
+	/* initialize the event queue and post an event for the received bytes */
+	EVENTQ_init();
 	UART_setRxInterruptCallback(uartRxCallback);
 
+	/* initialize the software timers */
+	SOFTTIMER_init();
+
+	/* count the sleep time by the system clock */
+	POWER_init(SYSCLK_nowUs);
+
 	/* enable global interrupt */
 	ENABLE_GLOBAL_INTERRUPT();
 
@@ -276,11 +533,43 @@ void app_init(void)
  */
 void app_update(void)
 {
-	/* reset await, data receive flag, timer finish flag */
-	g_awaitOption = AWAIT_NOTHING;
-	g_isDataReceived = FALSE;
-	g_hasMainTimerFinished = FALSE;
+	ST_Event event;
 
+	/* run the steps of the current state till one of them awaits an event */
+	while(g_awaitOption == AWAIT_NOTHING)
+	{
+		/* the link resends only the last frame if it's lost,
+		 * so a step runs after the answers of the progress frames */
+		if(g_droppedAnswers != 0)
+		{
+			g_awaitOption = AWAIT_DROPPED_ANSWERS;
+		}
+		else
+		{
+			runStateStep();
+		}
+
+		/* the awaited response may be already received */
+		takeResponse();
+	}
+
+	/* sleep till an event arrives, the events come from the uart and the timers
+	 * so the idle mode is the deepest one, then process it */
+	POWER_sleepWhile(EVENTQ_isEmpty, POWER_WAKE_UART | POWER_WAKE_TIMERS);
+	EVENTQ_get(&event);
+	processEvent(&event);
+}
+
+/*
+ * [Function Name]: runStateStep
+ * [Function Description]: runs the next step of the current state, the step
+ * 						   sets the events it awaits before the next step
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void runStateStep(void)
+{
 	/* choose the app behavior depending on the current state */
 	switch (g_currentState)
 	{
@@ -306,67 +595,334 @@ void app_update(void)
 		}
 		break;
 
-	case OPEN_DOOR_STATE:
-		/* open door with auth except if the user is already authorized */
-		if(g_previousState == AUTHORIZING_STATE)
+	case OPEN_DOOR_STATE:
+		/* open door with auth except if the user is already authorized */
+		if(g_previousState == AUTHORIZING_STATE)
+		{
+			openDoor(FALSE);
+		}
+		else
+		{
+			openDoor(TRUE);
+		}
+		break;
+
+	case AUTHORIZING_STATE:
+		/* authorize the user */
+		auth();
+		break;
+
+	default:
+		break;
+	}
+
+	/* the received frame is used only by this step */
+	g_receivedFrameSize = 0;
+
+	/* connect again once the door is locked and the warning ends */
+	if(g_isLinkLost && !isSafetyWorkRunning())
+	{
+		restartConnection();
+	}
+}
+
+/*
+ * [Function Name]: processEvent
+ * [Function Description]: clears the awaited events that the event satisfies
+ * [Args]:
+ * [in]: const ST_Event * a_event
+ * 		 event taken from the event queue
+ * [Return]: void
+ */
+static void processEvent(const ST_Event * a_event)
+{
+	switch(a_event->type)
+	{
+	case UART_RX_EVENT:
+		/* the bytes received from now on post a new event */
+		g_isUartEventPending = FALSE;
+		takeResponse();
+
+		/* a confirmation or a duplicate may be received even if no answer is awaited */
+		if(LINK_isConfirmed())
+		{
+			SOFTTIMER_stop(LINK_TIMER_ID);
+		}
+		break;
+
+	case TIMER_EXPIRED_EVENT:
+		/* the eeprom is checked out of the ISR as it uses the twi */
+		if(a_event->data == EEPROM_TIMER_ID)
+		{
+			if(!EEPROM_isWritePending())
+			{
+				SOFTTIMER_stop(EEPROM_TIMER_ID);
+				EVENTQ_post(EEPROM_DONE_EVENT, 0);
+			}
+			break;
+		}
+		/* the link is checked out of the ISR as it uses the uart */
+		if(a_event->data == LINK_TIMER_ID)
+		{
+			checkLink();
+			break;
+		}
+		/* the bar is updated out of the ISR as it uses the link */
+		if(a_event->data == PROGRESS_TIMER_ID)
+		{
+			/* a step posted before stopping the timer is not shown, and a step is
+			 * skipped while the last frame isn't confirmed so one frame is resent at most */
+			if(SOFTTIMER_isRunning(PROGRESS_TIMER_ID) && g_progressStep < g_progressSteps &&
+					LINK_isConfirmed())
+			{
+				g_progressStep ++;
+				showDoorProgress();
+			}
+			break;
+		}
+		/* fall through */
+
+	case MOTOR_DONE_EVENT:
+		if(a_event->data == g_awaitedTimer)
+		{
+			g_awaitOption &= ~AWAIT_TIMER;
+		}
+		break;
+
+	case EEPROM_DONE_EVENT:
+		g_awaitOption &= ~AWAIT_EEPROM;
+		break;
+
+	default:
+		break;
+	}
+}
+
+/*
+ * [Function Name]: takeResponse
+ * [Function Description]: takes the awaited response frame if it's received,
+ * 						   every sent frame is answered by exactly one frame from the other MCU
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void takeResponse(void)
+{
+	/* no answer is awaited while the link is lost, the received frames are dropped */
+	if(g_isLinkLost)
+	{
+		while(LINK_receiveFrame(g_receivedFrame, &g_receivedFrameSize) == LINK_SUCCESS);
+		g_receivedFrameSize = 0;
+		g_droppedAnswers = 0;
+		g_awaitOption &= ~(AWAIT_RESPONSE | AWAIT_DROPPED_ANSWERS);
+		return;
+	}
+
+	/* drop the answers of the frames that don't await them */
+	while(g_droppedAnswers != 0 && LINK_receiveFrame(g_receivedFrame, &g_receivedFrameSize) == LINK_SUCCESS)
+	{
+		g_droppedAnswers --;
+		g_receivedFrameSize = 0;
+	}
+
+	if(g_droppedAnswers == 0)
+	{
+		g_awaitOption &= ~AWAIT_DROPPED_ANSWERS;
+	}
+
+	if(g_droppedAnswers == 0 && (g_awaitOption & AWAIT_RESPONSE) &&
+			LINK_receiveFrame(g_receivedFrame, &g_receivedFrameSize) == LINK_SUCCESS)
+	{
+		g_awaitOption &= ~AWAIT_RESPONSE;
+	}
+}
+
+/*
+ * [Function Name]: uartRxCallback
+ * [Function Description]: called by the uart rx interrupt, posts a UART_RX_EVENT
+ * 						   if the previous one is processed
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void uartRxCallback(void)
+{
+	if(!g_isUartEventPending)
+	{
+		g_isUartEventPending = TRUE;
+		EVENTQ_postFromIsr(UART_RX_EVENT, 0);
+	}
+}
+
+/*
+ * [Function Name]: msgTimerCallback
+ * [Function Description]: called when the message timer expires, posts its event
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void msgTimerCallback(void)
+{
+	EVENTQ_postFromIsr(TIMER_EXPIRED_EVENT, MSG_TIMER_ID);
+}
+
+/*
+ * [Function Name]: motorTimerCallback
+ * [Function Description]: called when a motor phase ends, stops the motor
+ * 						   and posts a MOTOR_DONE_EVENT
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void motorTimerCallback(void)
+{
+	DCMOTOR_stop();
+	EVENTQ_postFromIsr(MOTOR_DONE_EVENT, MOTOR_TIMER_ID);
+}
+
+/*
+ * [Function Name]: buzzerTimerCallback
+ * [Function Description]: called when the warning time ends, turns off the buzzer
+ * 						   and posts the timer event
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void buzzerTimerCallback(void)
+{
+	BUZZER_off();
+	EVENTQ_postFromIsr(TIMER_EXPIRED_EVENT, BUZZER_TIMER_ID);
+}
+
+/*
+ * [Function Name]: progressTimerCallback
+ * [Function Description]: called every progress step while the motor moves the door,
+ * 						   posts the timer event
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void progressTimerCallback(void)
+{
+	EVENTQ_postFromIsr(TIMER_EXPIRED_EVENT, PROGRESS_TIMER_ID);
+}
+
+/*
+ * [Function Name]: eepromTimerCallback
+ * [Function Description]: called periodically while the eeprom write cycle is awaited,
+ * 						   posts the timer event so the main program checks the eeprom
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void eepromTimerCallback(void)
+{
+	EVENTQ_postFromIsr(TIMER_EXPIRED_EVENT, EEPROM_TIMER_ID);
+}
+
+/*
+ * [Function Name]: linkTimerCallback
+ * [Function Description]: called every LINK_RESPONSE_TIMEOUT_MS while the last sent frame
+ * 						   isn't confirmed, posts the timer event
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void linkTimerCallback(void)
+{
+	EVENTQ_postFromIsr(TIMER_EXPIRED_EVENT, LINK_TIMER_ID);
+}
+
+/*
+ * [Function Name]: sendFrame
+ * [Function Description]: sends a frame to the other MCU and starts waiting for its
+ * 						   confirmation, so it's resent if it's lost
+ * [Args]:
+ * [in]: const uint8_t * a_payload
+ * 		 batch of commands to send
+ * [in]: uint8_t a_size
+ * 		 payload size
+ * [Return]: void
+ */
+static void sendFrame(const uint8_t * a_payload, uint8_t a_size)
+{
+	LINK_sendFrame(a_payload, a_size);
+	if(!g_isLinkLost)
+	{
+		SOFTTIMER_start(LINK_TIMER_ID, LINK_RESPONSE_TIMEOUT_MS, SOFTTIMER_PERIODIC, linkTimerCallback);
+	}
+}
+
+/*
+ * [Function Name]: checkLink
+ * [Function Description]: stops waiting for the confirmation of the last sent frame if it's
+ * 						   confirmed, otherwise resends it, and connects to the other MCU
+ * 						   again if it's resent LINK_MAX_RETRIES times without a confirmation,
+ * 						   the running door or warning is finished first
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void checkLink(void)
+{
+	if(LINK_isConfirmed())
+	{
+		SOFTTIMER_stop(LINK_TIMER_ID);
+	}
+	else if(LINK_resendFrame() == LINK_ERROR)
+	{
+		SOFTTIMER_stop(LINK_TIMER_ID);
+
+		if(isSafetyWorkRunning())
 		{
-			openDoor(FALSE);
+			/* the door is locked and the warning ends on their timers, the steps await
+			 * the timers only and the connection starts again after them */
+			g_isLinkLost = TRUE;
+			takeResponse();
 		}
 		else
 		{
-			openDoor(TRUE);
+			/* the other MCU doesn't answer, drop what is awaited and connect again */
+			restartConnection();
 		}
-		break;
-
-	case AUTHORIZING_STATE:
-		/* authorize the user */
-		auth();
-		break;
-
-	default:
-		break;
 	}
-
-	/* await till reponse is received, timer has finished, await both or no await at all */
-	while(
-			(g_awaitOption == AWAIT_RESPONSE && !g_isDataReceived) ||
-			(g_awaitOption == AWAIT_TIMER && !g_hasMainTimerFinished) ||
-			(g_awaitOption == AWAIT_RESPONSE_AND_TIMER && (!g_isDataReceived || !g_hasMainTimerFinished))
-	);
-
 }
 
 /*
- * [Function Name]: uartRxCallback
- * [Function Description]: contains the callback routine when
- * 						   an RX interrupt occurs
+ * [Function Name]: isSafetyWorkRunning
+ * [Function Description]: checks if the motor moves or holds the door, or if the warning
+ * 						   of the wrong passwords is running, they're never cut by a link error
  * [Args]:
  * [in]: void
- * [Return]: void
+ * [Return]: boolean
+ * 			 TRUE if the door or the warning isn't finished yet, FALSE otherwise
  */
-static void uartRxCallback(void)
+static boolean isSafetyWorkRunning(void)
 {
-	g_isDataReceived = TRUE;
-
-	/* save the received data */
-	g_receivedData = UART_receiveByteNonBlocking();
+	/* the door steps start from 1 when the motor starts,
+	 * and the warning steps start from 4 when the max trials are reached */
+	return (g_currentState == OPEN_DOOR_STATE && g_innerState != 0) ||
+			(g_currentState == AUTHORIZING_STATE && g_innerState >= 4);
 }
 
 /*
- * [Function Name]: mainTimerCallback
- * [Function Description]: contains the callback routine when
- * 						   the main timer finishes counting,
- * 						   it stops the timer before returning
+ * [Function Name]: restartConnection
+ * [Function Description]: drops what is awaited from the other MCU and connects to it again
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-static void mainTimerCallback(void)
+static void restartConnection(void)
 {
-	g_hasMainTimerFinished = TRUE;
-
-	/* stop the timer each time the callback is executed */
-	TIMER_stop(TIMER_0);
+	/* the motor and the buzzer timers keep running so they are turned off on time */
+	SOFTTIMER_stop(LINK_TIMER_ID);
+	SOFTTIMER_stop(MSG_TIMER_ID);
+	SOFTTIMER_stop(PROGRESS_TIMER_ID);
+	g_isLinkLost = FALSE;
+	g_droppedAnswers = 0;
+	g_awaitOption = AWAIT_NOTHING;
+	g_innerState = 0;
+	setAppState(PREPAIRING_CONNECTION_STATE);
 }
 
 /*
@@ -392,39 +948,99 @@ static void setAppState(EN_AppStates a_state)
  */
 static void establishConnection(void)
 {
-	/* store if the user is a first-time user or not */
-	uint8_t eepromValue;
+	/* ack sent to the other MCU */
+	const uint8_t ackCmd = ACK_CMD;
+
+	/* states whether an answer or a late answer has been received or not */
+	boolean isReceived = FALSE;
 
 	switch(g_innerState)
 	{
 	case 0:
-		do
+		/* start with the shortest time between the acks */
+		g_connectRetryTimeMs = CONNECT_RETRY_MIN_TIME_MS;
+		g_innerState ++;
+		break;
+
+	case 1:
+		/* send an ack and give the other MCU some time to answer it */
+		LINK_sendFrame(&ackCmd, 1);
+		SOFTTIMER_start(MSG_TIMER_ID, g_connectRetryTimeMs, SOFTTIMER_ONE_SHOT, msgTimerCallback);
+		g_awaitedTimer = MSG_TIMER_ID;
+		g_awaitOption = AWAIT_TIMER;
+		g_innerState ++;
+		break;
+
+	case 2:
+		/* take all received frames, the other MCU answers every frame, so any of them
+		 * answers one of the sent acks, a menu shown before connecting again answers
+		 * the ack with the pressed key */
+		while(LINK_receiveFrame(g_receivedFrame, &g_receivedFrameSize) == LINK_SUCCESS)
+		{
+			isReceived = TRUE;
+		}
+
+		if(isReceived)
+		{
+			/* an ack resent after a NAK is answered after connecting, its answer would be
+			 * taken as the answer of the next frame, so the late answers are dropped till
+			 * none arrives in CONNECT_DRAIN_TIME_MS */
+			SOFTTIMER_start(MSG_TIMER_ID, CONNECT_DRAIN_TIME_MS, SOFTTIMER_ONE_SHOT, msgTimerCallback);
+			g_awaitOption = AWAIT_TIMER;
+			g_innerState ++;
+		}
+		else
+		{
+			/* send the next ack later, so less is sent while the other MCU is unreachable */
+			g_connectRetryTimeMs *= 2;
+			if(g_connectRetryTimeMs > CONNECT_RETRY_MAX_TIME_MS)
+			{
+				g_connectRetryTimeMs = CONNECT_RETRY_MAX_TIME_MS;
+			}
+			g_innerState = 1;
+		}
+		break;
+
+	case 3:
+		/* drop the late answers and wait again if any is received */
+		while(LINK_receiveFrame(g_receivedFrame, &g_receivedFrameSize) == LINK_SUCCESS)
 		{
-			/* wait till an ack is received */
-			UART_sendByteBlocking(ACK_CMD);
-			TIMER_DELAY_MS(50);
+			isReceived = TRUE;
+		}
 
-		} while (g_receivedData != ACK_CMD);
+		if(isReceived)
+		{
+			SOFTTIMER_start(MSG_TIMER_ID, CONNECT_DRAIN_TIME_MS, SOFTTIMER_ONE_SHOT, msgTimerCallback);
+			g_awaitOption = AWAIT_TIMER;
+			break;
+		}
 
 		/* show "Door lock system" for some time */
-		g_mainTimerConfig.ticks = TIME_MS_TO_TICKS(MAIN_TIMER_PRESCALER_NUMBERS, DEFAULT_MSG_TIME_MS);
-		TIMER_init(&g_mainTimerConfig);
-		TIMER_start(TIMER_0);
-		UART_sendByteBlocking(SHOW_DOOR_LOCK_TEXT_CMD);
+		SOFTTIMER_start(MSG_TIMER_ID, DEFAULT_MSG_TIME_MS, SOFTTIMER_ONE_SHOT, msgTimerCallback);
+		g_awaitedTimer = MSG_TIMER_ID;
+		showText(DOOR_LOCK_TEXT_ID, NULL, 0);
+
+		/* load the saved password once while the message is shown,
+		 * searching the log takes tens of ms, a log that can't be read
+		 * is searched again on the next connection */
+		if(!g_isSettingsLoaded)
+		{
+			g_isSettingsLoaded = (SETTINGS_init() != SETTINGS_CORRUPTED);
+		}
+
 		g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
 		g_innerState ++;
-
 		break;
 
-	case 1:
+	case 4:
 
-		/* read eeprom to check if first time or not
+		/* check the loaded settings if first time or not
 		 * if first time => set state to CHANGE_PASS_STATE
 		 * else set state to MAIN_MENU_STATE
+		 * a broken eeprom shows the menu, so the saved password can't be
+		 * replaced without entering it
 		 */
-		while(EEPROM_readByte(FIRST_TIME_CHECK_ADDRESS, &eepromValue) == EEPROM_ERROR);
-
-		if(eepromValue == NOT_FIRST_TIME_EEPROM_VAL)
+		if(SETTINGS_getState() != SETTINGS_EMPTY)
 		{
 			g_firstTime = FALSE;
 			setAppState(MAIN_MENU_STATE);
@@ -448,33 +1064,46 @@ static void establishConnection(void)
  */
 static void showMainMenu(void)
 {
+	/* batch to clear the screen and show the menu */
+	const uint8_t menuCmds[] = {CLEAR_SCREEN_CMD, GET_MENU_OPTION_CMD};
+
+	/* ack sent to ask for another key */
+	const uint8_t ackCmd = ACK_CMD;
+
+	/* key pressed by the user, zero if no key is received */
+	uint8_t key = 0;
+
 	switch(g_innerState)
 	{
 	case 0:
 		/* show menu and wait for a response */
-		UART_sendByteBlocking(GET_MENU_OPTION_CMD);
+		sendFrame(menuCmds, sizeof(menuCmds));
 		g_awaitOption = AWAIT_RESPONSE;
 		g_innerState ++;
 		break;
 
 	case 1:
+		if(g_receivedFrameSize == 2 && g_receivedFrame[0] == KEY_CMD)
+		{
+			key = g_receivedFrame[1];
+		}
 
 		/* check the option and send an ack if the command is not defined
 		 * to wait for another response
 		 */
-		if(g_receivedData == OPEN_DOOR_MENU_CHAR)
+		if(key == OPEN_DOOR_MENU_CHAR)
 		{
 			setAppState(OPEN_DOOR_STATE);
 			g_innerState = 0;
 		}
-		else if(g_receivedData == CHANGE_PASS_MENU_CHAR)
+		else if(key == CHANGE_PASS_MENU_CHAR)
 		{
 			setAppState(CHANGE_PASS_STATE);
 			g_innerState = 0;
 		}
 		else
 		{
-			UART_sendByteBlocking(ACK_CMD);
+			sendFrame(&ackCmd, 1);
 			g_awaitOption = AWAIT_RESPONSE;
 		}
 		break;
@@ -513,8 +1142,8 @@ static void changePass(boolean a_isAuthRequired)
 		}
 		else
 		{
-			/* show "enter new pass" and wait for response */
-			UART_sendByteBlocking(READ_NEW_PASS_CMD);
+			/* show "enter new pass" and wait for the pass */
+			requestPassword(READ_NEW_PASS_TEXT_ID);
 			g_awaitOption = AWAIT_RESPONSE;
 			g_innerState ++;
 		}
@@ -523,10 +1152,15 @@ static void changePass(boolean a_isAuthRequired)
 	case 2:
 		if(readPassword(newPass))
 		{
-			/* user has finished entering the pass */
-			UART_sendByteBlocking(CONFIRM_PASS_CMD);
+			/* user has finished entering the pass, ask for the confirmation */
+			requestPassword(CONFIRM_NEW_PASS_TEXT_ID);
 			g_innerState ++;
 		}
+		else
+		{
+			/* not a password, ask for it again */
+			requestPassword(READ_NEW_PASS_TEXT_ID);
+		}
 		g_awaitOption = AWAIT_RESPONSE;
 		break;
 
@@ -536,51 +1170,57 @@ static void changePass(boolean a_isAuthRequired)
 			/* user has finished entering the pass confirmation */
 			if(comparePasswords(newPass, confirmationPass))
 			{
-				/* save pass to eeprom if two passwords match */
-				savePassToEeprom(confirmationPass);
-
-				if(g_firstTime)
+				/* save pass if two passwords match, it's written to the eeprom
+				 * with the mark that the user is not a first-time user,
+				 * the next step awaits the write cycle and shows its outcome */
+				if(SETTINGS_setPass(confirmationPass) == SETTINGS_SUCCESS)
 				{
-					/* write to the eeprom that the user is not a first-time user */
-					while(EEPROM_writeByte(FIRST_TIME_CHECK_ADDRESS, NOT_FIRST_TIME_EEPROM_VAL) == EEPROM_ERROR);
-					g_firstTime = FALSE;
+					SOFTTIMER_start(EEPROM_TIMER_ID, EEPROM_POLL_TIME_MS, SOFTTIMER_PERIODIC, eepromTimerCallback);
+					g_awaitOption = AWAIT_EEPROM;
+					g_innerState ++;
+				}
+				else
+				{
+					/* the write can't be started, show "pass not saved" */
+					showNewPassError(PASS_NOT_SAVED_TEXT_ID);
 				}
-
-				/* show "pass changed" */
-				UART_sendByteBlocking(SHOW_PASS_CHANGED_CMD);
-				g_innerState ++;
 			}
 			else
 			{
 				/* show "pass mismatch" */
-				UART_sendByteBlocking(SHOW_PASS_MISMATCH_TEXT_CMD);
-
-				/* check the trials and return to menu if NEW_PASSWORD_TRIALS is reached */
-				if(!g_firstTime)
-				{
-					g_passTrials ++;
-				}
-				if(g_passTrials < NEW_PASSWORD_TRIALS)
-				{
-					g_innerState = 1;
-				}
-				else
-				{
-					g_innerState ++;
-				}
-
+				showNewPassError(PASS_MISMATCH_TEXT_ID);
 			}
+		}
+		else
+		{
+			/* not a password, ask for the confirmation again */
+			requestPassword(CONFIRM_NEW_PASS_TEXT_ID);
+			g_awaitOption = AWAIT_RESPONSE;
+		}
+		break;
 
-			/* wait for the specified msg to be showed on the screen for some time */
-			g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
-			g_mainTimerConfig.ticks = TIME_MS_TO_TICKS(MAIN_TIMER_PRESCALER_NUMBERS, DEFAULT_MSG_TIME_MS);
-			TIMER_init(&g_mainTimerConfig);
-			TIMER_start(TIMER_0);
+	case 4:
+		if(!EEPROM_isWriteFailed())
+		{
+			/* the new pass is saved, show "pass changed" */
+			g_firstTime = FALSE;
+			showText(PASS_CHANGED_TEXT_ID, NULL, 0);
+			g_innerState ++;
 
+			/* wait for the msg to be showed on the screen for some time */
+			g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
+			SOFTTIMER_start(MSG_TIMER_ID, DEFAULT_MSG_TIME_MS, SOFTTIMER_ONE_SHOT, msgTimerCallback);
+			g_awaitedTimer = MSG_TIMER_ID;
+		}
+		else
+		{
+			/* the eeprom keeps the old pass, so RAM takes it back, show "pass not saved" */
+			SETTINGS_revertPass();
+			showNewPassError(PASS_NOT_SAVED_TEXT_ID);
 		}
 		break;
 
-	case 4:
+	case 5:
 		/* go to main menu */
 		setAppState(MAIN_MENU_STATE);
 		g_innerState = 0;
@@ -589,6 +1229,42 @@ static void changePass(boolean a_isAuthRequired)
 	}
 }
 
+/*
+ * [Function Name]: showNewPassError
+ * [Function Description]: shows why the new password isn't changed for some time, then
+ * 						   changePass asks for it again, or returns to the main menu
+ * 						   if NEW_PASSWORD_TRIALS is reached
+ * [Args]:
+ * [in]: EN_TextId a_textId
+ * 		 id of the text
+ * [Return]: void
+ */
+static void showNewPassError(EN_TextId a_textId)
+{
+	showText(a_textId, NULL, 0);
+
+	/* check the trials and return to menu if NEW_PASSWORD_TRIALS is reached,
+	 * a first-time user can't skip setting the password */
+	if(!g_firstTime)
+	{
+		g_passTrials ++;
+	}
+	if(g_passTrials < NEW_PASSWORD_TRIALS)
+	{
+		g_innerState = 1;
+	}
+	else
+	{
+		/* the last step of changePass */
+		g_innerState = 5;
+	}
+
+	/* wait for the msg to be showed on the screen for some time */
+	g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
+	SOFTTIMER_start(MSG_TIMER_ID, DEFAULT_MSG_TIME_MS, SOFTTIMER_ONE_SHOT, msgTimerCallback);
+	g_awaitedTimer = MSG_TIMER_ID;
+}
+
 /*
  * [Function Name]: openDoor
  * [Function Description]: responsible for locking and unlocking the door
@@ -611,39 +1287,39 @@ static void openDoor(boolean a_isAuthRequired)
 		else
 		{
 			/* four inner states controlling unlocking, holding and locking the door rescpectively */
-			g_mainTimerConfig.ticks = TIME_MS_TO_TICKS(MAIN_TIMER_PRESCALER_NUMBERS, MOTOR_UNLOCK_TIME_MS);
-			TIMER_init(&g_mainTimerConfig);
-			TIMER_start(TIMER_0);
+			SOFTTIMER_start(MOTOR_TIMER_ID, MOTOR_UNLOCK_TIME_MS, SOFTTIMER_ONE_SHOT, motorTimerCallback);
+			g_awaitedTimer = MOTOR_TIMER_ID;
 			DCMOTOR_start(DCMOTOR_FORWARD, 50);
-			UART_sendByteBlocking(SHOW_DOOR_UNLOCKING_TEXT_CMD);
-			g_awaitOption = AWAIT_TIMER;
+			showText(DOOR_UNLOCKING_TEXT_ID, NULL, 0);
+			startDoorProgress(MOTOR_UNLOCK_TIME_MS, FALSE);
+			g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
 			g_innerState ++;
 		}
 		break;
 
 
 	case 1:
-		g_mainTimerConfig.ticks = TIME_MS_TO_TICKS(MAIN_TIMER_PRESCALER_NUMBERS, MOTOR_HOLD_TIME_MS);
-		TIMER_init(&g_mainTimerConfig);
-		TIMER_start(TIMER_0);
-		DCMOTOR_stop();
-		UART_sendByteBlocking(SHOW_DOOR_IS_UNLOCKED_TEXT_CMD);
-		g_awaitOption = AWAIT_TIMER;
+		/* the motor is stopped by its timer at the end of every phase */
+		SOFTTIMER_stop(PROGRESS_TIMER_ID);
+		SOFTTIMER_start(MOTOR_TIMER_ID, MOTOR_HOLD_TIME_MS, SOFTTIMER_ONE_SHOT, motorTimerCallback);
+		g_awaitedTimer = MOTOR_TIMER_ID;
+		showText(DOOR_IS_UNLOCKED_TEXT_ID, NULL, 0);
+		g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
 		g_innerState ++;
 		break;
 
 	case 2:
-		g_mainTimerConfig.ticks = TIME_MS_TO_TICKS(MAIN_TIMER_PRESCALER_NUMBERS, MOTOR_LOCK_TIME_MS);
-		TIMER_init(&g_mainTimerConfig);
-		TIMER_start(TIMER_0);
+		SOFTTIMER_start(MOTOR_TIMER_ID, MOTOR_LOCK_TIME_MS, SOFTTIMER_ONE_SHOT, motorTimerCallback);
+		g_awaitedTimer = MOTOR_TIMER_ID;
 		DCMOTOR_start(DCMOTOR_REVERSE, 50);
-		UART_sendByteBlocking(SHOW_DOOR_LOCKING_TEXT_CMD);
-		g_awaitOption = AWAIT_TIMER;
+		showText(DOOR_LOCKING_TEXT_ID, NULL, 0);
+		startDoorProgress(MOTOR_LOCK_TIME_MS, TRUE);
+		g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
 		g_innerState ++;
 		break;
 
 	case 3:
-		DCMOTOR_stop();
+		SOFTTIMER_stop(PROGRESS_TIMER_ID);
 		setAppState(MAIN_MENU_STATE);
 		g_innerState = 0;
 		break;
@@ -662,10 +1338,12 @@ static void openDoor(boolean a_isAuthRequired)
 static void auth(void)
 {
 	/* will be removed */
-	uint8_t rightPass[PASSWORD_LENGTH];
 
 	static uint8_t pass[PASSWORD_LENGTH];
 
+	/* args of the wrong pass text */
+	uint8_t trialsArgs[2];
+
 	switch(g_innerState)
 	{
 	case 0:
@@ -673,27 +1351,28 @@ static void auth(void)
 		g_innerState ++;
 		break;
 	case 1:
-		/* show "Enter Pass" and wait for response */
-		UART_sendByteBlocking(ENTER_PASS_CMD);
+		/* show "Enter Pass" and wait for the pass */
+		requestPassword(ENTER_PASS_TEXT_ID);
 		g_awaitOption = AWAIT_RESPONSE;
 		g_innerState ++;
 
 		break;
 
 	case 2:
-		/* wait till password is entered */
+		/* check the password is received, otherwise ask for it again */
 		if(readPassword(pass))
 		{
 			g_innerState ++;
 		}
+		else
+		{
+			g_innerState = 1;
+		}
 		break;
 
 	case 3:
-		/* read pass from eeprom */
-		readPassFromEeprom(rightPass);
-
-		/* compare both passwords */
-		if(comparePasswords(pass, rightPass))
+		/* compare with the saved password in RAM */
+		if(SETTINGS_checkPass(pass))
 		{
 			/* go to the previous state if password is true */
 			setAppState(g_previousState);
@@ -705,11 +1384,12 @@ static void auth(void)
 			g_passTrials ++;
 			if(g_passTrials < PASSWORD_TRIALS)
 			{
-				UART_sendByteBlocking(SHOW_WRONG_PASS_TEXT_CMD);
+				trialsArgs[0] = g_passTrials;
+				trialsArgs[1] = PASSWORD_TRIALS;
+				showText(WRONG_PASS_TEXT_ID, trialsArgs, sizeof(trialsArgs));
 				g_innerState = 1;
-				g_mainTimerConfig.ticks = TIME_MS_TO_TICKS(MAIN_TIMER_PRESCALER_NUMBERS, DEFAULT_MSG_TIME_MS);
-				TIMER_init(&g_mainTimerConfig);
-				TIMER_start(TIMER_0);
+				SOFTTIMER_start(MSG_TIMER_ID, DEFAULT_MSG_TIME_MS, SOFTTIMER_ONE_SHOT, msgTimerCallback);
+				g_awaitedTimer = MSG_TIMER_ID;
 				g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
 			}
 			else
@@ -721,87 +1401,176 @@ static void auth(void)
 		break;
 
 	case 4:
-		/* password max trials has reached, turn on buzzer and show "Access Denied" */
-		g_mainTimerConfig.ticks = TIME_MS_TO_TICKS(MAIN_TIMER_PRESCALER_NUMBERS, WARNING_MSG_TIME_MS);
-		TIMER_init(&g_mainTimerConfig);
-		TIMER_start(TIMER_0);
+		/* password max trials has reached, turn on buzzer and show "Access Denied",
+		 * the buzzer timer turns it off when the warning time ends, the message
+		 * timer counts the remaining time down on the second line
+		 */
+		SOFTTIMER_start(BUZZER_TIMER_ID, WARNING_MSG_TIME_MS, SOFTTIMER_ONE_SHOT, buzzerTimerCallback);
+		SOFTTIMER_start(MSG_TIMER_ID, LOCK_TIME_STEP_MS, SOFTTIMER_PERIODIC, msgTimerCallback);
+		g_lockSeconds = WARNING_MSG_TIME_MS / LOCK_TIME_STEP_MS;
 		BUZZER_on();
-		UART_sendByteBlocking(SHOW_ACCESS_DENIED_TEXT_CMD);
-		g_awaitOption = AWAIT_TIMER;
+		showText(ACCESS_DENIED_TEXT_ID, NULL, 0);
+		g_awaitOption = AWAIT_RESPONSE;
 		g_innerState ++;
 		break;
 
 	case 5:
-		/* turn off the buzzer */
-		BUZZER_off();
-		setAppState(MAIN_MENU_STATE);
-		g_innerState = 0;
+		/* show the remaining time and wait for the next step of the countdown */
+		showLockTime();
+		g_awaitedTimer = MSG_TIMER_ID;
+		g_awaitOption = AWAIT_RESPONSE_AND_TIMER;
+		g_innerState ++;
+		break;
+
+	case 6:
+		g_lockSeconds --;
+		if(g_lockSeconds > 0)
+		{
+			g_innerState = 5;
+		}
+		else
+		{
+			/* the buzzer is turned off by its timer */
+			SOFTTIMER_stop(MSG_TIMER_ID);
+			setAppState(MAIN_MENU_STATE);
+			g_innerState = 0;
+		}
 		break;
 	}
 }
 
+/*
+ * [Function Name]: showText
+ * [Function Description]: sends a batch to clear the screen and show a text on the
+ * 						   first line, the other MCU answers with an ACK
+ * [Args]:
+ * [in]: EN_TextId a_textId
+ * 		 id of the text
+ * [in]: const uint8_t * a_args
+ * 		 numeric args of the text
+ * [in]: uint8_t a_argsCount
+ * 		 number of the args, not more than PROTOCOL_MAX_TEXT_ARGS
+ * [Return]: void
+ */
+static void showText(EN_TextId a_textId, const uint8_t * a_args, uint8_t a_argsCount)
+{
+	uint8_t textCmds[5 + PROTOCOL_MAX_TEXT_ARGS] = {CLEAR_SCREEN_CMD, SHOW_TEXT_CMD, 0, TEXT_POS(0, 0), 0};
+	uint8_t argIndex;
+
+	if(a_argsCount > PROTOCOL_MAX_TEXT_ARGS)
+	{
+		a_argsCount = PROTOCOL_MAX_TEXT_ARGS;
+	}
+
+	/* text id at the start of the first line, then its args */
+	textCmds[2] = a_textId;
+	textCmds[4] = a_argsCount;
+	for(argIndex = 0; argIndex < a_argsCount; argIndex ++)
+	{
+		textCmds[5 + argIndex] = a_args[argIndex];
+	}
+
+	sendFrame(textCmds, 5 + a_argsCount);
+}
+
+/*
+ * [Function Name]: requestPassword
+ * [Function Description]: sends a batch to clear the screen, show a text on the first
+ * 						   line and read a password on the second line,
+ * 						   the other MCU answers with the password when the user submits it
+ * [Args]:
+ * [in]: EN_TextId a_textId
+ * 		 id of the text
+ * [Return]: void
+ */
+static void requestPassword(EN_TextId a_textId)
+{
+	const uint8_t passCmds[] = {CLEAR_SCREEN_CMD, SHOW_TEXT_CMD, a_textId, TEXT_POS(0, 0), 0,
+			SET_CURSOR_CMD, 1, 0, READ_PASS_CMD};
+
+	sendFrame(passCmds, sizeof(passCmds));
+}
+
+/*
+ * [Function Name]: showLockTime
+ * [Function Description]: sends the remaining time of the warning to be shown on the
+ * 						   second line, the other MCU answers with an ACK
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void showLockTime(void)
+{
+	const uint8_t lockCmds[] = {SHOW_TEXT_CMD, LOCKED_TIME_TEXT_ID, TEXT_POS(1, 0), 1, g_lockSeconds};
+
+	sendFrame(lockCmds, sizeof(lockCmds));
+}
+
+/*
+ * [Function Name]: startDoorProgress
+ * [Function Description]: starts updating the door progress bar every PROGRESS_STEP_MS
+ * 						   during a motor phase, the bar is shown from the first step
+ * 						   so its frame is sent after the answer of the phase text
+ * [Args]:
+ * [in]: uint32_t a_phaseTimeMs
+ * 		 time of the motor phase
+ * [in]: boolean a_isClosing
+ * 		 TRUE if the door is being locked, so the bar is emptied,
+ * 		 FALSE if it's being unlocked, so the bar is filled
+ * [Return]: void
+ */
+static void startDoorProgress(uint32_t a_phaseTimeMs, boolean a_isClosing)
+{
+	SOFTTIMER_start(PROGRESS_TIMER_ID, PROGRESS_STEP_MS, SOFTTIMER_PERIODIC, progressTimerCallback);
+	g_progressStep = 0;
+	g_progressSteps = a_phaseTimeMs / PROGRESS_STEP_MS;
+	g_isDoorClosing = a_isClosing;
+}
+
+/*
+ * [Function Name]: showDoorProgress
+ * [Function Description]: sends the current step of the door progress bar, its ack
+ * 						   isn't awaited, it's dropped when it's received
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void showDoorProgress(void)
+{
+	uint8_t progressCmds[] = {SHOW_PROGRESS_CMD, TEXT_POS(1, 0), PROGRESS_BAR_WIDTH, 0, 0};
+
+	/* the bar shows how open the door is */
+	progressCmds[3] = g_isDoorClosing ? g_progressSteps - g_progressStep : g_progressStep;
+	progressCmds[4] = g_progressSteps;
+
+	sendFrame(progressCmds, sizeof(progressCmds));
+	g_droppedAnswers ++;
+}
+
 /*
  * [Function Name]: readPassword
- * [Function Description]: read a password from the user and handles user input,
- * 						   whether deleting char, clearing screen, submiting pass and so on
+ * [Function Description]: takes the password from the received frame
  * [Args]:
  * [in]: uint8_t * password
  * 		 empty array to store the password
  * [Return]: boolean
- * 			 TRUE if the user has already finished entering the password
+ * 			 TRUE if the received frame contains a password
  * 			 FALSE otherwise
  */
 static boolean readPassword(uint8_t * password)
 {
-	static uint8_t passIndex = 0, passInnerState = 0;
+	uint8_t passIndex;
 
-	switch(passInnerState)
+	if(g_receivedFrameSize != PASSWORD_LENGTH + 1 || g_receivedFrame[0] != PASSWORD_CMD)
 	{
-	case 0:
-		/* delete a character from the password */
-		if(g_receivedData == PASS_BACKSPACE_CHAR && passIndex != 0)
-		{
-			passIndex --;
-			UART_sendByteBlocking(BACKSPACE_PASS_CHAR_CMD);
-		}
-		/* clear password */
-		else if(g_receivedData == PASS_CLEAR_SCREEN_CHAR)
-		{
-			passIndex = 0;
-			UART_sendByteBlocking(CLEAR_ALL_PASS_CHARS_CMD);
-		}
-		/* save entered char to password if it's a number */
-		else if(passIndex != PASSWORD_LENGTH && g_receivedData >= PASS_ALLOWED_START_CHAR && g_receivedData <= PASS_ALLOWED_END_CHAR)
-		{
-			password[passIndex] = g_receivedData;
-			passIndex ++;
-			UART_sendByteBlocking(READ_NEXT_PASS_CHAR_CMD);
-		}
-		/* submit entered pass */
-		else if(passIndex == PASSWORD_LENGTH && g_receivedData == PASS_ENTER_CHAR)
-		{
-			passIndex = 0;
-			UART_sendByteBlocking(STOP_RECEIVING_PASS_CMD);
-			passInnerState ++;
-		}
-		/* undefined char, skip it */
-		else
-		{
-			UART_sendByteBlocking(SKIP_PASS_CHAR_CMD);
-		}
-
-		/* await next char */
-		g_awaitOption = AWAIT_RESPONSE;
-
 		return FALSE;
-		break;
+	}
 
-	case 1:
-		passInnerState = 0;
-		return TRUE;
-		break;
+	for(passIndex = 0; passIndex < PASSWORD_LENGTH; passIndex ++)
+	{
+		password[passIndex] = g_receivedFrame[passIndex + 1];
 	}
-	return FALSE;
+	return TRUE;
 }
 
 /*
@@ -828,43 +1597,3 @@ static boolean comparePasswords(uint8_t * pass1, uint8_t * pass2)
 	}
 	return TRUE;
 }
-
-/*
- * [Function Name]: savePassToEeprom
- * [Function Description]: save password to eeprom
- * [Args]:
- * [in]: uint8_t * password
- * 		 password to save
- * [Return]: void
- */
-static void savePassToEeprom(uint8_t * password)
-{
-	uint8_t passIndex;
-
-	for(passIndex = 0; passIndex < PASSWORD_LENGTH; passIndex ++)
-	{
-		/* write char by char to eeprom */
-		while(EEPROM_writeByte(PASSWORD_EEPROM_START_ADDRESS + passIndex, password[passIndex]) == EEPROM_ERROR);
-		TIMER_DELAY_MS(20);
-	}
-}
-
-/*
- * [Function Name]: readPassFromEeprom
- * [Function Description]: read password from eeprom
- * [Args]:
- * [in]: uint8_t * password
- * 		 empty array to store the read password
- * [Return]: void
- */
-static void readPassFromEeprom(uint8_t * password)
-{
-	uint8_t passIndex;
-
-	for(passIndex = 0; passIndex < PASSWORD_LENGTH; passIndex ++)
-	{
-		/* read char by char from the eeprom */
-		while(EEPROM_readByte(PASSWORD_EEPROM_START_ADDRESS + passIndex, &password[passIndex]) == EEPROM_ERROR);
-		TIMER_DELAY_MS(20);
-	}
-}
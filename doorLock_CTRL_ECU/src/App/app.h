@@ -38,28 +38,47 @@
 /* For using defines */
 #include "../Lib/common.h"
 
+/* For using the commands shared with the other MCU */
+#include "../../../doorLock_Common/Protocol/protocol.h"
+
 /*******************************************************************************
  *                             	  Definitions                                  *
  *******************************************************************************/
 
-/* length of the password
- * the mcu will send SHOW_PASS_RULES_ERROR_TEXT_CMD if the
- * entered password not the same as PASSWORD_LENGTH
- */
-#define PASSWORD_LENGTH						5
+/* software timer of the messages shown for some time before
+ * sending other commands to the other MCU, and of the waits for
+ * the answers of the acks while connecting */
+#define MSG_TIMER_ID						0
+
+/* software timer of the motor phases */
+#define MOTOR_TIMER_ID						1
+
+/* software timer of the buzzer, turns it off when the warning time ends */
+#define BUZZER_TIMER_ID						2
+
+/* software timer of checking if the eeprom write cycle is complete */
+#define EEPROM_TIMER_ID						3
 
-/* main timer used for delaying some time before
- * sending other commands to the othe MCU */
-#define MAIN_TIMER							TIMER_0
+/* software timer of the door progress bar updates while the motor moves the door */
+#define PROGRESS_TIMER_ID					4
 
-/* main timer mode */
-#define MAIN_TIMER_MODE						TIMER_0_CTC
+/* software timer of the confirmation of the last sent frame */
+#define LINK_TIMER_ID						5
 
-/* main timer prescaler */
-#define MAIN_TIMER_PRESCALER				TIMER_0_PRESCALER_1024
+/* time between the checks of the eeprom write cycle */
+#define EEPROM_POLL_TIME_MS					1
 
-/* main timer prescaler in numbers - used for calulating total ticks from time */
-#define MAIN_TIMER_PRESCALER_NUMBERS		1024
+/* time in ms without any progress on the twi bus before the transaction is aborted
+ * and the bus is recovered, a page transfer at 400 kbps takes less than 1 ms */
+#define TWI_TIMEOUT_MS						5
+
+/* time between the acks sent while connecting to the other MCU, it's doubled
+ * after every unanswered ack till CONNECT_RETRY_MAX_TIME_MS */
+#define CONNECT_RETRY_MIN_TIME_MS			50
+#define CONNECT_RETRY_MAX_TIME_MS			800
+
+/* time without any received frame after connecting, before the first command is sent */
+#define CONNECT_DRAIN_TIME_MS				50
 
 /* default time for displaying any message on the screen */
 #define DEFAULT_MSG_TIME_MS					1000
@@ -67,6 +86,10 @@
 /* time for displaying warning msg on the screen */
 #define WARNING_MSG_TIME_MS					60000
 
+/* time between the updates of the remaining warning time on the screen,
+ * the remaining time is shown in seconds */
+#define LOCK_TIME_STEP_MS					1000
+
 /* time for turning the motor on during unlocking */
 #define MOTOR_UNLOCK_TIME_MS				15000
 
@@ -76,25 +99,19 @@
 /* time for turning the motor off between locking and unlocking */
 #define MOTOR_HOLD_TIME_MS					3000
 
+/* time between the updates of the door progress bar during unlocking and locking,
+ * the bar shows how open the door is */
+#define PROGRESS_STEP_MS					250
+
+/* number of chars of the door progress bar, it fills the second line */
+#define PROGRESS_BAR_WIDTH					16
+
 /* character responsible for choosing "open door" command */
 #define OPEN_DOOR_MENU_CHAR					'+'
 
 /* character responsible for choosing "change pass" command */
 #define CHANGE_PASS_MENU_CHAR				'-'
 
-/* range of available chars as password */
-#define PASS_ALLOWED_START_CHAR				'0'
-#define PASS_ALLOWED_END_CHAR				'9'
-
-/* character responsible for deleting a char from the pass */
-#define PASS_BACKSPACE_CHAR					'-'
-
-/* character responsible for cleering the screen during passwrod entry */
-#define PASS_CLEAR_SCREEN_CHAR				'c'
-
-/* character responsible for submiting the password */
-#define PASS_ENTER_CHAR						'='
-
 /* number of available trials to enter a new password,
  * number of wrong mismatches before returning to main menu
  */
@@ -103,15 +120,6 @@
 /* number of available traisl for entering a password */
 #define PASSWORD_TRIALS						3
 
-/* location of first time checking in the eeprom */
-#define FIRST_TIME_CHECK_ADDRESS			0x00
-
-/* location of the first address in the eeprom to store the address */
-#define PASSWORD_EEPROM_START_ADDRESS		0x01
-
-/* code for representing that the user is not a "first-time" user */
-#define NOT_FIRST_TIME_EEPROM_VAL			0x55
-
 /*******************************************************************************
  *                             Types Declaration                               *
  *******************************************************************************/
@@ -147,94 +155,53 @@ typedef enum
 }EN_AppStates;
 
 /*
- * [Enum Name]: EN_AppCommands
- * [Enum Description]: contains app commands sent and received
- * 					   between the 2 MCUs
+ * [Enum Name]: EN_AwaitOptions
+ * [Enum Description]: contains await states, whether to await receive interrupt,
+ * 					   timer interrupt, both, or await nothing,
+ * 					   they are bits so the awaited events are cleared one by one
  */
 typedef enum
 {
-	/* sent at the beginning and after executing
-	 * the previous cmd
-	 */
-	ACK_CMD = 'A',
-
-	/* show "DOOR LOCK SYSTEM" on lcd */
-	SHOW_DOOR_LOCK_TEXT_CMD,
-
-	/* read a new pass, at the beginning or at changing current pass */
-	READ_NEW_PASS_CMD,
-
-	/* new password confirmation */
-	CONFIRM_PASS_CMD,
-
-	/* receive next pass character */
-	READ_NEXT_PASS_CHAR_CMD,
-
-	/* skip pass character, when entering non valid pass character like '+', 'x', '/' */
-	SKIP_PASS_CHAR_CMD,
-
-	/* delete last entered pass character, when receiving '-' */
-	BACKSPACE_PASS_CHAR_CMD,
-
-	/* clear all entered pass characters, when receiving 'c' */
-	CLEAR_ALL_PASS_CHARS_CMD,
-
-	/* show "Password Mismatch" on lcd,
-	 * when confirmation pass is different
-	 */
-	SHOW_PASS_MISMATCH_TEXT_CMD,
-
-	/* show "Password Changed" on lcd */
-	SHOW_PASS_CHANGED_CMD,
-
-	/* Show menu and get selected option */
-	GET_MENU_OPTION_CMD,
-
-	/* get password from user to verify */
-	ENTER_PASS_CMD,
-
-	/* stop receiving other characters, because user reached max pass chars */
-	STOP_RECEIVING_PASS_CMD,
+	/* no await */
+	AWAIT_NOTHING = 0x00,
 
-	/* show "Wrong Password" on lcd */
-	SHOW_WRONG_PASS_TEXT_CMD,
+	/* await a response frame from the other MCU */
+	AWAIT_RESPONSE = 0x01,
 
-	/* show "Access Denied" on lcd
-	 * during buzzer warning
-	 */
-	SHOW_ACCESS_DENIED_TEXT_CMD,
+	/* await the awaited timer to expire */
+	AWAIT_TIMER = 0x02,
 
-	/* show "Unlocking Door" on lcd */
-	SHOW_DOOR_UNLOCKING_TEXT_CMD,
+	/* await both timer and response */
+	AWAIT_RESPONSE_AND_TIMER = AWAIT_RESPONSE | AWAIT_TIMER,
 
-	/* show "Locking Door" on lcd */
-	SHOW_DOOR_LOCKING_TEXT_CMD,
+	/* await the eeprom writes to complete */
+	AWAIT_EEPROM = 0x04,
 
-	/* show "Door is Unlocked" on lcd */
-	SHOW_DOOR_IS_UNLOCKED_TEXT_CMD,
+	/* await the dropped answers, so the next step doesn't send a frame
+	 * while another one isn't confirmed */
+	AWAIT_DROPPED_ANSWERS = 0x08
 
-}EN_AppCommands;
+}EN_AwaitOptions;
 
 /*
- * [Enum Name]: EN_AwaitOptions
- * [Enum Description]: contains await states, whether to await receive interrupt,
- * 					   timer interrupt, both, or await nothing
+ * [Enum Name]: EN_AppEvents
+ * [Enum Description]: contains the events posted to the event queue
  */
 typedef enum
 {
-	/* no await */
-	AWAIT_NOTHING,
+	/* bytes are received from the other MCU */
+	UART_RX_EVENT,
 
-	/* await uart receive interrupt */
-	AWAIT_RESPONSE,
+	/* a software timer has expired, its id is the event data */
+	TIMER_EXPIRED_EVENT,
 
-	/* await timer to finish counting */
-	AWAIT_TIMER,
+	/* the write cycle of the eeprom is complete */
+	EEPROM_DONE_EVENT,
 
-	/* await both timer and receive interrupt */
-	AWAIT_RESPONSE_AND_TIMER
+	/* a motor phase has finished and the motor is stopped */
+	MOTOR_DONE_EVENT
 
-}EN_AwaitOptions;
+}EN_AppEvents;
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
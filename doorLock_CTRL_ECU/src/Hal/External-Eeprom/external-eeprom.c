@@ -20,7 +20,79 @@
 /* For using TWI module */
 #include "../../Mcal/Twi/twi.h"
 
-#include "../../Mcal/Dio/dio.h"
+/* For timing the write cycle */
+#include "../../Service/System-Clock/system-clock.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* 7-bit address of the device, ored with A10 A9 A8 of the memory location */
+#define EEPROM_DEVICE_ADDRESS				0x50
+
+/* states of writing a page */
+#define EEPROM_WRITE_IDLE					0
+#define EEPROM_WRITE_TRANSFER				1
+#define EEPROM_WRITE_CYCLE					2
+
+/*******************************************************************************
+ *                      Static Functions Prototypes	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: waitWriteCycle
+ * [Function Description]: waits till the last page is written and its write cycle is complete,
+ * 						   the write cycle is given up after EEPROM_WRITE_CYCLE_MAX_MS
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void waitWriteCycle(void);
+
+/*
+ * [Function Name]: startPoll
+ * [Function Description]: queues a transaction that only addresses the device,
+ * 						   the device answers only if it's not in a write cycle
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void startPoll(void);
+
+/*
+ * [Function Name]: incrementRetries
+ * [Function Description]: counts a retried transaction, the count stops at 65535
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void incrementRetries(void);
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* the only transaction of the driver, a new one starts after it's complete */
+static ST_TwiTransaction g_transaction = { EEPROM_DEVICE_ADDRESS, NULL, 0, NULL, 0, TRUE, NULL, TWI_DONE };
+
+/* memory location address followed by the data of a page, the bus
+ * reads it while the caller continues so the caller's data isn't used */
+static uint8_t g_pageBuffer[EEPROM_PAGE_SIZE + 1];
+
+/* state of writing the last page */
+static uint8_t g_writeState = EEPROM_WRITE_IDLE;
+
+/* states whether the transfer of a page failed, reported by the next write or wait */
+static boolean g_isWriteFailed = FALSE;
+
+/* time of starting the last write cycle in ms */
+static uint32_t g_writeStartMs = 0;
+
+/* number of times the last page is sent again */
+static uint8_t g_transferTrials = 0;
+
+/* number of retried transactions since the start */
+static uint16_t g_retriesCount = 0;
 
 /*******************************************************************************
  *                          Functions Definition	                           *
@@ -39,80 +111,332 @@
  */
 uint8_t EEPROM_writeByte(uint16_t a_u16addr, uint8_t a_u8data)
 {
-	/* Send the Start Bit */
-	TWI_start();
-	if (TWI_getStatus() != TWI_START)
-		return EEPROM_ERROR;
+	return EEPROM_writePage(a_u16addr, &a_u8data, 1);
+}
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=0 (write) */
-	TWI_writeByte((uint8_t)(0xA0 | ((a_u16addr & 0x0700) >> 7)));
-	if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
-		return EEPROM_ERROR;
+/*
+ * [Function Name]: EEPROM_readByte
+ * [Function Description]: reades a byte from the eeprom from the specified address
+ * [Args]:
+ * [in]: uint16_t a_u16addr
+ * 		 the address in the eeprom to read from
+ * [in]: uint8_t * a_u8data
+ * 		 pointer to the location where the data will be saved
+ * [Return]: uint8_t
+ * 			 EEPROM_ERROR or EEPROM_SUCCESS
+ */
+uint8_t EEPROM_readByte(uint16_t a_u16addr, uint8_t * a_u8data)
+{
+	return EEPROM_readBlock(a_u16addr, a_u8data, 1);
+}
 
-	/* Send the required memory location address */
-	TWI_writeByte((uint8_t)(a_u16addr));
-	if (TWI_getStatus() != TWI_MT_DATA_ACK)
-		return EEPROM_ERROR;
+/*
+ * [Function Name]: EEPROM_writePage
+ * [Function Description]: writes bytes to the eeprom starting from the specified address,
+ * 						   the bytes of every page are written in one transaction and the
+ * 						   block is split at the page boundaries, it waits for the write
+ * 						   cycle of a page before writing the next one and returns as soon
+ * 						   as the last page is queued, the bus sends it in the background
+ * 						   and EEPROM_isWritePending() tells when it's written
+ * [Args]:
+ * [in]: uint16_t a_u16addr
+ * 		 the address in the eeprom to write to
+ * [in]: const uint8_t * a_data
+ * 		 the data to write in the eeprom
+ * [in]: uint16_t a_u16size
+ * 		 number of bytes to write
+ * [Return]: uint8_t
+ * 			 EEPROM_ERROR or EEPROM_SUCCESS
+ */
+uint8_t EEPROM_writePage(uint16_t a_u16addr, const uint8_t * a_data, uint16_t a_u16size)
+{
+	uint16_t pageBytes, byteIndex;
 
-	/* write byte to eeprom */
-	TWI_writeByte(a_u8data);
-	if (TWI_getStatus() != TWI_MT_DATA_ACK)
+	if(a_u16size == 0 || a_u16addr >= EEPROM_SIZE || a_u16size > EEPROM_SIZE - a_u16addr)
 		return EEPROM_ERROR;
 
-	/* Send the Stop Bit */
-	TWI_stop();
+	while(a_u16size != 0)
+	{
+		/* bytes till the end of the page, the address rolls over inside the page
+		 * so the rest of the block goes to the next page in a new transaction */
+		pageBytes = EEPROM_PAGE_SIZE - (a_u16addr & (EEPROM_PAGE_SIZE - 1));
+		if(pageBytes > a_u16size)
+		{
+			pageBytes = a_u16size;
+		}
+
+		/* the device doesn't answer during the write cycle of the previous page,
+		 * the failure of the previous page, or of a previous write, is reported once */
+		waitWriteCycle();
+		if(g_isWriteFailed)
+		{
+			g_isWriteFailed = FALSE;
+			return EEPROM_ERROR;
+		}
+
+		g_pageBuffer[0] = (uint8_t)a_u16addr;
+		for(byteIndex = 0; byteIndex < pageBytes; byteIndex ++)
+		{
+			g_pageBuffer[byteIndex + 1] = a_data[byteIndex];
+		}
+
+		/* A10 A9 A8 of the memory location are sent in the device address */
+		g_transaction.address = (uint8_t)(EEPROM_DEVICE_ADDRESS | ((a_u16addr >> 8) & 0x07));
+		g_transaction.writeData = g_pageBuffer;
+		g_transaction.writeSize = pageBytes + 1;
+		g_transaction.readSize = 0;
+
+		if(TWI_submit(&g_transaction) == TWI_ERROR)
+			return EEPROM_ERROR;
+
+		g_writeState = EEPROM_WRITE_TRANSFER;
+		g_transferTrials = 0;
+
+		a_u16addr += pageBytes;
+		a_data += pageBytes;
+		a_u16size -= pageBytes;
+	}
 
 	return EEPROM_SUCCESS;
 }
 
 /*
- * [Function Name]: EEPROM_readByte
- * [Function Description]: reades a byte from the eeprom from the specified address
+ * [Function Name]: EEPROM_readBlock
+ * [Function Description]: reads bytes from the eeprom starting from the specified address
+ * 						   in one sequential read transaction, the interrupts keep running
+ * 						   while the bus reads the bytes
  * [Args]:
  * [in]: uint16_t a_u16addr
  * 		 the address in the eeprom to read from
- * [in]: uint8_t * a_u8data
- * 		 pointer to the location where the data will be saved
+ * [out]: uint8_t * a_data
+ * 		  array where the data will be saved
+ * [in]: uint16_t a_u16size
+ * 		 number of bytes to read
  * [Return]: uint8_t
  * 			 EEPROM_ERROR or EEPROM_SUCCESS
  */
-uint8_t EEPROM_readByte(uint16_t a_u16addr, uint8_t * a_u8data)
+uint8_t EEPROM_readBlock(uint16_t a_u16addr, uint8_t * a_data, uint16_t a_u16size)
 {
-	/* Send the Start Bit */
-	TWI_start();
-	if (TWI_getStatus() != TWI_START)
-		return EEPROM_ERROR;
+	uint8_t trial;
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=0 (write) */
-	TWI_writeByte((uint8_t)((0xA0) | ((a_u16addr & 0x0700) >> 7)));
-	if (TWI_getStatus() != TWI_MT_SLA_W_ACK)
+	if(a_u16size == 0 || a_u16addr >= EEPROM_SIZE || a_u16size > EEPROM_SIZE - a_u16addr)
 		return EEPROM_ERROR;
 
-	/* Send the required memory location address */
-	TWI_writeByte((uint8_t)(a_u16addr));
-	if (TWI_getStatus() != TWI_MT_DATA_ACK)
-		return EEPROM_ERROR;
+	waitWriteCycle();
 
-	/* Send the Repeated Start Bit */
-	TWI_start();
-	if (TWI_getStatus() != TWI_REP_START)
-		return EEPROM_ERROR;
+	/* write the memory location address then read from it after a repeated start,
+	 * the read continues to the next blocks */
+	g_pageBuffer[0] = (uint8_t)a_u16addr;
+	g_transaction.address = (uint8_t)(EEPROM_DEVICE_ADDRESS | ((a_u16addr >> 8) & 0x07));
+	g_transaction.writeData = g_pageBuffer;
+	g_transaction.writeSize = 1;
+	g_transaction.readData = a_data;
+	g_transaction.readSize = a_u16size;
+	g_transaction.isRepeatedStart = TRUE;
 
-	/* Send the device address, we need to get A8 A9 A10 address bits from the
-	 * memory location address and R/W=1 (Read) */
-	TWI_writeByte((uint8_t)((0xA0) | ((a_u16addr & 0x0700) >> 7) | 1));
-	if (TWI_getStatus() != TWI_MT_SLA_R_ACK)
-		return EEPROM_ERROR;
+	for(trial = 0; ; trial ++)
+	{
+		if(TWI_submit(&g_transaction) == TWI_ERROR)
+			return EEPROM_ERROR;
 
-	/* Read Byte from Memory without send ACK */
-	*a_u8data = TWI_readByteWithoutACK();
-	if (TWI_getStatus() != TWI_MR_DATA_NACK)
-		return EEPROM_ERROR;
+		/* a stuck transaction is aborted by the twi timeout */
+		while(g_transaction.result == TWI_BUSY)
+		{
+			TWI_checkTimeout();
+			CPU_IDLE_HINT();
+		}
+
+		if(g_transaction.result == TWI_DONE)
+			return EEPROM_SUCCESS;
+
+		if(trial == EEPROM_RETRIES)
+			return EEPROM_ERROR;
+
+		incrementRetries();
+	}
+}
+
+/*
+ * [Function Name]: EEPROM_isWritePending
+ * [Function Description]: checks if the last written page is still being sent or in its
+ * 						   write cycle, it polls the device in the background and doesn't
+ * 						   wait, so the app can check it while doing other work, the write
+ * 						   cycle is considered complete after EEPROM_WRITE_CYCLE_MAX_MS even
+ * 						   if the device doesn't answer, then the write is reported as failed
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the write is running, FALSE otherwise
+ */
+boolean EEPROM_isWritePending(void)
+{
+	/* the page or the last poll is still on the bus, or stuck */
+	TWI_checkTimeout();
+	if(g_transaction.result == TWI_BUSY)
+	{
+		return TRUE;
+	}
+
+	switch(g_writeState)
+	{
+	case EEPROM_WRITE_TRANSFER:
+		if(g_transaction.result != TWI_DONE)
+		{
+			/* the page is still in the buffer, send it again */
+			if(g_transferTrials < EEPROM_RETRIES)
+			{
+				g_transferTrials ++;
+				incrementRetries();
+				TWI_submit(&g_transaction);
+			}
+			else
+			{
+				g_isWriteFailed = TRUE;
+				g_writeState = EEPROM_WRITE_IDLE;
+			}
+			break;
+		}
+
+		/* the write cycle started with the stop of the page */
+		g_writeStartMs = SYSCLK_nowMs();
+		g_writeState = EEPROM_WRITE_CYCLE;
+		startPoll();
+		break;
+
+	case EEPROM_WRITE_CYCLE:
+		if(g_transaction.result == TWI_DONE)
+		{
+			g_writeState = EEPROM_WRITE_IDLE;
+		}
+		else if(SYSCLK_nowMs() - g_writeStartMs >= EEPROM_WRITE_CYCLE_MAX_MS)
+		{
+			/* the device never answered after the page */
+			g_isWriteFailed = TRUE;
+			g_writeState = EEPROM_WRITE_IDLE;
+		}
+		else
+		{
+			startPoll();
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return g_writeState != EEPROM_WRITE_IDLE;
+}
+
+/*
+ * [Function Name]: EEPROM_isWriteFailed
+ * [Function Description]: checks the outcome of the last write after EEPROM_isWritePending()
+ * 						   returns FALSE, the failure is reported once, so the next write
+ * 						   doesn't report it again
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if a page couldn't be sent or its write cycle didn't complete,
+ * 			 FALSE otherwise
+ */
+boolean EEPROM_isWriteFailed(void)
+{
+	boolean isFailed = g_isWriteFailed;
+
+	g_isWriteFailed = FALSE;
+	return isFailed;
+}
+
+/*
+ * [Function Name]: EEPROM_waitReady
+ * [Function Description]: polls the device till the last written page is written or the
+ * 						   timeout passes, the interrupts keep running during the wait
+ * [Args]:
+ * [in]: uint16_t a_timeoutMs
+ * 		 maximum time to wait in ms
+ * [Return]: uint8_t
+ * 			 EEPROM_SUCCESS if the device is ready, EEPROM_ERROR on timeout
+ * 			 or if the last page couldn't be sent
+ */
+uint8_t EEPROM_waitReady(uint16_t a_timeoutMs)
+{
+	uint32_t startMs = SYSCLK_nowMs();
 
-	/* Send the Stop Bit */
-	TWI_stop();
+	while(EEPROM_isWritePending())
+	{
+		if(SYSCLK_nowMs() - startMs >= a_timeoutMs)
+			return EEPROM_ERROR;
+
+		CPU_IDLE_HINT();
+	}
+
+	if(g_isWriteFailed)
+	{
+		g_isWriteFailed = FALSE;
+		return EEPROM_ERROR;
+	}
 
 	return EEPROM_SUCCESS;
 }
+
+/*
+ * [Function Name]: EEPROM_retriesCount
+ * [Function Description]: gets the number of transactions retried after a nack, a bus error
+ * 						   or a timeout, a growing count means a flaky bus
+ * [Args]:
+ * [in]: void
+ * [Return]: uint16_t
+ * 			 number of retries, it stops at 65535
+ */
+uint16_t EEPROM_retriesCount(void)
+{
+	return g_retriesCount;
+}
+
+/*
+ * [Function Name]: waitWriteCycle
+ * [Function Description]: waits till the last page is written and its write cycle is complete,
+ * 						   the write cycle is given up after EEPROM_WRITE_CYCLE_MAX_MS
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void waitWriteCycle(void)
+{
+	while(EEPROM_isWritePending())
+	{
+		CPU_IDLE_HINT();
+	}
+}
+
+/*
+ * [Function Name]: startPoll
+ * [Function Description]: queues a transaction that only addresses the device,
+ * 						   the device answers only if it's not in a write cycle
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void startPoll(void)
+{
+	g_transaction.address = EEPROM_DEVICE_ADDRESS;
+	g_transaction.writeSize = 0;
+	g_transaction.readSize = 0;
+
+	/* the queue can't be full as the driver has one transaction only */
+	TWI_submit(&g_transaction);
+}
+
+/*
+ * [Function Name]: incrementRetries
+ * [Function Description]: counts a retried transaction, the count stops at 65535
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void incrementRetries(void)
+{
+	if(g_retriesCount != 0xFFFF)
+	{
+		g_retriesCount ++;
+	}
+}
@@ -33,6 +33,18 @@
 /* returned if the operation (R/W) completed successfully */
 #define EEPROM_SUCCESS 						1
 
+/* size of a page, a write transaction can write in one page only */
+#define EEPROM_PAGE_SIZE					16
+
+/* size of the eeprom in bytes */
+#define EEPROM_SIZE							2048
+
+/* maximum time of the write cycle of a page in ms */
+#define EEPROM_WRITE_CYCLE_MAX_MS			10
+
+/* number of times a failed transaction is sent again before reporting the error */
+#define EEPROM_RETRIES						2
+
 /*******************************************************************************
  *                           Function Prototypes                               *
  *******************************************************************************/
@@ -63,4 +75,92 @@ uint8_t EEPROM_writeByte(uint16_t a_u16addr, uint8_t a_u8data);
  */
 uint8_t EEPROM_readByte(uint16_t a_u16addr, uint8_t * a_u8data);
 
+/*
+ * [Function Name]: EEPROM_writePage
+ * [Function Description]: writes bytes to the eeprom starting from the specified address,
+ * 						   the bytes of every page are written in one transaction and the
+ * 						   block is split at the page boundaries, it waits for the write
+ * 						   cycle of a page before writing the next one and returns as soon
+ * 						   as the last page is queued, the bus sends it in the background
+ * 						   and EEPROM_isWritePending() tells when it's written
+ * [Args]:
+ * [in]: uint16_t a_u16addr
+ * 		 the address in the eeprom to write to
+ * [in]: const uint8_t * a_data
+ * 		 the data to write in the eeprom
+ * [in]: uint16_t a_u16size
+ * 		 number of bytes to write
+ * [Return]: uint8_t
+ * 			 EEPROM_ERROR or EEPROM_SUCCESS
+ */
+uint8_t EEPROM_writePage(uint16_t a_u16addr, const uint8_t * a_data, uint16_t a_u16size);
+
+/*
+ * [Function Name]: EEPROM_readBlock
+ * [Function Description]: reads bytes from the eeprom starting from the specified address
+ * 						   in one sequential read transaction, the interrupts keep running
+ * 						   while the bus reads the bytes
+ * [Args]:
+ * [in]: uint16_t a_u16addr
+ * 		 the address in the eeprom to read from
+ * [out]: uint8_t * a_data
+ * 		  array where the data will be saved
+ * [in]: uint16_t a_u16size
+ * 		 number of bytes to read
+ * [Return]: uint8_t
+ * 			 EEPROM_ERROR or EEPROM_SUCCESS
+ */
+uint8_t EEPROM_readBlock(uint16_t a_u16addr, uint8_t * a_data, uint16_t a_u16size);
+
+/*
+ * [Function Name]: EEPROM_isWritePending
+ * [Function Description]: checks if the last written page is still being sent or in its
+ * 						   write cycle, it polls the device in the background and doesn't
+ * 						   wait, so the app can check it while doing other work, the write
+ * 						   cycle is considered complete after EEPROM_WRITE_CYCLE_MAX_MS even
+ * 						   if the device doesn't answer, then the write is reported as failed
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the write is running, FALSE otherwise
+ */
+boolean EEPROM_isWritePending(void);
+
+/*
+ * [Function Name]: EEPROM_isWriteFailed
+ * [Function Description]: checks the outcome of the last write after EEPROM_isWritePending()
+ * 						   returns FALSE, the failure is reported once, so the next write
+ * 						   doesn't report it again
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if a page couldn't be sent or its write cycle didn't complete,
+ * 			 FALSE otherwise
+ */
+boolean EEPROM_isWriteFailed(void);
+
+/*
+ * [Function Name]: EEPROM_waitReady
+ * [Function Description]: polls the device till the last written page is written or the
+ * 						   timeout passes, the interrupts keep running during the wait
+ * [Args]:
+ * [in]: uint16_t a_timeoutMs
+ * 		 maximum time to wait in ms
+ * [Return]: uint8_t
+ * 			 EEPROM_SUCCESS if the device is ready, EEPROM_ERROR on timeout
+ * 			 or if the last page couldn't be sent
+ */
+uint8_t EEPROM_waitReady(uint16_t a_timeoutMs);
+
+/*
+ * [Function Name]: EEPROM_retriesCount
+ * [Function Description]: gets the number of transactions retried after a nack, a bus error
+ * 						   or a timeout, a growing count means a flaky bus
+ * [Args]:
+ * [in]: void
+ * [Return]: uint16_t
+ * 			 number of retries, it stops at 65535
+ */
+uint16_t EEPROM_retriesCount(void);
+
 #endif /* __EXTERNAL_EEPROM_H__ */
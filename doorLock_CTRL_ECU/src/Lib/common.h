@@ -84,9 +84,48 @@
 
 #define SELECT_INV_BIT(bit) (~(1 << (bit)))
 
-/* Interrupts */
+/* Interrupts, can be overridden by a host build */
+#ifndef ENABLE_GLOBAL_INTERRUPT
 #define ENABLE_GLOBAL_INTERRUPT()  __asm__ __volatile__ ("sei" ::)
+#endif
+
+#ifndef DISABLE_GLOBAL_INTERRUPT
 #define DISABLE_GLOBAL_INTERRUPT()  __asm__ __volatile__ ("cli" ::)
+#endif
+
+/* called in busy wait loops that wait for an interrupt to change a flag,
+ * it does nothing on the target, a host build uses it to skip the idle time
+ */
+#ifndef CPU_IDLE_HINT
+#define CPU_IDLE_HINT()
+#endif
+
+/* busy waits an exact number of cpu cycles, for the short timings of the external
+ * devices, the number must be a constant, can be overridden by a host build */
+#ifndef CPU_DELAY_CYCLES
+#define CPU_DELAY_CYCLES(cycles)  __builtin_avr_delay_cycles(cycles)
+#endif
+
+/* puts the cpu to sleep in the mode selected in MCUCR, can be overridden by a host build */
+#ifndef CPU_SLEEP
+#define CPU_SLEEP()  __asm__ __volatile__ ("sleep" ::)
+#endif
+
+/* places constant data in the flash only, so it isn't copied to the ram at startup,
+ * it must be read with FLASH_READ_BYTE(), both can be overridden by a host build */
+#ifndef FLASH_CONST
+#define FLASH_CONST  __attribute__((__progmem__))
+#endif
+
+/* reads the byte at an address of the flash with the lpm instruction */
+#ifndef FLASH_READ_BYTE
+#define FLASH_READ_BYTE(addr)  (__extension__({					\
+	unsigned short __flashAddr = (unsigned short)(addr);				\
+	unsigned char __flashByte;											\
+	__asm__ __volatile__ ("lpm %0, Z" : "=r" (__flashByte) : "z" (__flashAddr));	\
+	__flashByte;														\
+}))
+#endif
 
 
 #endif /* __COMMON_H__*/
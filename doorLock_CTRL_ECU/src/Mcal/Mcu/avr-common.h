@@ -11,6 +11,7 @@
 #  define __INTR_ATTRS used
 #endif
 
+#ifndef ISR
 #ifdef __cplusplus
 #  define ISR(vector, ...)            \
     extern "C" void vector (void) __attribute__ ((signal,__INTR_ATTRS)) __VA_ARGS__; \
@@ -20,6 +21,7 @@
     void vector (void) __attribute__ ((signal,__INTR_ATTRS)) __VA_ARGS__; \
     void vector (void)
 #endif
+#endif
 
 #ifdef __cplusplus
 #  define SIGNAL(vector)					\
@@ -0,0 +1,159 @@
+/******************************************************************************
+ *
+ * Module: POWER
+ *
+ * File Name: power.h
+ *
+ * Description: Header file for the AVR sleep modes driver, it puts the cpu to
+ * 				sleep in the deepest mode that keeps the needed wake up sources
+ * 				running and counts the sleeps and the time spent in every mode
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __POWER_H__
+#define __POWER_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* For using std types */
+#include "../../Lib/types.h"
+
+/* For using common defines and macros */
+#include "../../Lib/common.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* wake up sources, ored together and passed to POWER_deepestMode() */
+
+/* uart receive complete and data register empty */
+#define POWER_WAKE_UART						0x01
+
+/* timers clocked by the cpu clock (TIMER_0, TIMER_1 and a synchronous TIMER_2) */
+#define POWER_WAKE_TIMERS					0x02
+
+/* adc conversion complete */
+#define POWER_WAKE_ADC						0x04
+
+/* TIMER_2 clocked asynchronously from the TOSC pins */
+#define POWER_WAKE_TIMER2_ASYNC				0x08
+
+/* external interrupts INT0, INT1 and INT2, twi address match */
+#define POWER_WAKE_EXT_INT					0x10
+
+/* number of the supported sleep modes */
+#define POWER_SLEEP_MODES_COUNT				4
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Enum Name]: EN_PowerSleepMode
+ * [Enum Description]: contains the supported sleep modes, from the lightest to
+ * 					   the deepest, the values are the SM2:0 bits of MCUCR
+ */
+typedef enum
+{
+	/* only the cpu clock is stopped, all the peripherals can wake it up */
+	POWER_IDLE,
+
+	/* the io clock is stopped too, the adc, the external interrupts,
+	 * the twi address match and the async TIMER_2 can wake it up */
+	POWER_ADC_NOISE_REDUCTION,
+
+	/* all the clocks are stopped, only the external interrupts
+	 * and the twi address match can wake it up */
+	POWER_DOWN,
+
+	/* like power-down but the async TIMER_2 keeps running */
+	POWER_SAVE
+
+}EN_PowerSleepMode;
+
+/*
+ * [Struct Name]: ST_PowerStats
+ * [Struct Description]: residency counters of the sleep modes, indexed by EN_PowerSleepMode
+ */
+typedef struct
+{
+	/* number of times the cpu slept in every mode */
+	uint32_t sleeps[POWER_SLEEP_MODES_COUNT];
+
+	/* time spent in every mode in us, counted by the time source of POWER_init(),
+	 * the ISR that wakes the cpu up is counted as sleep time */
+	uint32_t timeUs[POWER_SLEEP_MODES_COUNT];
+
+}ST_PowerStats;
+
+/*******************************************************************************
+ *                           Function Prototypes                               *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: POWER_init
+ * [Function Description]: resets the residency counters and sets the time source of the sleep time
+ * [Args]:
+ * [in]: uint32_t (* a_nowUs)(void)
+ * 		 function returning a time in us that can be read with the interrupts
+ * 		 disabled, or NULL to count the sleeps only
+ * [Return]: void
+ */
+void POWER_init(uint32_t (* a_nowUs)(void));
+
+/*
+ * [Function Name]: POWER_deepestMode
+ * [Function Description]: gets the deepest sleep mode that keeps all the wake up sources running
+ * [Args]:
+ * [in]: uint8_t a_wakeSources
+ * 		 ored POWER_WAKE_xxx sources
+ * [Return]: EN_PowerSleepMode
+ * 			 deepest possible sleep mode
+ */
+EN_PowerSleepMode POWER_deepestMode(uint8_t a_wakeSources);
+
+/*
+ * [Function Name]: POWER_sleep
+ * [Function Description]: sleeps till an interrupt wakes the cpu up and its ISR runs,
+ * 						   it must be called with the global interrupt disabled after
+ * 						   checking that there is nothing to do, so an interrupt between
+ * 						   the check and the sleep still wakes the cpu up,
+ * 						   it returns with the global interrupt enabled
+ * [Args]:
+ * [in]: EN_PowerSleepMode a_mode
+ * 		 sleep mode
+ * [Return]: void
+ */
+void POWER_sleep(EN_PowerSleepMode a_mode);
+
+/*
+ * [Function Name]: POWER_sleepWhile
+ * [Function Description]: sleeps in the deepest possible mode as long as the condition is true,
+ * 						   the condition is checked with the global interrupt disabled so it
+ * 						   must be short and must not wait for an interrupt,
+ * 						   it returns with the global interrupt enabled
+ * [Args]:
+ * [in]: boolean (* a_condition)(void)
+ * 		 condition to keep sleeping
+ * [in]: uint8_t a_wakeSources
+ * 		 ored POWER_WAKE_xxx sources that may end the condition
+ * [Return]: void
+ */
+void POWER_sleepWhile(boolean (* a_condition)(void), uint8_t a_wakeSources);
+
+/*
+ * [Function Name]: POWER_getStats
+ * [Function Description]: gets the residency counters of the sleep modes
+ * [Args]:
+ * [out]: ST_PowerStats * a_stats
+ * 		  structure to store the counters
+ * [Return]: void
+ */
+void POWER_getStats(ST_PowerStats * a_stats);
+
+#endif /* __POWER_H__ */
@@ -29,21 +29,19 @@
 
 /*
  * [Function Name]: ticksPerIteration
- * [Function Description]: calculate the actual ticks from the passed ticks
- * 						   and setting global interrupt counts for the passed
- * 						   timer
+ * [Function Description]: calculate the actual ticks from the ticks of the config
+ * 						   and setting global interrupt counts for its timer,
+ * 						   the precomputed split of the config is used if it's set
  * [Args]:
- * [in]: uint8_t timer
- * 		 time to delay for in ms
- * [in]: uint32_t ticks
- * 		 total number of ticks, any 32-bit unsigned number
+ * [in]: const TIMER_config * a_timerConfig
+ * 		 config of the timer, its ticks can be any 32-bit unsigned number
  * [in]: uint16_t maxCounts
  * 		 max number of ticks available for each timer
  * [Return]: uint16_t
  * 			 number of ticks that can fit in the timer count register (in OVF mood)
  * 			 or in OCRx (in CTC mood)
  */
-static uint16_t ticksPerIteration(uint8_t a_timer, uint32_t a_ticks, uint16_t a_maxCounts);
+static uint16_t ticksPerIteration(const TIMER_config * a_timerConfig, uint16_t a_maxCounts);
 
 /*******************************************************************************
  *                            Global Variables	                               *
@@ -97,8 +95,7 @@ uint8_t TIMER_init(TIMER_config* a_timerConfig){
 		switch (a_timerConfig->mode) {
 		case TIMER_0_OVF:
 			/* set start value of the timer to be equal 256 - ticks per interrupt */
-			g_timer0_ovf_start = TIMER_0_MAX_COUNT + 1 - ticksPerIteration(a_timerConfig->timer, \
-					a_timerConfig->ticks, TIMER_0_MAX_COUNT);
+			g_timer0_ovf_start = TIMER_0_MAX_COUNT + 1 - ticksPerIteration(a_timerConfig, TIMER_0_MAX_COUNT);
 			TCNT0_R = g_timer0_ovf_start;
 
 			/* set timer pointer to handler */
@@ -120,7 +117,7 @@ uint8_t TIMER_init(TIMER_config* a_timerConfig){
 			TCNT0_R = 0;
 
 			/* compare on the value of ticks per interrupt */
-			OCR0_R = ticksPerIteration(a_timerConfig->timer, a_timerConfig->ticks, TIMER_0_MAX_COUNT) - 1;
+			OCR0_R = ticksPerIteration(a_timerConfig, TIMER_0_MAX_COUNT) - 1;
 
 			/* set timer pointer to handler */
 			g_timerInterruptHandler[TIMER_0] = a_timerConfig->ptrToHandler;
@@ -154,8 +151,7 @@ uint8_t TIMER_init(TIMER_config* a_timerConfig){
 
 			case TIMER_1_OVF:
 				/* set start value of the timer to be equal 65536 - ticks per interrupt */
-				g_timer1_ovf_start = TIMER_1_MAX_COUNT + 1 - ticksPerIteration(a_timerConfig->timer, \
-						a_timerConfig->ticks, TIMER_1_MAX_COUNT);
+				g_timer1_ovf_start = TIMER_1_MAX_COUNT + 1 - ticksPerIteration(a_timerConfig, TIMER_1_MAX_COUNT);
 				TCNT1_R = g_timer1_ovf_start;
 
 				/* set timer pointer to handler */
@@ -181,7 +177,7 @@ uint8_t TIMER_init(TIMER_config* a_timerConfig){
 				TCNT1_R = 0;
 
 				/* compare on the value of ticks per interrupt */
-				OCR1A_R = ticksPerIteration(a_timerConfig->timer, a_timerConfig->ticks, TIMER_1_MAX_COUNT) - 1;
+				OCR1A_R = ticksPerIteration(a_timerConfig, TIMER_1_MAX_COUNT) - 1;
 
 				/* set timer pointer to handler */
 				g_timerInterruptHandler[TIMER_1] = a_timerConfig->ptrToHandler;
@@ -230,8 +226,7 @@ uint8_t TIMER_init(TIMER_config* a_timerConfig){
 				switch (a_timerConfig->mode) {
 				case TIMER_2_OVF:
 					/* set start value of the timer to be equal 256 - ticks per interrupt */
-					g_timer2_ovf_start = TIMER_2_MAX_COUNT + 1 - ticksPerIteration(a_timerConfig->timer, a_timerConfig->ticks, \
-							TIMER_2_MAX_COUNT);
+					g_timer2_ovf_start = TIMER_2_MAX_COUNT + 1 - ticksPerIteration(a_timerConfig, TIMER_2_MAX_COUNT);
 					TCNT2_R = g_timer2_ovf_start;
 
 					/* set timer pointer to handler */
@@ -254,7 +249,7 @@ uint8_t TIMER_init(TIMER_config* a_timerConfig){
 					TCNT2_R = 0;
 
 					/* compare on the value of ticks per interrupt */
-					OCR2_R = ticksPerIteration(a_timerConfig->timer, a_timerConfig->ticks, TIMER_2_MAX_COUNT) - 1;
+					OCR2_R = ticksPerIteration(a_timerConfig, TIMER_2_MAX_COUNT) - 1;
 
 					/* set timer pointer to handler */
 					g_timerInterruptHandler[TIMER_2] = a_timerConfig->ptrToHandler;
@@ -345,6 +340,38 @@ uint8_t TIMER_stop(uint8_t a_timer){
 	return TIMER_SUCCESS;
 }
 
+/*
+ * [Function Name]: TIMER_resetCount
+ * [Function Description]: restarts the count of the current period of a timer, so its next
+ * 						   interrupt comes one whole period later, e.g. to keep a minimum time
+ * 						   after an action taken in a callback that other interrupts may delay
+ * [Args]:
+ * [in]: uint8_t a_timer
+ * 		 timer to reset
+ * [Return]: uint8_t
+ * 			 TIMER_SUCCESS or TIMER_ERROR
+ */
+uint8_t TIMER_resetCount(uint8_t a_timer)
+{
+	/* the overflow mode counts from its start value, the other modes from 0 */
+	switch(a_timer)
+	{
+	case TIMER_0:
+		TCNT0_R = (BIT_IS_CLEAR(TCCR0_R, WGM00) && BIT_IS_CLEAR(TCCR0_R, WGM01)) ? g_timer0_ovf_start : 0;
+		break;
+	case TIMER_1:
+		TCNT1_R = ((TCCR1A_R & 0b00000011) == 0 && BIT_IS_CLEAR(TCCR1B_R, WGM12) && BIT_IS_CLEAR(TCCR1B_R, WGM13)) ?
+				g_timer1_ovf_start : 0;
+		break;
+	case TIMER_2:
+		TCNT2_R = (BIT_IS_CLEAR(TCCR2_R, WGM20) && BIT_IS_CLEAR(TCCR2_R, WGM21)) ? g_timer2_ovf_start : 0;
+		break;
+	default:
+		return TIMER_ERROR;
+	}
+	return TIMER_SUCCESS;
+}
+
 /*
  * [Function Name]: TIMER_read
  * [Function Description]: gets the value of the current count of a timer
@@ -376,15 +403,43 @@ uint16_t TIMER_read(uint8_t a_timer)
 	return count;
 }
 
+/*
+ * [Function Name]: TIMER_isOverflowPending
+ * [Function Description]: checks the overflow flag of a timer, it's set when the
+ * 						   timer overflows and cleared when its ovf ISR runs, so it
+ * 						   tells whether an overflow is not handled yet,
+ * 						   e.g. while the interrupts are disabled
+ * [Args]:
+ * [in]: uint8_t a_timer
+ * 		 timer to check
+ * [Return]: boolean
+ * 			 TRUE if the overflow flag is set, FALSE otherwise
+ */
+boolean TIMER_isOverflowPending(uint8_t a_timer)
+{
+	switch(a_timer)
+	{
+	case TIMER_0:
+		return BIT_IS_SET(TIFR_R, TOV0) ? TRUE : FALSE;
+	case TIMER_1:
+		return BIT_IS_SET(TIFR_R, TOV1) ? TRUE : FALSE;
+	case TIMER_2:
+		return BIT_IS_SET(TIFR_R, TOV2) ? TRUE : FALSE;
+	default:
+		return FALSE;
+	}
+}
+
+#ifdef DELAY_TIMER
+
 /*
  * [Function Name]: TIMER_delayTicks
  * [Function Description]: delay function using the DELAY_TIMER defined
  * 						   in timer-config.h, It uses ctc mode annd delays
  * 						   for specific number of ticks = ticks * iterations
- * 						   with a defined prescaler, It's also used in
- * 						   TIMER_DELAY_MS macro, the difference is the macro
- * 						   takes time as input, while is can be faster if ticks,
- * 						   iterations and prescaler are known
+ * 						   with a defined prescaler, It's also used by
+ * 						   TIMER_delayUs() and TIMER_delayMs() which take
+ * 						   the time as input
  * [Args]:
  * [in]: uint16_t ticks
  * 		 timer ticks in one iteration
@@ -489,39 +544,33 @@ void TIMER_delayTicks(uint16_t ticks, uint32_t iterations, uint8_t prescaler)
 #endif /* DELAY_TIMER == TIMER_0 */
 }
 
+#endif /* DELAY_TIMER */
+
 /*
  * [Function Name]: ticksPerIteration
- * [Function Description]: calculate the actual ticks from the passed ticks
- * 						   and setting global interrupt counts for the passed
- * 						   timer
+ * [Function Description]: calculate the actual ticks from the ticks of the config
+ * 						   and setting global interrupt counts for its timer,
+ * 						   the precomputed split of the config is used if it's set
  * [Args]:
- * [in]: uint8_t timer
- * 		 time to delay for in ms
- * [in]: uint32_t ticks
- * 		 total number of ticks, any 32-bit unsigned number
+ * [in]: const TIMER_config * a_timerConfig
+ * 		 config of the timer, its ticks can be any 32-bit unsigned number
  * [in]: uint16_t maxCounts
  * 		 max number of ticks available for each timer
  * [Return]: uint16_t
  * 			 number of ticks that can fit in the timer count register (in OVF mood)
  * 			 or in OCRx (in CTC mood)
  */
-static uint16_t ticksPerIteration(uint8_t a_timer, uint32_t a_ticks, uint16_t a_maxCounts) {
-	uint32_t counts;									/* number of ticks in each interrupt */
-	float64_t countsTemp;								/* used to calculate  */
-	g_timersInterruptActualCount[a_timer] = 1;			/* reset the actual interrupt count to 1 */
-	if (a_ticks <= a_maxCounts) {						/* if the ticks <= maxCounts there will be only one interrupt */
-		g_timersInterruptCount[a_timer] = 1;
-		return (uint16_t) (a_ticks);
-	}
-	/* counts will  be equal to countsTemp or countsTemp + 1
-	   depending on whether countsTemp has fractions or not */
-	countsTemp = (float64_t) a_ticks / ((uint32_t)a_maxCounts + 1);
-	counts = (uint32_t) countsTemp;
-	if (counts != countsTemp) {
-		counts++;
+static uint16_t ticksPerIteration(const TIMER_config * a_timerConfig, uint16_t a_maxCounts) {
+	uint32_t counts;									/* number of interrupts before calling the callback */
+	g_timersInterruptActualCount[a_timerConfig->timer] = 1;	/* reset the actual interrupt count to 1 */
+	if (a_timerConfig->iterations != 0) {				/* the split is precomputed during compilation */
+		g_timersInterruptCount[a_timerConfig->timer] = a_timerConfig->iterations;
+		return a_timerConfig->ticksPerIteration;
 	}
-	g_timersInterruptCount[a_timer] = counts;
-	return (uint16_t) (((float64_t)a_ticks / counts) + 0.5);			/* number of ticks in each interrupt */
+	/* least number of interrupts that fit in the timer, ceil division */
+	counts = TIMER_ITERATIONS(a_timerConfig->ticks, a_maxCounts);
+	g_timersInterruptCount[a_timerConfig->timer] = counts;
+	return (uint16_t) ((a_timerConfig->ticks + counts / 2) / counts);	/* number of ticks in each interrupt, rounded */
 }
 
 /*******************************************************************************
@@ -540,7 +589,10 @@ ISR(TIMER0_COMP_vect) {
 
 /* ISR for timer 0 OVF */
 ISR(TIMER0_OVF_vect) {
-	TCNT0_R = g_timer0_ovf_start;
+	/* a free-running timer is not reloaded, so no counts are lost */
+	if (g_timer0_ovf_start != 0) {
+		TCNT0_R = g_timer0_ovf_start;
+	}
 	if (g_timersInterruptActualCount[TIMER_0] == g_timersInterruptCount[TIMER_0]) {
 		(*g_timerInterruptHandler[TIMER_0])();
 		g_timersInterruptActualCount[TIMER_0] = 1;
@@ -561,7 +613,10 @@ ISR(TIMER2_COMP_vect) {
 
 /* ISR for timer 2 OVF */
 ISR(TIMER2_OVF_vect) {
-	TCNT2_R = g_timer2_ovf_start;
+	/* a free-running timer is not reloaded, so no counts are lost */
+	if (g_timer2_ovf_start != 0) {
+		TCNT2_R = g_timer2_ovf_start;
+	}
 	if (g_timersInterruptActualCount[TIMER_2] == g_timersInterruptCount[TIMER_2]) {
 		(*g_timerInterruptHandler[TIMER_2])();
 		g_timersInterruptActualCount[TIMER_2] = 1;
@@ -572,7 +627,10 @@ ISR(TIMER2_OVF_vect) {
 
 /* ISR for timer 1 OVF */
 ISR(TIMER1_OVF_vect) {
-	TCNT1_R = g_timer1_ovf_start;
+	/* a free-running timer is not reloaded, so no counts are lost */
+	if (g_timer1_ovf_start != 0) {
+		TCNT1_R = g_timer1_ovf_start;
+	}
 	if (g_timersInterruptActualCount[TIMER_1] == g_timersInterruptCount[TIMER_1]) {
 		(*g_timerInterruptHandler[TIMER_1])();
 		g_timersInterruptActualCount[TIMER_1] = 1;
@@ -62,78 +62,48 @@
  *                                Macros                                       *
  *******************************************************************************/
 
-/* TIME_MS_TO_TICKS Macro to convert time in ms to ticks */
-#define TIME_MS_TO_TICKS(prescaler,time) ((uint32_t)((time) * ((F_CPU) / (1000.0 * prescaler))) + 0.5)
+/* TIME_MS_TO_TICKS Macro to convert time in ms to ticks, rounded,
+ * time * F_CPU / 1000 must fit in 32 bits (536870 ms at 8MHz)
+ */
+#define TIME_MS_TO_TICKS(prescaler,time) \
+	(((uint32_t)(time) * ((F_CPU) / 1000UL) + (prescaler) / 2) / (prescaler))
 
-/*
- * TIMER_DELAY_MS macro, used to delay (busy wait) for a specific time in ms
- * Please make sure to
- * -------------------
- * 1- enable compiler optimization to overcome calculations overhead
- * 2- use defined delay times during compilation time, using unknown
- * 	  delay values (variables) will result in more calculations overhead
+/* TIMER_ITERATIONS Macro to get the least number of interrupts that
+ * split the ticks into counts that fit in a timer of maxCounts
  */
-#if DELAY_TIMER == TIMER_1
+#define TIMER_ITERATIONS(ticks,maxCounts) \
+	(((uint32_t)(ticks) + (maxCounts)) / ((uint32_t)(maxCounts) + 1UL))
+
+/* TIMER_TICKS_PER_ITERATION Macro to get the ticks of each interrupt, rounded */
+#define TIMER_TICKS_PER_ITERATION(ticks,maxCounts) \
+	((uint16_t)(((uint32_t)(ticks) + TIMER_ITERATIONS(ticks, maxCounts) / 2) \
+			/ TIMER_ITERATIONS(ticks, maxCounts)))
 
-#define TIMER_DELAY_MS(time) {								\
-	/* check if time is greater than 0 */					\
-	if ((float64_t)time > 0)								\
-	{														\
-		uint32_t counts = 1, totalTicks;					\
-		/* calculate total ticks required */				\
-		totalTicks = TIME_MS_TO_TICKS(1, (float64_t)		\
-					((time) - DELAY_OVERHEAD));				\
-		/* check if total ticks fit in 						\
-		 compare match register */							\
-		if (totalTicks <= TIMER_1_MAX_COUNT)				\
-		{													\
-			/* call TIMER_delayTicks */						\
-			TIMER_delayTicks((uint16_t)						\
-								(totalTicks - 1), 1, 1);	\
-		}													\
-		else												\
-		{													\
-			/* calulate number of iterations required 		\
-			 then call TIMER_delayTicks */					\
-			counts = (totalTicks / (uint32_t)				\
-					(TIMER_1_MAX_COUNT + 1)) + 1;			\
-			TIMER_delayTicks((uint16_t)						\
-				(totalTicks / counts) - 1, counts, 1);	 	\
-		}													\
-	}														\
+/*
+ * TIMER_SET_PRECOMPUTED_TICKS macro, sets the ticks of a timer config with
+ * its split into interrupts, with constant ticks the split is done during
+ * compilation so TIMER_init() doesn't calculate it
+ */
+#define TIMER_SET_PRECOMPUTED_TICKS(config,ticksCount,maxCounts) {			\
+	(config).ticks = (ticksCount);											\
+	(config).ticksPerIteration = TIMER_TICKS_PER_ITERATION(ticksCount, maxCounts);	\
+	(config).iterations = TIMER_ITERATIONS(ticksCount, maxCounts);			\
 }
 
-#else
+/* TIME_US_TO_CYCLES Macro to convert time in us to cpu cycles, rounded up */
+#define TIME_US_TO_CYCLES(time) (((uint32_t)(time) * ((F_CPU) / 1000UL) + 999UL) / 1000UL)
 
-#define TIMER_DELAY_MS(time) {								\
-	/* check if time is greater than 0 */					\
-	if ((float64_t)time > 0)								\
-	{														\
-		uint32_t counts = 1, totalTicks;					\
-		/* calculate total ticks required */				\
-		totalTicks = TIME_MS_TO_TICKS(1, (float64_t)		\
-					((time) - DELAY_OVERHEAD));				\
-		/* check if total ticks fit in 						\
-		 compare match register */							\
-		if (totalTicks <= TIMER_0_MAX_COUNT)				\
-		{													\
-			/* call TIMER_delayTicks */						\
-			TIMER_delayTicks((uint8_t)						\
-								(totalTicks - 1), 1, 1);	\
-		}													\
-		else												\
-		{													\
-			/* calulate number of iterations required 		\
-			 then call TIMER_delayTicks */					\
-			counts = (totalTicks / (uint32_t)				\
-					(TIMER_0_MAX_COUNT + 1)) + 1;			\
-			TIMER_delayTicks((uint8_t)						\
-				(totalTicks / counts) - 1, counts, 1);	 	\
-		}													\
-	}														\
-}
+/* TIME_MS_TO_CYCLES Macro to convert time in ms to cpu cycles */
+#define TIME_MS_TO_CYCLES(time) ((uint32_t)(time) * ((F_CPU) / 1000UL))
 
+/* max count of the DELAY_TIMER, it runs with no prescaler so a tick is a cpu cycle */
+#ifdef DELAY_TIMER
+#if DELAY_TIMER == TIMER_1
+#define DELAY_TIMER_MAX_COUNT			TIMER_1_MAX_COUNT
+#else
+#define DELAY_TIMER_MAX_COUNT			TIMER_0_MAX_COUNT
 #endif /* DELAY_TIMER == TIMER_1 */
+#endif /* DELAY_TIMER */
 
 /*******************************************************************************
  *                             Types Declaration                               *
@@ -236,12 +206,20 @@ typedef struct
 
 	/*
 	 * ticks of 3 timers in case of CTC or OVF,
-	 * can be any 32-bit data except 0
+	 * can be any 32-bit data except 0,
+	 * max count + 1 in OVF mode makes the timer free-running, it's not reloaded
 	 */
 	uint32_t ticks;
 
 	/* pointer to interrupt handler function */
 	void (* volatile ptrToHandler)(void);
+
+	/*
+	 * optional split of the ticks into interrupts, set by TIMER_SET_PRECOMPUTED_TICKS,
+	 * iterations = 0 to calculate them from ticks in TIMER_init()
+	 */
+	uint16_t ticksPerIteration;
+	uint32_t iterations;
 }TIMER_config;
 
 /*******************************************************************************
@@ -290,6 +268,19 @@ uint8_t TIMER_start(uint8_t a_timer);
  */
 uint8_t TIMER_stop(uint8_t a_timer);
 
+/*
+ * [Function Name]: TIMER_resetCount
+ * [Function Description]: restarts the count of the current period of a timer, so its next
+ * 						   interrupt comes one whole period later, e.g. to keep a minimum time
+ * 						   after an action taken in a callback that other interrupts may delay
+ * [Args]:
+ * [in]: uint8_t a_timer
+ * 		 timer to reset
+ * [Return]: uint8_t
+ * 			 TIMER_SUCCESS or TIMER_ERROR
+ */
+uint8_t TIMER_resetCount(uint8_t a_timer);
+
 /*
  * [Function Name]: TIMER_read
  * [Function Description]: gets the value of the current count of a timer
@@ -303,15 +294,33 @@ uint8_t TIMER_stop(uint8_t a_timer);
  */
 uint16_t TIMER_read(uint8_t a_timer);
 
+/*
+ * [Function Name]: TIMER_isOverflowPending
+ * [Function Description]: checks the overflow flag of a timer, it's set when the
+ * 						   timer overflows and cleared when its ovf ISR runs, so it
+ * 						   tells whether an overflow is not handled yet,
+ * 						   e.g. while the interrupts are disabled
+ * [Args]:
+ * [in]: uint8_t a_timer
+ * 		 timer to check
+ * [Return]: boolean
+ * 			 TRUE if the overflow flag is set, FALSE otherwise
+ */
+boolean TIMER_isOverflowPending(uint8_t a_timer);
+
+/* the delay functions take over the DELAY_TIMER, they exist only when it's
+ * defined in timer-config.h, so a timer used by another module can't be one
+ */
+#ifdef DELAY_TIMER
+
 /*
  * [Function Name]: TIMER_delayTicks
  * [Function Description]: delay function using the DELAY_TIMER defined
  * 						   in timer-config.h, It uses ctc mode annd delays
  * 						   for specific number of ticks = ticks * iterations
- * 						   with a defined prescaler, It's also used in
- * 						   TIMER_DELAY_MS macro, the difference is the macro
- * 						   takes time as input, while is can be faster if ticks,
- * 						   iterations and prescaler are known
+ * 						   with a defined prescaler, It's also used by
+ * 						   TIMER_delayUs() and TIMER_delayMs() which take
+ * 						   the time as input
  * [Args]:
  * [in]: uint16_t ticks
  * 		 timer ticks in one iteration
@@ -326,4 +335,72 @@ uint16_t TIMER_read(uint8_t a_timer);
  */
 void TIMER_delayTicks(uint16_t ticks, uint32_t iterations, uint8_t prescaler);
 
+#endif /* DELAY_TIMER */
+
+/*******************************************************************************
+ *                        Inline Functions Definitions                         *
+ *******************************************************************************/
+
+#ifdef DELAY_TIMER
+
+/*
+ * [Function Name]: TIMER_delayCycles
+ * [Function Description]: busy wait for a number of cpu cycles using the DELAY_TIMER,
+ * 						   the cycles are split into the least number of equal
+ * 						   compare match iterations with integer math only, so
+ * 						   with a constant number of cycles all the calculations
+ * 						   are done during compilation
+ * [Args]:
+ * [in]: uint32_t a_cycles
+ * 		 cpu cycles to wait, including the call overhead DELAY_OVERHEAD_CYCLES
+ * [Return]: void
+ */
+static inline void TIMER_delayCycles(uint32_t a_cycles)
+{
+	uint32_t iterations, ticks;
+
+	/* the delay is shorter than the call itself */
+	if(a_cycles <= DELAY_OVERHEAD_CYCLES)
+	{
+		return;
+	}
+	a_cycles -= DELAY_OVERHEAD_CYCLES;
+
+	/* ceil divisions, the iterations fit in the timer and never wait less than a_cycles */
+	iterations = (a_cycles + DELAY_TIMER_MAX_COUNT) / (DELAY_TIMER_MAX_COUNT + 1UL);
+	ticks = (a_cycles + iterations - 1) / iterations;
+
+	TIMER_delayTicks((uint16_t) (ticks - 1), iterations, 1);
+}
+
+/*
+ * [Function Name]: TIMER_delayUs
+ * [Function Description]: busy wait for a specific time in us,
+ * 						   use constant times to have no calculations at run time
+ * [Args]:
+ * [in]: uint32_t a_time
+ * 		 time in us
+ * [Return]: void
+ */
+static inline void TIMER_delayUs(uint32_t a_time)
+{
+	TIMER_delayCycles(TIME_US_TO_CYCLES(a_time));
+}
+
+/*
+ * [Function Name]: TIMER_delayMs
+ * [Function Description]: busy wait for a specific time in ms,
+ * 						   use constant times to have no calculations at run time
+ * [Args]:
+ * [in]: uint32_t a_time
+ * 		 time in ms
+ * [Return]: void
+ */
+static inline void TIMER_delayMs(uint32_t a_time)
+{
+	TIMER_delayCycles(TIME_MS_TO_CYCLES(a_time));
+}
+
+#endif /* DELAY_TIMER */
+
 #endif /* __TIMER_H__ */
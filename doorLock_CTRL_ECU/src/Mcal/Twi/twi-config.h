@@ -0,0 +1,38 @@
+/******************************************************************************
+ *
+ * Module: TWI (I2C)
+ *
+ * File Name: twi-config.h
+ *
+ * Description: Config file for the TWI (I2C) driver
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __TWI_CONFIG_H__
+#define __TWI_CONFIG_H__
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* number of transactions that can wait for the bus,
+ * must be a power of two and not more than 128
+ */
+#define TWI_QUEUE_SIZE						4
+
+/* number of clock pulses sent to free the bus, a slave holding SDA low
+ * in the middle of a byte releases it after 9 pulses at most */
+#define TWI_RECOVERY_PULSES					9
+
+/* busy loop counts of half a clock pulse during the bus recovery,
+ * about 5 us at 8 MHz so the recovery clock is under 100 kHz */
+#define TWI_RECOVERY_HALF_PULSE_LOOPS		8
+
+/* busy loop counts of waiting for the stop of the last transaction before a start,
+ * about 30 us at 8 MHz while a stop takes less than 5 us at 100 kbps,
+ * a stop that isn't sent by then is left to the timeout of the transaction */
+#define TWI_STOP_WAIT_LOOPS					32
+
+#endif /* __TWI_CONFIG_H__ */
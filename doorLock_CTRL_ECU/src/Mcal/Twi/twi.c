@@ -20,6 +20,109 @@
 /* For using mcu registers */
 #include "../Mcu/mcu.h"
 
+/* For controlling the bus lines during the recovery */
+#include "../Dio/dio.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if (TWI_QUEUE_SIZE & (TWI_QUEUE_SIZE - 1)) != 0 || TWI_QUEUE_SIZE > 128
+#error "TWI_QUEUE_SIZE must be a power of two and not more than 128"
+#endif
+
+/* mask to wrap the free running indices into the queue */
+#define TWI_QUEUE_MASK						(TWI_QUEUE_SIZE - 1)
+
+/* control values written to TWCR_R, they clear TWINT to start the next operation */
+
+/* send a start and interrupt when it's sent */
+#define TWI_CONTROL_START					(SELECT_BIT(TWINT) | SELECT_BIT(TWSTA) | SELECT_BIT(TWEN) | SELECT_BIT(TWIE))
+
+/* send a stop then a start */
+#define TWI_CONTROL_STOP_START				(TWI_CONTROL_START | SELECT_BIT(TWSTO))
+
+/* send a stop and disable the interrupt as the bus is free */
+#define TWI_CONTROL_STOP					(SELECT_BIT(TWINT) | SELECT_BIT(TWSTO) | SELECT_BIT(TWEN))
+
+/* send TWDR_R or receive a byte without sending ack */
+#define TWI_CONTROL_NEXT					(SELECT_BIT(TWINT) | SELECT_BIT(TWEN) | SELECT_BIT(TWIE))
+
+/* receive a byte and send ack */
+#define TWI_CONTROL_NEXT_ACK				(TWI_CONTROL_NEXT | SELECT_BIT(TWEA))
+
+/*******************************************************************************
+ *                      Static Functions Prototypes	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: completeTransaction
+ * [Function Description]: sets the result of the running transaction, calls its callback
+ * 						   and sends a stop, or a stop then a start if another transaction
+ * 						   is queued, called with the global interrupt disabled
+ * [Args]:
+ * [in]: EN_TwiResult a_result
+ * 		 result of the transaction
+ * [in]: boolean a_isBusOwned
+ * 		 TRUE if the transaction owns the bus and must send a stop,
+ * 		 FALSE if the bus is already free
+ * [Return]: void
+ */
+static void completeTransaction(EN_TwiResult a_result, boolean a_isBusOwned);
+
+/*
+ * [Function Name]: incrementCounter
+ * [Function Description]: increments a counter of the stats till it reaches 65535
+ * [Args]:
+ * [in]: uint16_t a_counter
+ * 		 counter to increment
+ * [Return]: uint16_t
+ * 			 the incremented counter
+ */
+static uint16_t incrementCounter(uint16_t a_counter);
+
+/*
+ * [Function Name]: halfPulseDelay
+ * [Function Description]: waits for half a clock pulse of the bus recovery
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void halfPulseDelay(void);
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* queued transactions, the running one is the one at the tail */
+static ST_TwiTransaction * volatile g_twiQueue[TWI_QUEUE_SIZE];
+
+/* free running indices of the queue,
+ * number of queued transactions = (uint8_t)(head - tail)
+ */
+static volatile uint8_t g_twiQueueHead = 0, g_twiQueueTail = 0;
+
+/* index of the next byte to write or read in the running transaction */
+static volatile uint16_t g_twiIndex = 0;
+
+/* states whether the running transaction is in its read part */
+static volatile boolean g_twiIsReading = FALSE;
+
+/* time source and timeout of the stuck transactions */
+static uint32_t (* g_twiNowMs)(void) = NULL;
+static uint8_t g_twiTimeoutMs = 0;
+
+/* incremented with every step of the transactions, a transaction is stuck
+ * if it's not changed for the timeout time */
+static volatile uint8_t g_twiSteps = 0;
+
+/* steps count and time of the last check of the timeout */
+static uint8_t g_twiCheckedSteps = 0;
+static uint32_t g_twiCheckedMs = 0;
+
+/* counters of the transactions results */
+static ST_TwiStats g_twiStats;
+
 /*******************************************************************************
  *                          Functions Definition	                           *
  *******************************************************************************/
@@ -50,122 +153,354 @@ void TWI_init(ST_TwiConfig * a_twiConfig)
 	 */
 	COPY_BITS(TWAR_R, 0xFE, a_twiConfig->slaveAddress, TWA0);
 
-	/* enable TWI */
-	TWCR_R = SELECT_BIT(TWEN);
+	/* empty the transactions queue */
+	g_twiQueueHead = 0;
+	g_twiQueueTail = 0;
+
+	g_twiNowMs = a_twiConfig->nowMs;
+	g_twiTimeoutMs = a_twiConfig->timeoutMs;
+
+	g_twiStats.done = 0;
+	g_twiStats.addressNacks = 0;
+	g_twiStats.dataNacks = 0;
+	g_twiStats.busErrors = 0;
+	g_twiStats.timeouts = 0;
+	g_twiStats.recoveries = 0;
+
+	/* a reset in the middle of a transaction may leave a slave holding SDA,
+	 * the recovery enables TWI, its interrupt is enabled only while a transaction runs */
+	TWI_recoverBus();
 }
 
 /*
- * [Function Name]: TWI_start
- * [Function Description]: sends the start bit
+ * [Function Name]: TWI_submit
+ * [Function Description]: queues a transaction, the twi interrupt runs it when the bus is
+ * 						   free and sets its result when it's complete, the global interrupt
+ * 						   must be enabled, don't call it from an ISR
  * [Args]:
- * [in]: void
- * [Return]: void
+ * [in]: ST_TwiTransaction * a_transaction
+ * 		 transaction to run, its result is set to TWI_BUSY
+ * [Return]: uint8_t
+ * 			 TWI_SUCCESS or TWI_ERROR if the queue is full
  */
-void TWI_start(void)
+uint8_t TWI_submit(ST_TwiTransaction * a_transaction)
 {
-	/*
-	 * Clear the TWINT flag before sending the start bit TWINT=1
-	 * send the start bit by TWSTA=1
-	 * Enable TWI Module TWEN=1
-	 */
-	TWCR_R = SELECT_BIT(TWINT) | SELECT_BIT(TWSTA) | SELECT_BIT(TWEN);
+	uint8_t result = TWI_SUCCESS;
+	uint8_t sreg, loop;
+
+	a_transaction->result = TWI_BUSY;
+
+	sreg = SREG_R;
+	DISABLE_GLOBAL_INTERRUPT();
+
+	if((uint8_t)(g_twiQueueHead - g_twiQueueTail) >= TWI_QUEUE_SIZE)
+	{
+		result = TWI_ERROR;
+	}
+	else
+	{
+		g_twiQueue[g_twiQueueHead & TWI_QUEUE_MASK] = a_transaction;
+		g_twiQueueHead ++;
+
+		/* the bus is free, start the transaction now, otherwise
+		 * the ISR starts it after the running ones */
+		if((uint8_t)(g_twiQueueHead - g_twiQueueTail) == 1)
+		{
+			g_twiIndex = 0;
+			g_twiIsReading = (a_transaction->writeSize == 0 && a_transaction->readSize != 0);
+
+			/* the stop of the last transaction may be still on the bus, a held bus
+			 * never ends it, then the start doesn't run and TWI_checkTimeout()
+			 * aborts the transaction and recovers the bus */
+			for(loop = 0; loop < TWI_STOP_WAIT_LOOPS && BIT_IS_SET(TWCR_R, TWSTO); loop ++);
 
-	/* Wait for TWINT flag set in TWCR_R Register (start bit is send successfully) */
-	while(BIT_IS_CLEAR(TWCR_R, TWINT));
+			g_twiSteps ++;
+			TWCR_R = TWI_CONTROL_START;
+		}
+	}
+
+	/* restore the global interrupt as it was */
+	SREG_R = sreg;
+
+	return result;
 }
 
 /*
- * [Function Name]: TWI_stop
- * [Function Description]: sends the stop bit
+ * [Function Name]: TWI_isIdle
+ * [Function Description]: checks if no transaction is running or queued
  * [Args]:
  * [in]: void
- * [Return]: void
+ * [Return]: boolean
+ * 			 TRUE if the twi is idle, FALSE otherwise
  */
-void TWI_stop(void)
+boolean TWI_isIdle(void)
 {
-	/*
-	 * Clear the TWINT flag before sending the stop bit TWINT=1
-	 * send the stop bit by TWSTO=1
-	 * Enable TWI Module TWEN=1
-	 */
-	TWCR_R = SELECT_BIT(TWINT) | SELECT_BIT(TWSTO) | SELECT_BIT(TWEN);
+	return g_twiQueueHead == g_twiQueueTail;
 }
 
 /*
- * [Function Name]: TWI_stop
- * [Function Description]: sends a byte
+ * [Function Name]: TWI_checkTimeout
+ * [Function Description]: aborts the running transaction if it made no progress for the
+ * 						   timeout time, then recovers the bus and starts the next one,
+ * 						   the aborted transaction ends with TWI_TIMEOUT,
+ * 						   call it from the loops waiting for a transaction
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-void TWI_writeByte(uint8_t a_data)
+void TWI_checkTimeout(void)
 {
-	/* Put data On TWI data Register */
-	TWDR_R = a_data;
-	/*
-	 * Clear the TWINT flag before sending the data TWINT=1
-	 * Enable TWI Module TWEN=1
-	 */
-	TWCR_R = SELECT_BIT(TWINT) | SELECT_BIT(TWEN);
+	uint32_t nowMs;
+	uint8_t steps, sreg;
+
+	if(g_twiNowMs == NULL)
+	{
+		return;
+	}
+
+	nowMs = g_twiNowMs();
 
-	/* Wait for TWINT flag set in TWCR Register(data is send successfully) */
-	while(BIT_IS_CLEAR(TWCR_R, TWINT));
+	sreg = SREG_R;
+	DISABLE_GLOBAL_INTERRUPT();
+
+	steps = g_twiSteps;
+
+	if(g_twiQueueHead == g_twiQueueTail || steps != g_twiCheckedSteps)
+	{
+		/* idle or making progress, the timeout starts from now */
+		g_twiCheckedSteps = steps;
+		g_twiCheckedMs = nowMs;
+	}
+	else if(nowMs - g_twiCheckedMs >= g_twiTimeoutMs)
+	{
+		/* the bus is free after the recovery, so no stop is sent */
+		TWI_recoverBus();
+		completeTransaction(TWI_TIMEOUT, FALSE);
+		g_twiCheckedSteps = g_twiSteps;
+		g_twiCheckedMs = nowMs;
+	}
+
+	/* restore the global interrupt as it was */
+	SREG_R = sreg;
 }
 
 /*
- * [Function Name]: TWI_readByteWithACK
- * [Function Description]: receives a byte and enables sending ack after receving
+ * [Function Name]: TWI_recoverBus
+ * [Function Description]: frees a bus held by a slave, it disables the twi, sends clock
+ * 						   pulses on SCL till the slave releases SDA then sends a stop and
+ * 						   enables the twi again, don't call it while a transaction runs
  * [Args]:
  * [in]: void
- * [Return]: void
+ * [Return]: boolean
+ * 			 TRUE if SDA is released, FALSE if it's still held low
  */
-uint8_t TWI_readByteWithACK(void)
+boolean TWI_recoverBus(void)
 {
-	/*
-	 * Clear the TWINT flag before reading the data TWINT=1
-	 * Enable sending ACK after reading or receiving data TWEA=1
-	 * Enable TWI Module TWEN=1
-	 */
-	TWCR_R = SELECT_BIT(TWINT) | SELECT_BIT(TWEN) | SELECT_BIT(TWEA);
+	uint8_t pulse;
+	boolean isReleased;
+
+	/* the twi releases the pins when it's disabled, the lines are driven like
+	 * open drain by their direction: output to pull a line low, and input to release
+	 * it to the external pull up, the port stays low so the internal pull up is off */
+	TWCR_R = 0;
+	DIO_writePin(TWI_SCL_PIN, LOW);
+	DIO_writePin(TWI_SDA_PIN, LOW);
+	DIO_pinInit(TWI_SDA_PIN, PIN_INPUT);
+	DIO_pinInit(TWI_SCL_PIN, PIN_INPUT);
+	halfPulseDelay();
+
+	/* clock the slave till it finishes the byte it's sending and releases SDA */
+	for(pulse = 0; pulse < TWI_RECOVERY_PULSES && DIO_readPin(TWI_SDA_PIN) == LOW; pulse ++)
+	{
+		DIO_pinInit(TWI_SCL_PIN, PIN_OUTPUT);
+		halfPulseDelay();
+		DIO_pinInit(TWI_SCL_PIN, PIN_INPUT);
+		halfPulseDelay();
+	}
 
-	/* Wait for TWINT flag set in TWCR Register (data received successfully) */
-	while(BIT_IS_CLEAR(TWCR_R, TWINT));
+	isReleased = (DIO_readPin(TWI_SDA_PIN) == HIGH);
 
-	/* Read Data */
-	return TWDR_R;
+	/* stop: SDA goes high while SCL is high */
+	DIO_pinInit(TWI_SCL_PIN, PIN_OUTPUT);
+	DIO_pinInit(TWI_SDA_PIN, PIN_OUTPUT);
+	halfPulseDelay();
+	DIO_pinInit(TWI_SCL_PIN, PIN_INPUT);
+	halfPulseDelay();
+	DIO_pinInit(TWI_SDA_PIN, PIN_INPUT);
+	halfPulseDelay();
+
+	g_twiStats.recoveries = incrementCounter(g_twiStats.recoveries);
+
+	TWCR_R = SELECT_BIT(TWEN);
+
+	return isReleased;
 }
 
 /*
- * [Function Name]: TWI_readByteWithoutACK
- * [Function Description]: receives a byte without sending ack
+ * [Function Name]: TWI_getStats
+ * [Function Description]: gets the counters of the transactions results
  * [Args]:
- * [in]: void
+ * [out]: ST_TwiStats * a_stats
+ * 		  structure to store the counters
  * [Return]: void
  */
-uint8_t TWI_readByteWithoutACK(void)
+void TWI_getStats(ST_TwiStats * a_stats)
 {
-	/*
-	 * Clear the TWINT flag before reading the data TWINT=1
-	 * Enable TWI Module TWEN=1
-	 */
-	TWCR_R = SELECT_BIT(TWINT) | SELECT_BIT(TWEN);
+	uint8_t sreg = SREG_R;
 
-	/* Wait for TWINT flag set in TWCR_R Register (data received successfully) */
-	while(BIT_IS_CLEAR(TWCR_R, TWINT));
+	DISABLE_GLOBAL_INTERRUPT();
+	*a_stats = g_twiStats;
+	SREG_R = sreg;
+}
+
+/*
+ * [Function Name]: completeTransaction
+ * [Function Description]: sets the result of the running transaction, calls its callback
+ * 						   and sends a stop, or a stop then a start if another transaction
+ * 						   is queued, called with the global interrupt disabled
+ * [Args]:
+ * [in]: EN_TwiResult a_result
+ * 		 result of the transaction
+ * [in]: boolean a_isBusOwned
+ * 		 TRUE if the transaction owns the bus and must send a stop,
+ * 		 FALSE if the bus is already free
+ * [Return]: void
+ */
+static void completeTransaction(EN_TwiResult a_result, boolean a_isBusOwned)
+{
+	ST_TwiTransaction * transaction = g_twiQueue[g_twiQueueTail & TWI_QUEUE_MASK];
+	ST_TwiTransaction * next;
 
-	/* Read Data */
-	return TWDR_R;
+	g_twiQueueTail ++;
+
+	switch(a_result)
+	{
+	case TWI_DONE: g_twiStats.done = incrementCounter(g_twiStats.done); break;
+	case TWI_ADDRESS_NACK: g_twiStats.addressNacks = incrementCounter(g_twiStats.addressNacks); break;
+	case TWI_DATA_NACK: g_twiStats.dataNacks = incrementCounter(g_twiStats.dataNacks); break;
+	case TWI_TIMEOUT: g_twiStats.timeouts = incrementCounter(g_twiStats.timeouts); break;
+	default: g_twiStats.busErrors = incrementCounter(g_twiStats.busErrors); break;
+	}
+
+	/* every transaction ends with a stop, whatever its result */
+	if(g_twiQueueHead != g_twiQueueTail)
+	{
+		next = g_twiQueue[g_twiQueueTail & TWI_QUEUE_MASK];
+		g_twiIndex = 0;
+		g_twiIsReading = (next->writeSize == 0 && next->readSize != 0);
+		g_twiSteps ++;
+		TWCR_R = a_isBusOwned ? TWI_CONTROL_STOP_START : TWI_CONTROL_START;
+	}
+	else
+	{
+		TWCR_R = a_isBusOwned ? TWI_CONTROL_STOP : SELECT_BIT(TWEN);
+	}
+
+	/* the result is set after the transaction leaves the queue, so the
+	 * owner can submit it again as soon as it sees the result */
+	transaction->result = a_result;
+
+	if(transaction->callback != NULL)
+	{
+		(*transaction->callback)(transaction);
+	}
 }
 
 /*
- * [Function Name]: TWI_getStatus
- * [Function Description]: gets the twi status
+ * [Function Name]: incrementCounter
+ * [Function Description]: increments a counter of the stats till it reaches 65535
+ * [Args]:
+ * [in]: uint16_t a_counter
+ * 		 counter to increment
+ * [Return]: uint16_t
+ * 			 the incremented counter
+ */
+static uint16_t incrementCounter(uint16_t a_counter)
+{
+	return (a_counter != 0xFFFF) ? (a_counter + 1) : a_counter;
+}
+
+/*
+ * [Function Name]: halfPulseDelay
+ * [Function Description]: waits for half a clock pulse of the bus recovery
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-uint8_t TWI_getStatus(void)
+static void halfPulseDelay(void)
+{
+	volatile uint8_t loop;
+
+	for(loop = 0; loop < TWI_RECOVERY_HALF_PULSE_LOOPS; loop ++);
+}
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+/* ISR for twi, runs every step of the transaction at the tail of the queue */
+ISR(TWI_vect)
 {
-	/* masking to eliminate first 3 bits and get the last 5 bits (status bits) */
-	return (TWSR_R & 0xF8);
+	ST_TwiTransaction * transaction = g_twiQueue[g_twiQueueTail & TWI_QUEUE_MASK];
+
+	g_twiSteps ++;
+
+	switch(TWSR_R & 0xF8)
+	{
+	case TWI_START:
+	case TWI_REP_START:
+		/* send the slave address with R/W bit */
+		TWDR_R = (uint8_t)((transaction->address << 1) | (g_twiIsReading ? 1 : 0));
+		TWCR_R = TWI_CONTROL_NEXT;
+		break;
+
+	case TWI_MT_SLA_W_ACK:
+	case TWI_MT_DATA_ACK:
+		if(g_twiIndex < transaction->writeSize)
+		{
+			TWDR_R = transaction->writeData[g_twiIndex];
+			g_twiIndex ++;
+			TWCR_R = TWI_CONTROL_NEXT;
+		}
+		else if(transaction->readSize != 0)
+		{
+			g_twiIsReading = TRUE;
+			g_twiIndex = 0;
+			TWCR_R = transaction->isRepeatedStart ? TWI_CONTROL_START : TWI_CONTROL_STOP_START;
+		}
+		else
+		{
+			completeTransaction(TWI_DONE, TRUE);
+		}
+		break;
+
+	case TWI_MT_SLA_R_ACK:
+		/* ack every byte except the last one */
+		TWCR_R = (transaction->readSize > 1) ? TWI_CONTROL_NEXT_ACK : TWI_CONTROL_NEXT;
+		break;
+
+	case TWI_MR_DATA_ACK:
+		transaction->readData[g_twiIndex] = TWDR_R;
+		g_twiIndex ++;
+		TWCR_R = (g_twiIndex + 1 < transaction->readSize) ? TWI_CONTROL_NEXT_ACK : TWI_CONTROL_NEXT;
+		break;
+
+	case TWI_MR_DATA_NACK:
+		transaction->readData[g_twiIndex] = TWDR_R;
+		completeTransaction(TWI_DONE, TRUE);
+		break;
+
+	case TWI_MT_SLA_W_NACK:
+	case TWI_MT_SLA_R_NACK:
+		completeTransaction(TWI_ADDRESS_NACK, TRUE);
+		break;
+
+	case TWI_MT_DATA_NACK:
+		completeTransaction(TWI_DATA_NACK, TRUE);
+		break;
+
+	default:
+		completeTransaction(TWI_BUS_ERROR, TRUE);
+		break;
+	}
 }
@@ -17,6 +17,9 @@
  *                                Includes	                                   *
  *******************************************************************************/
 
+/* module config file */
+#include "twi-config.h"
+
 /* For using std types */
 #include "../../Lib/types.h"
 
@@ -38,18 +41,33 @@
 /* Master transmit ( slave address + Write request ) to slave + ACK received from slave. */
 #define TWI_MT_SLA_W_ACK  0x18
 
+/* Master transmit ( slave address + Write request ) to slave + NACK received from slave. */
+#define TWI_MT_SLA_W_NACK 0x20
+
 /* Master transmit ( slave address + Read request ) to slave + ACK received from slave. */
 #define TWI_MT_SLA_R_ACK  0x40
 
+/* Master transmit ( slave address + Read request ) to slave + NACK received from slave. */
+#define TWI_MT_SLA_R_NACK 0x48
+
 /* Master transmit data and ACK has been received from Slave. */
 #define TWI_MT_DATA_ACK   0x28
 
+/* Master transmit data and NACK has been received from Slave. */
+#define TWI_MT_DATA_NACK  0x30
+
 /* Master received data and send ACK to slave. */
 #define TWI_MR_DATA_ACK   0x50
 
 /* Master received data but doesn't send ACK to slave. */
 #define TWI_MR_DATA_NACK  0x58
 
+/* returned if the transaction is queued */
+#define TWI_SUCCESS						1
+
+/* returned if the queue is full */
+#define TWI_ERROR						0
+
 /*******************************************************************************
  *                             Types Declaration                               *
  *******************************************************************************/
@@ -86,8 +104,99 @@ typedef struct
 	/* bit rate */
 	uint8_t bitRate;
 
+	/* function returning a time in ms, used to detect a stuck transaction,
+	 * or NULL to disable the timeout */
+	uint32_t (* nowMs)(void);
+
+	/* time in ms without any progress before a transaction is aborted */
+	uint8_t timeoutMs;
+
 }ST_TwiConfig;
 
+/*
+ * [Enum Name]: EN_TwiResult
+ * [Enum Description]: contains the results of a transaction
+ */
+typedef enum
+{
+	/* the transaction is queued or running */
+	TWI_BUSY,
+
+	/* all the bytes are written and read */
+	TWI_DONE,
+
+	/* no slave answered the address */
+	TWI_ADDRESS_NACK,
+
+	/* the slave didn't accept a written byte */
+	TWI_DATA_NACK,
+
+	/* unexpected bus state, e.g. a lost arbitration */
+	TWI_BUS_ERROR,
+
+	/* no progress for the timeout time, the bus is recovered */
+	TWI_TIMEOUT
+
+}EN_TwiResult;
+
+/*
+ * [Struct Name]: ST_TwiTransaction
+ * [Struct Description]: describes a transaction, the bytes are written first then read
+ * 						 from the same slave, the structure and the buffers must stay
+ * 						 valid till the transaction is complete
+ */
+typedef struct ST_TwiTransaction
+{
+	/* 7-bit address of the slave */
+	uint8_t address;
+
+	/* bytes to write, and their number, 0 to write nothing */
+	const uint8_t * writeData;
+	uint16_t writeSize;
+
+	/* array to store the read bytes, and their number, 0 to read nothing */
+	uint8_t * readData;
+	uint16_t readSize;
+
+	/* TRUE to read after writing with a repeated start,
+	 * FALSE to send a stop then a start */
+	boolean isRepeatedStart;
+
+	/* called from the twi ISR when the transaction is complete, or NULL,
+	 * it must not queue another transaction */
+	void (* callback)(struct ST_TwiTransaction * a_transaction);
+
+	/* result of the transaction, TWI_BUSY till it's complete */
+	volatile EN_TwiResult result;
+
+}ST_TwiTransaction;
+
+/*
+ * [Struct Name]: ST_TwiStats
+ * [Struct Description]: counters of the transactions results, they stop at 65535
+ */
+typedef struct
+{
+	/* transactions completed successfully */
+	uint16_t done;
+
+	/* transactions whose address wasn't answered */
+	uint16_t addressNacks;
+
+	/* transactions whose written data wasn't accepted */
+	uint16_t dataNacks;
+
+	/* transactions ended by a bus error or a lost arbitration */
+	uint16_t busErrors;
+
+	/* transactions aborted by the timeout */
+	uint16_t timeouts;
+
+	/* bus recoveries */
+	uint16_t recoveries;
+
+}ST_TwiStats;
+
 
 /*******************************************************************************
  *                      Functions Prototypes                                   *
@@ -104,57 +213,60 @@ typedef struct
 void TWI_init(ST_TwiConfig * a_twiConfig);
 
 /*
- * [Function Name]: TWI_start
- * [Function Description]: sends the start bit
- * [Args]:
- * [in]: void
- * [Return]: void
- */
-void TWI_start(void);
-
-/*
- * [Function Name]: TWI_stop
- * [Function Description]: sends the stop bit
+ * [Function Name]: TWI_submit
+ * [Function Description]: queues a transaction, the twi interrupt runs it when the bus is
+ * 						   free and sets its result when it's complete, the global interrupt
+ * 						   must be enabled, don't call it from an ISR
  * [Args]:
- * [in]: void
- * [Return]: void
+ * [in]: ST_TwiTransaction * a_transaction
+ * 		 transaction to run, its result is set to TWI_BUSY
+ * [Return]: uint8_t
+ * 			 TWI_SUCCESS or TWI_ERROR if the queue is full
  */
-void TWI_stop(void);
+uint8_t TWI_submit(ST_TwiTransaction * a_transaction);
 
 /*
- * [Function Name]: TWI_stop
- * [Function Description]: sends a byte
+ * [Function Name]: TWI_isIdle
+ * [Function Description]: checks if no transaction is running or queued
  * [Args]:
  * [in]: void
- * [Return]: void
+ * [Return]: boolean
+ * 			 TRUE if the twi is idle, FALSE otherwise
  */
-void TWI_writeByte(uint8_t a_data);
+boolean TWI_isIdle(void);
 
 /*
- * [Function Name]: TWI_readByteWithACK
- * [Function Description]: receives a byte and enables sending ack after receving
+ * [Function Name]: TWI_checkTimeout
+ * [Function Description]: aborts the running transaction if it made no progress for the
+ * 						   timeout time, then recovers the bus and starts the next one,
+ * 						   the aborted transaction ends with TWI_TIMEOUT,
+ * 						   call it from the loops waiting for a transaction
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-uint8_t TWI_readByteWithACK(void);
+void TWI_checkTimeout(void);
 
 /*
- * [Function Name]: TWI_readByteWithoutACK
- * [Function Description]: receives a byte without sending ack
+ * [Function Name]: TWI_recoverBus
+ * [Function Description]: frees a bus held by a slave, it disables the twi, sends clock
+ * 						   pulses on SCL till the slave releases SDA then sends a stop and
+ * 						   enables the twi again, don't call it while a transaction runs
  * [Args]:
  * [in]: void
- * [Return]: void
+ * [Return]: boolean
+ * 			 TRUE if SDA is released, FALSE if it's still held low
  */
-uint8_t TWI_readByteWithoutACK(void);
+boolean TWI_recoverBus(void);
 
 /*
- * [Function Name]: TWI_getStatus
- * [Function Description]: gets the twi status
+ * [Function Name]: TWI_getStats
+ * [Function Description]: gets the counters of the transactions results
  * [Args]:
- * [in]: void
+ * [out]: ST_TwiStats * a_stats
+ * 		  structure to store the counters
  * [Return]: void
  */
-uint8_t TWI_getStatus(void);
+void TWI_getStats(ST_TwiStats * a_stats);
 
 #endif /* __TWI_H__ */
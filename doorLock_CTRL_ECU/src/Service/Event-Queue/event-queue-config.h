@@ -0,0 +1,25 @@
+/******************************************************************************
+ *
+ * Module: EVENTQ
+ *
+ * File Name: event-queue-config.h
+ *
+ * Description: Config file for the event queue service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __EVENTQ_CONFIG_H__
+#define __EVENTQ_CONFIG_H__
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* max number of events waiting in the queue,
+ * must be a power of two and not more than 128
+ */
+#define EVENTQ_SIZE							16
+
+#endif /* __EVENTQ_CONFIG_H__ */
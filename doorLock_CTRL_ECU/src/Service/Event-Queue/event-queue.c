@@ -0,0 +1,182 @@
+/******************************************************************************
+ *
+ * Module: EVENTQ
+ *
+ * File Name: event-queue.c
+ *
+ * Description: Source file for the event queue service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module header file */
+#include "event-queue.h"
+
+/* For using mcu registers */
+#include "../../Mcal/Mcu/mcu.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if (EVENTQ_SIZE & (EVENTQ_SIZE - 1)) != 0 || EVENTQ_SIZE > 128
+#error "EVENTQ_SIZE must be a power of two and not more than 128"
+#endif
+
+/* mask to wrap the free running indices into the queue */
+#define EVENTQ_MASK							(EVENTQ_SIZE - 1)
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* ring buffer of the events */
+static volatile ST_Event g_eventQueue[EVENTQ_SIZE];
+
+/* free running indices of the queue, the head is written only by the producers
+ * and the tail only by the main program, the ISRs don't interrupt each other and
+ * the main program posts with the interrupts disabled, so only one producer
+ * writes the head at a time,
+ * number of events in the queue = (uint8_t)(head - tail)
+ */
+static volatile uint8_t g_eventQueueHead = 0, g_eventQueueTail = 0;
+
+/* number of events dropped because the queue was full */
+static volatile uint8_t g_eventQueueDropped = 0;
+
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: EVENTQ_init
+ * [Function Description]: empties the queue and resets the dropped events counter
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void EVENTQ_init(void)
+{
+	g_eventQueueHead = 0;
+	g_eventQueueTail = 0;
+	g_eventQueueDropped = 0;
+}
+
+/*
+ * [Function Name]: EVENTQ_post
+ * [Function Description]: adds an event at the end of the queue from the main program,
+ * 						   the interrupts are disabled while adding it and restored after
+ * [Args]:
+ * [in]: uint8_t a_type
+ * 		 type of the event
+ * [in]: uint8_t a_data
+ * 		 data of the event
+ * [Return]: uint8_t
+ * 			 EVENTQ_SUCCESS or EVENTQ_ERROR if the queue is full and the event is dropped
+ */
+uint8_t EVENTQ_post(uint8_t a_type, uint8_t a_data)
+{
+	uint8_t result;
+	uint8_t sreg = SREG_R;
+
+	DISABLE_GLOBAL_INTERRUPT();
+	result = EVENTQ_postFromIsr(a_type, a_data);
+
+	/* restore the global interrupt as it was */
+	SREG_R = sreg;
+
+	return result;
+}
+
+/*
+ * [Function Name]: EVENTQ_postFromIsr
+ * [Function Description]: adds an event at the end of the queue from an ISR
+ * 						   or from a callback called by an ISR
+ * [Args]:
+ * [in]: uint8_t a_type
+ * 		 type of the event
+ * [in]: uint8_t a_data
+ * 		 data of the event
+ * [Return]: uint8_t
+ * 			 EVENTQ_SUCCESS or EVENTQ_ERROR if the queue is full and the event is dropped
+ */
+uint8_t EVENTQ_postFromIsr(uint8_t a_type, uint8_t a_data)
+{
+	uint8_t head = g_eventQueueHead;
+
+	if((uint8_t)(head - g_eventQueueTail) >= EVENTQ_SIZE)
+	{
+		if(g_eventQueueDropped != 0xFF)
+		{
+			g_eventQueueDropped ++;
+		}
+		return EVENTQ_ERROR;
+	}
+
+	g_eventQueue[head & EVENTQ_MASK].type = a_type;
+	g_eventQueue[head & EVENTQ_MASK].data = a_data;
+
+	/* the event is visible to the main program only after it's written */
+	g_eventQueueHead = head + 1;
+
+	return EVENTQ_SUCCESS;
+}
+
+/*
+ * [Function Name]: EVENTQ_get
+ * [Function Description]: takes the oldest event of the queue if any, it doesn't wait
+ * [Args]:
+ * [out]: ST_Event * a_event
+ * 		  structure to store the event
+ * [Return]: uint8_t
+ * 			 EVENTQ_SUCCESS or EVENTQ_ERROR if the queue is empty
+ */
+uint8_t EVENTQ_get(ST_Event * a_event)
+{
+	uint8_t tail = g_eventQueueTail;
+
+	if(tail == g_eventQueueHead)
+	{
+		return EVENTQ_ERROR;
+	}
+
+	a_event->type = g_eventQueue[tail & EVENTQ_MASK].type;
+	a_event->data = g_eventQueue[tail & EVENTQ_MASK].data;
+
+	/* free the slot only after the event is read */
+	g_eventQueueTail = tail + 1;
+
+	return EVENTQ_SUCCESS;
+}
+
+/*
+ * [Function Name]: EVENTQ_isEmpty
+ * [Function Description]: checks if there are no events in the queue, it's short so
+ * 						   it can be the condition of sleeping till an event is posted
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the queue is empty, FALSE otherwise
+ */
+boolean EVENTQ_isEmpty(void)
+{
+	return g_eventQueueTail == g_eventQueueHead;
+}
+
+/*
+ * [Function Name]: EVENTQ_droppedCount
+ * [Function Description]: gets the number of events dropped because the queue was full
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 number of dropped events, it stops at 255
+ */
+uint8_t EVENTQ_droppedCount(void)
+{
+	return g_eventQueueDropped;
+}
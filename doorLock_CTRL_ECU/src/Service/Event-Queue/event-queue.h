@@ -0,0 +1,130 @@
+/******************************************************************************
+ *
+ * Module: EVENTQ
+ *
+ * File Name: event-queue.h
+ *
+ * Description: Header file for the event queue service, the ISRs and the main
+ * 				program post events and the main program takes them in order,
+ * 				so it runs only when something happens and idles otherwise
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __EVENTQ_H__
+#define __EVENTQ_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module config file */
+#include "event-queue-config.h"
+
+/* For using std types */
+#include "../../Lib/types.h"
+
+/* For using common defines and macros */
+#include "../../Lib/common.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* return values of the event queue functions */
+#define EVENTQ_SUCCESS						1
+#define EVENTQ_ERROR						0
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Struct Name]: ST_Event
+ * [Struct Description]: an event, its types are defined by the user of the queue
+ */
+typedef struct
+{
+	/* what happened */
+	uint8_t type;
+
+	/* data of the event, e.g. the id of an expired timer */
+	uint8_t data;
+
+}ST_Event;
+
+/*******************************************************************************
+ *                           Function Prototypes                               *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: EVENTQ_init
+ * [Function Description]: empties the queue and resets the dropped events counter
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void EVENTQ_init(void);
+
+/*
+ * [Function Name]: EVENTQ_post
+ * [Function Description]: adds an event at the end of the queue from the main program,
+ * 						   the interrupts are disabled while adding it and restored after
+ * [Args]:
+ * [in]: uint8_t a_type
+ * 		 type of the event
+ * [in]: uint8_t a_data
+ * 		 data of the event
+ * [Return]: uint8_t
+ * 			 EVENTQ_SUCCESS or EVENTQ_ERROR if the queue is full and the event is dropped
+ */
+uint8_t EVENTQ_post(uint8_t a_type, uint8_t a_data);
+
+/*
+ * [Function Name]: EVENTQ_postFromIsr
+ * [Function Description]: adds an event at the end of the queue from an ISR
+ * 						   or from a callback called by an ISR
+ * [Args]:
+ * [in]: uint8_t a_type
+ * 		 type of the event
+ * [in]: uint8_t a_data
+ * 		 data of the event
+ * [Return]: uint8_t
+ * 			 EVENTQ_SUCCESS or EVENTQ_ERROR if the queue is full and the event is dropped
+ */
+uint8_t EVENTQ_postFromIsr(uint8_t a_type, uint8_t a_data);
+
+/*
+ * [Function Name]: EVENTQ_get
+ * [Function Description]: takes the oldest event of the queue if any, it doesn't wait
+ * [Args]:
+ * [out]: ST_Event * a_event
+ * 		  structure to store the event
+ * [Return]: uint8_t
+ * 			 EVENTQ_SUCCESS or EVENTQ_ERROR if the queue is empty
+ */
+uint8_t EVENTQ_get(ST_Event * a_event);
+
+/*
+ * [Function Name]: EVENTQ_isEmpty
+ * [Function Description]: checks if there are no events in the queue, it's short so
+ * 						   it can be the condition of sleeping till an event is posted
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the queue is empty, FALSE otherwise
+ */
+boolean EVENTQ_isEmpty(void);
+
+/*
+ * [Function Name]: EVENTQ_droppedCount
+ * [Function Description]: gets the number of events dropped because the queue was full
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 number of dropped events, it stops at 255
+ */
+uint8_t EVENTQ_droppedCount(void);
+
+#endif /* __EVENTQ_H__ */
@@ -0,0 +1,518 @@
+/******************************************************************************
+ *
+ * Module: LINK
+ *
+ * File Name: link.c
+ *
+ * Description: Source file for the framed link between the two MCUs over the uart,
+ * 				frames are built and checked as defined in protocol.h
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module header file */
+#include "link.h"
+
+/* For using UART Module */
+#include "../../Mcal/Uart/uart.h"
+
+/* For using the crc of the frames */
+#include "../Crc8/crc8.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if PROTOCOL_MAX_FRAME_SIZE > UART_TX_BUFFER_SIZE
+#error "UART_TX_BUFFER_SIZE must fit a complete frame"
+#endif
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Enum Name]: EN_LinkRxStates
+ * [Enum Description]: contains the states of the received frame parser
+ */
+typedef enum
+{
+	/* waiting for PROTOCOL_START_BYTE */
+	LINK_RX_WAIT_START,
+
+	/* waiting for the payload length */
+	LINK_RX_WAIT_LENGTH,
+
+	/* waiting for the sequence number */
+	LINK_RX_WAIT_SEQUENCE,
+
+	/* receiving the payload bytes */
+	LINK_RX_WAIT_PAYLOAD,
+
+	/* waiting for the crc */
+	LINK_RX_WAIT_CRC
+
+}EN_LinkRxStates;
+
+/*******************************************************************************
+ *                      Static Functions Prototypes	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: sendControlFrame
+ * [Function Description]: sends a frame with an empty payload and a control code
+ * 						   in its sequence number, as a NAK or a WAIT
+ * [Args]:
+ * [in]: uint8_t a_code
+ * 		 PROTOCOL_NAK or PROTOCOL_WAIT
+ * [Return]: void
+ */
+static void sendControlFrame(uint8_t a_code);
+
+/*
+ * [Function Name]: retransmitLastFrame
+ * [Function Description]: resends the last sent frame as it is, with the same sequence number
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void retransmitLastFrame(void);
+
+/*
+ * [Function Name]: processFrame
+ * [Function Description]: handles a received frame with a valid crc, a control frame
+ * 						   or a duplicate is handled here, otherwise the frame
+ * 						   is marked as available to be read
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void processFrame(void);
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* last sent frame, kept to be resent, and its size */
+static uint8_t g_linkTxFrame[PROTOCOL_MAX_FRAME_SIZE];
+static uint8_t g_linkTxFrameSize = 0;
+
+/* sequence number of the next sent frame */
+static uint8_t g_linkTxSequence = 0;
+
+/* payload of the frame being received or waiting to be read */
+static uint8_t g_linkRxPayload[PROTOCOL_MAX_PAYLOAD_SIZE];
+
+/* g_linkRxState => current state of the received frame parser
+ * g_linkRxLength => payload length of the frame being received
+ * g_linkRxIndex => number of payload bytes received
+ * g_linkRxSequence => sequence number of the frame being received
+ * g_linkRxCrc => crc of the bytes received till now
+ * g_linkLastRxSequence => sequence number of the last accepted frame
+ * g_linkRetransmissions => number of retransmissions for the duplicates of the last accepted frame
+ * g_linkResends => number of times the last sent frame is resent as it isn't confirmed
+ */
+static EN_LinkRxStates g_linkRxState = LINK_RX_WAIT_START;
+static uint8_t g_linkRxLength = 0, g_linkRxIndex = 0, g_linkRxSequence = 0, g_linkRxCrc = 0;
+static uint8_t g_linkLastRxSequence = 0, g_linkRetransmissions = 0, g_linkResends = 0;
+
+/* g_linkHasReceived => states whether any frame has been accepted or not
+ * g_linkFrameAvailable => states whether a frame is waiting to be read or not
+ * g_linkIsConfirmed => states whether the other MCU confirmed the last sent frame or not
+ * g_linkIsAnswered => states whether a frame is sent after the last accepted frame or not
+ * g_linkIsWaitSent => states whether a WAIT is sent for the last accepted frame or not
+ */
+static boolean g_linkHasReceived = FALSE,
+		g_linkFrameAvailable = FALSE,
+		g_linkIsConfirmed = TRUE,
+		g_linkIsAnswered = TRUE,
+		g_linkIsWaitSent = FALSE;
+
+/* link counters */
+static ST_LinkStats g_linkStats;
+
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: LINK_init
+ * [Function Description]: resets the link state and counters,
+ * 						   the uart must be initialized with rx interrupt enabled
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void LINK_init(void)
+{
+	g_linkTxFrameSize = 0;
+	g_linkTxSequence = 0;
+	g_linkRxState = LINK_RX_WAIT_START;
+	g_linkHasReceived = FALSE;
+	g_linkFrameAvailable = FALSE;
+	g_linkIsConfirmed = TRUE;
+	g_linkIsAnswered = TRUE;
+	g_linkIsWaitSent = FALSE;
+	g_linkResends = 0;
+
+	g_linkStats.txFrames = 0;
+	g_linkStats.rxFrames = 0;
+	g_linkStats.crcErrors = 0;
+	g_linkStats.duplicates = 0;
+	g_linkStats.retransmissions = 0;
+	g_linkStats.timeouts = 0;
+}
+
+/*
+ * [Function Name]: LINK_sendFrame
+ * [Function Description]: builds a frame with the next sequence number around the payload
+ * 						   and queues it in the uart tx buffer, it waits only if the
+ * 						   tx buffer doesn't have room for the whole frame,
+ * 						   the frame is kept to be resent if the other MCU asks for it
+ * [Args]:
+ * [in]: const uint8_t * a_payload
+ * 		 batch of commands to send
+ * [in]: uint8_t a_size
+ * 		 payload size, from 1 to PROTOCOL_MAX_PAYLOAD_SIZE
+ * [Return]: uint8_t
+ * 			 LINK_SUCCESS if the frame is queued
+ * 			 LINK_ERROR if the payload size is not valid
+ */
+uint8_t LINK_sendFrame(const uint8_t * a_payload, uint8_t a_size)
+{
+	uint8_t index, crc;
+
+	/* an empty payload is reserved for the control frames */
+	if(a_size == 0 || a_size > PROTOCOL_MAX_PAYLOAD_SIZE)
+	{
+		return LINK_ERROR;
+	}
+
+	/* frame header */
+	g_linkTxFrame[0] = PROTOCOL_START_BYTE;
+	g_linkTxFrame[1] = a_size;
+	g_linkTxFrame[2] = g_linkTxSequence;
+	crc = CRC8_update(CRC8_INIT, a_size);
+	crc = CRC8_update(crc, g_linkTxSequence);
+
+	/* payload */
+	for(index = 0; index < a_size; index ++)
+	{
+		g_linkTxFrame[3 + index] = a_payload[index];
+		crc = CRC8_update(crc, a_payload[index]);
+	}
+
+	/* crc */
+	g_linkTxFrame[3 + a_size] = crc;
+	g_linkTxFrameSize = a_size + PROTOCOL_FRAME_OVERHEAD;
+
+	g_linkTxSequence ++;
+	g_linkStats.txFrames ++;
+
+	/* the frame answers the last accepted frame and waits for its own confirmation */
+	g_linkIsAnswered = TRUE;
+	g_linkIsConfirmed = FALSE;
+	g_linkResends = 0;
+
+	/* wait till the whole frame fits in the tx buffer */
+	while(UART_queueBytes(g_linkTxFrame, g_linkTxFrameSize) == UART_ERROR);
+
+	return LINK_SUCCESS;
+}
+
+/*
+ * [Function Name]: LINK_frameIsAvailable
+ * [Function Description]: parses the received bytes and checks if a complete frame
+ * 						   is waiting to be read, it doesn't use any busy wait
+ * 						   so it can be used in await loops
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if a frame is available, FALSE otherwise
+ */
+boolean LINK_frameIsAvailable(void)
+{
+	uint8_t data;
+
+	/* parsing stops at a complete frame till it's read */
+	while(!g_linkFrameAvailable && UART_readByte(&data) == UART_SUCCESS)
+	{
+		switch(g_linkRxState)
+		{
+		case LINK_RX_WAIT_START:
+			if(data == PROTOCOL_START_BYTE)
+			{
+				g_linkRxState = LINK_RX_WAIT_LENGTH;
+			}
+			break;
+
+		case LINK_RX_WAIT_LENGTH:
+			if(data > PROTOCOL_MAX_PAYLOAD_SIZE)
+			{
+				/* not a valid frame, drop it and search for the next start byte */
+				g_linkStats.crcErrors ++;
+				sendControlFrame(PROTOCOL_NAK);
+				g_linkRxState = LINK_RX_WAIT_START;
+			}
+			else
+			{
+				g_linkRxLength = data;
+				g_linkRxIndex = 0;
+				g_linkRxCrc = CRC8_update(CRC8_INIT, data);
+				g_linkRxState = LINK_RX_WAIT_SEQUENCE;
+			}
+			break;
+
+		case LINK_RX_WAIT_SEQUENCE:
+			g_linkRxSequence = data;
+			g_linkRxCrc = CRC8_update(g_linkRxCrc, data);
+			g_linkRxState = (g_linkRxLength == 0) ? LINK_RX_WAIT_CRC : LINK_RX_WAIT_PAYLOAD;
+			break;
+
+		case LINK_RX_WAIT_PAYLOAD:
+			g_linkRxPayload[g_linkRxIndex] = data;
+			g_linkRxCrc = CRC8_update(g_linkRxCrc, data);
+			g_linkRxIndex ++;
+			if(g_linkRxIndex == g_linkRxLength)
+			{
+				g_linkRxState = LINK_RX_WAIT_CRC;
+			}
+			break;
+
+		case LINK_RX_WAIT_CRC:
+			if(data == g_linkRxCrc)
+			{
+				processFrame();
+			}
+			else
+			{
+				/* corrupted frame, ask for it again */
+				g_linkStats.crcErrors ++;
+				sendControlFrame(PROTOCOL_NAK);
+			}
+			g_linkRxState = LINK_RX_WAIT_START;
+			break;
+		}
+	}
+
+	return g_linkFrameAvailable;
+}
+
+/*
+ * [Function Name]: LINK_receiveFrame
+ * [Function Description]: takes the payload of the next received frame if any,
+ * 						   it doesn't use any busy wait
+ * [Args]:
+ * [out]: uint8_t * a_payload
+ * 		  array of PROTOCOL_MAX_PAYLOAD_SIZE bytes to store the payload
+ * [out]: uint8_t * a_size
+ * 		  size of the received payload
+ * [Return]: uint8_t
+ * 			 LINK_SUCCESS if a frame is received
+ * 			 LINK_ERROR if no frame is available
+ */
+uint8_t LINK_receiveFrame(uint8_t * a_payload, uint8_t * a_size)
+{
+	uint8_t index;
+
+	if(!LINK_frameIsAvailable())
+	{
+		return LINK_ERROR;
+	}
+
+	for(index = 0; index < g_linkRxLength; index ++)
+	{
+		a_payload[index] = g_linkRxPayload[index];
+	}
+	*a_size = g_linkRxLength;
+
+	/* continue parsing the next frame */
+	g_linkFrameAvailable = FALSE;
+
+	return LINK_SUCCESS;
+}
+
+/*
+ * [Function Name]: LINK_isConfirmed
+ * [Function Description]: checks if the other MCU confirmed the last sent frame,
+ * 						   by sending a new frame or a WAIT after it
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the frame is confirmed or no frame is sent, FALSE otherwise
+ */
+boolean LINK_isConfirmed(void)
+{
+	/* parse the received bytes as the confirmation may be one of them */
+	LINK_frameIsAvailable();
+
+	return g_linkIsConfirmed;
+}
+
+/*
+ * [Function Name]: LINK_resendFrame
+ * [Function Description]: resends the last sent frame with the same sequence number,
+ * 						   called when it isn't confirmed in LINK_RESPONSE_TIMEOUT_MS
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 LINK_SUCCESS if the frame is resent
+ * 			 LINK_ERROR if it's already resent LINK_MAX_RETRIES times, so the link is broken
+ */
+uint8_t LINK_resendFrame(void)
+{
+	if(g_linkResends == LINK_MAX_RETRIES)
+	{
+		return LINK_ERROR;
+	}
+
+	g_linkResends ++;
+	g_linkStats.timeouts ++;
+	retransmitLastFrame();
+
+	return LINK_SUCCESS;
+}
+
+/*
+ * [Function Name]: LINK_restartResends
+ * [Function Description]: lets the last sent frame be resent LINK_MAX_RETRIES times again,
+ * 						   used by the MCU that keeps resending its frame till the other
+ * 						   MCU connects again
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void LINK_restartResends(void)
+{
+	g_linkResends = 0;
+}
+
+/*
+ * [Function Name]: LINK_confirmFrame
+ * [Function Description]: sends a WAIT for the last received frame if it isn't answered yet,
+ * 						   called before waiting for the user so the other MCU doesn't
+ * 						   resend the frame meanwhile, the WAIT is sent once for each frame
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void LINK_confirmFrame(void)
+{
+	if(!g_linkIsAnswered && !g_linkIsWaitSent)
+	{
+		g_linkIsWaitSent = TRUE;
+		sendControlFrame(PROTOCOL_WAIT);
+	}
+}
+
+/*
+ * [Function Name]: LINK_getStats
+ * [Function Description]: copies the link counters
+ * [Args]:
+ * [out]: ST_LinkStats * a_stats
+ * 		  structure to store the counters
+ * [Return]: void
+ */
+void LINK_getStats(ST_LinkStats * a_stats)
+{
+	*a_stats = g_linkStats;
+}
+
+/*
+ * [Function Name]: sendControlFrame
+ * [Function Description]: sends a frame with an empty payload and a control code
+ * 						   in its sequence number, as a NAK or a WAIT
+ * [Args]:
+ * [in]: uint8_t a_code
+ * 		 PROTOCOL_NAK or PROTOCOL_WAIT
+ * [Return]: void
+ */
+static void sendControlFrame(uint8_t a_code)
+{
+	uint8_t controlFrame[PROTOCOL_FRAME_OVERHEAD];
+
+	controlFrame[0] = PROTOCOL_START_BYTE;
+	controlFrame[1] = 0;
+	controlFrame[2] = a_code;
+	controlFrame[3] = CRC8_update(CRC8_update(CRC8_INIT, 0), a_code);
+
+	/* the frame is dropped if the tx buffer is full, the other MCU will send a duplicate then */
+	UART_queueBytes(controlFrame, PROTOCOL_FRAME_OVERHEAD);
+}
+
+/*
+ * [Function Name]: retransmitLastFrame
+ * [Function Description]: resends the last sent frame as it is, with the same sequence number
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void retransmitLastFrame(void)
+{
+	if(g_linkTxFrameSize != 0)
+	{
+		g_linkStats.retransmissions ++;
+		while(UART_queueBytes(g_linkTxFrame, g_linkTxFrameSize) == UART_ERROR);
+	}
+}
+
+/*
+ * [Function Name]: processFrame
+ * [Function Description]: handles a received frame with a valid crc, a control frame
+ * 						   or a duplicate is handled here, otherwise the frame
+ * 						   is marked as available to be read
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void processFrame(void)
+{
+	if(g_linkRxLength == 0)
+	{
+		if(g_linkRxSequence == PROTOCOL_WAIT)
+		{
+			/* the other MCU received the last frame and will answer it later */
+			g_linkIsConfirmed = TRUE;
+		}
+		else
+		{
+			/* nak, the other MCU didn't receive the last frame correctly */
+			retransmitLastFrame();
+		}
+	}
+	else if(g_linkHasReceived && g_linkRxSequence == g_linkLastRxSequence)
+	{
+		/* the frame is already accepted, so the other MCU is sending it again as it
+		 * didn't receive the answer, the answer is resent at most LINK_MAX_RETRIES times
+		 * so both MCUs don't keep resending duplicates to each other
+		 */
+		g_linkStats.duplicates ++;
+		if(!g_linkIsAnswered)
+		{
+			/* the answer isn't ready yet */
+			sendControlFrame(PROTOCOL_WAIT);
+		}
+		else if(g_linkRetransmissions < LINK_MAX_RETRIES)
+		{
+			g_linkRetransmissions ++;
+			retransmitLastFrame();
+		}
+	}
+	else
+	{
+		/* new frame, it confirms the last sent frame */
+		g_linkHasReceived = TRUE;
+		g_linkLastRxSequence = g_linkRxSequence;
+		g_linkRetransmissions = 0;
+		g_linkIsConfirmed = TRUE;
+		g_linkIsAnswered = FALSE;
+		g_linkIsWaitSent = FALSE;
+		g_linkStats.rxFrames ++;
+		g_linkFrameAvailable = TRUE;
+	}
+}
@@ -0,0 +1,47 @@
+/******************************************************************************
+ *
+ * Module: SETTINGS
+ *
+ * File Name: settings-config.h
+ *
+ * Description: Config file for the settings service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SETTINGS_CONFIG_H__
+#define __SETTINGS_CONFIG_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* For using the password length shared with the other MCU */
+#include "../../../../doorLock_Common/Protocol/protocol.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* first page and number of pages of the records log in the eeprom, every page holds one
+ * record and every save goes to the page after the newest record, so each page takes
+ * one write of every SETTINGS_LOG_PAGES saves */
+#define SETTINGS_LOG_FIRST_PAGE				0
+#define SETTINGS_LOG_PAGES					128
+
+/* number of pages read in one block read while searching for the newest record,
+ * the buffer of the block is on the stack */
+#define SETTINGS_SCAN_PAGES					4
+
+/* number of chars of the saved password */
+#define SETTINGS_PASS_LENGTH				PASSWORD_LENGTH
+
+/* initial value of the crc of the records, it's not 0 so an erased (0xFF)
+ * or a zeroed page doesn't have a right crc and is never loaded as a record */
+#define SETTINGS_CRC_SEED					0xFF
+
+/* number of trials of reading or writing a block before giving up */
+#define SETTINGS_EEPROM_TRIALS				3
+
+#endif /* __SETTINGS_CONFIG_H__ */
@@ -0,0 +1,315 @@
+/******************************************************************************
+ *
+ * Module: SETTINGS
+ *
+ * File Name: settings.c
+ *
+ * Description: Source file for the settings service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module header file */
+#include "settings.h"
+
+/* For using the external eeprom */
+#include "../../Hal/External-Eeprom/external-eeprom.h"
+
+/* For using the crc of the records */
+#include "../Crc8/crc8.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if SETTINGS_RECORD_SIZE > EEPROM_PAGE_SIZE
+#error "the settings record must fit in one eeprom page"
+#endif
+
+#if (SETTINGS_LOG_FIRST_PAGE + SETTINGS_LOG_PAGES) * EEPROM_PAGE_SIZE > EEPROM_SIZE
+#error "the settings log must fit in the eeprom"
+#endif
+
+#if SETTINGS_LOG_PAGES % SETTINGS_SCAN_PAGES != 0
+#error "SETTINGS_LOG_PAGES must be a multiple of SETTINGS_SCAN_PAGES"
+#endif
+
+/* locations of the fields in the record, the sequence is little endian */
+#define SETTINGS_SEQUENCE_INDEX				0
+#define SETTINGS_PASS_INDEX					2
+#define SETTINGS_CRC_INDEX					(SETTINGS_PASS_LENGTH + 2)
+
+#if SETTINGS_CRC_SEED == 0
+#error "a zeroed page has a right crc with a zero seed"
+#endif
+
+/* eeprom address of a page of the log */
+#define SETTINGS_PAGE_ADDRESS(page)			((uint16_t)(SETTINGS_LOG_FIRST_PAGE + (page)) * EEPROM_PAGE_SIZE)
+
+/*******************************************************************************
+ *                      Static Functions Prototypes	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: recordSequence
+ * [Function Description]: gets the sequence of a record
+ * [Args]:
+ * [in]: const uint8_t * a_record
+ * 		 record to read its sequence
+ * [Return]: uint16_t
+ * 			 sequence of the record
+ */
+static uint16_t recordSequence(const uint8_t * a_record);
+
+/*
+ * [Function Name]: recordCrc
+ * [Function Description]: calculates the crc of the sequence and the password of a record,
+ * 						   starting from SETTINGS_CRC_SEED
+ * [Args]:
+ * [in]: const uint8_t * a_record
+ * 		 record to calculate its crc
+ * [Return]: uint8_t
+ * 			 crc of the record
+ */
+static uint8_t recordCrc(const uint8_t * a_record);
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* copy of the newest record */
+static uint8_t g_record[SETTINGS_RECORD_SIZE];
+
+/* state of the record in RAM */
+static EN_SettingsState g_settingsState = SETTINGS_CORRUPTED;
+
+/* page of the newest record in the log, the next record is saved in the page after it */
+static uint8_t g_newestPage = SETTINGS_LOG_PAGES - 1;
+
+/* the record, its state and its page before the last SETTINGS_setPass, they're
+ * restored if the new record isn't written, so RAM doesn't differ from the eeprom */
+static uint8_t g_previousRecord[SETTINGS_RECORD_SIZE];
+static EN_SettingsState g_previousState = SETTINGS_CORRUPTED;
+static uint8_t g_previousPage = SETTINGS_LOG_PAGES - 1;
+
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: SETTINGS_init
+ * [Function Description]: searches the log for the newest record with a right crc and loads
+ * 						   it, the log is read in blocks of SETTINGS_SCAN_PAGES pages,
+ * 						   the eeprom must be initialized first
+ * [Args]:
+ * [in]: void
+ * [Return]: EN_SettingsState
+ * 			 state of the loaded settings
+ */
+EN_SettingsState SETTINGS_init(void)
+{
+	uint8_t block[SETTINGS_SCAN_PAGES * EEPROM_PAGE_SIZE];
+	const uint8_t * record;
+	uint8_t page, blockPage, byteIndex, trial;
+
+	g_settingsState = SETTINGS_EMPTY;
+	g_newestPage = SETTINGS_LOG_PAGES - 1;
+
+	for(page = 0; page < SETTINGS_LOG_PAGES; page += SETTINGS_SCAN_PAGES)
+	{
+		for(trial = 0; trial < SETTINGS_EEPROM_TRIALS; trial ++)
+		{
+			if(EEPROM_readBlock(SETTINGS_PAGE_ADDRESS(page), block, sizeof(block)) == EEPROM_SUCCESS)
+			{
+				break;
+			}
+		}
+
+		/* an unknown page may hold the newest password, so none is trusted */
+		if(trial == SETTINGS_EEPROM_TRIALS)
+		{
+			g_settingsState = SETTINGS_CORRUPTED;
+			return g_settingsState;
+		}
+
+		for(blockPage = 0; blockPage < SETTINGS_SCAN_PAGES; blockPage ++)
+		{
+			record = &block[blockPage * EEPROM_PAGE_SIZE];
+
+			/* a page with a wrong crc is either erased or torn by a power loss,
+			 * so it's skipped and the record before it stays in use */
+			if(record[SETTINGS_CRC_INDEX] == recordCrc(record))
+			{
+				/* the sequences of the log are within SETTINGS_LOG_PAGES of each other,
+				 * so the difference tells the newer one even after wrapping */
+				if(g_settingsState != SETTINGS_VALID ||
+						(int16_t)(recordSequence(record) - recordSequence(g_record)) > 0)
+				{
+					for(byteIndex = 0; byteIndex < SETTINGS_RECORD_SIZE; byteIndex ++)
+					{
+						g_record[byteIndex] = record[byteIndex];
+					}
+					g_newestPage = page + blockPage;
+					g_settingsState = SETTINGS_VALID;
+				}
+			}
+		}
+	}
+
+	return g_settingsState;
+}
+
+/*
+ * [Function Name]: SETTINGS_getState
+ * [Function Description]: gets the state of the settings in RAM
+ * [Args]:
+ * [in]: void
+ * [Return]: EN_SettingsState
+ * 			 state of the settings
+ */
+EN_SettingsState SETTINGS_getState(void)
+{
+	return g_settingsState;
+}
+
+/*
+ * [Function Name]: SETTINGS_checkPass
+ * [Function Description]: compares a password with the saved one in RAM
+ * [Args]:
+ * [in]: const uint8_t * a_pass
+ * 		 password of SETTINGS_PASS_LENGTH chars
+ * [Return]: boolean
+ * 			 TRUE if the settings are valid and the password matches, FALSE otherwise
+ */
+boolean SETTINGS_checkPass(const uint8_t * a_pass)
+{
+	uint8_t passIndex;
+
+	if(g_settingsState != SETTINGS_VALID)
+		return FALSE;
+
+	for(passIndex = 0; passIndex < SETTINGS_PASS_LENGTH; passIndex ++)
+	{
+		if(a_pass[passIndex] != g_record[SETTINGS_PASS_INDEX + passIndex])
+			return FALSE;
+	}
+	return TRUE;
+}
+
+/*
+ * [Function Name]: SETTINGS_setPass
+ * [Function Description]: saves a new password in RAM and starts writing its record to the
+ * 						   next page of the log, the write cycle runs in the background and
+ * 						   its completion is checked with EEPROM_isWritePending, if the
+ * 						   write fails SETTINGS_revertPass restores the previous password
+ * [Args]:
+ * [in]: const uint8_t * a_pass
+ * 		 password of SETTINGS_PASS_LENGTH chars
+ * [Return]: uint8_t
+ * 			 SETTINGS_SUCCESS or SETTINGS_ERROR if the write can't be started,
+ * 			 then RAM keeps the previous password
+ */
+uint8_t SETTINGS_setPass(const uint8_t * a_pass)
+{
+	uint16_t sequence;
+	uint8_t byteIndex, passIndex, trial;
+
+	/* keep the previous record till the new one is written */
+	for(byteIndex = 0; byteIndex < SETTINGS_RECORD_SIZE; byteIndex ++)
+	{
+		g_previousRecord[byteIndex] = g_record[byteIndex];
+	}
+	g_previousState = g_settingsState;
+	g_previousPage = g_newestPage;
+
+	/* the first record of an empty log has sequence 0 */
+	sequence = (g_settingsState == SETTINGS_VALID) ? (uint16_t)(recordSequence(g_record) + 1) : 0;
+
+	g_record[SETTINGS_SEQUENCE_INDEX] = (uint8_t)sequence;
+	g_record[SETTINGS_SEQUENCE_INDEX + 1] = (uint8_t)(sequence >> 8);
+	for(passIndex = 0; passIndex < SETTINGS_PASS_LENGTH; passIndex ++)
+	{
+		g_record[SETTINGS_PASS_INDEX + passIndex] = a_pass[passIndex];
+	}
+	g_record[SETTINGS_CRC_INDEX] = recordCrc(g_record);
+	g_settingsState = SETTINGS_VALID;
+
+	/* write through to the page after the newest record, the newest one is
+	 * kept as it is till the new one is complete */
+	g_newestPage = (g_newestPage + 1) % SETTINGS_LOG_PAGES;
+
+	for(trial = 0; trial < SETTINGS_EEPROM_TRIALS; trial ++)
+	{
+		if(EEPROM_writePage(SETTINGS_PAGE_ADDRESS(g_newestPage), g_record, SETTINGS_RECORD_SIZE) == EEPROM_SUCCESS)
+		{
+			return SETTINGS_SUCCESS;
+		}
+	}
+
+	SETTINGS_revertPass();
+	return SETTINGS_ERROR;
+}
+
+/*
+ * [Function Name]: SETTINGS_revertPass
+ * [Function Description]: restores the password in RAM before the last SETTINGS_setPass,
+ * 						   it's called when the write of the new record fails, so the
+ * 						   eeprom keeps the previous record and the next record is saved
+ * 						   in the same page again
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void SETTINGS_revertPass(void)
+{
+	uint8_t byteIndex;
+
+	for(byteIndex = 0; byteIndex < SETTINGS_RECORD_SIZE; byteIndex ++)
+	{
+		g_record[byteIndex] = g_previousRecord[byteIndex];
+	}
+	g_settingsState = g_previousState;
+	g_newestPage = g_previousPage;
+}
+
+/*
+ * [Function Name]: recordSequence
+ * [Function Description]: gets the sequence of a record
+ * [Args]:
+ * [in]: const uint8_t * a_record
+ * 		 record to read its sequence
+ * [Return]: uint16_t
+ * 			 sequence of the record
+ */
+static uint16_t recordSequence(const uint8_t * a_record)
+{
+	return (uint16_t)a_record[SETTINGS_SEQUENCE_INDEX] |
+			((uint16_t)a_record[SETTINGS_SEQUENCE_INDEX + 1] << 8);
+}
+
+/*
+ * [Function Name]: recordCrc
+ * [Function Description]: calculates the crc of the sequence and the password of a record,
+ * 						   starting from SETTINGS_CRC_SEED
+ * [Args]:
+ * [in]: const uint8_t * a_record
+ * 		 record to calculate its crc
+ * [Return]: uint8_t
+ * 			 crc of the record
+ */
+static uint8_t recordCrc(const uint8_t * a_record)
+{
+	uint8_t crc = SETTINGS_CRC_SEED;
+	uint8_t byteIndex;
+
+	for(byteIndex = 0; byteIndex < SETTINGS_CRC_INDEX; byteIndex ++)
+	{
+		crc = CRC8_update(crc, a_record[byteIndex]);
+	}
+	return crc;
+}
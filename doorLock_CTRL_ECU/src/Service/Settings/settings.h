@@ -0,0 +1,134 @@
+/******************************************************************************
+ *
+ * Module: SETTINGS
+ *
+ * File Name: settings.h
+ *
+ * Description: Header file for the settings service, it keeps a copy of the settings
+ * 				saved in the eeprom in RAM, reads are served from RAM and writes update
+ * 				RAM and the eeprom together
+ *
+ * 				the eeprom holds a log of records, one in each page:
+ * 				| sequence (2 bytes) | password | crc-8 of sequence and password |
+ * 				a save writes a new record to the page after the newest one, at startup
+ * 				the record with the newest sequence and a right crc is loaded, so a save
+ * 				cut by a power loss leaves the previous record in use
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SETTINGS_H__
+#define __SETTINGS_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module config file */
+#include "settings-config.h"
+
+/* For using std types */
+#include "../../Lib/types.h"
+
+/* For using common defines and macros */
+#include "../../Lib/common.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* return values of the settings functions */
+#define SETTINGS_SUCCESS					1
+#define SETTINGS_ERROR						0
+
+/* size of the record in the eeprom */
+#define SETTINGS_RECORD_SIZE				(SETTINGS_PASS_LENGTH + 3)
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Enum Name]: EN_SettingsState
+ * [Enum Description]: contains the states of the settings loaded from the eeprom
+ */
+typedef enum
+{
+	/* no record with a right crc is found, the log is erased or its only
+	 * record is torn, so a new password is set */
+	SETTINGS_EMPTY,
+
+	/* a record with a right crc is found */
+	SETTINGS_VALID,
+
+	/* the log can't be read, no entered password matches it */
+	SETTINGS_CORRUPTED
+
+}EN_SettingsState;
+
+/*******************************************************************************
+ *                           Function Prototypes                               *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: SETTINGS_init
+ * [Function Description]: searches the log for the newest record with a right crc and loads
+ * 						   it, the log is read in blocks of SETTINGS_SCAN_PAGES pages,
+ * 						   the eeprom must be initialized first
+ * [Args]:
+ * [in]: void
+ * [Return]: EN_SettingsState
+ * 			 state of the loaded settings
+ */
+EN_SettingsState SETTINGS_init(void);
+
+/*
+ * [Function Name]: SETTINGS_getState
+ * [Function Description]: gets the state of the settings in RAM
+ * [Args]:
+ * [in]: void
+ * [Return]: EN_SettingsState
+ * 			 state of the settings
+ */
+EN_SettingsState SETTINGS_getState(void);
+
+/*
+ * [Function Name]: SETTINGS_checkPass
+ * [Function Description]: compares a password with the saved one in RAM
+ * [Args]:
+ * [in]: const uint8_t * a_pass
+ * 		 password of SETTINGS_PASS_LENGTH chars
+ * [Return]: boolean
+ * 			 TRUE if the settings are valid and the password matches, FALSE otherwise
+ */
+boolean SETTINGS_checkPass(const uint8_t * a_pass);
+
+/*
+ * [Function Name]: SETTINGS_setPass
+ * [Function Description]: saves a new password in RAM and starts writing its record to the
+ * 						   next page of the log, the write cycle runs in the background and
+ * 						   its completion is checked with EEPROM_isWritePending, if the
+ * 						   write fails SETTINGS_revertPass restores the previous password
+ * [Args]:
+ * [in]: const uint8_t * a_pass
+ * 		 password of SETTINGS_PASS_LENGTH chars
+ * [Return]: uint8_t
+ * 			 SETTINGS_SUCCESS or SETTINGS_ERROR if the write can't be started,
+ * 			 then RAM keeps the previous password
+ */
+uint8_t SETTINGS_setPass(const uint8_t * a_pass);
+
+/*
+ * [Function Name]: SETTINGS_revertPass
+ * [Function Description]: restores the password in RAM before the last SETTINGS_setPass,
+ * 						   it's called when the write of the new record fails, so the
+ * 						   eeprom keeps the previous record and the next record is saved
+ * 						   in the same page again
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void SETTINGS_revertPass(void);
+
+#endif /* __SETTINGS_H__ */
@@ -0,0 +1,45 @@
+/******************************************************************************
+ *
+ * Module: SOFTTIMER
+ *
+ * File Name: soft-timer-config.h
+ *
+ * Description: Config file for the software timers service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SOFTTIMER_CONFIG_H__
+#define __SOFTTIMER_CONFIG_H__
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* number of software timers, the ids are 0 to SOFTTIMERS_COUNT - 1 */
+#define SOFTTIMERS_COUNT					6
+
+/* number of slots of the timer wheel, must be a power of 2,
+ * a timer is checked only when the wheel passes by its slot,
+ * so more slots means less timers checked in each tick
+ */
+#define SOFTTIMER_WHEEL_SIZE				16
+
+/* hardware timer generating the tick */
+#define SOFTTIMER_HW_TIMER					TIMER_0
+
+/* mode of the hardware timer */
+#define SOFTTIMER_HW_TIMER_MODE				TIMER_0_CTC
+
+/* prescaler of the hardware timer, and its numerical value */
+#define SOFTTIMER_HW_TIMER_PRESCALER		TIMER_0_PRESCALER_64
+#define SOFTTIMER_HW_TIMER_PRESCALER_NUMBERS	64
+
+/* max count of the hardware timer */
+#define SOFTTIMER_HW_TIMER_MAX_COUNT		TIMER_0_MAX_COUNT
+
+/* tick period in ms */
+#define SOFTTIMER_TICK_MS					1
+
+#endif /* __SOFTTIMER_CONFIG_H__ */
@@ -0,0 +1,498 @@
+/******************************************************************************
+ *
+ * Module: SOFTTIMER
+ *
+ * File Name: soft-timer.c
+ *
+ * Description: Source file for the software timers service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module header file */
+#include "soft-timer.h"
+
+/* For using the hardware timer of the tick */
+#include "../../Mcal/Timer/timer.h"
+
+/* For using mcu registers */
+#include "../../Mcal/Mcu/mcu.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* hardware timer ticks in one software tick */
+#define SOFTTIMER_HW_TICKS					TIME_MS_TO_TICKS(SOFTTIMER_HW_TIMER_PRESCALER_NUMBERS, SOFTTIMER_TICK_MS)
+
+/* mask of the wheel position */
+#define SOFTTIMER_WHEEL_MASK				(SOFTTIMER_WHEEL_SIZE - 1)
+
+/* max ticks of a timer, limited by its rounds counter */
+#define SOFTTIMER_MAX_TICKS					((uint32_t)SOFTTIMER_WHEEL_SIZE * 65536UL)
+
+/* end of a wheel slot list */
+#define SOFTTIMER_NONE						0xFF
+
+/* timer states */
+#define SOFTTIMER_STOPPED					0
+#define SOFTTIMER_RUNNING					1
+#define SOFTTIMER_EXPIRING					2
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Struct Name]: ST_SoftTimer
+ * [Struct Description]: a software timer, the running timers of a wheel slot
+ * 						 are linked in a doubly linked list
+ */
+typedef struct
+{
+	/* ticks of the period, used to restart a periodic timer */
+	uint32_t periodTicks;
+
+	/* number of times the wheel passes by the slot before the timer expires */
+	uint16_t rounds;
+
+	/* slot of the wheel and the next and previous timers in it */
+	uint8_t slot, next, prev;
+
+	/* SOFTTIMER_STOPPED, SOFTTIMER_RUNNING or SOFTTIMER_EXPIRING */
+	uint8_t state;
+
+	/* EN_SoftTimerMode */
+	uint8_t mode;
+
+	/* set when the timer expires, cleared by SOFTTIMER_hasExpired() */
+	volatile boolean hasExpired;
+
+	/* called when the timer expires */
+	void (* callback)(void);
+
+}ST_SoftTimer;
+
+/*******************************************************************************
+ *                      Static Functions Prototypes	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: tickHandler
+ * [Function Description]: callback of the hardware timer, moves the wheel one slot,
+ * 						   expires the timers of the slot that have no rounds left
+ * 						   then calls their callbacks
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void tickHandler(void);
+
+/*
+ * [Function Name]: insertTimer
+ * [Function Description]: adds a timer to the wheel slot where it expires
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [in]: uint32_t a_ticks
+ * 		 ticks till the timer expires, at least 1
+ * [Return]: void
+ */
+static void insertTimer(uint8_t a_timerId, uint32_t a_ticks);
+
+/*
+ * [Function Name]: removeTimer
+ * [Function Description]: removes a running timer from its wheel slot
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [Return]: void
+ */
+static void removeTimer(uint8_t a_timerId);
+
+/*
+ * [Function Name]: enterCriticalSection
+ * [Function Description]: disables the interrupts while changing the wheel
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 status register before disabling the interrupts
+ */
+static uint8_t enterCriticalSection(void);
+
+/*
+ * [Function Name]: exitCriticalSection
+ * [Function Description]: restores the global interrupt as it was before changing
+ * 						   the wheel, so a timer callback or another ISR leaves
+ * 						   the interrupts disabled
+ * [Args]:
+ * [in]: uint8_t a_sreg
+ * 		 status register returned by enterCriticalSection()
+ * [Return]: void
+ */
+static void exitCriticalSection(uint8_t a_sreg);
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* the software timers */
+static ST_SoftTimer g_softTimers[SOFTTIMERS_COUNT];
+
+/* first timer of each wheel slot */
+static uint8_t g_wheel[SOFTTIMER_WHEEL_SIZE];
+
+/* current slot of the wheel */
+static uint8_t g_wheelPosition = 0;
+
+/* number of timers that are not stopped, the hardware timer is stopped when it's 0 */
+static uint8_t g_runningCount = 0;
+
+/* config of the hardware timer, the ticks split is done during compilation */
+static TIMER_config g_hwTimerConfig = { SOFTTIMER_HW_TIMER, SOFTTIMER_HW_TIMER_MODE,
+		SOFTTIMER_HW_TIMER_PRESCALER, SOFTTIMER_HW_TICKS, tickHandler,
+		TIMER_TICKS_PER_ITERATION(SOFTTIMER_HW_TICKS, SOFTTIMER_HW_TIMER_MAX_COUNT),
+		TIMER_ITERATIONS(SOFTTIMER_HW_TICKS, SOFTTIMER_HW_TIMER_MAX_COUNT) };
+
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: SOFTTIMER_init
+ * [Function Description]: stops all the software timers and initializes the
+ * 						   hardware timer, the hardware timer runs only while
+ * 						   a software timer is running,
+ * 						   the global interrupt must be enabled for the timers to count
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void SOFTTIMER_init(void)
+{
+	uint8_t index;
+
+	for(index = 0; index < SOFTTIMERS_COUNT; index ++)
+	{
+		g_softTimers[index].state = SOFTTIMER_STOPPED;
+		g_softTimers[index].hasExpired = FALSE;
+	}
+
+	for(index = 0; index < SOFTTIMER_WHEEL_SIZE; index ++)
+	{
+		g_wheel[index] = SOFTTIMER_NONE;
+	}
+
+	g_wheelPosition = 0;
+	g_runningCount = 0;
+
+	/* init the hardware timer stopped, it's started with the first timer */
+	TIMER_init(&g_hwTimerConfig);
+}
+
+/*
+ * [Function Name]: SOFTTIMER_start
+ * [Function Description]: starts or restarts a software timer, it can be called
+ * 						   from the main program or from a timer callback
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer, 0 to SOFTTIMERS_COUNT - 1
+ * [in]: uint32_t a_timeMs
+ * 		 time till the timer expires and the period of a periodic timer,
+ * 		 rounded up to a multiple of SOFTTIMER_TICK_MS,
+ * 		 at most SOFTTIMER_WHEEL_SIZE * 65536 ticks
+ * [in]: EN_SoftTimerMode a_mode
+ * 		 one-shot or periodic
+ * [in]: void (* a_callback)(void)
+ * 		 function called from the tick interrupt when the timer expires, can be NULL
+ * [Return]: uint8_t
+ * 			 SOFTTIMER_SUCCESS or SOFTTIMER_ERROR if the id or the time is not valid
+ */
+uint8_t SOFTTIMER_start(uint8_t a_timerId, uint32_t a_timeMs, EN_SoftTimerMode a_mode, void (* a_callback)(void))
+{
+	uint32_t ticks = (a_timeMs + SOFTTIMER_TICK_MS - 1) / SOFTTIMER_TICK_MS;
+	ST_SoftTimer * timer;
+	uint8_t sreg;
+
+	if(a_timerId >= SOFTTIMERS_COUNT || ticks == 0 || ticks > SOFTTIMER_MAX_TICKS)
+	{
+		return SOFTTIMER_ERROR;
+	}
+	timer = &g_softTimers[a_timerId];
+
+	sreg = enterCriticalSection();
+
+	/* restart a running timer */
+	if(timer->state == SOFTTIMER_RUNNING)
+	{
+		removeTimer(a_timerId);
+	}
+	else if(timer->state == SOFTTIMER_STOPPED)
+	{
+		g_runningCount ++;
+	}
+
+	timer->periodTicks = ticks;
+	timer->mode = a_mode;
+	timer->callback = a_callback;
+	timer->hasExpired = FALSE;
+	insertTimer(a_timerId, ticks);
+
+	/* start the tick, it does nothing if it's already running */
+	TIMER_start(SOFTTIMER_HW_TIMER);
+
+	exitCriticalSection(sreg);
+
+	return SOFTTIMER_SUCCESS;
+}
+
+/*
+ * [Function Name]: SOFTTIMER_stop
+ * [Function Description]: stops a software timer, its callback won't be called
+ * 						   even if it expires in the same tick
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [Return]: uint8_t
+ * 			 SOFTTIMER_SUCCESS or SOFTTIMER_ERROR if the id is not valid
+ */
+uint8_t SOFTTIMER_stop(uint8_t a_timerId)
+{
+	uint8_t sreg;
+
+	if(a_timerId >= SOFTTIMERS_COUNT)
+	{
+		return SOFTTIMER_ERROR;
+	}
+
+	sreg = enterCriticalSection();
+
+	if(g_softTimers[a_timerId].state == SOFTTIMER_RUNNING)
+	{
+		removeTimer(a_timerId);
+	}
+
+	/* an expiring timer is only marked as stopped, the tick handler skips it */
+	if(g_softTimers[a_timerId].state != SOFTTIMER_STOPPED)
+	{
+		g_softTimers[a_timerId].state = SOFTTIMER_STOPPED;
+		g_runningCount --;
+	}
+
+	exitCriticalSection(sreg);
+
+	return SOFTTIMER_SUCCESS;
+}
+
+/*
+ * [Function Name]: SOFTTIMER_isRunning
+ * [Function Description]: checks whether a timer is running, a one-shot timer
+ * 						   stops running when it expires
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [Return]: boolean
+ * 			 TRUE if the timer is running, FALSE otherwise
+ */
+boolean SOFTTIMER_isRunning(uint8_t a_timerId)
+{
+	if(a_timerId >= SOFTTIMERS_COUNT)
+	{
+		return FALSE;
+	}
+	return (g_softTimers[a_timerId].state != SOFTTIMER_STOPPED) ? TRUE : FALSE;
+}
+
+/*
+ * [Function Name]: SOFTTIMER_hasExpired
+ * [Function Description]: checks whether a timer has expired since the last
+ * 						   check or since it was started, and clears its expiry flag
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [Return]: boolean
+ * 			 TRUE if the timer has expired, FALSE otherwise
+ */
+boolean SOFTTIMER_hasExpired(uint8_t a_timerId)
+{
+	boolean hasExpired;
+	uint8_t sreg;
+
+	if(a_timerId >= SOFTTIMERS_COUNT)
+	{
+		return FALSE;
+	}
+
+	sreg = enterCriticalSection();
+	hasExpired = g_softTimers[a_timerId].hasExpired;
+	g_softTimers[a_timerId].hasExpired = FALSE;
+	exitCriticalSection(sreg);
+
+	return hasExpired;
+}
+
+/*
+ * [Function Name]: tickHandler
+ * [Function Description]: callback of the hardware timer, moves the wheel one slot,
+ * 						   expires the timers of the slot that have no rounds left
+ * 						   then calls their callbacks
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void tickHandler(void)
+{
+	/* timers expiring in this tick, the callbacks are called after leaving the slot
+	 * because they may start or stop timers of the same slot
+	 */
+	uint8_t expired[SOFTTIMERS_COUNT], expiredCount = 0, index, timerId, nextId;
+	ST_SoftTimer * timer;
+
+	g_wheelPosition = (g_wheelPosition + 1) & SOFTTIMER_WHEEL_MASK;
+
+	/* expire the timers without rounds, and count down the rounds of the others */
+	for(timerId = g_wheel[g_wheelPosition]; timerId != SOFTTIMER_NONE; timerId = nextId)
+	{
+		timer = &g_softTimers[timerId];
+		nextId = timer->next;
+
+		if(timer->rounds == 0)
+		{
+			removeTimer(timerId);
+			timer->state = SOFTTIMER_EXPIRING;
+			expired[expiredCount ++] = timerId;
+		}
+		else
+		{
+			timer->rounds --;
+		}
+	}
+
+	for(index = 0; index < expiredCount; index ++)
+	{
+		timer = &g_softTimers[expired[index]];
+
+		/* skip the timers stopped or restarted by a previous callback */
+		if(timer->state != SOFTTIMER_EXPIRING)
+		{
+			continue;
+		}
+
+		timer->hasExpired = TRUE;
+
+		/* restart a periodic timer before its callback, so the callback can stop it */
+		if(timer->mode == SOFTTIMER_PERIODIC)
+		{
+			insertTimer(expired[index], timer->periodTicks);
+		}
+		else
+		{
+			timer->state = SOFTTIMER_STOPPED;
+			g_runningCount --;
+		}
+
+		if(timer->callback != NULL)
+		{
+			timer->callback();
+		}
+	}
+
+	/* no timers to count, stop the tick */
+	if(g_runningCount == 0)
+	{
+		TIMER_stop(SOFTTIMER_HW_TIMER);
+	}
+}
+
+/*
+ * [Function Name]: insertTimer
+ * [Function Description]: adds a timer to the wheel slot where it expires
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [in]: uint32_t a_ticks
+ * 		 ticks till the timer expires, at least 1
+ * [Return]: void
+ */
+static void insertTimer(uint8_t a_timerId, uint32_t a_ticks)
+{
+	ST_SoftTimer * timer = &g_softTimers[a_timerId];
+
+	/* the wheel passes by the slot every SOFTTIMER_WHEEL_SIZE ticks */
+	timer->slot = (g_wheelPosition + a_ticks) & SOFTTIMER_WHEEL_MASK;
+	timer->rounds = (uint16_t) ((a_ticks - 1) / SOFTTIMER_WHEEL_SIZE);
+	timer->state = SOFTTIMER_RUNNING;
+
+	/* add it at the head of the slot list */
+	timer->prev = SOFTTIMER_NONE;
+	timer->next = g_wheel[timer->slot];
+	if(timer->next != SOFTTIMER_NONE)
+	{
+		g_softTimers[timer->next].prev = a_timerId;
+	}
+	g_wheel[timer->slot] = a_timerId;
+}
+
+/*
+ * [Function Name]: removeTimer
+ * [Function Description]: removes a running timer from its wheel slot
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [Return]: void
+ */
+static void removeTimer(uint8_t a_timerId)
+{
+	ST_SoftTimer * timer = &g_softTimers[a_timerId];
+
+	if(timer->prev != SOFTTIMER_NONE)
+	{
+		g_softTimers[timer->prev].next = timer->next;
+	}
+	else
+	{
+		g_wheel[timer->slot] = timer->next;
+	}
+
+	if(timer->next != SOFTTIMER_NONE)
+	{
+		g_softTimers[timer->next].prev = timer->prev;
+	}
+}
+
+/*
+ * [Function Name]: enterCriticalSection
+ * [Function Description]: disables the interrupts while changing the wheel
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 status register before disabling the interrupts
+ */
+static uint8_t enterCriticalSection(void)
+{
+	uint8_t sreg = SREG_R;
+
+	DISABLE_GLOBAL_INTERRUPT();
+
+	return sreg;
+}
+
+/*
+ * [Function Name]: exitCriticalSection
+ * [Function Description]: restores the global interrupt as it was before changing
+ * 						   the wheel, so a timer callback or another ISR leaves
+ * 						   the interrupts disabled
+ * [Args]:
+ * [in]: uint8_t a_sreg
+ * 		 status register returned by enterCriticalSection()
+ * [Return]: void
+ */
+static void exitCriticalSection(uint8_t a_sreg)
+{
+	SREG_R = a_sreg;
+}
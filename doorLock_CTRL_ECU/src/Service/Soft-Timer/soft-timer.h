@@ -0,0 +1,130 @@
+/******************************************************************************
+ *
+ * Module: SOFTTIMER
+ *
+ * File Name: soft-timer.h
+ *
+ * Description: Header file for the software timers service, many one-shot or
+ * 				periodic timers counting on one hardware timer tick,
+ * 				the running timers are kept in a timer wheel so starting,
+ * 				stopping and expiring a timer don't depend on the number of timers
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SOFTTIMER_H__
+#define __SOFTTIMER_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module config file */
+#include "soft-timer-config.h"
+
+/* For using std types */
+#include "../../Lib/types.h"
+
+/* For using common defines and macros */
+#include "../../Lib/common.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* return values of the software timers functions */
+#define SOFTTIMER_SUCCESS					1
+#define SOFTTIMER_ERROR						0
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Enum Name]: EN_SoftTimerMode
+ * [Enum Description]: contains the modes of a software timer
+ */
+typedef enum
+{
+	/* the timer expires once then stops */
+	SOFTTIMER_ONE_SHOT,
+
+	/* the timer expires every period till it's stopped */
+	SOFTTIMER_PERIODIC
+
+}EN_SoftTimerMode;
+
+/*******************************************************************************
+ *                           Function Prototypes                               *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: SOFTTIMER_init
+ * [Function Description]: stops all the software timers and initializes the
+ * 						   hardware timer, the hardware timer runs only while
+ * 						   a software timer is running,
+ * 						   the global interrupt must be enabled for the timers to count
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void SOFTTIMER_init(void);
+
+/*
+ * [Function Name]: SOFTTIMER_start
+ * [Function Description]: starts or restarts a software timer, it can be called
+ * 						   from the main program or from a timer callback
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer, 0 to SOFTTIMERS_COUNT - 1
+ * [in]: uint32_t a_timeMs
+ * 		 time till the timer expires and the period of a periodic timer,
+ * 		 rounded up to a multiple of SOFTTIMER_TICK_MS,
+ * 		 at most SOFTTIMER_WHEEL_SIZE * 65536 ticks
+ * [in]: EN_SoftTimerMode a_mode
+ * 		 one-shot or periodic
+ * [in]: void (* a_callback)(void)
+ * 		 function called from the tick interrupt when the timer expires, can be NULL
+ * [Return]: uint8_t
+ * 			 SOFTTIMER_SUCCESS or SOFTTIMER_ERROR if the id or the time is not valid
+ */
+uint8_t SOFTTIMER_start(uint8_t a_timerId, uint32_t a_timeMs, EN_SoftTimerMode a_mode, void (* a_callback)(void));
+
+/*
+ * [Function Name]: SOFTTIMER_stop
+ * [Function Description]: stops a software timer, its callback won't be called
+ * 						   even if it expires in the same tick
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [Return]: uint8_t
+ * 			 SOFTTIMER_SUCCESS or SOFTTIMER_ERROR if the id is not valid
+ */
+uint8_t SOFTTIMER_stop(uint8_t a_timerId);
+
+/*
+ * [Function Name]: SOFTTIMER_isRunning
+ * [Function Description]: checks whether a timer is running, a one-shot timer
+ * 						   stops running when it expires
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [Return]: boolean
+ * 			 TRUE if the timer is running, FALSE otherwise
+ */
+boolean SOFTTIMER_isRunning(uint8_t a_timerId);
+
+/*
+ * [Function Name]: SOFTTIMER_hasExpired
+ * [Function Description]: checks whether a timer has expired since the last
+ * 						   check or since it was started, and clears its expiry flag
+ * [Args]:
+ * [in]: uint8_t a_timerId
+ * 		 id of the timer
+ * [Return]: boolean
+ * 			 TRUE if the timer has expired, FALSE otherwise
+ */
+boolean SOFTTIMER_hasExpired(uint8_t a_timerId);
+
+#endif /* __SOFTTIMER_H__ */
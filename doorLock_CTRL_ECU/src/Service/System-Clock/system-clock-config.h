@@ -0,0 +1,37 @@
+/******************************************************************************
+ *
+ * Module: SYSCLK
+ *
+ * File Name: system-clock-config.h
+ *
+ * Description: Config file for the system clock service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SYSCLK_CONFIG_H__
+#define __SYSCLK_CONFIG_H__
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* free-running timer of the clock, it's used only by the clock,
+ * TIMER_0 is the software timers tick and TIMER_1 is the motor pwm
+ */
+#define SYSCLK_TIMER						TIMER_2
+
+/* overflow mode of the timer */
+#define SYSCLK_TIMER_MODE					TIMER_2_OVF
+
+/* prescaler of the timer, and its numerical value,
+ * a count must be a whole number of us: prescaler * 1000000 / F_CPU
+ */
+#define SYSCLK_TIMER_PRESCALER				TIMER_2_PRESCALER_64
+#define SYSCLK_TIMER_PRESCALER_NUMBERS		64
+
+/* max count of the timer */
+#define SYSCLK_TIMER_MAX_COUNT				TIMER_2_MAX_COUNT
+
+#endif /* __SYSCLK_CONFIG_H__ */
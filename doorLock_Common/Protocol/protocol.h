@@ -0,0 +1,194 @@
+/******************************************************************************
+ *
+ * Module: PROTOCOL
+ *
+ * File Name: protocol.h
+ *
+ * Description: Commands and frame format shared between the CTRL and HMI ECUs,
+ * 				both ECUs include this file so it's the only place where
+ * 				the protocol is defined
+ *
+ * 				frame format:
+ * 				| START | LENGTH | SEQUENCE | PAYLOAD (LENGTH bytes) | CRC-8 |
+ *
+ * 				- the crc is calculated over LENGTH, SEQUENCE and PAYLOAD
+ * 				- the payload is a batch of one or more commands, each command
+ * 				  is one byte followed by its arguments if any
+ * 				- a frame with an empty payload is a control frame, its SEQUENCE
+ * 				  is the control code:
+ * 				  NAK, sent by the receiver when a corrupted frame is received
+ * 				  so the sender retransmits its last frame
+ * 				  WAIT, sent by the receiver of a frame whose answer isn't ready
+ * 				  yet, e.g. it waits for the user, so the sender stops resending it
+ * 				- every frame is confirmed by the next frame of the other MCU or a WAIT,
+ * 				  a frame that isn't confirmed in time is resent with the same SEQUENCE
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __PROTOCOL_H__
+#define __PROTOCOL_H__
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* first byte of every frame, used to synchronize with the frame start */
+#define PROTOCOL_START_BYTE					0x7E
+
+/* maximum number of payload bytes in a single frame */
+#define PROTOCOL_MAX_PAYLOAD_SIZE			16
+
+/* number of frame bytes other than the payload (start, length, sequence, crc) */
+#define PROTOCOL_FRAME_OVERHEAD				4
+
+/* maximum size of a complete frame */
+#define PROTOCOL_MAX_FRAME_SIZE				(PROTOCOL_MAX_PAYLOAD_SIZE + PROTOCOL_FRAME_OVERHEAD)
+
+/* control codes of the frames with an empty payload */
+#define PROTOCOL_NAK						0x00
+#define PROTOCOL_WAIT						0x01
+
+/* crc-8 polynomial x^8 + x^2 + x + 1 and its initial value */
+#define PROTOCOL_CRC8_POLYNOMIAL			0x07
+#define PROTOCOL_CRC8_INIT					0x00
+
+/* length of the password,
+ * the HMI accepts submitting the password only if it has PASSWORD_LENGTH chars
+ */
+#define PASSWORD_LENGTH						5
+
+/* maximum number of the numeric args of SHOW_TEXT_CMD */
+#define PROTOCOL_MAX_TEXT_ARGS				4
+
+/* char of a text replaced by the next numeric arg of SHOW_TEXT_CMD */
+#define TEXT_ARG_CHAR						'%'
+
+/* position arg of SHOW_TEXT_CMD, the row in the high nibble and the col in the low one,
+ * so a text costs one byte less on the line
+ */
+#define TEXT_POS(row, col)					((uint8_t)(((row) << 4) | ((col) & 0x0F)))
+#define TEXT_POS_ROW(pos)					((pos) >> 4)
+#define TEXT_POS_COL(pos)					((pos) & 0x0F)
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Enum Name]: EN_TextId
+ * [Enum Description]: contains the ids of the texts shown by SHOW_TEXT_CMD,
+ * 					   the texts are stored in the flash of the HMI
+ */
+typedef enum
+{
+	/* "DOOR LOCK SYSTEM" */
+	DOOR_LOCK_TEXT_ID,
+
+	/* "Enter a new Pass" */
+	READ_NEW_PASS_TEXT_ID,
+
+	/* "Confirm Pass" */
+	CONFIRM_NEW_PASS_TEXT_ID,
+
+	/* "Pass Mismatch", when the confirmation pass is different */
+	PASS_MISMATCH_TEXT_ID,
+
+	/* "Pass Changed" */
+	PASS_CHANGED_TEXT_ID,
+
+	/* "Pass Not Saved", when writing the new pass to the eeprom fails */
+	PASS_NOT_SAVED_TEXT_ID,
+
+	/* "+: Open Door" */
+	MENU_OPTIONS_UPPER_TEXT_ID,
+
+	/* "-: Change Pass" */
+	MENU_OPTIONS_LOWER_TEXT_ID,
+
+	/* "Enter Pass :" */
+	ENTER_PASS_TEXT_ID,
+
+	/* "Wrong Pass (%/%)", args: wrong trials, max trials */
+	WRONG_PASS_TEXT_ID,
+
+	/* "ACCESS DENIED", during the buzzer warning */
+	ACCESS_DENIED_TEXT_ID,
+
+	/* "Unlocking Door" */
+	DOOR_UNLOCKING_TEXT_ID,
+
+	/* "Locking Door" */
+	DOOR_LOCKING_TEXT_ID,
+
+	/* "Door is Unlocked" */
+	DOOR_IS_UNLOCKED_TEXT_ID,
+
+	/* "Locked %s", args: remaining seconds of the warning */
+	LOCKED_TIME_TEXT_ID,
+
+	/* "", clears the line */
+	EMPTY_LINE_TEXT_ID,
+
+	/* number of the texts */
+	TEXTS_COUNT
+
+}EN_TextId;
+
+/*
+ * [Enum Name]: EN_AppCommands
+ * [Enum Description]: contains app commands sent and received
+ * 					   between the 2 MCUs, every frame sent by the CTRL
+ * 					   is answered by exactly one frame from the HMI,
+ * 					   (ACK_CMD, KEY_CMD or PASSWORD_CMD)
+ */
+typedef enum
+{
+	/* sent to establish the connection and after executing
+	 * a frame that doesn't request any input from the user
+	 */
+	ACK_CMD = 'A',
+
+	/***************************** CTRL => HMI ********************************/
+
+	/* clear the lcd */
+	CLEAR_SCREEN_CMD,
+
+	/* move the lcd cursor, args: row, col */
+	SET_CURSOR_CMD,
+
+	/* show a text of the HMI text table, args: text id (EN_TextId), position (TEXT_POS),
+	 * number of the numeric args, then the numeric args (one byte each),
+	 * every TEXT_ARG_CHAR in the text is replaced by the next arg in decimal,
+	 * the rest of the old text of the line is cleared
+	 */
+	SHOW_TEXT_CMD,
+
+	/* show a progress bar filled from the left in value / max of its width,
+	 * args: position (TEXT_POS), width in chars, value, max
+	 */
+	SHOW_PROGRESS_CMD,
+
+	/* show the menu and answer with KEY_CMD when a key is pressed,
+	 * an ACK_CMD from the CTRL asks for another key
+	 */
+	GET_MENU_OPTION_CMD,
+
+	/* read a password at the current cursor position,
+	 * editing the password is handled by the HMI and
+	 * it's answered with PASSWORD_CMD when the user submits it
+	 */
+	READ_PASS_CMD,
+
+	/***************************** HMI => CTRL ********************************/
+
+	/* pressed key, args: key */
+	KEY_CMD,
+
+	/* entered password, args: PASSWORD_LENGTH password chars */
+	PASSWORD_CMD
+
+}EN_AppCommands;
+
+#endif /* __PROTOCOL_H__ */
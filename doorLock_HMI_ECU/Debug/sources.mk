@@ -23,7 +23,12 @@ src/App \
 src/Hal/Keypad \
 src/Hal/Lcd \
 src/Mcal/Dio \
+src/Mcal/Ext-Interrupt \
+src/Mcal/Power \
 src/Mcal/Timer \
 src/Mcal/Uart \
+src/Service/Crc8 \
+src/Service/Link \
+src/Service/System-Clock \
 src \
 
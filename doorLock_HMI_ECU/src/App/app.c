@@ -38,68 +38,226 @@
 /* For using UART Module - communication with the other MCU */
 #include "../Mcal/Uart/uart.h"
 
+/* For sending and receiving frames to and from the other MCU */
+#include "../Service/Link/link.h"
+
+/* For using the system clock */
+#include "../Service/System-Clock/system-clock.h"
+
+/* For sleeping while waiting for the other MCU */
+#include "../Mcal/Power/power.h"
+
 /* For using KEYPAD Module */
 #include "../Hal/Keypad/keypad.h"
 
 /* For using LCD Module */
 #include "../Hal/Lcd/lcd.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* every timer has one user */
+#if KEYPAD_SCAN_TIMER == LCD_FLUSH_TIMER || KEYPAD_SCAN_TIMER == SYSCLK_TIMER || LCD_FLUSH_TIMER == SYSCLK_TIMER
+#error "the keypad scan, the lcd flush and the system clock must use different timers"
+#endif
+
+#if defined(DELAY_TIMER) && (DELAY_TIMER == KEYPAD_SCAN_TIMER || DELAY_TIMER == LCD_FLUSH_TIMER || DELAY_TIMER == SYSCLK_TIMER)
+#error "the DELAY_TIMER must not be used by another module"
+#endif
+
+#if RESEND_MAX_TIMEOUT_MS < LINK_RESPONSE_TIMEOUT_MS
+#error "the resends must not be closer than the link response timeout"
+#endif
+
 /*******************************************************************************
  *                      Static Functions Prototypes	                           *
  *******************************************************************************/
 
 /*
- * [Function Name]: UartRxCallback
- * [Function Description]: contains the callback routine when
- * 						   an RX interrupt occurs
+ * [Function Name]: executeCommands
+ * [Function Description]: executes the batch of commands in the received frame
+ * 						   in order, it changes the state if the batch asks for
+ * 						   a menu option or a password
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-static void UartRxCallback(void);
+static void executeCommands(void);
 
 /*
- * [Function Name]: controlLcdText
- * [Function Description]: shows different text on lcd depending on
- * 						   received cmd
+ * [Function Name]: showText
+ * [Function Description]: shows a text of the text table at a position, every TEXT_ARG_CHAR
+ * 						   in it is replaced by the next arg in decimal, every icon char by
+ * 						   its glyph, and the rest of the old text of the line is cleared,
+ * 						   so a shorter text overwrites a longer one
  * [Args]:
- * [in]: void
+ * [in]: EN_TextId a_textId
+ * 		 id of the text
+ * [in]: uint8_t a_row
+ * 		 row of the text
+ * [in]: uint8_t a_col
+ * 		 column of the first char of the text
+ * [in]: const uint8_t * a_args
+ * 		 numeric args of the text
+ * [in]: uint8_t a_argsCount
+ * 		 number of the args
+ * [Return]: void
+ */
+static void showText(EN_TextId a_textId, uint8_t a_row, uint8_t a_col, const uint8_t * a_args, uint8_t a_argsCount);
+
+/*
+ * [Function Name]: showProgress
+ * [Function Description]: shows a progress bar filled from the left in a_value / a_max
+ * 						   of its width, only the changed cells are written to the lcd
+ * [Args]:
+ * [in]: uint8_t a_pos
+ * 		 position of the first cell of the bar (TEXT_POS)
+ * [in]: uint8_t a_width
+ * 		 number of cells of the bar
+ * [in]: uint8_t a_value
+ * 		 progress
+ * [in]: uint8_t a_max
+ * 		 value of the full bar
  * [Return]: void
  */
-static void controlLcdText(EN_AppCommands receivedCmd);
+static void showProgress(uint8_t a_pos, uint8_t a_width, uint8_t a_value, uint8_t a_max);
 
 /*
  * [Function Name]: readPassword
- * [Function Description]: reads the password from the user and send it
- * 						   to the other MCU char by char till the other MCU
- * 						   sends STOP_RECEIVING_PASS_CMD,
- * 						   each call to the function reads only one char, the other
- * 						   MCU needs to send another cmd for example an ACK
- * 						   to ask for the next char
- *
+ * [Function Description]: reads the password from the user, each call to the function
+ * 						   reads only one char and handles it, whether deleting char,
+ * 						   clearing the password or submiting it, the password is sent to
+ * 						   the other MCU in one frame only when it's submitted
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-static void readPassword(EN_AppCommands receivedCmd);
+static void readPassword(void);
+
+/*
+ * [Function Name]: noLinkEvent
+ * [Function Description]: checks that no byte from the other MCU is waiting in the uart
+ * 						   and the last sent frame doesn't have to be resent yet,
+ * 						   the condition of sleeping while waiting for a frame
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if there is nothing to handle, FALSE otherwise
+ */
+static boolean noLinkEvent(void);
+
+/*
+ * [Function Name]: isResendDue
+ * [Function Description]: checks if the last sent frame isn't confirmed by the other MCU
+ * 						   in the resend timeout, so it has to be resent
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the frame has to be resent, FALSE otherwise
+ */
+static boolean isResendDue(void);
+
+/*
+ * [Function Name]: noKeyEvent
+ * [Function Description]: checks that no key event is queued and no byte from the other MCU
+ * 						   is waiting in the uart, the condition of sleeping while waiting
+ * 						   for a key
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if there is nothing to handle, FALSE otherwise
+ */
+static boolean noKeyEvent(void);
+
+/*
+ * [Function Name]: getPressedKey
+ * [Function Description]: takes the queued key events till a press is found, the repeats
+ * 						   of the backspace are presses too so holding it erases the
+ * 						   password, the other events are skipped
+ * [Args]:
+ * [out]: ST_KeypadEvent * a_event
+ * 		  structure to store the press event
+ * [Return]: boolean
+ * 			 TRUE if a key is pressed, FALSE if the queue has no press
+ */
+static boolean getPressedKey(ST_KeypadEvent * a_event);
+
+/*
+ * [Function Name]: keyWakeSources
+ * [Function Description]: gets the sources that wake the cpu up while waiting for a key,
+ * 						   the uart wakes it up for the frames of the other MCU, and the
+ * 						   timers are needed only while the keypad is scanning or the lcd
+ * 						   is flushing
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 ored POWER_WAKE_xxx sources
+ */
+static uint8_t keyWakeSources(void);
 
 /*******************************************************************************
  *                        Global Variables	                                   *
  *******************************************************************************/
 
-/* states whether new data has been received or not */
-static volatile boolean g_isDataReceived = FALSE;
-
 /* current app state */
 static EN_AppStates g_state = RECEIVE_COMMAND_STATE;
 
+/* lcd texts in the order of EN_TextId, stored in the flash only */
+static const uint8_t g_texts[TEXTS_COUNT][LCD_COLS + 1] FLASH_CONST =
+{
+	DOOR_LOCK_TEXT,
+	READ_NEW_PASS_TEXT,
+	CONFIRM_NEW_PASS_TEXT,
+	PASS_MISMATCH_TEXT,
+	PASS_CHANGED_TEXT,
+	PASS_NOT_SAVED_TEXT,
+	MENU_OPTIONS_UPPER_TEXT,
+	MENU_OPTIONS_LOWER_TEXT,
+	ENTER_PASS_TEXT,
+	WRONG_PASS_TEXT,
+	ACCESS_DENIED_TEXT,
+	DOOR_UNLOCKING_TEXT,
+	DOOR_LOCKING_TEXT,
+	DOOR_IS_UNLOCKED_TEXT,
+	LOCKED_TIME_TEXT,
+	EMPTY_LINE_TEXT
+};
+
+/* glyphs of the icon chars of the texts, in the order of the chars */
+static const uint8_t g_icons[ICONS_COUNT] =
+{
+	LCD_GLYPH_LOCKED,
+	LCD_GLYPH_UNLOCKED,
+	LCD_GLYPH_BELL,
+	LCD_GLYPH_HOURGLASS
+};
+
 /* await option, used to wait at the end of every main iteration
  * tell some event happens then procced
  */
 static EN_AwaitOptions g_awaitOption = AWAIT_NOTHING;
 
-/* received command from the other MCU */
-static volatile EN_AppCommands g_receivedCmd = 0;
+/* payload of the frame received from the other MCU and its size,
+ * the size is reset after executing the frame
+ */
+static uint8_t g_receivedFrame[PROTOCOL_MAX_PAYLOAD_SIZE], g_receivedFrameSize = 0;
+
+/* g_password => password being entered by the user
+ * g_passIndex => number of entered password chars
+ */
+static uint8_t g_password[PASSWORD_LENGTH], g_passIndex = 0;
+
+/* end column of what is shown on each line, a new text is padded with spaces
+ * only till the end of the old one, the whole line is unknown after moving the cursor to it
+ */
+static uint8_t g_lineEnds[LCD_ROWS] = {LCD_COLS, LCD_COLS};
+
+/* time of sending or resending the last frame, by the system clock */
+static uint32_t g_frameSentTimeMs = 0;
+
+/* time between the resends of the last sent frame */
+static uint16_t g_resendTimeoutMs = LINK_RESPONSE_TIMEOUT_MS;
 
 /*******************************************************************************
  *                      Functions Definitions                                  *
@@ -114,6 +272,9 @@ static volatile EN_AppCommands g_receivedCmd = 0;
  */
 void app_init(void)
 {
+	/* start the system clock */
+	SYSCLK_init();
+
 	/* initialize the lcd */
 	LCD_init();
 
@@ -126,18 +287,14 @@ void app_init(void)
 			UART_RX_INTERRUPT_ENABLED };
 	UART_init(&uartConfig);
 
-	/* set uart rx callback */
-	UART_setRxInterruptCallback(UartRxCallback);
+	/* initialize the link over the uart */
+	LINK_init();
+
+	/* count the sleep time by the system clock */
+	POWER_init(SYSCLK_nowUs);
 
 	/* enable global interrupt */
 	ENABLE_GLOBAL_INTERRUPT();
-
-	/* check if the other MCU is ready */
-	if (g_receivedCmd == ACK_CMD)
-	{
-		/* send ready to establish the connection */
-		UART_sendByteBlocking(ACK_CMD);
-	}
 }
 
 /*
@@ -149,65 +306,71 @@ void app_init(void)
  */
 void app_update(void)
 {
-	/* copy the received cmd and use it in case another data was received
-	 * during the executing of the app_update, so as to process previous data first
+	/* ack sent after executing a frame */
+	const uint8_t ackCmd = ACK_CMD;
+
+	/* answer of the menu, the pressed key */
+	uint8_t keyCmds[2];
+
+	/* key event of the menu */
+	ST_KeypadEvent keyEvent;
+
+	/* take the next frame if it was awaited,
+	 * otherwise the same frame is processed again in the new state
 	 */
-	uint8_t receivedCmdCpy = g_receivedCmd;
+	if(g_awaitOption == AWAIT_RESPONSE)
+	{
+		LINK_receiveFrame(g_receivedFrame, &g_receivedFrameSize);
+	}
 
-	/* reset await and data receive flag*/
+	/* reset await */
 	g_awaitOption = AWAIT_NOTHING;
-	g_isDataReceived = FALSE;
 
 	switch (g_state)
 	{
 
 	case RECEIVE_COMMAND_STATE:
 
-		/* show text on lcd depending on command */
-		controlLcdText(receivedCmdCpy);
+		/* show text on lcd and manage behavior related to menu or passwords */
+		executeCommands();
 
-		/* manage behavior related to menu or passwords */
-		switch (receivedCmdCpy)
+		if(g_state == RECEIVE_COMMAND_STATE)
 		{
+			/* send ack to notify the other mcu that executing the frame is finished */
+			if(g_receivedFrameSize != 0)
+			{
+				LINK_sendFrame(&ackCmd, 1);
+			}
 
-		case GET_MENU_OPTION_CMD:
-			g_state = READING_MENU_OPTIONS_STATE;
-			break;
-
-		case READ_NEW_PASS_CMD:
-		case CONFIRM_PASS_CMD:
-		case ENTER_PASS_CMD:
-			g_state = READING_PASS_STATE;
-
-			/* go to first position in the second line on the lcd to start entering password */
-			LCD_setCursor(SECOND_LINE_START_POS);
-			break;
-
-		default:
-
-			/* send ack to notify the other mcu that executing the cmd is finished */
-			UART_sendByteBlocking(ACK_CMD);
-
-			/* wait for another command */
+			/* wait for another frame */
 			g_awaitOption = AWAIT_RESPONSE;
-			break;
-
 		}
+		g_receivedFrameSize = 0;
 		break;
 
 		case READING_PASS_STATE:
 
 			/* read a password char */
-			readPassword(receivedCmdCpy);
+			readPassword();
 			break;
 
 		case READING_MENU_OPTIONS_STATE:
 
-			if(receivedCmdCpy == ACK_CMD || receivedCmdCpy == GET_MENU_OPTION_CMD)
+			/* the menu is just shown or the other MCU asks for another key */
+			if(g_receivedFrameSize == 0 || (g_receivedFrameSize == 1 && g_receivedFrame[0] == ACK_CMD))
 			{
 				/* send user choice from the menu options */
-				UART_sendByteBlocking(KEYPAD_getPressedKey());
-				g_awaitOption = AWAIT_RESPONSE;
+				if(getPressedKey(&keyEvent))
+				{
+					keyCmds[0] = KEY_CMD;
+					keyCmds[1] = keyEvent.key;
+					LINK_sendFrame(keyCmds, sizeof(keyCmds));
+					g_awaitOption = AWAIT_RESPONSE;
+				}
+				else
+				{
+					g_awaitOption = AWAIT_KEY;
+				}
 
 			}
 			else
@@ -220,153 +383,417 @@ void app_update(void)
 			break;
 	}
 
-	/* await till reponse is received */
-	while(g_awaitOption == AWAIT_RESPONSE && !g_isDataReceived);
+	/* await till reponse is received, sleeping till every byte of it arrives,
+	 * the uart and the lcd timer wake the cpu up so the idle mode is the deepest one,
+	 * the sent frame is resent if the other MCU doesn't confirm it in time,
+	 * after LINK_MAX_RETRIES the other MCU connects again by itself, so the frame
+	 * is kept being resent less often till a new frame from it confirms the frame */
+	g_frameSentTimeMs = SYSCLK_nowMs();
+	g_resendTimeoutMs = LINK_RESPONSE_TIMEOUT_MS;
+	while(g_awaitOption == AWAIT_RESPONSE && !LINK_frameIsAvailable())
+	{
+		if(isResendDue())
+		{
+			g_frameSentTimeMs = SYSCLK_nowMs();
+			if(LINK_resendFrame() == LINK_ERROR)
+			{
+				if(g_resendTimeoutMs < RESEND_MAX_TIMEOUT_MS / 2)
+				{
+					g_resendTimeoutMs *= 2;
+				}
+				else
+				{
+					g_resendTimeoutMs = RESEND_MAX_TIMEOUT_MS;
+				}
+				LINK_restartResends();
+				LINK_resendFrame();
+			}
+		}
+		POWER_sleepWhile(noLinkEvent, POWER_WAKE_UART | POWER_WAKE_TIMERS);
+	}
+
+	/* await a key, the mode is chosen before every sleep as the keypad scan and the lcd
+	 * flush stop their timers by themselves, the other MCU is told to wait for the answer,
+	 * the received bytes end the wait too, so a frame resent as the WAIT is lost is
+	 * answered by another WAIT, and a new frame from the other MCU after connecting
+	 * again is executed instead of the awaited key */
+	if(g_awaitOption == AWAIT_KEY)
+	{
+		LINK_confirmFrame();
+		DISABLE_GLOBAL_INTERRUPT();
+		while(noKeyEvent())
+		{
+			POWER_sleep(POWER_deepestMode(keyWakeSources()));
+			DISABLE_GLOBAL_INTERRUPT();
+		}
+		ENABLE_GLOBAL_INTERRUPT();
+
+		/* the duplicates are answered while parsing, only a new frame is available */
+		if(LINK_frameIsAvailable())
+		{
+			g_state = RECEIVE_COMMAND_STATE;
+			g_awaitOption = AWAIT_RESPONSE;
+		}
+	}
 }
 
 /*
- * [Function Name]: UartRxCallback
- * [Function Description]: contains the callback routine when
- * 						   an RX interrupt occurs
+ * [Function Name]: executeCommands
+ * [Function Description]: executes the batch of commands in the received frame
+ * 						   in order, it changes the state if the batch asks for
+ * 						   a menu option or a password
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-static void UartRxCallback(void)
+static void executeCommands(void)
 {
-	g_isDataReceived = TRUE;
+	uint8_t index = 0;
+
+	while(index < g_receivedFrameSize)
+	{
+		switch(g_receivedFrame[index])
+		{
+		case CLEAR_SCREEN_CMD:
+			LCD_sendCommand(LCD_CLEAR_SCREEN);
+			g_lineEnds[0] = 0;
+			g_lineEnds[1] = 0;
+			index ++;
+			break;
+
+		case SET_CURSOR_CMD:
+			/* stop if the args are missing */
+			if(index + 2 >= g_receivedFrameSize)
+			{
+				return;
+			}
+			LCD_setCursor(g_receivedFrame[index + 1], g_receivedFrame[index + 2]);
+			if(g_receivedFrame[index + 1] < LCD_ROWS)
+			{
+				g_lineEnds[g_receivedFrame[index + 1]] = LCD_COLS;
+			}
+			index += 3;
+			break;
+
+		case SHOW_TEXT_CMD:
+			/* stop if the args are missing */
+			if(index + 3 >= g_receivedFrameSize ||
+					index + 4 + g_receivedFrame[index + 3] > g_receivedFrameSize)
+			{
+				return;
+			}
+			showText(g_receivedFrame[index + 1], TEXT_POS_ROW(g_receivedFrame[index + 2]),
+					TEXT_POS_COL(g_receivedFrame[index + 2]), &g_receivedFrame[index + 4],
+					g_receivedFrame[index + 3]);
+			index += 4 + g_receivedFrame[index + 3];
+			break;
+
+		case SHOW_PROGRESS_CMD:
+			/* stop if the args are missing */
+			if(index + 4 >= g_receivedFrameSize)
+			{
+				return;
+			}
+			showProgress(g_receivedFrame[index + 1], g_receivedFrame[index + 2],
+					g_receivedFrame[index + 3], g_receivedFrame[index + 4]);
+			index += 5;
+			break;
+
+		case GET_MENU_OPTION_CMD:
+			showText(MENU_OPTIONS_UPPER_TEXT_ID, FIRST_LINE_START_POS, NULL, 0);
+			showText(MENU_OPTIONS_LOWER_TEXT_ID, SECOND_LINE_START_POS, NULL, 0);
+			g_state = READING_MENU_OPTIONS_STATE;
+			index ++;
+			break;
 
-	/* save received cmd */
-	g_receivedCmd = UART_receiveByteNonBlocking();
+		case READ_PASS_CMD:
+			/* start entering the password at the current cursor position */
+			g_passIndex = 0;
+			g_state = READING_PASS_STATE;
+			index ++;
+			break;
+
+		default:
+			/* unknown command, skip it */
+			index ++;
+			break;
+		}
+	}
 }
 
 /*
- * [Function Name]: controlLcdText
- * [Function Description]: shows different text on lcd depending on
- * 						   received cmd
+ * [Function Name]: showText
+ * [Function Description]: shows a text of the text table at a position, every TEXT_ARG_CHAR
+ * 						   in it is replaced by the next arg in decimal, every icon char by
+ * 						   its glyph, and the rest of the old text of the line is cleared,
+ * 						   so a shorter text overwrites a longer one
  * [Args]:
- * [in]: void
+ * [in]: EN_TextId a_textId
+ * 		 id of the text
+ * [in]: uint8_t a_row
+ * 		 row of the text
+ * [in]: uint8_t a_col
+ * 		 column of the first char of the text
+ * [in]: const uint8_t * a_args
+ * 		 numeric args of the text
+ * [in]: uint8_t a_argsCount
+ * 		 number of the args
  * [Return]: void
  */
-void controlLcdText(EN_AppCommands receivedCmd)
+static void showText(EN_TextId a_textId, uint8_t a_row, uint8_t a_col, const uint8_t * a_args, uint8_t a_argsCount)
 {
+	/* the text with its args and the spaces covering the old text of the line */
+	uint8_t line[LCD_COLS + 1], length = 0, digits[3], digitsCount, arg, data, end;
+	const uint8_t * text;
 
-	/* clear screen if cmd is known only */
-	if (receivedCmd >= ACK_CMD && receivedCmd <= SHOW_DOOR_IS_UNLOCKED_TEXT_CMD)
+	if(a_textId >= TEXTS_COUNT || a_row >= LCD_ROWS || a_col > LCD_COLS)
 	{
-		/* clear the screen each time */
-		LCD_sendCommand(LCD_CLEAR_SCREEN);
+		return;
 	}
+	text = g_texts[a_textId];
 
-	/* select text shown based on the cmd */
-	switch (receivedCmd)
+	while(a_col + length < LCD_COLS && (data = FLASH_READ_BYTE(text)) != '\0')
 	{
-	case SHOW_DOOR_LOCK_TEXT_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) DOOR_LOCK_TEXT);
-		break;
-
-	case READ_NEW_PASS_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) READ_NEW_PASS_TEXT);
-		break;
-
-	case CONFIRM_PASS_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) CONFIRM_NEW_PASS_TEXT);
-		break;
-
-	case SHOW_PASS_MISMATCH_TEXT_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) PASS_MISMATCH_TEXT);
-		break;
-
-	case SHOW_PASS_CHANGED_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) PASS_CHANGED_TEXT);
-		break;
-
-	case GET_MENU_OPTION_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) MENU_OPTIONS_UPPER_TEXT);
-		LCD_sendStrAt(SECOND_LINE_START_POS,
-				(uint8_t*) MENU_OPTIONS_LOWER_TEXT);
-		break;
-
-	case ENTER_PASS_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) ENTER_PASS_TEXT);
-		break;
-
-	case SHOW_WRONG_PASS_TEXT_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) WRONG_PASS_TEXT);
-		break;
+		if(data == TEXT_ARG_CHAR && a_argsCount != 0)
+		{
+			/* the digits are found starting from the lowest one */
+			arg = *a_args;
+			a_args ++;
+			a_argsCount --;
+			digitsCount = 0;
+			do
+			{
+				digits[digitsCount] = arg % 10 + '0';
+				digitsCount ++;
+				arg /= 10;
+			}while(arg);
 
-	case SHOW_ACCESS_DENIED_TEXT_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) ACCESS_DENIED_TEXT);
-		break;
+			while(digitsCount != 0 && a_col + length < LCD_COLS)
+			{
+				digitsCount --;
+				line[length] = digits[digitsCount];
+				length ++;
+			}
+		}
+		else if(data >= ICONS_BASE_CHAR && data < ICONS_BASE_CHAR + ICONS_COUNT)
+		{
+			line[length] = LCD_glyphChar(g_icons[data - ICONS_BASE_CHAR]);
+			length ++;
+		}
+		else
+		{
+			line[length] = data;
+			length ++;
+		}
+		text ++;
+	}
 
-	case SHOW_DOOR_UNLOCKING_TEXT_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) DOOR_UNLOCKING_TEXT);
-		break;
+	/* clear the rest of the old text */
+	end = a_col + length;
+	while(a_col + length < g_lineEnds[a_row])
+	{
+		line[length] = ' ';
+		length ++;
+	}
+	line[length] = '\0';
+	g_lineEnds[a_row] = end;
 
-	case SHOW_DOOR_LOCKING_TEXT_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) DOOR_LOCKING_TEXT);
-		break;
+	LCD_sendStrAt(a_row, a_col, line);
+}
 
-	case SHOW_DOOR_IS_UNLOCKED_TEXT_CMD:
-		LCD_sendStrAt(FIRST_LINE_START_POS, (uint8_t*) DOOR_IS_UNLOCKED_TEXT);
-		break;
+/*
+ * [Function Name]: showProgress
+ * [Function Description]: shows a progress bar filled from the left in a_value / a_max
+ * 						   of its width, only the changed cells are written to the lcd
+ * [Args]:
+ * [in]: uint8_t a_pos
+ * 		 position of the first cell of the bar (TEXT_POS)
+ * [in]: uint8_t a_width
+ * 		 number of cells of the bar
+ * [in]: uint8_t a_value
+ * 		 progress
+ * [in]: uint8_t a_max
+ * 		 value of the full bar
+ * [Return]: void
+ */
+static void showProgress(uint8_t a_pos, uint8_t a_width, uint8_t a_value, uint8_t a_max)
+{
+	uint8_t row = TEXT_POS_ROW(a_pos), col = TEXT_POS_COL(a_pos);
 
-	default:
-		break;
+	if(row >= LCD_ROWS)
+	{
+		return;
+	}
+	LCD_showProgressBar(row, col, a_width, a_value, a_max);
 
+	/* a text shown later on the line clears the bar too */
+	if(col + a_width > g_lineEnds[row])
+	{
+		g_lineEnds[row] = (col + a_width < LCD_COLS) ? col + a_width : LCD_COLS;
 	}
 }
 
 /*
  * [Function Name]: readPassword
- * [Function Description]: reads the password from the user and send it
- * 						   to the other MCU char by char till the other MCU
- * 						   sends STOP_RECEIVING_PASS_CMD,
- * 						   each call to the function reads only one char, the other
- * 						   MCU needs to send another cmd for example an ACK
- * 						   to ask for the next char
- *
+ * [Function Description]: reads the password from the user, each call to the function
+ * 						   reads only one char and handles it, whether deleting char,
+ * 						   clearing the password or submiting it, the password is sent to
+ * 						   the other MCU in one frame only when it's submitted
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-void readPassword(EN_AppCommands receivedCmd)
+static void readPassword(void)
 {
-	switch(receivedCmd)
+	/* answer of the password request */
+	uint8_t passCmds[PASSWORD_LENGTH + 1];
+
+	uint8_t passIndex, key;
+
+	ST_KeypadEvent keyEvent;
+
+	/* wait for a key if none is pressed */
+	if(!getPressedKey(&keyEvent))
 	{
-	/* cmd to stop receiving chars, so change state */
-	case STOP_RECEIVING_PASS_CMD:
-		g_state = RECEIVE_COMMAND_STATE;
-		UART_sendByteBlocking(ACK_CMD);
-		break;
+		g_awaitOption = AWAIT_KEY;
+		return;
+	}
+	key = keyEvent.key;
+
+	/* delete a character from the password */
+	if(key == PASS_BACKSPACE_CHAR && g_passIndex != 0)
+	{
+		g_passIndex --;
 
-	/* smd to delete a char */
-	case BACKSPACE_PASS_CHAR_CMD:
 		/* move the cursor left, write a space then move it left again to write in the same position */
 		LCD_sendCommand(LCD_MOVE_CURSOR_LEFT);
 		LCD_sendChar(' ');
 		LCD_sendCommand(LCD_MOVE_CURSOR_LEFT);
-		break;
+	}
+	/* clear password */
+	else if(key == PASS_CLEAR_SCREEN_CHAR)
+	{
+		g_passIndex = 0;
 
-	case CLEAR_ALL_PASS_CHARS_CMD:
-		/* cmd to clear the screen by writing spaces */
-		LCD_sendStrAt(SECOND_LINE_START_POS, (uint8_t *)"                ");
+		/* clear the line by writing spaces */
+		showText(EMPTY_LINE_TEXT_ID, SECOND_LINE_START_POS, NULL, 0);
 		LCD_setCursor(SECOND_LINE_START_POS);
-		break;
+	}
+	/* save entered char to password if it's a number */
+	else if(g_passIndex != PASSWORD_LENGTH && key >= PASS_ALLOWED_START_CHAR && key <= PASS_ALLOWED_END_CHAR)
+	{
+		g_password[g_passIndex] = key;
+		g_passIndex ++;
 
-	case READ_NEXT_PASS_CHAR_CMD:
 		/* show pass hash '*' char on lcd */
 		LCD_sendChar(PASS_DISPLAY_CHAR);
-		break;
+	}
+	/* submit entered pass */
+	else if(g_passIndex == PASSWORD_LENGTH && key == PASS_ENTER_CHAR)
+	{
+		passCmds[0] = PASSWORD_CMD;
+		for(passIndex = 0; passIndex < PASSWORD_LENGTH; passIndex ++)
+		{
+			passCmds[passIndex + 1] = g_password[passIndex];
+		}
+		LINK_sendFrame(passCmds, sizeof(passCmds));
 
-	default:
-		break;
+		/* wait for the next frame */
+		g_passIndex = 0;
+		g_state = RECEIVE_COMMAND_STATE;
+		g_awaitOption = AWAIT_RESPONSE;
 	}
+	/* undefined char, skip it */
+}
+
+/*
+ * [Function Name]: noLinkEvent
+ * [Function Description]: checks that no byte from the other MCU is waiting in the uart
+ * 						   and the last sent frame doesn't have to be resent yet,
+ * 						   the condition of sleeping while waiting for a frame
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if there is nothing to handle, FALSE otherwise
+ */
+static boolean noLinkEvent(void)
+{
+	/* the uart is checked first, so checking the confirmation doesn't parse any byte
+	 * and the link doesn't send anything while the interrupts are disabled */
+	return UART_rxAvailable() == 0 && !isResendDue();
+}
+
+/*
+ * [Function Name]: isResendDue
+ * [Function Description]: checks if the last sent frame isn't confirmed by the other MCU
+ * 						   in the resend timeout, so it has to be resent
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the frame has to be resent, FALSE otherwise
+ */
+static boolean isResendDue(void)
+{
+	return !LINK_isConfirmed() && SYSCLK_nowMs() - g_frameSentTimeMs >= g_resendTimeoutMs;
+}
+
+/*
+ * [Function Name]: noKeyEvent
+ * [Function Description]: checks that no key event is queued and no byte from the other MCU
+ * 						   is waiting in the uart, the condition of sleeping while waiting
+ * 						   for a key
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if there is nothing to handle, FALSE otherwise
+ */
+static boolean noKeyEvent(void)
+{
+	return KEYPAD_isQueueEmpty() && UART_rxAvailable() == 0;
+}
+
+/*
+ * [Function Name]: getPressedKey
+ * [Function Description]: takes the queued key events till a press is found, the repeats
+ * 						   of the backspace are presses too so holding it erases the
+ * 						   password, the other events are skipped
+ * [Args]:
+ * [out]: ST_KeypadEvent * a_event
+ * 		  structure to store the press event
+ * [Return]: boolean
+ * 			 TRUE if a key is pressed, FALSE if the queue has no press
+ */
+static boolean getPressedKey(ST_KeypadEvent * a_event)
+{
+	while(KEYPAD_getEvent(a_event))
+	{
+		if(a_event->type == KEYPAD_KEY_PRESSED ||
+				(a_event->type == KEYPAD_KEY_REPEATED && a_event->key == PASS_BACKSPACE_CHAR))
+		{
+			return TRUE;
+		}
+	}
+	return FALSE;
+}
+
+/*
+ * [Function Name]: keyWakeSources
+ * [Function Description]: gets the sources that wake the cpu up while waiting for a key,
+ * 						   the uart wakes it up for the frames of the other MCU, and the
+ * 						   timers are needed only while the keypad is scanning or the lcd
+ * 						   is flushing
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 ored POWER_WAKE_xxx sources
+ */
+static uint8_t keyWakeSources(void)
+{
+	uint8_t wakeSources = POWER_WAKE_UART | POWER_WAKE_EXT_INT;
 
-	/* get key tell stop cmd is received */
-	if(receivedCmd != STOP_RECEIVING_PASS_CMD)
+	if(KEYPAD_isScanning() || !LCD_isFlushed())
 	{
-		UART_sendByteBlocking(KEYPAD_getPressedKey());
+		wakeSources |= POWER_WAKE_TIMERS;
 	}
-	g_awaitOption = AWAIT_RESPONSE;
+	return wakeSources;
 }
@@ -38,40 +38,74 @@
 /* For using defines */
 #include "../Lib/common.h"
 
+/* For using the commands shared with the other MCU */
+#include "../../../doorLock_Common/Protocol/protocol.h"
+
 /*******************************************************************************
  *                             	  Definitions                                  *
  *******************************************************************************/
 
-/* lcd text */
+/* chars of the texts shown as lcd glyphs, in the order of the icons table */
+#define LOCKED_ICON							"\x01"
+#define UNLOCKED_ICON						"\x02"
+#define BELL_ICON							"\x03"
+#define HOURGLASS_ICON						"\x04"
+
+/* char of the first icon and the number of icons */
+#define ICONS_BASE_CHAR						0x01
+#define ICONS_COUNT							4
+
+/* lcd texts, they are stored in the flash only and shown by their EN_TextId,
+ * every TEXT_ARG_CHAR is replaced by a numeric arg */
 #define DOOR_LOCK_TEXT						"DOOR LOCK SYSTEM"
 #define READ_NEW_PASS_TEXT					"Enter a new Pass"
 #define CONFIRM_NEW_PASS_TEXT				"Confirm Pass"
 #define PASS_MISMATCH_TEXT					"Pass Mismatch"
 #define PASS_CHANGED_TEXT					"Pass Changed"
+#define PASS_NOT_SAVED_TEXT					"Pass Not Saved"
 #define MENU_OPTIONS_UPPER_TEXT				"+: Open Door"
 #define MENU_OPTIONS_LOWER_TEXT				"-: Change Pass"
 #define ENTER_PASS_TEXT						"Enter Pass :"
-#define WRONG_PASS_TEXT						"Wrong Pass"
-#define ACCESS_DENIED_TEXT					"ACCESS DENIED"
-#define DOOR_UNLOCKING_TEXT					"Unlocking Door"
-#define DOOR_LOCKING_TEXT					"Locking Door"
-#define DOOR_IS_UNLOCKED_TEXT				"Door is Unlocked"
+#define WRONG_PASS_TEXT						"Wrong Pass (%/%)"
+#define ACCESS_DENIED_TEXT					BELL_ICON " ACCESS DENIED"
+#define DOOR_UNLOCKING_TEXT					UNLOCKED_ICON " Unlocking Door"
+#define DOOR_LOCKING_TEXT					LOCKED_ICON " Locking Door"
+#define DOOR_IS_UNLOCKED_TEXT				UNLOCKED_ICON " Door Unlocked"
+#define LOCKED_TIME_TEXT					HOURGLASS_ICON " Locked %s"
+#define EMPTY_LINE_TEXT						""
 
 /* passwrod display character */
 #define PASS_DISPLAY_CHAR					'*'
 
+/* range of available chars as password */
+#define PASS_ALLOWED_START_CHAR				'0'
+#define PASS_ALLOWED_END_CHAR				'9'
+
+/* character responsible for deleting a char from the pass */
+#define PASS_BACKSPACE_CHAR					'-'
+
+/* character responsible for cleering the screen during passwrod entry */
+#define PASS_CLEAR_SCREEN_CHAR				'c'
+
+/* character responsible for submiting the password */
+#define PASS_ENTER_CHAR						'='
+
 /* lcd start positions */
 #define FIRST_LINE_START_POS				0, 0
 #define SECOND_LINE_START_POS				1, 0
 
+/* longest time between the resends of a frame the other MCU doesn't confirm, the time
+ * is doubled after every LINK_MAX_RETRIES resends till the other MCU connects again */
+#define RESEND_MAX_TIMEOUT_MS				2000
+
 /*******************************************************************************
  *                             Types Declaration                               *
  *******************************************************************************/
 
 /*
  * [Enum Name]: EN_AwaitOptions
- * [Enum Description]: contains await states, whether to await receive interrupt
- * 					   or await nothing
+ * [Enum Description]: contains await states, whether to await receive interrupt,
+ * 					   a key press or await nothing
  */
 typedef enum
 {
@@ -81,6 +115,9 @@ typedef enum
 	/* await uart receive interrupt */
 	AWAIT_RESPONSE,
 
+	/* await a key event from the keypad */
+	AWAIT_KEY,
+
 }EN_AwaitOptions;
 
 /*
@@ -102,75 +139,6 @@ typedef enum
 
 }EN_AppStates;
 
-/*
- * [Enum Name]: EN_AppCommands
- * [Enum Description]: contains app commands sent and received
- * 					   between the 2 MCUs
- */
-typedef enum
-{
-	/* sent at the beginning and after executing
-	 * the previous cmd
-	 */
-	ACK_CMD = 'A',
-
-	/* show "DOOR LOCK SYSTEM" on lcd */
-	SHOW_DOOR_LOCK_TEXT_CMD,
-
-	/* read a new pass, at the beginning or at changing current pass */
-	READ_NEW_PASS_CMD,
-
-	/* new password confirmation */
-	CONFIRM_PASS_CMD,
-
-	/* receive next pass character */
-	READ_NEXT_PASS_CHAR_CMD,
-
-	/* skip pass character, when entering non valid pass character like '+', 'x', '/' */
-	SKIP_PASS_CHAR_CMD,
-
-	/* delete last entered pass character, when receiving '-' */
-	BACKSPACE_PASS_CHAR_CMD,
-
-	/* clear all entered pass characters, when receiving 'c' */
-	CLEAR_ALL_PASS_CHARS_CMD,
-
-	/* show "Password Mismatch" on lcd,
-	 * when confirmation pass is different
-	 */
-	SHOW_PASS_MISMATCH_TEXT_CMD,
-
-	/* show "Password Changed" on lcd */
-	SHOW_PASS_CHANGED_CMD,
-
-	/* Show menu and get selected option */
-	GET_MENU_OPTION_CMD,
-
-	/* get password from user to verify */
-	ENTER_PASS_CMD,
-
-	/* stop receiving other characters, because user reached max pass chars */
-	STOP_RECEIVING_PASS_CMD,
-
-	/* show "Wrong Password" on lcd */
-	SHOW_WRONG_PASS_TEXT_CMD,
-
-	/* show "Access Denied" on lcd
-	 * during buzzer warning
-	 */
-	SHOW_ACCESS_DENIED_TEXT_CMD,
-
-	/* show "Unlocking Door" on lcd */
-	SHOW_DOOR_UNLOCKING_TEXT_CMD,
-
-	/* show "Locking Door" on lcd */
-	SHOW_DOOR_LOCKING_TEXT_CMD,
-
-	/* show "Door is Unlocked" on lcd */
-	SHOW_DOOR_IS_UNLOCKED_TEXT_CMD,
-
-}EN_AppCommands;
-
 /*******************************************************************************
  *                      Functions Prototypes                                   *
  *******************************************************************************/
@@ -38,16 +38,55 @@
  */
 #define KEYPAD_ROWS_INTERNAL_PULL			KEYPAD_PULL_UP
 
-/* if KEYPAD_CHECK_DEBOUNCE_ENABLED = 1 => the module will add a delay
- * of BUTTON_CHECK_DEBOUNCE_DELAY_MS to prevent debounce effect,
- * if KEYPAD_CHECK_DEBOUNCE_ENABLED = 0, the module won't check for debounces
+/* keypad scan mode
+ * can be	KEYPAD_SCAN_CONTINUOUS => the scan timer runs all the time
+ * 			KEYPAD_SCAN_ON_DEMAND => all the cols are driven and the rows wait for a press on
+ * 									 the wake interrupt, the scan timer runs only till
+ * 									 all the keys are released, then the wake is armed again,
+ * 									 it needs the diodes from the rows to KEYPAD_WAKE_PIN
  */
-#define KEYPAD_CHECK_DEBOUNCE_ENABLED		1
+#define KEYPAD_SCAN_MODE					KEYPAD_SCAN_CONTINUOUS
 
-/* only used if KEYPAD_CHECK_DEBOUNCE_ENABLED = 1, used to specify
- * the time in ms used in check debounce delay
+/* external interrupt that wakes the scan, the atmega16 has no pin change interrupts so
+ * the rows are connected to its pin through diodes (cathodes at the rows), the pin is
+ * pulled the same as the rows and it goes to the pressed level when any row does,
+ * the pressed level LOW uses the low level sense which wakes the mcu from power down,
+ * HIGH uses the rising edge which wakes it from power down only on EXTINT_2 (PB2),
+ * so HIGH must use EXTINT_2, used only by KEYPAD_SCAN_ON_DEMAND
  */
-#define KEYPAD_CHECK_DEBOUNCE_DELAY_MS		30
+#define KEYPAD_WAKE_INTERRUPT				EXTINT_0
+#define KEYPAD_WAKE_PIN						PD2
+
+/* timer that scans the keypad, one column every scan period,
+ * TIMER_0 is the lcd flush and TIMER_1 is the system clock
+ */
+#define KEYPAD_SCAN_TIMER					TIMER_2
+
+/* mode of the scan timer */
+#define KEYPAD_SCAN_TIMER_MODE				TIMER_2_CTC
+
+/* prescaler of the scan timer, and its numerical value */
+#define KEYPAD_SCAN_TIMER_PRESCALER			TIMER_2_PRESCALER_64
+#define KEYPAD_SCAN_TIMER_PRESCALER_NUMBERS	64
+
+/* time between scanning 2 columns in us, every key is sampled
+ * once every KEYPAD_NUM_COLS periods */
+#define KEYPAD_SCAN_PERIOD_US				2000
+
+/* number of successive samples that differ from the debounced state of a key
+ * to change it, 3 samples every 8 ms filter the bounces of 24 ms */
+#define KEYPAD_DEBOUNCE_SAMPLES				3
+
+/* time a key is held before its long press event, then the time between its repeat events,
+ * only the last pressed key is repeated, the times are rounded up to whole scan rounds
+ * of KEYPAD_NUM_COLS scan periods */
+#define KEYPAD_LONG_PRESS_MS				600
+#define KEYPAD_REPEAT_PERIOD_MS				100
+
+/* max number of key events waiting in the queue,
+ * must be a power of two and not more than 128
+ */
+#define KEYPAD_QUEUE_SIZE					8
 
 /* Keypad button asciis */
 #define KEYPAD_KEY_1			           	'7'
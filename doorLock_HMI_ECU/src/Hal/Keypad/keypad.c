@@ -20,12 +20,62 @@
 /* For using DIO functions */
 #include "../../Mcal/Dio/dio.h"
 
-#if KEYPAD_CHECK_DEBOUNCE_ENABLED == 1
-
-/* For using delay function */
+/* For using the scan timer */
 #include "../../Mcal/Timer/timer.h"
 
-#endif /* KEYPAD_CHECK_DEBOUNCE_ENABLED == 1 */
+/* For waking the scan when a key is pressed */
+#include "../../Mcal/Ext-Interrupt/ext-interrupt.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if KEYPAD_NUM_COLS * KEYPAD_NUM_ROWS > 16
+#error "the keypad can't have more than 16 keys"
+#endif
+
+#if (KEYPAD_QUEUE_SIZE & (KEYPAD_QUEUE_SIZE - 1)) != 0 || KEYPAD_QUEUE_SIZE > 128
+#error "KEYPAD_QUEUE_SIZE must be a power of two and not more than 128"
+#endif
+
+/* the rising edge of the pressed level HIGH wakes the mcu from power down only on INT2 */
+#if KEYPAD_SCAN_MODE == KEYPAD_SCAN_ON_DEMAND && KEYPAD_BUTTON_PRESSED == HIGH && KEYPAD_WAKE_PIN != PB2
+#error "the scan on demand with KEYPAD_BUTTON_PRESSED = HIGH must wake on EXTINT_2 (PB2)"
+#endif
+
+/* mask to wrap the free running indices into the queue */
+#define KEYPAD_QUEUE_MASK					(KEYPAD_QUEUE_SIZE - 1)
+
+/* mask of the cols pins starting from KEYPAD_FIRST_COL_PIN */
+#define KEYPAD_COLS_MASK					((1 << KEYPAD_NUM_COLS) - 1)
+
+/* sense of the wake interrupt and the levels of the cols,
+ * the wake pin goes to the pressed level when any key is pressed */
+#if KEYPAD_BUTTON_PRESSED == LOW
+#define KEYPAD_WAKE_SENSE					EXTINT_LOW_LEVEL
+#define KEYPAD_COLS_PRESSED_LEVEL			ALL_LOW
+#define KEYPAD_COLS_RELEASED_LEVEL			ALL_HIGH
+#else
+#define KEYPAD_WAKE_SENSE					EXTINT_RISING_EDGE
+#define KEYPAD_COLS_PRESSED_LEVEL			ALL_HIGH
+#define KEYPAD_COLS_RELEASED_LEVEL			ALL_LOW
+#endif
+
+/* levels of the cols when only COL is driven to the pressed level */
+#define KEYPAD_COL_DRIVEN_LEVELS(COL)		(KEYPAD_COLS_RELEASED_LEVEL ^ (1 << (COL)))
+
+/* scan rounds of holding a key before its long press and between its repeats,
+ * every key is sampled once a round */
+#define KEYPAD_ROUND_US						((uint32_t)KEYPAD_SCAN_PERIOD_US * KEYPAD_NUM_COLS)
+#define KEYPAD_LONG_PRESS_ROUNDS			((KEYPAD_LONG_PRESS_MS * 1000UL + KEYPAD_ROUND_US - 1) / KEYPAD_ROUND_US)
+#define KEYPAD_REPEAT_ROUNDS				((KEYPAD_REPEAT_PERIOD_MS * 1000UL + KEYPAD_ROUND_US - 1) / KEYPAD_ROUND_US)
+
+/* g_heldKey when no key is held */
+#define KEYPAD_NO_KEY						0xFF
+
+/* ticks of the scan timer in one scan period */
+#define KEYPAD_SCAN_TIMER_TICKS				((F_CPU / (1000UL * KEYPAD_SCAN_TIMER_PRESCALER_NUMBERS)) \
+												* KEYPAD_SCAN_PERIOD_US / 1000UL)
 
 /*******************************************************************************
  *                      Static Functions Prototypes	                           *
@@ -43,13 +93,115 @@
  */
 static uint8_t KEYPAD_numberToChar(uint8_t a_number);
 
+/*
+ * [Function Name]: KEYPAD_scanColumn
+ * [Function Description]: called by the scan timer interrupt, samples the keys of the
+ * 						   driven column, queues the events of the keys whose state
+ * 						   changed, then drives the next column so it settles
+ * 						   till the next interrupt
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void KEYPAD_scanColumn(void);
+
+/*
+ * [Function Name]: KEYPAD_postEvent
+ * [Function Description]: adds a key event with the current keys state at the end of the queue,
+ * 						   called by the scan interrupt
+ * [Args]:
+ * [in]: uint8_t a_keyNumber
+ * 		 number of the key starting from 0
+ * [in]: EN_KeypadEventType a_type
+ * 		 type of the event
+ * [Return]: void
+ */
+static void KEYPAD_postEvent(uint8_t a_keyNumber, EN_KeypadEventType a_type);
+
+/*
+ * [Function Name]: KEYPAD_updateHeldKey
+ * [Function Description]: called by the scan interrupt every scan round, counts the rounds of
+ * 						   holding the last pressed key and posts its long press and repeats
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void KEYPAD_updateHeldKey(void);
+
+/*
+ * [Function Name]: KEYPAD_startScan
+ * [Function Description]: called by the wake interrupt in KEYPAD_SCAN_ON_DEMAND, disables it,
+ * 						   drives the first column only and starts the scan timer
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void KEYPAD_startScan(void);
+
+/*
+ * [Function Name]: KEYPAD_armWake
+ * [Function Description]: stops the scan timer, drives all the columns so a press on any key
+ * 						   reaches the wake pin, then enables the wake interrupt
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void KEYPAD_armWake(void);
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* config of the scan timer */
+static TIMER_config g_scanTimerConfig = { KEYPAD_SCAN_TIMER, KEYPAD_SCAN_TIMER_MODE,
+		KEYPAD_SCAN_TIMER_PRESCALER, KEYPAD_SCAN_TIMER_TICKS, KEYPAD_scanColumn, 0, 0 };
+
+/* column driven by the scan */
+static uint8_t g_scanCol = 0;
+
+/* TRUE while the scan timer is running */
+static volatile boolean g_isScanning = FALSE;
+
+/* TRUE if all the keys sampled in the current scan round are released with no bounces,
+ * the scan on demand stops after a whole round like that */
+static boolean g_isRoundIdle = TRUE;
+
+/* debounced state of the keys, bit n is set if key number n is pressed */
+static uint16_t g_keysState = 0;
+
+/* number of successive samples of every key that differ from its debounced state */
+static uint8_t g_keysDebounceCount[KEYPAD_NUM_COLS * KEYPAD_NUM_ROWS];
+
+/* number of the last pressed key while it's held, or KEYPAD_NO_KEY */
+static uint8_t g_heldKey = KEYPAD_NO_KEY;
+
+/* scan rounds left till the next long press or repeat event of the held key */
+static uint16_t g_heldKeyRoundsLeft = 0;
+
+/* TRUE after the long press event of the held key is posted */
+static boolean g_isHeldKeyLong = FALSE;
+
+/* ring buffer of the key events */
+static volatile ST_KeypadEvent g_keypadQueue[KEYPAD_QUEUE_SIZE];
+
+/* free running indices of the queue, the head is written only by the scan
+ * interrupt and the tail only by the main program,
+ * number of events in the queue = (uint8_t)(head - tail)
+ */
+static volatile uint8_t g_keypadQueueHead = 0, g_keypadQueueTail = 0;
+
+/* number of events dropped because the queue was full */
+static volatile uint8_t g_keypadQueueDropped = 0;
+
 /*******************************************************************************
  *                          Functions Definition	                           *
  *******************************************************************************/
 
 /*
  * [Function Name]: KEYPAD_init
- * [Function Description]: Initializes the keypad pins
+ * [Function Description]: Initializes the keypad pins and starts the scan timer, or arms the
+ * 						   wake interrupt in KEYPAD_SCAN_ON_DEMAND,
+ * 						   the global interrupt must be enabled to scan
  * [Args]:
  * [in]: void
  * [Return]: void
@@ -82,107 +234,331 @@ void KEYPAD_init(void)
 	/* control internal pull of the rows */
 	for(loopCounter = 0; loopCounter < KEYPAD_NUM_ROWS; loopCounter++)
 	{
-		DIO_controlPinInternalPull(KEYPAD_FIRST_ROW_PIN + loopCounter, KEYPAD_ROWS_INTERNAL_PULL);
+		/* KEYPAD_NO_PULL and KEYPAD_PULL_UP have the same values of the dio pull options */
+		DIO_controlPinInternalPull(KEYPAD_FIRST_ROW_PIN + loopCounter, (DIO_InternalPullOptions) KEYPAD_ROWS_INTERNAL_PULL);
 	}
 
 	/* init cols pins as outputs */
 	DIO_portInitPartial(KEYPAD_PORT, PORT_OUTPUT, colsMask, KEYPAD_FIRST_COL_PIN);
+
+#if KEYPAD_BUTTON_PRESSED == LOW
+
+	/* write ones to all cols pins */
+	DIO_writePortPartial(KEYPAD_PORT, ALL_HIGH, colsMask, KEYPAD_FIRST_COL_PIN);
+
+#else
+
+	/* write zeros to all cols pins */
+	DIO_writePortPartial(KEYPAD_PORT, ALL_LOW, colsMask, KEYPAD_FIRST_COL_PIN);
+
+#endif
+
+	/* all keys are released and no events are queued */
+	g_keysState = 0;
+	g_heldKey = KEYPAD_NO_KEY;
+	for(loopCounter = 0; loopCounter < KEYPAD_NUM_COLS * KEYPAD_NUM_ROWS; loopCounter++)
+	{
+		g_keysDebounceCount[loopCounter] = 0;
+	}
+	g_keypadQueueHead = 0;
+	g_keypadQueueTail = 0;
+	g_keypadQueueDropped = 0;
+
+	TIMER_init(&g_scanTimerConfig);
+
+	if(KEYPAD_SCAN_MODE == KEYPAD_SCAN_ON_DEMAND)
+	{
+		EXTINT_init(KEYPAD_WAKE_INTERRUPT, KEYPAD_WAKE_SENSE, KEYPAD_startScan);
+
+		/* the wake pin is pulled the same as the rows */
+		DIO_controlPinInternalPull(KEYPAD_WAKE_PIN, (DIO_InternalPullOptions) KEYPAD_ROWS_INTERNAL_PULL);
+
+		KEYPAD_armWake();
+	}
+	else
+	{
+		/* drive the first column, it's sampled in the first interrupt */
+		g_scanCol = 0;
+		g_isRoundIdle = TRUE;
+		DIO_writePin(KEYPAD_FIRST_COL_PIN, KEYPAD_BUTTON_PRESSED);
+
+		g_isScanning = TRUE;
+		TIMER_start(KEYPAD_SCAN_TIMER);
+	}
 }
 
 /*
- * [Function Name]: KEYPAD_getPressedKey
- * [Function Description]: get the pressed key of the keypad
- * 						   It's a busy wait function that won't
- * 						   return till a button is pressed
+ * [Function Name]: KEYPAD_getEvent
+ * [Function Description]: takes the oldest key event of the queue if any, it doesn't wait
  * [Args]:
- * [in]: void
- * [Return]: uint8_t
- * 			 the ascii of the pressed key
+ * [out]: ST_KeypadEvent * a_event
+ * 		  structure to store the event
+ * [Return]: boolean
+ * 			 TRUE if an event is taken, FALSE if the queue is empty
  */
-uint8_t KEYPAD_getPressedKey(void)
+boolean KEYPAD_getEvent(ST_KeypadEvent * a_event)
 {
-	uint8_t row, col, colsMask, rowReadValue;
+	uint8_t tail = g_keypadQueueTail;
 
-	/* hold the index of the selected row to
-	 * use in checking the key is released from the
-	 * previous time pefore proceeding
-	 */
-	static uint8_t selectedRow = 0;
+	if(tail == g_keypadQueueHead)
+	{
+		return FALSE;
+	}
 
-	colsMask = 0;
+	a_event->key = g_keypadQueue[tail & KEYPAD_QUEUE_MASK].key;
+	a_event->type = g_keypadQueue[tail & KEYPAD_QUEUE_MASK].type;
+	a_event->keys = g_keypadQueue[tail & KEYPAD_QUEUE_MASK].keys;
 
-	while(DIO_readPin(KEYPAD_FIRST_ROW_PIN + selectedRow) == KEYPAD_BUTTON_PRESSED);
+	/* free the slot only after the event is read */
+	g_keypadQueueTail = tail + 1;
 
-	/* loop to generate ones in the mask equal to the number of cols */
-	for(col = 0; col < KEYPAD_NUM_COLS; col++)
+	return TRUE;
+}
+
+/*
+ * [Function Name]: KEYPAD_isQueueEmpty
+ * [Function Description]: checks if there are no key events in the queue, it's short so
+ * 						   it can be the condition of sleeping till a key is pressed
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the queue is empty, FALSE otherwise
+ */
+boolean KEYPAD_isQueueEmpty(void)
+{
+	return g_keypadQueueTail == g_keypadQueueHead;
+}
+
+/*
+ * [Function Name]: KEYPAD_droppedCount
+ * [Function Description]: gets the number of key events dropped because the queue was full
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 number of dropped events, it stops at 255
+ */
+uint8_t KEYPAD_droppedCount(void)
+{
+	return g_keypadQueueDropped;
+}
+
+/*
+ * [Function Name]: KEYPAD_keyMask
+ * [Function Description]: gets the bit of a key in the keys field of the events,
+ * 						   the masks of many keys are ored to compare with a chord
+ * [Args]:
+ * [in]: uint8_t a_key
+ * 		 ascii of the key from the config file
+ * [Return]: uint16_t
+ * 			 bit of the key, 0 if the key isn't in the keypad
+ */
+uint16_t KEYPAD_keyMask(uint8_t a_key)
+{
+	uint8_t keyNumber;
+
+	for(keyNumber = 0; keyNumber < KEYPAD_NUM_COLS * KEYPAD_NUM_ROWS; keyNumber++)
 	{
-		colsMask <<= 1;
-		colsMask |= 1;
+		if(KEYPAD_numberToChar(keyNumber + 1) == a_key)
+		{
+			return (uint16_t)1 << keyNumber;
+		}
 	}
+	return 0;
+}
 
-#if KEYPAD_BUTTON_PRESSED == LOW
+/*
+ * [Function Name]: KEYPAD_isScanning
+ * [Function Description]: checks if the scan timer is running, in KEYPAD_SCAN_ON_DEMAND
+ * 						   the keypad needs no timer while it's not scanning, so the mcu
+ * 						   can sleep in power down till a key is pressed
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the keys are being scanned, FALSE if the scan waits for a press
+ */
+boolean KEYPAD_isScanning(void)
+{
+	return g_isScanning;
+}
 
-	/* write ones to all cols pins */
-	DIO_writePortPartial(KEYPAD_PORT, ALL_HIGH, colsMask, KEYPAD_FIRST_COL_PIN);
+/*
+ * [Function Name]: KEYPAD_scanColumn
+ * [Function Description]: called by the scan timer interrupt, samples the keys of the
+ * 						   driven column, queues the events of the keys whose state
+ * 						   changed, then drives the next column so it settles
+ * 						   till the next interrupt
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void KEYPAD_scanColumn(void)
+{
+	uint8_t row, keyNumber, rowsLevels;
+	uint16_t keyMask;
+	boolean isPressed;
 
-#else
+	/* sample all the rows at once, shifted so the first row is bit 0 */
+	rowsLevels = DIO_readPortFast(KEYPAD_PORT) >> GET_PIN_NO(KEYPAD_FIRST_ROW_PIN);
 
-	/* write zeros to all cols pins */
-	DIO_writePortPartial(KEYPAD_PORT, ALL_LOW, colsMask, KEYPAD_FIRST_COL_PIN);
+	for(row = 0; row < KEYPAD_NUM_ROWS; row ++)
+	{
+		keyNumber = (row * KEYPAD_NUM_COLS) + g_scanCol;
+		keyMask = (uint16_t)1 << keyNumber;
+		isPressed = (GET_BIT(rowsLevels, row) == KEYPAD_BUTTON_PRESSED);
 
-#endif
+		if(isPressed == ((g_keysState & keyMask) != 0))
+		{
+			/* same as the debounced state, a bounce is over */
+			g_keysDebounceCount[keyNumber] = 0;
+		}
+		else if(++ g_keysDebounceCount[keyNumber] >= KEYPAD_DEBOUNCE_SAMPLES)
+		{
+			/* the new state is stable */
+			g_keysDebounceCount[keyNumber] = 0;
+			g_keysState ^= keyMask;
 
-	while(1)
+			if(isPressed)
+			{
+				/* the newest key is the one that repeats */
+				g_heldKey = keyNumber;
+				g_heldKeyRoundsLeft = KEYPAD_LONG_PRESS_ROUNDS;
+				g_isHeldKeyLong = FALSE;
+				KEYPAD_postEvent(keyNumber, KEYPAD_KEY_PRESSED);
+			}
+			else
+			{
+				if(keyNumber == g_heldKey)
+				{
+					g_heldKey = KEYPAD_NO_KEY;
+				}
+				KEYPAD_postEvent(keyNumber, KEYPAD_KEY_RELEASED);
+			}
+		}
+
+		if(g_keysDebounceCount[keyNumber] != 0 || (g_keysState & keyMask) != 0)
+		{
+			g_isRoundIdle = FALSE;
+		}
+	}
+
+	/* move to the next col */
+	g_scanCol ++;
+	if(g_scanCol == KEYPAD_NUM_COLS)
 	{
-		for (col = 0; col < KEYPAD_NUM_COLS; col ++)
+		g_scanCol = 0;
+		KEYPAD_updateHeldKey();
+
+		if(KEYPAD_SCAN_MODE == KEYPAD_SCAN_ON_DEMAND && g_isRoundIdle)
 		{
-			/* write 0 or 1 to col by col depending on the value of KEYPAD_BUTTON_PRESSED */
-			DIO_writePin(KEYPAD_FIRST_COL_PIN + col, KEYPAD_BUTTON_PRESSED);
+			/* all the keys are released and stable, wait for the next press */
+			KEYPAD_armWake();
+			return;
+		}
+		g_isRoundIdle = TRUE;
+	}
 
-			for (row = 0; row < KEYPAD_NUM_ROWS; row ++)
-			{
-				/* read the value of each row */
-				rowReadValue = DIO_readPin(KEYPAD_FIRST_ROW_PIN + row);
+	/* return the current col to its initial level and drive the next one in one write */
+	DIO_writePortPartialFast(KEYPAD_PORT, KEYPAD_COL_DRIVEN_LEVELS(g_scanCol), KEYPAD_COLS_MASK, KEYPAD_FIRST_COL_PIN);
+}
 
-				if(rowReadValue == KEYPAD_BUTTON_PRESSED)
-				{
-#if KEYPAD_CHECK_DEBOUNCE_ENABLED == 1
+/*
+ * [Function Name]: KEYPAD_startScan
+ * [Function Description]: called by the wake interrupt in KEYPAD_SCAN_ON_DEMAND, disables it,
+ * 						   drives the first column only and starts the scan timer
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void KEYPAD_startScan(void)
+{
+	/* the low level keeps interrupting while the key is pressed */
+	EXTINT_disable(KEYPAD_WAKE_INTERRUPT);
 
-					/* delay for some time to check again - debounce effect */
-					TIMER_DELAY_MS(KEYPAD_CHECK_DEBOUNCE_DELAY_MS);
+	/* drive the first column only, it's sampled in the first interrupt */
+	g_scanCol = 0;
+	g_isRoundIdle = TRUE;
+	DIO_writePortPartialFast(KEYPAD_PORT, KEYPAD_COL_DRIVEN_LEVELS(0), KEYPAD_COLS_MASK, KEYPAD_FIRST_COL_PIN);
 
-					/* read the row pin again after debounce */
-					rowReadValue = DIO_readPin(KEYPAD_FIRST_ROW_PIN + row);
+	g_isScanning = TRUE;
+	TIMER_start(KEYPAD_SCAN_TIMER);
+}
 
-					if(rowReadValue == KEYPAD_BUTTON_PRESSED)
-					{
-						/* save the value of the selected row */
-						selectedRow = row;
+/*
+ * [Function Name]: KEYPAD_armWake
+ * [Function Description]: stops the scan timer, drives all the columns so a press on any key
+ * 						   reaches the wake pin, then enables the wake interrupt
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void KEYPAD_armWake(void)
+{
+	TIMER_stop(KEYPAD_SCAN_TIMER);
+	g_isScanning = FALSE;
 
-						/* convert the number of the pressed key to ascii and return it */
-						return KEYPAD_numberToChar((row * KEYPAD_NUM_COLS) + col + 1);
-					}
+	DIO_writePortPartialFast(KEYPAD_PORT, KEYPAD_COLS_PRESSED_LEVEL, KEYPAD_COLS_MASK, KEYPAD_FIRST_COL_PIN);
 
-#else
+	EXTINT_enable(KEYPAD_WAKE_INTERRUPT);
+}
 
-					/* save the value of the selected row */
-					selectedRow = row;
+/*
+ * [Function Name]: KEYPAD_updateHeldKey
+ * [Function Description]: called by the scan interrupt every scan round, counts the rounds of
+ * 						   holding the last pressed key and posts its long press and repeats
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void KEYPAD_updateHeldKey(void)
+{
+	if(g_heldKey == KEYPAD_NO_KEY || --g_heldKeyRoundsLeft != 0)
+	{
+		return;
+	}
 
-					/* convert the number of the pressed key to ascii and return it */
-					return KEYPAD_numberToChar((row * KEYPAD_NUM_COLS) + col + 1);
+	g_heldKeyRoundsLeft = KEYPAD_REPEAT_ROUNDS;
 
-#endif /* KEYPAD_CHECK_DEBOUNCE_ENABLED == 1 */
+	if(g_isHeldKeyLong)
+	{
+		KEYPAD_postEvent(g_heldKey, KEYPAD_KEY_REPEATED);
+	}
+	else
+	{
+		g_isHeldKeyLong = TRUE;
+		KEYPAD_postEvent(g_heldKey, KEYPAD_KEY_LONG_PRESSED);
+	}
+}
 
-				}
-			}
+/*
+ * [Function Name]: KEYPAD_postEvent
+ * [Function Description]: adds a key event with the current keys state at the end of the queue,
+ * 						   called by the scan interrupt
+ * [Args]:
+ * [in]: uint8_t a_keyNumber
+ * 		 number of the key starting from 0
+ * [in]: EN_KeypadEventType a_type
+ * 		 type of the event
+ * [Return]: void
+ */
+static void KEYPAD_postEvent(uint8_t a_keyNumber, EN_KeypadEventType a_type)
+{
+	uint8_t head = g_keypadQueueHead;
 
-			/* return the current col pin to its initial state
-			 * HIGH if KEYPAD_BUTTON_PRESSED = LOW or
-			 * LOW  if KEYPAD_BUTTON_PRESSED = HIGH
-			 */
-			DIO_writePin(KEYPAD_FIRST_COL_PIN + col, !KEYPAD_BUTTON_PRESSED);
+	if((uint8_t)(head - g_keypadQueueTail) >= KEYPAD_QUEUE_SIZE)
+	{
+		if(g_keypadQueueDropped != 0xFF)
+		{
+			g_keypadQueueDropped ++;
 		}
+		return;
 	}
+
+	g_keypadQueue[head & KEYPAD_QUEUE_MASK].key = KEYPAD_numberToChar(a_keyNumber + 1);
+	g_keypadQueue[head & KEYPAD_QUEUE_MASK].type = a_type;
+	g_keypadQueue[head & KEYPAD_QUEUE_MASK].keys = g_keysState;
+
+	/* the event is visible to the main program only after it's written */
+	g_keypadQueueHead = head + 1;
 }
 
 /*
@@ -4,7 +4,9 @@
  *
  * File Name: keypad.h
  *
- * Description: Header file for the KEYPAD driver
+ * Description: Header file for the KEYPAD driver, a timer interrupt scans the keypad
+ * 				one column at a time, debounces every key and queues its press and
+ * 				release events, so the keys pressed while the app is busy are kept
  *
  * Author: Kirollos Ashraf
  *
@@ -26,6 +28,15 @@
 /* For using common defines and macros */
 #include "../../Lib/common.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* keypad scan modes of KEYPAD_SCAN_MODE, they're macros so the config
+ * can be checked during compilation */
+#define KEYPAD_SCAN_CONTINUOUS				0
+#define KEYPAD_SCAN_ON_DEMAND				1
+
 /*******************************************************************************
  *                             Types Declaration                               *
  *******************************************************************************/
@@ -43,6 +54,46 @@ typedef enum
 	KEYPAD_PULL_DOWN
 }EN_KeypadInternalPull;
 
+/*
+ * [Enum Name]: EN_KeypadEventType
+ * [Enum Description]: contains the types of the key events
+ */
+typedef enum
+{
+	/* the key is pressed and stable */
+	KEYPAD_KEY_PRESSED,
+
+	/* the key is released and stable */
+	KEYPAD_KEY_RELEASED,
+
+	/* the key is held for KEYPAD_LONG_PRESS_MS */
+	KEYPAD_KEY_LONG_PRESSED,
+
+	/* the key is still held, every KEYPAD_REPEAT_PERIOD_MS after the long press */
+	KEYPAD_KEY_REPEATED
+
+}EN_KeypadEventType;
+
+/*
+ * [Struct Name]: ST_KeypadEvent
+ * [Struct Description]: a key event
+ */
+typedef struct
+{
+	/* ascii of the key from the config file */
+	uint8_t key;
+
+	/* type of the event */
+	EN_KeypadEventType type;
+
+	/* keys held after the event, bit n is set if key number n is pressed,
+	 * a chord is a press with more than one bit set, see KEYPAD_keyMask(),
+	 * only 2 keys are reliable as a third key on the corner of their
+	 * rectangle in the matrix makes the fourth one read as pressed */
+	uint16_t keys;
+
+}ST_KeypadEvent;
+
 
 /*******************************************************************************
  *                           Function Prototypes                               *
@@ -50,7 +101,8 @@ typedef enum
 
 /*
  * [Function Name]: KEYPAD_init
- * [Function Description]: Initializes the keypad pins
+ * [Function Description]: Initializes the keypad pins and starts the scan timer,
+ * 						   the global interrupt must be enabled to scan
  * [Args]:
  * [in]: void
  * [Return]: void
@@ -58,15 +110,59 @@ typedef enum
 void KEYPAD_init(void);
 
 /*
- * [Function Name]: KEYPAD_getPressedKey
- * [Function Description]: get the pressed key of the keypad
- * 						   It's a busy wait function that won't
- * 						   return till a button is pressed
+ * [Function Name]: KEYPAD_getEvent
+ * [Function Description]: takes the oldest key event of the queue if any, it doesn't wait
+ * [Args]:
+ * [out]: ST_KeypadEvent * a_event
+ * 		  structure to store the event
+ * [Return]: boolean
+ * 			 TRUE if an event is taken, FALSE if the queue is empty
+ */
+boolean KEYPAD_getEvent(ST_KeypadEvent * a_event);
+
+/*
+ * [Function Name]: KEYPAD_isQueueEmpty
+ * [Function Description]: checks if there are no key events in the queue, it's short so
+ * 						   it can be the condition of sleeping till a key is pressed
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the queue is empty, FALSE otherwise
+ */
+boolean KEYPAD_isQueueEmpty(void);
+
+/*
+ * [Function Name]: KEYPAD_droppedCount
+ * [Function Description]: gets the number of key events dropped because the queue was full
  * [Args]:
  * [in]: void
  * [Return]: uint8_t
- * 			 the ascii of the pressed key
+ * 			 number of dropped events, it stops at 255
+ */
+uint8_t KEYPAD_droppedCount(void);
+
+/*
+ * [Function Name]: KEYPAD_keyMask
+ * [Function Description]: gets the bit of a key in the keys field of the events,
+ * 						   the masks of many keys are ored to compare with a chord
+ * [Args]:
+ * [in]: uint8_t a_key
+ * 		 ascii of the key from the config file
+ * [Return]: uint16_t
+ * 			 bit of the key, 0 if the key isn't in the keypad
+ */
+uint16_t KEYPAD_keyMask(uint8_t a_key);
+
+/*
+ * [Function Name]: KEYPAD_isScanning
+ * [Function Description]: checks if the scan timer is running, in KEYPAD_SCAN_ON_DEMAND
+ * 						   the keypad needs no timer while it's not scanning, so the mcu
+ * 						   can sleep in power down till a key is pressed
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the keys are being scanned, FALSE if the scan waits for a press
  */
-uint8_t KEYPAD_getPressedKey(void);
+boolean KEYPAD_isScanning(void);
 
 #endif /* KEYPAD */
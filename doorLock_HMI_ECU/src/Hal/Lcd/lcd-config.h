@@ -18,16 +18,55 @@
  *******************************************************************************/
 
 /* 0 => 8-bit mode
- * 1 => 4-bit mode
+ * 1 => 4-bit mode, only D4 - D7 of the lcd are connected, every byte is
+ * 		written as 2 nibbles in the same flush call, so the screen is
+ * 		updated as fast as the 8-bit mode with 4 pins less
  */
-#define LCD_4_BIT_MODE						0
+#define LCD_4_BIT_MODE						1
+
+/* number of rows and columns of the screen, the shadow frame buffer
+ * of the driver has the same size
+ */
+#define LCD_ROWS							2
+#define LCD_COLS							16
+
+/* timer that flushes the changed cells of the frame buffer to the screen,
+ * it's started only while there are changes to flush
+ */
+#define LCD_FLUSH_TIMER						TIMER_0
+
+/* mode of the flush timer */
+#define LCD_FLUSH_TIMER_MODE				TIMER_0_CTC
+
+/* prescaler of the flush timer, and its numerical value */
+#define LCD_FLUSH_TIMER_PRESCALER			TIMER_0_PRESCALER_8
+#define LCD_FLUSH_TIMER_PRESCALER_NUMBERS	8
+
+/* time between 2 writes to the screen in us, one cell or command
+ * is written every period so it must be longer than the execution time
+ * of the lcd commands (37us) and data writes (41us) with a slow lcd clock,
+ * the lcd is never read so this period replaces polling the busy flag
+ */
+#define LCD_FLUSH_PERIOD_US					60
 
 /* RS pin */
 #define LCD_RS_PIN							PB2
 
+/* whether the R/W pin of the lcd is connected or not
+ * 0 => R/W is tied to the ground, the driver only writes to the lcd
+ * 1 => R/W is connected to LCD_RW_PIN, it's kept low as the driver never reads
+ * the board wires R/W to PB1, so it must be driven low or it floats and the lcd
+ * may drive the data pins, 0 needs R/W tied to the ground on the board first
+ */
+#define LCD_USE_RW_PIN						1
+
+#if LCD_USE_RW_PIN == 1
+
 /* R/W pin */
 #define LCD_RW_PIN							PB1
 
+#endif /* LCD_USE_RW_PIN == 1 */
+
 /* Enable pin */
 #define LCD_ENABLE_PIN						PB0
 
@@ -48,7 +87,7 @@
  * in case of 4-bit mode, it should be the D4 bit
  * in case of 8-bit mode, it should be the D0 bit
  */
-#define LCD_DATA_START_PIN					PA0
+#define LCD_DATA_START_PIN					PA4
 
 #else
 
@@ -60,7 +99,7 @@
 #define LCD_D2								PD2
 #define LCD_D3								PD3
 
-#endif /* LCD_4_BIT_MODE == 1 */
+#endif /* LCD_4_BIT_MODE == 0 */
 
 #define LCD_D4								PD4
 #define LCD_D5								PD5
@@ -20,9 +20,44 @@
 /* For using dio functions for pins */
 #include "../../Mcal/Dio/dio.h"
 
-/* For using delay function */
+/* For using the flush timer */
 #include "../../Mcal/Timer/timer.h"
 
+/* For the delays of the init sequence */
+#include "../../Service/System-Clock/system-clock.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* the execution times are given for the typical 270kHz lcd clock, it can be as slow as
+ * 190kHz which makes them 1.42 times longer, so the flush period must cover that
+ */
+#if LCD_FLUSH_PERIOD_US * 100UL < LCD_COMMAND_TIME_US * 142UL || LCD_FLUSH_PERIOD_US * 100UL < LCD_DATA_TIME_US * 142UL
+#error "LCD_FLUSH_PERIOD_US must cover the lcd execution times with a slow lcd clock"
+#endif
+
+/* ticks of the flush timer in one flush period, rounded up so the period
+ * is never shorter than LCD_FLUSH_PERIOD_US
+ */
+#define LCD_FLUSH_TIMER_TICKS		(((F_CPU / (1000UL * LCD_FLUSH_TIMER_PRESCALER_NUMBERS)) \
+										* LCD_FLUSH_PERIOD_US + 999UL) / 1000UL)
+
+/* cycles of the minimum enable pulse width and of the rest of the enable cycle,
+ * rounded up */
+#define LCD_ENABLE_PULSE_CYCLES		((F_CPU / 1000000UL * LCD_ENABLE_PULSE_NS + 999UL) / 1000UL)
+#define LCD_ENABLE_LOW_CYCLES		((F_CPU / 1000000UL * (LCD_ENABLE_CYCLE_NS - LCD_ENABLE_PULSE_NS) \
+										+ 999UL) / 1000UL)
+
+/* value of the tracked lcd address when it's not known */
+#define LCD_UNKNOWN_ADDRESS			0xFF
+
+/* value of a glyph slot that holds no glyph */
+#define LCD_NO_GLYPH				0xFF
+
+/* value of the uploaded slot when no glyph is being uploaded */
+#define LCD_NO_SLOT					0xFF
+
 /*******************************************************************************
  *                      Static Functions Prototypes	                           *
  *******************************************************************************/
@@ -30,8 +65,7 @@
 /*
  * [Function Name]: LCD_setDataPinsDir
  * [Function Description]: set the direction of the pins/port of the lcd
- * 						   as input or output, input is used to read if the screen
- * 						   is busy, output is used in all writing operations
+ * 						   as input or output
  * [Args]:
  * [in]: uint8_t a_direction
  * 	  	 direction to be set
@@ -39,15 +73,6 @@
  */
 static void LCD_setDataPinsDir(uint8_t a_direction);
 
-/*
- * [Function Name]: LCD_waitTillNotBusy
- * [Function Description]: busy wait till the screen is not busy
- * [Args]:
- * [in]: void
- * [Return]: void
- */
-static void LCD_waitTillNotBusy(void);
-
 /*
  * [Function Name]: LCD_writeToDataPins
  * [Function Description]: write data to data pins/port
@@ -58,167 +83,380 @@ static void LCD_waitTillNotBusy(void);
  */
 static void LCD_writeToDataPins(uint8_t a_data);
 
-/*******************************************************************************
- *                          Functions Definition	                           *
- *******************************************************************************/
-
 /*
- * [Function Name]: LCD_init
- * [Function Description]: initializes the lcd
+ * [Function Name]: LCD_pulseEnable
+ * [Function Description]: makes an enable pulse of the minimum width, the lcd
+ * 						   latches the data pins at its falling edge
  * [Args]:
  * [in]: void
  * [Return]: void
  */
-void LCD_init(void)
-{
-	/* init RS, R/W, enable pins as output  */
-	DIO_pinInit(LCD_RS_PIN, PIN_OUTPUT);
-	DIO_pinInit(LCD_RW_PIN, PIN_OUTPUT);
-	DIO_pinInit(LCD_ENABLE_PIN, PIN_OUTPUT);
+static void LCD_pulseEnable(void);
 
 #if LCD_4_BIT_MODE == 1
-	/* use 4-bit mode */
-	LCD_sendCommand(0x02);
-#endif
 
-#if LCD_USE_SINGLE_DATA_PORT == 1
-	/* init data port as output */
-	LCD_setDataPinsDir(PORT_OUTPUT);
+/*
+ * [Function Name]: LCD_writeNibble
+ * [Function Description]: writes the lower 4 bits of a value to D4 - D7 of the lcd
+ * 						   with one enable pulse, used by the 4-bit mode reset sequence
+ * [Args]:
+ * [in]: uint8_t a_nibble
+ * 		 nibble to be written
+ * [Return]: void
+ */
+static void LCD_writeNibble(uint8_t a_nibble);
 
-#else
-	/* init data pins as output */
-	LCD_setDataPinsDir(PIN_OUTPUT);
+#endif /* LCD_4_BIT_MODE == 1 */
 
-#endif
+/*
+ * [Function Name]: LCD_writeByte
+ * [Function Description]: writes a command or data byte to the lcd with
+ * 						   minimum width enable pulses, it doesn't wait for the lcd
+ * 						   so the caller must not write again before the
+ * 						   execution time of the previous byte passes
+ * [Args]:
+ * [in]: uint8_t a_rs
+ * 		 RS_CMD or RS_DATA
+ * [in]: uint8_t a_data
+ * 		 byte to be written
+ * [Return]: void
+ */
+static void LCD_writeByte(uint8_t a_rs, uint8_t a_data);
 
-	/* use 2-lines with 5*8 font size as default */
-	LCD_sendCommand(LCD_2_LINES_SM_FONT);
+/*
+ * [Function Name]: LCD_putChar
+ * [Function Description]: writes a char to the frame buffer at the cursor
+ * 						   and moves the cursor right, without requesting a flush
+ * [Args]:
+ * [in]: uint8_t a_data
+ * 		 character to be written
+ * [Return]: void
+ */
+static void LCD_putChar(uint8_t a_data);
 
-	/* turn on display and turn off cursor */
-	LCD_sendCommand(LCD_DISPLAY_ON_CURSOR_OFF);
+/*
+ * [Function Name]: LCD_isSlotShown
+ * [Function Description]: checks whether the char of a glyph slot is in the
+ * 						   frame buffer or on the lcd
+ * [Args]:
+ * [in]: uint8_t a_slot
+ * 		 index of the slot
+ * [Return]: boolean
+ * 			 TRUE if the slot is shown, FALSE otherwise
+ */
+static boolean LCD_isSlotShown(uint8_t a_slot);
 
-	/* clear lcd */
-	LCD_sendCommand(LCD_CLEAR_SCREEN);
-}
+/*
+ * [Function Name]: LCD_uploadNext
+ * [Function Description]: writes the next byte of the uploaded glyph, the cgram
+ * 						   address of its slot first then its lines
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void LCD_uploadNext(void);
 
 /*
- * [Function Name]: LCD_sendCommand
- * [Function Description]: send command to the lcd
+ * [Function Name]: LCD_requestFlush
+ * [Function Description]: starts the flush timer to write the changes
+ * 						   of the frame buffer to the lcd
  * [Args]:
- * [in]: uint8_t a_cmd
- * 	  command to be sent
+ * [in]: void
  * [Return]: void
  */
-void LCD_sendCommand(uint8_t a_cmd)
-{
-	/* make sure lcd is not busy */
-	LCD_waitTillNotBusy();
+static void LCD_requestFlush(void);
 
-	/* make RS=0 to send commmand and R/W=0 to write */
-	DIO_writePin(LCD_RS_PIN, RS_CMD);
-	DIO_writePin(LCD_RW_PIN, RW_WRITE);
+/*
+ * [Function Name]: LCD_flushNext
+ * [Function Description]: flush timer callback, writes the queued command,
+ * 						   the next byte of the uploaded glyph or the next
+ * 						   changed cell to the lcd, a cell away
+ * 						   from the lcd address takes 2 calls, one to set
+ * 						   the address and one to write the char,
+ * 						   it stops the timer when the screen is up to date
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void LCD_flushNext(void);
 
-	TIMER_DELAY_MS(1);
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
 
-	/* write high to enable pin */
-	DIO_writePin(LCD_ENABLE_PIN, HIGH);
+/* ddram address of the first column of each row */
+static const uint8_t g_rowAddress[4] = { LCD_ROW_0_ADDRESS, LCD_ROW_1_ADDRESS,
+		LCD_ROW_2_ADDRESS, LCD_ROW_3_ADDRESS };
 
-	TIMER_DELAY_MS(1);
+/* the frame buffer written by the app and the content shown on the lcd */
+static volatile uint8_t g_frameBuffer[LCD_ROWS][LCD_COLS];
+static uint8_t g_screen[LCD_ROWS][LCD_COLS];
 
-#if LCD_4_BIT_MODE == 1
+/* cursor of the frame buffer, a column equal to LCD_COLS is out of the screen */
+static uint8_t g_cursorRow = 0, g_cursorCol = 0;
 
-	/* write higher 4 bits of data to data pins/port */
-	LCD_writeToDataPins((a_cmd & 0xF0) >> 4);
+/* set when the frame buffer is changed, cleared by the flush when
+ * it finds no changed cell
+ */
+static volatile uint8_t g_isDirty = FALSE;
 
-	TIMER_DELAY_MS(1);
+/* command waiting to be written before the next cell */
+static volatile uint8_t g_pendingCommand, g_isCommandPending = FALSE;
 
-	/* write low to enable pin */
-	DIO_writePin(LCD_ENABLE_PIN, LOW);
+/* next cell checked by the flush */
+static uint8_t g_flushRow = 0, g_flushCol = 0;
 
-	TIMER_DELAY_MS(1);
+/* current ddram address of the lcd, incremented by the lcd after each char */
+static uint8_t g_lcdAddress = LCD_UNKNOWN_ADDRESS;
 
-	/* write high to enable pin */
-	DIO_writePin(LCD_ENABLE_PIN, HIGH);
+/* glyph table in the order of EN_LcdGlyph, stored in the flash only */
+static const uint8_t g_glyphs[LCD_GLYPHS_COUNT][LCD_GLYPH_LINES] FLASH_CONST =
+{
+	/* progress bar cells */
+	{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 },
+	{ 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18 },
+	{ 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C },
+	{ 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E },
 
-	TIMER_DELAY_MS(1);
+	/* locked */
+	{ 0x0E, 0x11, 0x11, 0x1F, 0x1B, 0x1B, 0x1F, 0x00 },
 
-	/* write lower 4 bits of data to data pins/port */
-	LCD_writeToDataPins(a_cmd & 0x0F);
+	/* unlocked */
+	{ 0x0E, 0x10, 0x10, 0x1F, 0x1B, 0x1B, 0x1F, 0x00 },
 
-#else
+	/* bell */
+	{ 0x04, 0x0E, 0x0E, 0x0E, 0x1F, 0x00, 0x04, 0x00 },
 
-	/* write 8-bits data to data port/pins */
-	LCD_writeToDataPins(a_cmd);
+	/* hourglass */
+	{ 0x1F, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x1F, 0x00 }
+};
 
-#endif /* LCD_4_BIT_MODE == 1 */
+/* glyph held by each cgram slot */
+static uint8_t g_slotGlyphs[LCD_GLYPH_SLOTS];
 
-	TIMER_DELAY_MS(1);
+/* next slot checked for replacing its glyph, the slots are replaced in turn */
+static uint8_t g_nextSlot = 0;
 
-	/* write low to enable pin */
-	DIO_writePin(LCD_ENABLE_PIN, LOW);
+/* slot being uploaded by the flush and its next byte,
+ * byte 0 is the cgram address and the others are the glyph lines
+ */
+static volatile uint8_t g_uploadSlot = LCD_NO_SLOT;
+static uint8_t g_uploadByte = 0;
 
-	TIMER_DELAY_MS(1);
+/* config of the flush timer */
+static TIMER_config g_flushTimerConfig = { LCD_FLUSH_TIMER, LCD_FLUSH_TIMER_MODE,
+		LCD_FLUSH_TIMER_PRESCALER, LCD_FLUSH_TIMER_TICKS, LCD_flushNext, 0, 0 };
 
-}
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
 
 /*
- * [Function Name]: LCD_sendChar
- * [Function Description]: send char to the lcd
+ * [Function Name]: LCD_init
+ * [Function Description]: initializes the lcd and the flush timer,
+ * 						   its delays are counted by the system clock, so
+ * 						   SYSCLK_init() must be called first,
+ * 						   the global interrupt must be enabled after it
+ * 						   for the screen to be updated
  * [Args]:
- * [in]: uint8_t a_data
- * 	  	 character to be sent
+ * [in]: void
  * [Return]: void
  */
-void LCD_sendChar(uint8_t a_data)
+void LCD_init(void)
 {
-	/* make sure lcd is not busy */
-	LCD_waitTillNotBusy();
+	uint8_t row, col, slot, line;
 
-	/* make RS=1 to send data and R/W=0 to write */
-	DIO_writePin(LCD_RS_PIN, RS_DATA);
+	/* init RS, R/W, enable pins as output  */
+	DIO_pinInit(LCD_RS_PIN, PIN_OUTPUT);
+	DIO_pinInit(LCD_ENABLE_PIN, PIN_OUTPUT);
+
+#if LCD_USE_RW_PIN == 1
+	/* the driver never reads the lcd, R/W is kept 0 from the start
+	 * so the lcd never drives the data pins */
+	DIO_pinInit(LCD_RW_PIN, PIN_OUTPUT);
 	DIO_writePin(LCD_RW_PIN, RW_WRITE);
+#endif
 
-	TIMER_DELAY_MS(1);
+	/* wait for the lcd to power on */
+	SYSCLK_delayMs(LCD_POWER_ON_TIME_MS);
 
-	/* write high to enable pin */
-	DIO_writePin(LCD_ENABLE_PIN, HIGH);
+	DIO_writePin(LCD_ENABLE_PIN, LOW);
 
-	TIMER_DELAY_MS(1);
+#if LCD_USE_SINGLE_DATA_PORT == 1
+	/* init data port as output */
+	LCD_setDataPinsDir(PORT_OUTPUT);
 
-#if LCD_4_BIT_MODE == 1
+#else
+	/* init data pins as output */
+	LCD_setDataPinsDir(PIN_OUTPUT);
 
-	/* write higher 4 bits of data to data pins/port */
-	LCD_writeToDataPins((a_data & 0xF0) >> 4);
+#endif
 
-	TIMER_DELAY_MS(1);
+#if LCD_4_BIT_MODE == 1
+	/* the lcd is in 8-bit mode after power on, or in any nibble of the 4-bit mode
+	 * after a reset of the mcu only, the 8-bit function set is written 3 times
+	 * so it's taken as a whole instruction in both cases, then 4-bit mode is selected
+	 */
+	DIO_writePin(LCD_RS_PIN, RS_CMD);
+	LCD_writeNibble(LCD_RESET_8_BIT_NIBBLE);
+	SYSCLK_delayUs(LCD_RESET_FIRST_TIME_US);
+	LCD_writeNibble(LCD_RESET_8_BIT_NIBBLE);
+	SYSCLK_delayUs(LCD_RESET_SECOND_TIME_US);
+	LCD_writeNibble(LCD_RESET_8_BIT_NIBBLE);
+	SYSCLK_delayUs(LCD_COMMAND_TIME_US);
+	LCD_writeNibble(LCD_RESET_4_BIT_NIBBLE);
+	SYSCLK_delayUs(LCD_COMMAND_TIME_US);
+#endif
 
-	/* write low to enable pin */
-	DIO_writePin(LCD_ENABLE_PIN, LOW);
+	/* use 2-lines with 5*8 font size as default */
+	LCD_writeByte(RS_CMD, LCD_2_LINES_SM_FONT);
+	SYSCLK_delayUs(LCD_COMMAND_TIME_US);
 
-	TIMER_DELAY_MS(1);
+	/* turn on display and turn off cursor */
+	LCD_writeByte(RS_CMD, LCD_DISPLAY_ON_CURSOR_OFF);
+	SYSCLK_delayUs(LCD_COMMAND_TIME_US);
+
+	/* upload the first glyphs of the table once, the cgram address
+	 * is incremented by the lcd after each line
+	 */
+	LCD_writeByte(RS_CMD, LCD_SET_CGRAM_BASE_ADDRESS);
+	SYSCLK_delayUs(LCD_COMMAND_TIME_US);
+	for(slot = 0; slot < LCD_GLYPH_SLOTS; slot ++)
+	{
+		if(slot < LCD_GLYPHS_COUNT)
+		{
+			for(line = 0; line < LCD_GLYPH_LINES; line ++)
+			{
+				LCD_writeByte(RS_DATA, FLASH_READ_BYTE(&g_glyphs[slot][line]));
+				SYSCLK_delayUs(LCD_DATA_TIME_US);
+			}
+			g_slotGlyphs[slot] = slot;
+		}
+		else
+		{
+			g_slotGlyphs[slot] = LCD_NO_GLYPH;
+		}
+	}
 
-	/* write high to enable pin */
-	DIO_writePin(LCD_ENABLE_PIN, HIGH);
+	/* clear lcd, it also moves back to the ddram */
+	LCD_writeByte(RS_CMD, LCD_CLEAR_SCREEN);
+	SYSCLK_delayUs(LCD_CLEAR_TIME_US);
 
-	TIMER_DELAY_MS(1);
+	/* the lcd and the frame buffer are both empty */
+	for(row = 0; row < LCD_ROWS; row ++)
+	{
+		for(col = 0; col < LCD_COLS; col ++)
+		{
+			g_frameBuffer[row][col] = ' ';
+			g_screen[row][col] = ' ';
+		}
+	}
+	g_cursorRow = 0;
+	g_cursorCol = 0;
+	g_lcdAddress = LCD_ROW_0_ADDRESS;
 
-	/* write lower 4 bits of data to data pins/port */
-	LCD_writeToDataPins(a_data & 0x0F);
+	/* init the flush timer, it's started when the frame buffer changes */
+	TIMER_init(&g_flushTimerConfig);
+}
 
-#else
+/*
+ * [Function Name]: LCD_sendCommand
+ * [Function Description]: send command to the lcd, clear screen, return home,
+ * 						   move cursor and set cursor commands are applied to
+ * 						   the frame buffer, other commands are queued and sent
+ * 						   before the next flushed cell
+ * [Args]:
+ * [in]: uint8_t a_cmd
+ * 	  command to be sent
+ * [Return]: void
+ */
+void LCD_sendCommand(uint8_t a_cmd)
+{
+	uint8_t row, col;
 
-	/* write 8-bits data to data port/pins */
-	LCD_writeToDataPins(a_data);
+	switch(a_cmd)
+	{
+	case LCD_CLEAR_SCREEN:
+		/* fill the frame buffer with spaces, only the cells that
+		 * are not empty will be written to the lcd
+		 */
+		for(row = 0; row < LCD_ROWS; row ++)
+		{
+			for(col = 0; col < LCD_COLS; col ++)
+			{
+				g_frameBuffer[row][col] = ' ';
+			}
+		}
+		g_cursorRow = 0;
+		g_cursorCol = 0;
+		LCD_requestFlush();
+		break;
 
-#endif /* LCD_4_BIT_MODE == 1 */
+	case LCD_RETURN_HOME:
+		g_cursorRow = 0;
+		g_cursorCol = 0;
+		break;
 
-	TIMER_DELAY_MS(1);
+	case LCD_MOVE_CURSOR_LEFT:
+		if(g_cursorCol != 0)
+		{
+			g_cursorCol --;
+		}
+		break;
 
-	/* write low to enable pin */
-	DIO_writePin(LCD_ENABLE_PIN, LOW);
+	case LCD_MOVE_CURSOR_RIGHT:
+		if(g_cursorCol < LCD_COLS)
+		{
+			g_cursorCol ++;
+		}
+		break;
 
-	TIMER_DELAY_MS(1);
+	default:
+		if(a_cmd & LCD_SET_CURSOR_BASE_ADDRESS)
+		{
+			/* find the row of the address, the cursor stays out of the
+			 * screen if the address isn't shown
+			 */
+			a_cmd &= ~LCD_SET_CURSOR_BASE_ADDRESS;
+			g_cursorCol = LCD_COLS;
+
+			for(row = 0; row < LCD_ROWS; row ++)
+			{
+				if(a_cmd >= g_rowAddress[row] && a_cmd < g_rowAddress[row] + LCD_COLS)
+				{
+					g_cursorRow = row;
+					g_cursorCol = a_cmd - g_rowAddress[row];
+					break;
+				}
+			}
+		}
+		else
+		{
+			/* wait for the previous queued command to be written */
+			while(g_isCommandPending)
+			{
+				CPU_IDLE_HINT();
+			}
+			g_pendingCommand = a_cmd;
+			g_isCommandPending = TRUE;
+			LCD_requestFlush();
+		}
+		break;
+	}
+}
 
+/*
+ * [Function Name]: LCD_sendChar
+ * [Function Description]: send char to the lcd
+ * [Args]:
+ * [in]: uint8_t a_data
+ * 	  	 character to be sent
+ * [Return]: void
+ */
+void LCD_sendChar(uint8_t a_data)
+{
+	LCD_putChar(a_data);
+	LCD_requestFlush();
 }
 
 /*
@@ -255,9 +493,12 @@ void LCD_sendStr(const uint8_t * a_data)
 	/* loop till reach the null char '\0' */
 	while(*a_data)
 	{
-		LCD_sendChar(*a_data);
+		LCD_putChar(*a_data);
 		a_data ++;
 	}
+
+	/* flush the whole string */
+	LCD_requestFlush();
 }
 
 /*
@@ -281,6 +522,50 @@ void LCD_sendStrAt(uint8_t a_row, uint8_t a_col, const uint8_t * a_data)
 	LCD_sendStr(a_data);
 }
 
+/*
+ * [Function Name]: LCD_sendStrP
+ * [Function Description]: send string stored in the flash to the lcd
+ * [Args]:
+ * [in]: const uint8_t * a_data
+ * 	  	 FLASH_CONST string to be sent
+ * [Return]: void
+ */
+void LCD_sendStrP(const uint8_t * a_data)
+{
+	uint8_t data;
+
+	/* loop till reach the null char '\0' */
+	while((data = FLASH_READ_BYTE(a_data)) != '\0')
+	{
+		LCD_putChar(data);
+		a_data ++;
+	}
+
+	/* flush the whole string */
+	LCD_requestFlush();
+}
+
+/*
+ * [Function Name]: LCD_sendStrAtP
+ * [Function Description]: send string stored in the flash to the lcd at specific location
+ * [Args]:
+ * [in]: uint8_t a_row
+ * 	  	 index of the row to write in
+ * [in]: uint8_t a_col
+ * 	  	 index of the column to write in
+ * [in]: const uint8_t * a_data
+ * 	  	 FLASH_CONST string to be sent
+ * [Return]: void
+ */
+void LCD_sendStrAtP(uint8_t a_row, uint8_t a_col, const uint8_t * a_data)
+{
+	/* set cursor to row and col */
+	LCD_setCursor(a_row, a_col);
+
+	/* write string */
+	LCD_sendStrP(a_data);
+}
+
 /*
  * [Function Name]: LCD_setCursor
  * [Function Description]: set the cursor location in the lcd
@@ -293,28 +578,13 @@ void LCD_sendStrAt(uint8_t a_row, uint8_t a_col, const uint8_t * a_data)
  */
 void LCD_setCursor(uint8_t a_row, uint8_t a_col)
 {
-	uint8_t lcdMemoryAddress;
-
-	/* Calculate the required address in the LCD DDRAM */
-	switch(a_row)
+	if(a_row >= LCD_ROWS)
 	{
-	case 0:
-		lcdMemoryAddress = a_col;
-		break;
-	case 1:
-		lcdMemoryAddress = a_col + 0x40;
-		break;
-	case 2:
-		lcdMemoryAddress = a_col + 0x10;
-		break;
-	case 3:
-		lcdMemoryAddress = a_col + 0x50;
-		break;
-	default :
 		return;
 	}
-	/* Move the LCD cursor to this specific address */
-	LCD_sendCommand(lcdMemoryAddress | LCD_SET_CURSOR_BASE_ADDRESS);
+	/* Move the cursor of the frame buffer to this location */
+	g_cursorRow = a_row;
+	g_cursorCol = (a_col < LCD_COLS) ? a_col : LCD_COLS;
 }
 
 /*
@@ -382,11 +652,177 @@ void LCD_sendInteger(int32_t a_num, uint8_t a_minLength)
 	}
 }
 
+/*
+ * [Function Name]: LCD_glyphChar
+ * [Function Description]: gets the char code showing a glyph, a glyph that isn't
+ * 						   in the cgram replaces a glyph that isn't shown on the screen,
+ * 						   the new glyph is uploaded by the flush before any cell
+ * [Args]:
+ * [in]: EN_LcdGlyph a_glyph
+ * 	  	 id of the glyph
+ * [Return]: uint8_t
+ * 			 char code of the glyph, ' ' if the glyph is not valid or all
+ * 			 the slots are shown on the screen
+ */
+uint8_t LCD_glyphChar(EN_LcdGlyph a_glyph)
+{
+	uint8_t slot, slotsCount;
+
+	if(a_glyph >= LCD_GLYPHS_COUNT)
+	{
+		return ' ';
+	}
+
+	/* the glyph is already in the cgram */
+	for(slot = 0; slot < LCD_GLYPH_SLOTS; slot ++)
+	{
+		if(g_slotGlyphs[slot] == a_glyph)
+		{
+			return LCD_GLYPH_BASE_CHAR + slot;
+		}
+	}
+
+	/* replace the glyph of the next slot that isn't shown */
+	for(slotsCount = 0; slotsCount < LCD_GLYPH_SLOTS; slotsCount ++)
+	{
+		slot = g_nextSlot;
+		g_nextSlot = (g_nextSlot + 1) % LCD_GLYPH_SLOTS;
+
+		if(slot != g_uploadSlot && !LCD_isSlotShown(slot))
+		{
+			/* wait for the previous upload to be written */
+			while(g_uploadSlot != LCD_NO_SLOT)
+			{
+				CPU_IDLE_HINT();
+			}
+			g_slotGlyphs[slot] = a_glyph;
+			g_uploadByte = 0;
+			g_uploadSlot = slot;
+			LCD_requestFlush();
+
+			return LCD_GLYPH_BASE_CHAR + slot;
+		}
+	}
+
+	return ' ';
+}
+
+/*
+ * [Function Name]: LCD_sendGlyph
+ * [Function Description]: send a glyph to the lcd
+ * [Args]:
+ * [in]: EN_LcdGlyph a_glyph
+ * 	  	 id of the glyph
+ * [Return]: void
+ */
+void LCD_sendGlyph(EN_LcdGlyph a_glyph)
+{
+	LCD_sendChar(LCD_glyphChar(a_glyph));
+}
+
+/*
+ * [Function Name]: LCD_sendGlyphAt
+ * [Function Description]: send a glyph to the lcd at specific location
+ * [Args]:
+ * [in]: uint8_t a_row
+ * 	  	 index of the row to write in
+ * [in]: uint8_t a_col
+ * 	  	 index of the column to write in
+ * [in]: EN_LcdGlyph a_glyph
+ * 	  	 id of the glyph
+ * [Return]: void
+ */
+void LCD_sendGlyphAt(uint8_t a_row, uint8_t a_col, EN_LcdGlyph a_glyph)
+{
+	/* set cursor to row and col */
+	LCD_setCursor(a_row, a_col);
+
+	/* write glyph */
+	LCD_sendGlyph(a_glyph);
+}
+
+/*
+ * [Function Name]: LCD_showProgressBar
+ * [Function Description]: shows a horizontal bar filled from the left in
+ * 						   a_value / a_max of its width, with a resolution of one
+ * 						   pixel column, only the cells that change are written
+ * 						   to the lcd, one per pixel column of progress
+ * [Args]:
+ * [in]: uint8_t a_row
+ * 	  	 index of the row of the bar
+ * [in]: uint8_t a_col
+ * 	  	 index of the first column of the bar
+ * [in]: uint8_t a_width
+ * 	  	 number of cells of the bar
+ * [in]: uint8_t a_value
+ * 	  	 progress, a value bigger than a_max fills the bar
+ * [in]: uint8_t a_max
+ * 	  	 value of the full bar, not 0
+ * [Return]: void
+ */
+void LCD_showProgressBar(uint8_t a_row, uint8_t a_col, uint8_t a_width, uint8_t a_value, uint8_t a_max)
+{
+	/* filled pixel columns of the bar */
+	uint16_t pixels;
+	uint8_t cell;
+
+	if(a_max == 0)
+	{
+		return;
+	}
+	if(a_value > a_max)
+	{
+		a_value = a_max;
+	}
+	if(a_width > LCD_COLS)
+	{
+		a_width = LCD_COLS;
+	}
+	pixels = ((uint16_t)a_value * a_width * LCD_CHAR_PIXELS) / a_max;
+
+	LCD_setCursor(a_row, a_col);
+
+	/* full cells, then one partial cell, then empty cells */
+	for(cell = 0; cell < a_width; cell ++)
+	{
+		if(pixels >= LCD_CHAR_PIXELS)
+		{
+			LCD_putChar(LCD_FULL_BLOCK_CHAR);
+			pixels -= LCD_CHAR_PIXELS;
+		}
+		else if(pixels != 0)
+		{
+			LCD_putChar(LCD_glyphChar(LCD_GLYPH_BAR_1 + pixels - 1));
+			pixels = 0;
+		}
+		else
+		{
+			LCD_putChar(' ');
+		}
+	}
+
+	/* flush the changed cells */
+	LCD_requestFlush();
+}
+
+/*
+ * [Function Name]: LCD_isFlushed
+ * [Function Description]: checks whether the screen shows all the
+ * 						   changes written to the frame buffer
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 TRUE if all the changes are flushed, FALSE otherwise
+ */
+uint8_t LCD_isFlushed(void)
+{
+	return (g_isDirty || g_isCommandPending || g_uploadSlot != LCD_NO_SLOT) ? FALSE : TRUE;
+}
+
 /*
  * [Function Name]: LCD_setDataPinsDir
  * [Function Description]: set the direction of the pins/port of the lcd
- * 						   as input or output, input is used to read if the screen
- * 						   is busy, output is used in all writing operations
+ * 						   as input or output
  * [Args]:
  * [in]: uint8_t a_direction
  * 	  	 direction to be set
@@ -428,126 +864,305 @@ static void LCD_setDataPinsDir(uint8_t a_direction)
 }
 
 /*
- * [Function Name]: LCD_waitTillNotBusy
- * [Function Description]: busy wait till the screen is not busy
+ * [Function Name]: LCD_writeToDataPins
+ * [Function Description]: write data to data pins/port
  * [Args]:
- * [in]: void
+ * [in]: uint8_t a_data
+ * 		 data to be written
  * [Return]: void
  */
-static void LCD_waitTillNotBusy()
+static void LCD_writeToDataPins(uint8_t a_data)
 {
-	uint8_t isBusy = 0;
-
-	/* make datapins input */
-#if LCD_USE_SINGLE_DATA_PORT == 1
+#if LCD_4_BIT_MODE == 1 && LCD_USE_SINGLE_DATA_PORT == 1
 
-	LCD_setDataPinsDir(PORT_INPUT);
+	/* write to only 4 successive pins of the port */
+	DIO_writePortPartialFast(LCD_DATA_PORT, a_data, 0x0F, LCD_DATA_START_PIN);
 
-#else
+#elif LCD_4_BIT_MODE == 1 && LCD_USE_SINGLE_DATA_PORT == 0
 
-	LCD_setDataPinsDir(PIN_INPUT);
+	/* write to indvidual pins */
+	DIO_writePinFast(LCD_D4, GET_BIT(a_data, 0));
+	DIO_writePinFast(LCD_D5, GET_BIT(a_data, 1));
+	DIO_writePinFast(LCD_D6, GET_BIT(a_data, 2));
+	DIO_writePinFast(LCD_D7, GET_BIT(a_data, 3));
 
-#endif
+#elif LCD_4_BIT_MODE == 0 && LCD_USE_SINGLE_DATA_PORT == 1
 
-	/* make RS=0 to read cmd, R/W=1 to read */
-	DIO_writePin(LCD_RS_PIN, RS_CMD);
-	DIO_writePin(LCD_RW_PIN, RW_READ);
+	/* write to 8 successive pins of the port */
+	DIO_writePortPartialFast(LCD_DATA_PORT, a_data, 0xFF, LCD_DATA_START_PIN);
 
-	do{
-#if (LCD_4_BIT_MODE == 1)
+#elif LCD_4_BIT_MODE == 0 && LCD_USE_SINGLE_DATA_PORT == 0
 
-		DIO_writePin(LCD_ENABLE_PIN, HIGH);
+	/* write to indvidual pins */
+	DIO_writePinFast(LCD_D0, GET_BIT(a_data, 0));
+	DIO_writePinFast(LCD_D1, GET_BIT(a_data, 1));
+	DIO_writePinFast(LCD_D2, GET_BIT(a_data, 2));
+	DIO_writePinFast(LCD_D3, GET_BIT(a_data, 3));
+	DIO_writePinFast(LCD_D4, GET_BIT(a_data, 4));
+	DIO_writePinFast(LCD_D5, GET_BIT(a_data, 5));
+	DIO_writePinFast(LCD_D6, GET_BIT(a_data, 6));
+	DIO_writePinFast(LCD_D7, GET_BIT(a_data, 7));
 
-		TIMER_DELAY_MS(1);
+#endif
 
-#if LCD_USE_SINGLE_DATA_PORT == 1
-		/* read the 4th pin D7 to check the busy flag */
-		isBusy = DIO_readPin(LCD_DATA_START_PIN + 3);
-#else
-		isBusy = DIO_readPin(LCD_D7);
-#endif /* LCD_USE_SINGLE_DATA_PORT == 1 */
+}
 
-		DIO_writePin(LCD_ENABLE_PIN, LOW);
+/*
+ * [Function Name]: LCD_writeByte
+ * [Function Description]: writes a command or data byte to the lcd with
+ * 						   minimum width enable pulses, it doesn't wait for the lcd
+ * 						   so the caller must not write again before the
+ * 						   execution time of the previous byte passes
+ * [Args]:
+ * [in]: uint8_t a_rs
+ * 		 RS_CMD or RS_DATA
+ * [in]: uint8_t a_data
+ * 		 byte to be written
+ * [Return]: void
+ */
+static void LCD_writeByte(uint8_t a_rs, uint8_t a_data)
+{
+	/* select command or data, R/W is always 0 */
+	DIO_writePinFast(LCD_RS_PIN, a_rs);
 
-		TIMER_DELAY_MS(1);
+#if LCD_4_BIT_MODE == 1
 
-		DIO_writePin(LCD_ENABLE_PIN, HIGH);
+	/* write higher 4 bits of data to data pins/port */
+	LCD_writeToDataPins(a_data >> 4);
+	LCD_pulseEnable();
 
-		TIMER_DELAY_MS(1);
+	/* the second pulse starts a new enable cycle */
+	CPU_DELAY_CYCLES(LCD_ENABLE_LOW_CYCLES);
 
-		DIO_writePin(LCD_ENABLE_PIN, LOW);
+	/* write lower 4 bits of data to data pins/port */
+	LCD_writeToDataPins(a_data & 0x0F);
+	LCD_pulseEnable();
 
 #else
-		DIO_writePin(LCD_ENABLE_PIN, HIGH);
 
-		TIMER_DELAY_MS(1);
+	/* write 8-bits data to data port/pins */
+	LCD_writeToDataPins(a_data);
+	LCD_pulseEnable();
 
-#if LCD_USE_SINGLE_DATA_PORT == 1
-		/* read the 8th pin D7 to check the busy flag */
-		isBusy = DIO_readPin(LCD_DATA_START_PIN + 7);
-#else
-		isBusy = DIO_readPin(LCD_D7);
-#endif /* LCD_USE_SINGLE_DATA_PORT == 1 */
+#endif /* LCD_4_BIT_MODE == 1 */
+}
 
-		TIMER_DELAY_MS(1);
+/*
+ * [Function Name]: LCD_pulseEnable
+ * [Function Description]: makes an enable pulse of the minimum width, the lcd
+ * 						   latches the data pins at its falling edge
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void LCD_pulseEnable(void)
+{
+	DIO_writePinFast(LCD_ENABLE_PIN, HIGH);
+	CPU_DELAY_CYCLES(LCD_ENABLE_PULSE_CYCLES);
+	DIO_writePinFast(LCD_ENABLE_PIN, LOW);
+}
 
-		DIO_writePin(LCD_ENABLE_PIN, LOW);
-#endif
-	}while(isBusy);
+#if LCD_4_BIT_MODE == 1
 
-	/* return the data pins to output mode */
-#if LCD_USE_SINGLE_DATA_PORT == 1
+/*
+ * [Function Name]: LCD_writeNibble
+ * [Function Description]: writes the lower 4 bits of a value to D4 - D7 of the lcd
+ * 						   with one enable pulse, used by the 4-bit mode reset sequence
+ * [Args]:
+ * [in]: uint8_t a_nibble
+ * 		 nibble to be written
+ * [Return]: void
+ */
+static void LCD_writeNibble(uint8_t a_nibble)
+{
+	LCD_writeToDataPins(a_nibble);
+	LCD_pulseEnable();
+}
 
-	LCD_setDataPinsDir(PORT_OUTPUT);
+#endif /* LCD_4_BIT_MODE == 1 */
 
-#else
+/*
+ * [Function Name]: LCD_putChar
+ * [Function Description]: writes a char to the frame buffer at the cursor
+ * 						   and moves the cursor right, without requesting a flush
+ * [Args]:
+ * [in]: uint8_t a_data
+ * 		 character to be written
+ * [Return]: void
+ */
+static void LCD_putChar(uint8_t a_data)
+{
+	/* chars out of the screen are dropped */
+	if(g_cursorCol < LCD_COLS)
+	{
+		if(g_frameBuffer[g_cursorRow][g_cursorCol] != a_data)
+		{
+			g_frameBuffer[g_cursorRow][g_cursorCol] = a_data;
+			g_isDirty = TRUE;
+		}
+		g_cursorCol ++;
+	}
+}
 
-	LCD_setDataPinsDir(PIN_OUTPUT);
+/*
+ * [Function Name]: LCD_isSlotShown
+ * [Function Description]: checks whether the char of a glyph slot is in the
+ * 						   frame buffer or on the lcd
+ * [Args]:
+ * [in]: uint8_t a_slot
+ * 		 index of the slot
+ * [Return]: boolean
+ * 			 TRUE if the slot is shown, FALSE otherwise
+ */
+static boolean LCD_isSlotShown(uint8_t a_slot)
+{
+	uint8_t row, col, slotChar = LCD_GLYPH_BASE_CHAR + a_slot;
 
-#endif
+	for(row = 0; row < LCD_ROWS; row ++)
+	{
+		for(col = 0; col < LCD_COLS; col ++)
+		{
+			if(g_frameBuffer[row][col] == slotChar || g_screen[row][col] == slotChar)
+			{
+				return TRUE;
+			}
+		}
+	}
 
+	return FALSE;
 }
 
 /*
- * [Function Name]: LCD_writeToDataPins
- * [Function Description]: write data to data pins/port
+ * [Function Name]: LCD_requestFlush
+ * [Function Description]: starts the flush timer to write the changes
+ * 						   of the frame buffer to the lcd
  * [Args]:
- * [in]: uint8_t a_data
- * 		 data to be written
+ * [in]: void
  * [Return]: void
  */
-static void LCD_writeToDataPins(uint8_t a_data)
+static void LCD_requestFlush(void)
 {
-#if LCD_4_BIT_MODE == 1 && LCD_USE_SINGLE_DATA_PORT == 1
+	/* starting a running timer does nothing, if the flush has already
+	 * written the changes, the next flush call finds nothing and stops it
+	 */
+	if(g_isDirty || g_isCommandPending || g_uploadSlot != LCD_NO_SLOT)
+	{
+		TIMER_start(LCD_FLUSH_TIMER);
+	}
+}
 
-	/* write to only 4 successive pins of the port */
-	DIO_writePortPartial(LCD_DATA_PORT, a_data, 0x0F, LCD_DATA_START_PIN);
+/*
+ * [Function Name]: LCD_uploadNext
+ * [Function Description]: writes the next byte of the uploaded glyph, the cgram
+ * 						   address of its slot first then its lines
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void LCD_uploadNext(void)
+{
+	if(g_uploadByte == 0)
+	{
+		/* the lcd address moves to the cgram */
+		LCD_writeByte(RS_CMD, LCD_SET_CGRAM_BASE_ADDRESS | (g_uploadSlot * LCD_GLYPH_LINES));
+		g_lcdAddress = LCD_UNKNOWN_ADDRESS;
+	}
+	else
+	{
+		LCD_writeByte(RS_DATA, FLASH_READ_BYTE(&g_glyphs[g_slotGlyphs[g_uploadSlot]][g_uploadByte - 1]));
+	}
 
-#elif LCD_4_BIT_MODE == 1 && LCD_USE_SINGLE_DATA_PORT == 0
+	g_uploadByte ++;
+	if(g_uploadByte > LCD_GLYPH_LINES)
+	{
+		g_uploadSlot = LCD_NO_SLOT;
+	}
+}
 
-	/* write to indvidual pins */
-	DIO_writePin(LCD_D4, GET_BIT(a_data, 0));
-	DIO_writePin(LCD_D5, GET_BIT(a_data, 1));
-	DIO_writePin(LCD_D6, GET_BIT(a_data, 2));
-	DIO_writePin(LCD_D7, GET_BIT(a_data, 3));
+/*
+ * [Function Name]: LCD_flushNext
+ * [Function Description]: flush timer callback, writes the queued command,
+ * 						   the next byte of the uploaded glyph or the next
+ * 						   changed cell to the lcd, a cell away
+ * 						   from the lcd address takes 2 calls, one to set
+ * 						   the address and one to write the char,
+ * 						   it stops the timer when the screen is up to date
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void LCD_flushNext(void)
+{
+	uint8_t cellsCount, address, data;
 
-#elif LCD_4_BIT_MODE == 0 && LCD_USE_SINGLE_DATA_PORT == 1
+	/* the next write is one whole period after this one, even if another
+	 * interrupt delayed this call */
+	TIMER_resetCount(LCD_FLUSH_TIMER);
 
-	/* write to 8 successive pins of the port */
-	DIO_writePortPartial(LCD_DATA_PORT, a_data, 0xFF, LCD_DATA_START_PIN);
+	/* commands are written first */
+	if(g_isCommandPending)
+	{
+		LCD_writeByte(RS_CMD, g_pendingCommand);
+		g_isCommandPending = FALSE;
 
-#elif LCD_4_BIT_MODE == 0 && LCD_USE_SINGLE_DATA_PORT == 0
+		/* the command may move the lcd address */
+		g_lcdAddress = LCD_UNKNOWN_ADDRESS;
+		return;
+	}
 
-	/* write to indvidual pins */
-	DIO_writePin(LCD_D0, GET_BIT(a_data, 0));
-	DIO_writePin(LCD_D1, GET_BIT(a_data, 1));
-	DIO_writePin(LCD_D2, GET_BIT(a_data, 2));
-	DIO_writePin(LCD_D3, GET_BIT(a_data, 3));
-	DIO_writePin(LCD_D4, GET_BIT(a_data, 4));
-	DIO_writePin(LCD_D5, GET_BIT(a_data, 5));
-	DIO_writePin(LCD_D6, GET_BIT(a_data, 6));
-	DIO_writePin(LCD_D7, GET_BIT(a_data, 7));
+	/* a new glyph is uploaded before the cells that show it */
+	if(g_uploadSlot != LCD_NO_SLOT)
+	{
+		LCD_uploadNext();
+		return;
+	}
 
-#endif
+	if(g_isDirty)
+	{
+		/* cleared before checking the cells, so a change made by the app
+		 * during the check sets it again
+		 */
+		g_isDirty = FALSE;
+
+		/* check all the cells starting from the last flushed one */
+		for(cellsCount = 0; cellsCount < LCD_ROWS * LCD_COLS; cellsCount ++)
+		{
+			data = g_frameBuffer[g_flushRow][g_flushCol];
+
+			if(data != g_screen[g_flushRow][g_flushCol])
+			{
+				g_isDirty = TRUE;
+				address = g_rowAddress[g_flushRow] + g_flushCol;
+
+				if(address != g_lcdAddress)
+				{
+					/* move the lcd to the cell, it's written in the next call */
+					LCD_writeByte(RS_CMD, address | LCD_SET_CURSOR_BASE_ADDRESS);
+					g_lcdAddress = address;
+				}
+				else
+				{
+					LCD_writeByte(RS_DATA, data);
+					g_screen[g_flushRow][g_flushCol] = data;
+					g_lcdAddress ++;
+				}
+				return;
+			}
+
+			/* next cell */
+			g_flushCol ++;
+			if(g_flushCol == LCD_COLS)
+			{
+				g_flushCol = 0;
+				g_flushRow ++;
+				if(g_flushRow == LCD_ROWS)
+				{
+					g_flushRow = 0;
+				}
+			}
+		}
+	}
 
+	/* the screen is up to date */
+	TIMER_stop(LCD_FLUSH_TIMER);
 }
@@ -42,6 +42,50 @@
 /* R/W value when writing */
 #define RW_WRITE										0
 
+/* time after power on before the lcd accepts commands in ms */
+#define LCD_POWER_ON_TIME_MS							40
+
+/* minimum width of the enable pulse and of the enable cycle in ns */
+#define LCD_ENABLE_PULSE_NS								450
+#define LCD_ENABLE_CYCLE_NS								1000
+
+/* time after the first and the second 8-bit function set of the 4-bit
+ * mode reset sequence in us */
+#define LCD_RESET_FIRST_TIME_US							4100
+#define LCD_RESET_SECOND_TIME_US						100
+
+/* 8-bit and 4-bit function set nibbles of the 4-bit mode reset sequence */
+#define LCD_RESET_8_BIT_NIBBLE							0x03
+#define LCD_RESET_4_BIT_NIBBLE							0x02
+
+/* execution time of the commands in us, except clear screen and return home */
+#define LCD_COMMAND_TIME_US								37
+
+/* execution time of clear screen and return home in us */
+#define LCD_CLEAR_TIME_US								1520
+
+/* execution time of the data writes in us */
+#define LCD_DATA_TIME_US								41
+
+/*------------Glyphs------------*/
+
+/* number of the user-defined chars (glyph slots) of the cgram with 5x8 font */
+#define LCD_GLYPH_SLOTS									8
+
+/* number of lines of a glyph, one byte each */
+#define LCD_GLYPH_LINES									8
+
+/* number of pixel columns of a char */
+#define LCD_CHAR_PIXELS									5
+
+/* char code of the first glyph slot, codes 0x00 - 0x07 and 0x08 - 0x0F both
+ * show the slots, the second ones are used so a glyph never ends a string
+ */
+#define LCD_GLYPH_BASE_CHAR								0x08
+
+/* char code of the full block of the lcd font */
+#define LCD_FULL_BLOCK_CHAR								0xFF
+
 /*------------Commands------------*/
 
 /* clear screen */
@@ -79,6 +123,15 @@
 /* base address for setting cursor location */
 #define LCD_SET_CURSOR_BASE_ADDRESS						0x80
 
+/* base address for setting the cgram address */
+#define LCD_SET_CGRAM_BASE_ADDRESS						0x40
+
+/* ddram addresses of the first column of each row */
+#define LCD_ROW_0_ADDRESS								0x00
+#define LCD_ROW_1_ADDRESS								0x40
+#define LCD_ROW_2_ADDRESS								0x10
+#define LCD_ROW_3_ADDRESS								0x50
+
 #if LCD_4_BIT_MODE == 0
 
 /* 2 lines, 5x11 font size */
@@ -103,13 +156,57 @@
 
 #endif	/* LCD_4_BIT_MODE == 0 */
 
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Enum Name]: EN_LcdGlyph
+ * [Enum Description]: contains the ids of the glyphs of the glyph table,
+ * 					   the first LCD_GLYPH_SLOTS of them are uploaded at init
+ */
+typedef enum
+{
+	/* progress bar cells with 1 to 4 pixel columns filled from the left */
+	LCD_GLYPH_BAR_1,
+	LCD_GLYPH_BAR_2,
+	LCD_GLYPH_BAR_3,
+	LCD_GLYPH_BAR_4,
+
+	/* closed and open lock */
+	LCD_GLYPH_LOCKED,
+	LCD_GLYPH_UNLOCKED,
+
+	/* bell of the warning */
+	LCD_GLYPH_BELL,
+
+	/* hourglass of the waiting times */
+	LCD_GLYPH_HOURGLASS,
+
+	/* number of the glyphs */
+	LCD_GLYPHS_COUNT
+
+}EN_LcdGlyph;
+
 /*******************************************************************************
  *                           Function Prototypes                               *
  *******************************************************************************/
 
+/*
+ * The driver keeps a shadow frame buffer of the screen, all the writing
+ * functions below only change the frame buffer and return immediately,
+ * the changed cells are written to the lcd in the background by the
+ * LCD_FLUSH_TIMER interrupt, one cell every LCD_FLUSH_PERIOD_US.
+ * The frame buffer assumes left to right entry mode without display shift.
+ */
+
 /*
  * [Function Name]: LCD_init
- * [Function Description]: initializes the lcd
+ * [Function Description]: initializes the lcd and the flush timer,
+ * 						   its delays are counted by the system clock, so
+ * 						   SYSCLK_init() must be called first,
+ * 						   the global interrupt must be enabled after it
+ * 						   for the screen to be updated
  * [Args]:
  * [in]: void
  * [Return]: void
@@ -118,7 +215,10 @@ void LCD_init(void);
 
  /*
   * [Function Name]: LCD_sendCommand
-  * [Function Description]: send command to the lcd
+  * [Function Description]: send command to the lcd, clear screen, return home,
+  * 						move cursor and set cursor commands are applied to
+  * 						the frame buffer, other commands are queued and sent
+  * 						before the next flushed cell
   * [Args]:
   * [in]: uint8_t a_cmd
   * 	  command to be sent
@@ -174,6 +274,30 @@ void LCD_sendStr(const uint8_t * a_data);
  */
 void LCD_sendStrAt(uint8_t a_row, uint8_t a_col, const uint8_t * a_data);
 
+/*
+ * [Function Name]: LCD_sendStrP
+ * [Function Description]: send string stored in the flash to the lcd
+ * [Args]:
+ * [in]: const uint8_t * a_data
+ * 	  	 FLASH_CONST string to be sent
+ * [Return]: void
+ */
+void LCD_sendStrP(const uint8_t * a_data);
+
+/*
+ * [Function Name]: LCD_sendStrAtP
+ * [Function Description]: send string stored in the flash to the lcd at specific location
+ * [Args]:
+ * [in]: uint8_t a_row
+ * 	  	 index of the row to write in
+ * [in]: uint8_t a_col
+ * 	  	 index of the column to write in
+ * [in]: const uint8_t * a_data
+ * 	  	 FLASH_CONST string to be sent
+ * [Return]: void
+ */
+void LCD_sendStrAtP(uint8_t a_row, uint8_t a_col, const uint8_t * a_data);
+
 /*
  * [Function Name]: LCD_setCursor
  * [Function Description]: set the cursor location in the lcd
@@ -199,4 +323,74 @@ void LCD_setCursor(uint8_t a_row, uint8_t a_col);
  */
 void LCD_sendInteger(int32_t a_num, uint8_t a_minLength);
 
+/*
+ * [Function Name]: LCD_glyphChar
+ * [Function Description]: gets the char code showing a glyph, a glyph that isn't
+ * 						   in the cgram replaces a glyph that isn't shown on the screen,
+ * 						   the new glyph is uploaded by the flush before any cell
+ * [Args]:
+ * [in]: EN_LcdGlyph a_glyph
+ * 	  	 id of the glyph
+ * [Return]: uint8_t
+ * 			 char code of the glyph, ' ' if the glyph is not valid or all
+ * 			 the slots are shown on the screen
+ */
+uint8_t LCD_glyphChar(EN_LcdGlyph a_glyph);
+
+/*
+ * [Function Name]: LCD_sendGlyph
+ * [Function Description]: send a glyph to the lcd
+ * [Args]:
+ * [in]: EN_LcdGlyph a_glyph
+ * 	  	 id of the glyph
+ * [Return]: void
+ */
+void LCD_sendGlyph(EN_LcdGlyph a_glyph);
+
+/*
+ * [Function Name]: LCD_sendGlyphAt
+ * [Function Description]: send a glyph to the lcd at specific location
+ * [Args]:
+ * [in]: uint8_t a_row
+ * 	  	 index of the row to write in
+ * [in]: uint8_t a_col
+ * 	  	 index of the column to write in
+ * [in]: EN_LcdGlyph a_glyph
+ * 	  	 id of the glyph
+ * [Return]: void
+ */
+void LCD_sendGlyphAt(uint8_t a_row, uint8_t a_col, EN_LcdGlyph a_glyph);
+
+/*
+ * [Function Name]: LCD_showProgressBar
+ * [Function Description]: shows a horizontal bar filled from the left in
+ * 						   a_value / a_max of its width, with a resolution of one
+ * 						   pixel column, only the cells that change are written
+ * 						   to the lcd, one per pixel column of progress
+ * [Args]:
+ * [in]: uint8_t a_row
+ * 	  	 index of the row of the bar
+ * [in]: uint8_t a_col
+ * 	  	 index of the first column of the bar
+ * [in]: uint8_t a_width
+ * 	  	 number of cells of the bar
+ * [in]: uint8_t a_value
+ * 	  	 progress, a value bigger than a_max fills the bar
+ * [in]: uint8_t a_max
+ * 	  	 value of the full bar, not 0
+ * [Return]: void
+ */
+void LCD_showProgressBar(uint8_t a_row, uint8_t a_col, uint8_t a_width, uint8_t a_value, uint8_t a_max);
+
+/*
+ * [Function Name]: LCD_isFlushed
+ * [Function Description]: checks whether the screen shows all the
+ * 						   changes written to the frame buffer
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 TRUE if all the changes are flushed, FALSE otherwise
+ */
+uint8_t LCD_isFlushed(void);
+
 #endif /* __LCD_H__ */
@@ -6,8 +6,14 @@ typedef signed char int8_t;
 typedef unsigned char uint8_t;
 typedef signed short int16_t;
 typedef unsigned short uint16_t;
+/* long is 64 bits on 64 bit hosts, int keeps the 32 bits of the target there */
+#if defined(__LP64__)
+typedef signed int int32_t;
+typedef unsigned int uint32_t;
+#else
 typedef signed long int int32_t;
 typedef unsigned long int uint32_t;
+#endif
 typedef signed long long int int64_t;
 typedef unsigned long long int uint64_t;
 typedef float float32_t;
@@ -23,6 +23,9 @@
 /* For using common defines and macros */
 #include "../../Lib/common.h"
 
+/* For using mcu registers in the inline functions */
+#include "../Mcu/mcu.h"
+
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
@@ -56,13 +59,13 @@
  *******************************************************************************/
 
 /* Get DDRx register of a specific port */
-#define GET_DDR_FROM_PORT_NO(PORT_NO) (*(volatile uint8_t*)((DDR_START_LOC) - (uint8_t)((PORT_NO) * PORTS_OFFSET)))
+#define GET_DDR_FROM_PORT_NO(PORT_NO) MCU_REG8((DDR_START_LOC) - (uint8_t)((PORT_NO) * PORTS_OFFSET))
 
 /* Get PORTx register of a specific port */
-#define GET_PORT_FROM_PORT_NO(PORT_NO) (*(volatile uint8_t*)((PORT_START_LOC) - (uint8_t)((PORT_NO) * PORTS_OFFSET)))
+#define GET_PORT_FROM_PORT_NO(PORT_NO) MCU_REG8((PORT_START_LOC) - (uint8_t)((PORT_NO) * PORTS_OFFSET))
 
 /* Get PINx register of a specific port */
-#define GET_PIN_FROM_PORT_NO(PORT_NO) (*(volatile uint8_t*)((PIN_START_LOC) - (uint8_t)((PORT_NO) * PORTS_OFFSET)))
+#define GET_PIN_FROM_PORT_NO(PORT_NO) MCU_REG8((PIN_START_LOC) - (uint8_t)((PORT_NO) * PORTS_OFFSET))
 
 /* check if port number is valid */
 #define DIO_PORT_IS_VALID(PORT)	((PORT) < DIO_PORTS_NUM)
@@ -268,4 +271,120 @@ uint8_t DIO_controlPinInternalPull(uint8_t a_pin, DIO_InternalPullOptions a_pull
  */
 uint8_t DIO_controlPortInternalPull(uint8_t a_port, DIO_InternalPullOptions a_pull);
 
+/*******************************************************************************
+ *                        Inline Functions Definitions                         *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: DIO_writePinFast
+ * [Function Description]: same as DIO_writePin, but with a constant pin the port and pin
+ * 						   are decoded and checked during compilation, so it's a single
+ * 						   sbi or cbi instruction, with a non constant pin it calls DIO_writePin
+ * [Args]:
+ * [in]: uint8_t a_pin
+ * 		 the pin number to write to
+ * [in]: uint8_t a_data
+ * 		 the data to be written if the pin is output, HIGH or LOW
+ * 		 or if the pin is input, it controls the pin internal pullup
+ * 		 HIGH => enable, LOW => disable
+ * [Return]: void
+ */
+static inline void DIO_writePinFast(uint8_t a_pin, uint8_t a_data)
+{
+	if(!__builtin_constant_p(a_pin))
+	{
+		DIO_writePin(a_pin, a_data);
+	}
+	else if(DIO_PORT_IS_VALID(GET_PORT_NO(a_pin)) && DIO_PIN_IS_VALID(GET_PIN_NO(a_pin)))
+	{
+		if(a_data == LOW)
+		{
+			CLEAR_BIT(GET_PORT_FROM_PORT_NO(GET_PORT_NO(a_pin)), GET_PIN_NO(a_pin));
+		}
+		else
+		{
+			SET_BIT(GET_PORT_FROM_PORT_NO(GET_PORT_NO(a_pin)), GET_PIN_NO(a_pin));
+		}
+	}
+}
+
+/*
+ * [Function Name]: DIO_readPinFast
+ * [Function Description]: same as DIO_readPin, but with a constant pin the port and pin
+ * 						   are decoded and checked during compilation, so it's a single
+ * 						   sbis or sbic instruction when used in a condition, with a
+ * 						   non constant pin it calls DIO_readPin
+ * [Args]:
+ * [in]: uint8_t a_pin
+ * 		 the pin number to read from
+ * [Return]: uint8_t
+ * 			 the data read from the pin HIGH or LOW
+ */
+static inline uint8_t DIO_readPinFast(uint8_t a_pin)
+{
+	if(!__builtin_constant_p(a_pin))
+	{
+		return DIO_readPin(a_pin);
+	}
+	else if(DIO_PORT_IS_VALID(GET_PORT_NO(a_pin)) && DIO_PIN_IS_VALID(GET_PIN_NO(a_pin)))
+	{
+		return BIT_IS_SET(GET_PIN_FROM_PORT_NO(GET_PORT_NO(a_pin)), GET_PIN_NO(a_pin)) ? HIGH : LOW;
+	}
+	return 0;
+}
+
+/*
+ * [Function Name]: DIO_readPortFast
+ * [Function Description]: same as DIO_readPort, but with a constant port it's checked
+ * 						   during compilation, so it's a single in instruction, with a
+ * 						   non constant port it calls DIO_readPort
+ * [Args]:
+ * [in]: uint8_t a_port
+ * 		 the port number to read from
+ * [Return]: uint8_t
+ * 			 the data read from the port
+ */
+static inline uint8_t DIO_readPortFast(uint8_t a_port)
+{
+	if(!__builtin_constant_p(a_port))
+	{
+		return DIO_readPort(a_port);
+	}
+	else if(DIO_PORT_IS_VALID(a_port))
+	{
+		return GET_PIN_FROM_PORT_NO(a_port);
+	}
+	return 0;
+}
+
+/*
+ * [Function Name]: DIO_writePortPartialFast
+ * [Function Description]: same as DIO_writePortPartial, but with a constant port, mask and
+ * 						   start pin the masks and the shift are done during compilation,
+ * 						   so only the data is shifted at run time, otherwise it calls
+ * 						   DIO_writePortPartial
+ * [Args]:
+ * [in]: uint8_t a_port
+ * 		 the port number
+ * [in]: uint8_t a_data
+ * 		 data to be written to the port after applying the mask to it
+ * [in]: uint8_t a_mask
+ * 		 mask applied to the data to select only specific number of bits
+ * 		 bits with ones in the corresponding locations only will be written
+ * [in]: uint8_t a_startPin
+ * 		 the pin to start writing from, it represents the shift amount
+ * [Return]: void
+ */
+static inline void DIO_writePortPartialFast(uint8_t a_port, uint8_t a_data, uint8_t a_dataMask, uint8_t a_startPin)
+{
+	if(!__builtin_constant_p(a_port) || !__builtin_constant_p(a_dataMask) || !__builtin_constant_p(a_startPin))
+	{
+		DIO_writePortPartial(a_port, a_data, a_dataMask, a_startPin);
+	}
+	else if(DIO_PORT_IS_VALID(a_port))
+	{
+		COPY_BITS(GET_PORT_FROM_PORT_NO(a_port), a_dataMask, a_data, GET_PIN_NO(a_startPin));
+	}
+}
+
 #endif /* __DIO_H__ */
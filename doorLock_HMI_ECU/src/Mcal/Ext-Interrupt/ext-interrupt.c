@@ -0,0 +1,169 @@
+/******************************************************************************
+ *
+ * Module: EXTINT
+ *
+ * File Name: ext-interrupt.c
+ *
+ * Description: Source file for the AVR external interrupts driver
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module header file */
+#include "ext-interrupt.h"
+
+/* For using mcu registers */
+#include "../Mcu/mcu.h"
+
+/* For setting the interrupt pins as inputs */
+#include "../Dio/dio.h"
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* pointers to the interrupts handlers */
+static void (* volatile g_extIntPtrToHandler[3])(void) = { NULL, NULL, NULL };
+
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: EXTINT_init
+ * [Function Description]: sets the pin of an external interrupt as input and its sense and
+ * 						   callback, the interrupt stays disabled till EXTINT_enable is called
+ * [Args]:
+ * [in]: EN_ExtInt a_extInt
+ * 		 external interrupt to initialize
+ * [in]: EN_ExtIntSense a_sense
+ * 		 condition that triggers the interrupt
+ * [in]: void (* volatile a_ptrToHandler)(void)
+ * 		 pointer to the callback function
+ * [Return]: void
+ */
+void EXTINT_init(EN_ExtInt a_extInt, EN_ExtIntSense a_sense, void (* volatile a_ptrToHandler)(void))
+{
+	EXTINT_disable(a_extInt);
+
+	g_extIntPtrToHandler[a_extInt] = a_ptrToHandler;
+
+	switch(a_extInt)
+	{
+	case EXTINT_0:
+		DIO_pinInit(INT0_PIN, PIN_INPUT);
+		COPY_BITS(MCUCR_R, 0x03, a_sense, ISC00);
+		break;
+
+	case EXTINT_1:
+		DIO_pinInit(INT1_PIN, PIN_INPUT);
+		COPY_BITS(MCUCR_R, 0x03, a_sense, ISC10);
+		break;
+
+	case EXTINT_2:
+		/* INT2 has a single sense bit, 0 => falling and 1 => rising */
+		DIO_pinInit(INT2_PIN, PIN_INPUT);
+		if(a_sense == EXTINT_RISING_EDGE)
+		{
+			SET_BIT(MCUCSR_R, ISC2);
+		}
+		else
+		{
+			CLEAR_BIT(MCUCSR_R, ISC2);
+		}
+		break;
+	}
+}
+
+/*
+ * [Function Name]: EXTINT_enable
+ * [Function Description]: clears the pending flag of an external interrupt and enables it,
+ * 						   a low level interrupt is triggered right away if the pin is low
+ * [Args]:
+ * [in]: EN_ExtInt a_extInt
+ * 		 external interrupt to enable
+ * [Return]: void
+ */
+void EXTINT_enable(EN_ExtInt a_extInt)
+{
+	switch(a_extInt)
+	{
+	case EXTINT_0:
+		/* the flag is cleared by writing one to it */
+		GIFR_R = SELECT_BIT(INTF0);
+		SET_BIT(GICR_R, INT0);
+		break;
+
+	case EXTINT_1:
+		GIFR_R = SELECT_BIT(INTF1);
+		SET_BIT(GICR_R, INT1);
+		break;
+
+	case EXTINT_2:
+		GIFR_R = SELECT_BIT(INTF2);
+		SET_BIT(GICR_R, INT2);
+		break;
+	}
+}
+
+/*
+ * [Function Name]: EXTINT_disable
+ * [Function Description]: disables an external interrupt, it can be called by its callback
+ * [Args]:
+ * [in]: EN_ExtInt a_extInt
+ * 		 external interrupt to disable
+ * [Return]: void
+ */
+void EXTINT_disable(EN_ExtInt a_extInt)
+{
+	switch(a_extInt)
+	{
+	case EXTINT_0:
+		CLEAR_BIT(GICR_R, INT0);
+		break;
+
+	case EXTINT_1:
+		CLEAR_BIT(GICR_R, INT1);
+		break;
+
+	case EXTINT_2:
+		CLEAR_BIT(GICR_R, INT2);
+		break;
+	}
+}
+
+/*******************************************************************************
+ *                       Interrupt Service Routines                            *
+ *******************************************************************************/
+
+/* ISR for external interrupt 0 */
+ISR(INT0_vect)
+{
+	if(g_extIntPtrToHandler[EXTINT_0] != NULL)
+	{
+		(*g_extIntPtrToHandler[EXTINT_0])();
+	}
+}
+
+/* ISR for external interrupt 1 */
+ISR(INT1_vect)
+{
+	if(g_extIntPtrToHandler[EXTINT_1] != NULL)
+	{
+		(*g_extIntPtrToHandler[EXTINT_1])();
+	}
+}
+
+/* ISR for external interrupt 2 */
+ISR(INT2_vect)
+{
+	if(g_extIntPtrToHandler[EXTINT_2] != NULL)
+	{
+		(*g_extIntPtrToHandler[EXTINT_2])();
+	}
+}
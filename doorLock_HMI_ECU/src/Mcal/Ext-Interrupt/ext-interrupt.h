@@ -0,0 +1,97 @@
+/******************************************************************************
+ *
+ * Module: EXTINT
+ *
+ * File Name: ext-interrupt.h
+ *
+ * Description: Header file for the AVR external interrupts driver
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __EXTINT_H__
+#define __EXTINT_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* For using std types */
+#include "../../Lib/types.h"
+
+/* For using common defines and macros */
+#include "../../Lib/common.h"
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Enum Name]: EN_ExtInt
+ * [Enum Description]: contains the external interrupts,
+ * 					   INT0 => PD2, INT1 => PD3, INT2 => PB2
+ */
+typedef enum
+{
+	EXTINT_0,
+	EXTINT_1,
+	EXTINT_2
+}EN_ExtInt;
+
+/*
+ * [Enum Name]: EN_ExtIntSense
+ * [Enum Description]: contains the conditions that trigger an external interrupt,
+ * 					   INT2 supports the edges only, only the low level of INT0 and INT1
+ * 					   and the edges of INT2 wake the mcu up from power down
+ */
+typedef enum
+{
+	/* keeps interrupting as long as the pin is low */
+	EXTINT_LOW_LEVEL,
+	EXTINT_ANY_CHANGE,
+	EXTINT_FALLING_EDGE,
+	EXTINT_RISING_EDGE
+}EN_ExtIntSense;
+
+/*******************************************************************************
+ *                           Function Prototypes                               *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: EXTINT_init
+ * [Function Description]: sets the pin of an external interrupt as input and its sense and
+ * 						   callback, the interrupt stays disabled till EXTINT_enable is called
+ * [Args]:
+ * [in]: EN_ExtInt a_extInt
+ * 		 external interrupt to initialize
+ * [in]: EN_ExtIntSense a_sense
+ * 		 condition that triggers the interrupt
+ * [in]: void (* volatile a_ptrToHandler)(void)
+ * 		 pointer to the callback function
+ * [Return]: void
+ */
+void EXTINT_init(EN_ExtInt a_extInt, EN_ExtIntSense a_sense, void (* volatile a_ptrToHandler)(void));
+
+/*
+ * [Function Name]: EXTINT_enable
+ * [Function Description]: clears the pending flag of an external interrupt and enables it,
+ * 						   a low level interrupt is triggered right away if the pin is low
+ * [Args]:
+ * [in]: EN_ExtInt a_extInt
+ * 		 external interrupt to enable
+ * [Return]: void
+ */
+void EXTINT_enable(EN_ExtInt a_extInt);
+
+/*
+ * [Function Name]: EXTINT_disable
+ * [Function Description]: disables an external interrupt, it can be called by its callback
+ * [Args]:
+ * [in]: EN_ExtInt a_extInt
+ * 		 external interrupt to disable
+ * [Return]: void
+ */
+void EXTINT_disable(EN_ExtInt a_extInt);
+
+#endif /* __EXTINT_H__ */
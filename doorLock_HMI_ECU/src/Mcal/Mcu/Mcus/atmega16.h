@@ -4,87 +4,88 @@
 #include "../../../Lib/types.h"
 
 /** General **/
-#define SFIOR_R 	(*(volatile uint8_t*)(0x50))
+#define SFIOR_R 	MCU_REG8(0x50)
+#define SREG_R 		MCU_REG8(0x5F)
 
 /** DIO **/
 /* DDRx Registers */
-#define DDRA_R 		(*(volatile uint8_t*)(0x3A))
-#define DDRB_R 		(*(volatile uint8_t*)(0x37))
-#define DDRC_R 		(*(volatile uint8_t*)(0x34))
-#define DDRD_R 		(*(volatile uint8_t*)(0x31))
+#define DDRA_R 		MCU_REG8(0x3A)
+#define DDRB_R 		MCU_REG8(0x37)
+#define DDRC_R 		MCU_REG8(0x34)
+#define DDRD_R 		MCU_REG8(0x31)
 
 /* PORTx Registers */
-#define PORTA_R		(*(volatile uint8_t*)(0x3B))
-#define PORTB_R		(*(volatile uint8_t*)(0x38))
-#define PORTC_R 	(*(volatile uint8_t*)(0x35))
-#define PORTD_R 	(*(volatile uint8_t*)(0x32))
+#define PORTA_R		MCU_REG8(0x3B)
+#define PORTB_R		MCU_REG8(0x38)
+#define PORTC_R 	MCU_REG8(0x35)
+#define PORTD_R 	MCU_REG8(0x32)
 
 /* PINx Registers */
-#define PINA_R 		(*(volatile uint8_t*)(0x39))
-#define PINB_R 		(*(volatile uint8_t*)(0x36))
-#define PINC_R 		(*(volatile uint8_t*)(0x33))
-#define PIND_R 		(*(volatile uint8_t*)(0x30))
+#define PINA_R 		MCU_REG8(0x39)
+#define PINB_R 		MCU_REG8(0x36)
+#define PINC_R 		MCU_REG8(0x33)
+#define PIND_R 		MCU_REG8(0x30)
 
 /** External Interrupts **/
-#define MCUCR_R 	(*(volatile uint8_t*)(0x55))
-#define MCUCSR_R 	(*(volatile uint8_t*)(0x54))
-#define GICR_R 		(*(volatile uint8_t*)(0x5B))
-#define GIFR_R 		(*(volatile uint8_t*)(0x5A))
+#define MCUCR_R 	MCU_REG8(0x55)
+#define MCUCSR_R 	MCU_REG8(0x54)
+#define GICR_R 		MCU_REG8(0x5B)
+#define GIFR_R 		MCU_REG8(0x5A)
 
 /** Timers **/
-#define TCCR0_R 	(*(volatile uint8_t*)(0x53))
-#define TCNT0_R 	(*(volatile uint8_t*)(0x52))
-#define OCR0_R 		(*(volatile uint8_t*)(0x5C))
-#define TIMSK_R 	(*(volatile uint8_t*)(0x59))
-#define TIFR_R 		(*(volatile uint8_t*)(0x58))
-#define TCCR1A_R 	(*(volatile uint8_t*)(0x4F))
-#define TCCR1B_R 	(*(volatile uint8_t*)(0x4E))
-#define TCNT1L_R 	(*(volatile uint8_t*)(0x4C))
-#define TCNT1H_R 	(*(volatile uint8_t*)(0x4D))
-#define TCNT1_R 	(*(volatile uint16_t*)(0x4C))
-#define OCR1AL_R 	(*(volatile uint8_t*)(0x4A))
-#define OCR1AH_R 	(*(volatile uint8_t*)(0x4B))
-#define OCR1A_R 	(*(volatile uint16_t*)(0x4A))
-#define OCR1BL_R 	(*(volatile uint8_t*)(0x48))
-#define OCR1BH_R 	(*(volatile uint8_t*)(0x49))
-#define OCR1B_R 	(*(volatile uint16_t*)(0x48))
-#define ICR1L_R 	(*(volatile uint8_t*)(0x46))
-#define ICR1H_R 	(*(volatile uint8_t*)(0x47))
-#define ICR1_R 		(*(volatile uint16_t*)(0x46))
-#define TCCR2_R 	(*(volatile uint8_t*)(0x45))
-#define TCNT2_R 	(*(volatile uint8_t*)(0x44))
-#define OCR2_R 		(*(volatile uint8_t*)(0x43))
-#define ASSR_R 		(*(volatile uint8_t*)(0x42))
+#define TCCR0_R 	MCU_REG8(0x53)
+#define TCNT0_R 	MCU_REG8(0x52)
+#define OCR0_R 		MCU_REG8(0x5C)
+#define TIMSK_R 	MCU_REG8(0x59)
+#define TIFR_R 		MCU_REG8(0x58)
+#define TCCR1A_R 	MCU_REG8(0x4F)
+#define TCCR1B_R 	MCU_REG8(0x4E)
+#define TCNT1L_R 	MCU_REG8(0x4C)
+#define TCNT1H_R 	MCU_REG8(0x4D)
+#define TCNT1_R 	MCU_REG16(0x4C)
+#define OCR1AL_R 	MCU_REG8(0x4A)
+#define OCR1AH_R 	MCU_REG8(0x4B)
+#define OCR1A_R 	MCU_REG16(0x4A)
+#define OCR1BL_R 	MCU_REG8(0x48)
+#define OCR1BH_R 	MCU_REG8(0x49)
+#define OCR1B_R 	MCU_REG16(0x48)
+#define ICR1L_R 	MCU_REG8(0x46)
+#define ICR1H_R 	MCU_REG8(0x47)
+#define ICR1_R 		MCU_REG16(0x46)
+#define TCCR2_R 	MCU_REG8(0x45)
+#define TCNT2_R 	MCU_REG8(0x44)
+#define OCR2_R 		MCU_REG8(0x43)
+#define ASSR_R 		MCU_REG8(0x42)
 
 /** WATCH DOG **/
-#define WDTCR_R 	(*(volatile uint8_t*)(0x41))
+#define WDTCR_R 	MCU_REG8(0x41)
 
 /** ADC **/
-#define ADMUX_R 	(*(volatile uint8_t*)(0x27))
-#define ADCSRA_R 	(*(volatile uint8_t*)(0x26))
-#define ADCH_R 		(*(volatile uint8_t*)(0x25))
-#define ADCL_R 		(*(volatile uint8_t*)(0x24))
-#define ADC_R 		(*(volatile uint16_t*)(0x24))
+#define ADMUX_R 	MCU_REG8(0x27)
+#define ADCSRA_R 	MCU_REG8(0x26)
+#define ADCH_R 		MCU_REG8(0x25)
+#define ADCL_R 		MCU_REG8(0x24)
+#define ADC_R 		MCU_REG16(0x24)
 
 /** USART **/
-#define UDR_R 		(*(volatile uint8_t*)(0x2C))
-#define UCSRA_R 	(*(volatile uint8_t*)(0x2B))
-#define UCSRB_R 	(*(volatile uint8_t*)(0x2A))
-#define UCSRC_R 	(*(volatile uint8_t*)(0x40))
-#define UBRRL_R 	(*(volatile uint8_t*)(0x29))
-#define UBRRH_R 	(*(volatile uint8_t*)(0x40))
+#define UDR_R 		MCU_REG8(0x2C)
+#define UCSRA_R 	MCU_REG8(0x2B)
+#define UCSRB_R 	MCU_REG8(0x2A)
+#define UCSRC_R 	MCU_REG8(0x40)
+#define UBRRL_R 	MCU_REG8(0x29)
+#define UBRRH_R 	MCU_REG8(0x40)
 
 /** SPI **/
-#define SPCR_R 		(*(volatile uint8_t*)(0x2D))
-#define SPSR_R 		(*(volatile uint8_t*)(0x2E))
-#define SPDR_R 		(*(volatile uint8_t*)(0x2F))
+#define SPCR_R 		MCU_REG8(0x2D)
+#define SPSR_R 		MCU_REG8(0x2E)
+#define SPDR_R 		MCU_REG8(0x2F)
 
 /** TWI **/
-#define TWBR_R 		(*(volatile uint8_t*)(0x20))
-#define TWCR_R 		(*(volatile uint8_t*)(0x56))
-#define TWSR_R 		(*(volatile uint8_t*)(0x21))
-#define TWDR_R 		(*(volatile uint8_t*)(0x23))
-#define TWAR_R 		(*(volatile uint8_t*)(0x22))
+#define TWBR_R 		MCU_REG8(0x20)
+#define TWCR_R 		MCU_REG8(0x56)
+#define TWSR_R 		MCU_REG8(0x21)
+#define TWDR_R 		MCU_REG8(0x23)
+#define TWAR_R 		MCU_REG8(0x22)
 
 /* start address of PORTx = PORTA address */
 #define PORT_START_LOC		(0x3B)
@@ -97,6 +98,9 @@
 
 /** Register bits **/
 
+/* SREG */
+#define SREG_I			7
+
 /* SFIOR */
 #define PSR10			0
 #define PSR2			1
@@ -106,6 +110,12 @@
 #define ADTS1			6
 #define ADTS2			7
 
+/* MCUCR - sleep */
+#define SM0				4
+#define SM1				5
+#define SE				6
+#define SM2				7
+
 /* External Interrupts */
 #define ISC00			0
 #define ISC01			1
@@ -312,6 +322,9 @@
 #define TWA5			6
 #define TWA6			7
 
+#define TWI_SCL_PIN		PC0
+#define TWI_SDA_PIN		PC1
+
 /* Interrupt vectors */
 /* External Interrupt Request 0 */
 #define INT0_vect				_VECTOR(1)
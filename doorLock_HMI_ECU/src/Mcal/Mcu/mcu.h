@@ -1,6 +1,17 @@
 #ifndef __MCU_H__
 #define __MCU_H__
 
+/* memory mapped register access, can be overridden by a host build
+ * that maps the registers to a simulated peripheral model
+ */
+#ifndef MCU_REG8
+#define MCU_REG8(ADDR)		(*(volatile uint8_t*)(ADDR))
+#endif
+
+#ifndef MCU_REG16
+#define MCU_REG16(ADDR)		(*(volatile uint16_t*)(ADDR))
+#endif
+
 #if defined (__AVR_ATmega16__)
 #include "Mcus/atmega16.h"
 #elif defined (__AVR_ATmega32__)
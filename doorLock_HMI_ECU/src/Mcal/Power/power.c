@@ -0,0 +1,180 @@
+/******************************************************************************
+ *
+ * Module: POWER
+ *
+ * File Name: power.c
+ *
+ * Description: Source file for the AVR sleep modes driver
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module header file */
+#include "power.h"
+
+/* For using mcu registers */
+#include "../Mcu/mcu.h"
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* time source of the sleep time, NULL if the time isn't counted */
+static uint32_t (* g_nowUs)(void) = NULL;
+
+/* residency counters of the sleep modes */
+static ST_PowerStats g_powerStats;
+
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: POWER_init
+ * [Function Description]: resets the residency counters and sets the time source of the sleep time
+ * [Args]:
+ * [in]: uint32_t (* a_nowUs)(void)
+ * 		 function returning a time in us that can be read with the interrupts
+ * 		 disabled, or NULL to count the sleeps only
+ * [Return]: void
+ */
+void POWER_init(uint32_t (* a_nowUs)(void))
+{
+	uint8_t mode;
+
+	g_nowUs = a_nowUs;
+
+	for(mode = 0; mode < POWER_SLEEP_MODES_COUNT; mode ++)
+	{
+		g_powerStats.sleeps[mode] = 0;
+		g_powerStats.timeUs[mode] = 0;
+	}
+
+	/* sleep enable is set only right before the sleep instruction */
+	CLEAR_BIT(MCUCR_R, SE);
+}
+
+/*
+ * [Function Name]: POWER_deepestMode
+ * [Function Description]: gets the deepest sleep mode that keeps all the wake up sources running
+ * [Args]:
+ * [in]: uint8_t a_wakeSources
+ * 		 ored POWER_WAKE_xxx sources
+ * [Return]: EN_PowerSleepMode
+ * 			 deepest possible sleep mode
+ */
+EN_PowerSleepMode POWER_deepestMode(uint8_t a_wakeSources)
+{
+	/* the uart and the synchronous timers need the io clock */
+	if(a_wakeSources & (POWER_WAKE_UART | POWER_WAKE_TIMERS))
+	{
+		return POWER_IDLE;
+	}
+
+	/* the adc needs its own clock */
+	if(a_wakeSources & POWER_WAKE_ADC)
+	{
+		return POWER_ADC_NOISE_REDUCTION;
+	}
+
+	/* the async timer needs the oscillator of the TOSC pins */
+	if(a_wakeSources & POWER_WAKE_TIMER2_ASYNC)
+	{
+		return POWER_SAVE;
+	}
+
+	/* the external interrupts work without any clock */
+	return POWER_DOWN;
+}
+
+/*
+ * [Function Name]: POWER_sleep
+ * [Function Description]: sleeps till an interrupt wakes the cpu up and its ISR runs,
+ * 						   it must be called with the global interrupt disabled after
+ * 						   checking that there is nothing to do, so an interrupt between
+ * 						   the check and the sleep still wakes the cpu up,
+ * 						   it returns with the global interrupt enabled
+ * [Args]:
+ * [in]: EN_PowerSleepMode a_mode
+ * 		 sleep mode
+ * [Return]: void
+ */
+void POWER_sleep(EN_PowerSleepMode a_mode)
+{
+	uint32_t sleptAt = 0;
+
+	if(g_nowUs != NULL)
+	{
+		sleptAt = g_nowUs();
+	}
+
+	/* SM2 isn't next to SM1:0 and its place differs between the mcus */
+	COPY_BITS(MCUCR_R, 0x03, a_mode, SM0);
+	if(a_mode & 0x04)
+	{
+		SET_BIT(MCUCR_R, SM2);
+	}
+	else
+	{
+		CLEAR_BIT(MCUCR_R, SM2);
+	}
+	SET_BIT(MCUCR_R, SE);
+
+	/* the instruction after sei is always executed before any pending
+	 * interrupt, so an interrupt that came after the check of the caller
+	 * wakes the cpu up right after it sleeps */
+	ENABLE_GLOBAL_INTERRUPT();
+	CPU_SLEEP();
+
+	CLEAR_BIT(MCUCR_R, SE);
+
+	g_powerStats.sleeps[a_mode] ++;
+	if(g_nowUs != NULL)
+	{
+		g_powerStats.timeUs[a_mode] += g_nowUs() - sleptAt;
+	}
+}
+
+/*
+ * [Function Name]: POWER_sleepWhile
+ * [Function Description]: sleeps in the deepest possible mode as long as the condition is true,
+ * 						   the condition is checked with the global interrupt disabled so it
+ * 						   must be short and must not wait for an interrupt,
+ * 						   it returns with the global interrupt enabled
+ * [Args]:
+ * [in]: boolean (* a_condition)(void)
+ * 		 condition to keep sleeping
+ * [in]: uint8_t a_wakeSources
+ * 		 ored POWER_WAKE_xxx sources that may end the condition
+ * [Return]: void
+ */
+void POWER_sleepWhile(boolean (* a_condition)(void), uint8_t a_wakeSources)
+{
+	EN_PowerSleepMode mode = POWER_deepestMode(a_wakeSources);
+
+	DISABLE_GLOBAL_INTERRUPT();
+	while(a_condition())
+	{
+		POWER_sleep(mode);
+		DISABLE_GLOBAL_INTERRUPT();
+	}
+	ENABLE_GLOBAL_INTERRUPT();
+}
+
+/*
+ * [Function Name]: POWER_getStats
+ * [Function Description]: gets the residency counters of the sleep modes
+ * [Args]:
+ * [out]: ST_PowerStats * a_stats
+ * 		  structure to store the counters
+ * [Return]: void
+ */
+void POWER_getStats(ST_PowerStats * a_stats)
+{
+	*a_stats = g_powerStats;
+}
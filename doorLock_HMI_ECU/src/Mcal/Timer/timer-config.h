@@ -24,10 +24,15 @@
 
 /* Timer used when calling the TIMER_delay() function */
 /* can be TIMER_0, TIMER_1, or TIMER_2 */
-#define DELAY_TIMER			TIMER_2
+/* it's not defined in this ECU, so the TIMER_delay() functions aren't built:
+ * TIMER_0 is the lcd flush, TIMER_1 is the system clock and TIMER_2 is the
+ * keypad scan, SYSCLK_delayMs() and SYSCLK_delayUs() wait on the system clock instead
+ */
+/* #define DELAY_TIMER			TIMER_2 */
 
-/* overhead delay time in ms, depending on optimization level */
-/* should be decreased when increasing clock frequency (F_CPU) */
-#define DELAY_OVERHEAD		0.1
+/* overhead of a delay call in cpu cycles, depending on optimization level,
+ * it's subtracted from every delay
+ */
+#define DELAY_OVERHEAD_CYCLES	30
 
 #endif /* __TIMER_CONFIG_H__ */
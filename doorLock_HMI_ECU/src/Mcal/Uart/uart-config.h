@@ -22,6 +22,16 @@
  */
 #define UART_RECEIVE_STRING_TILL			'\r'
 
+/* size of the rx ring buffer in bytes, filled by the rx interrupt
+ * must be a power of two and not more than 128
+ */
+#define UART_RX_BUFFER_SIZE					32
+
+/* size of the tx ring buffer in bytes, drained by the data register empty interrupt
+ * must be a power of two and not more than 128
+ */
+#define UART_TX_BUFFER_SIZE					32
+
 /* Define F_CPU if not defined to calculate baud rate correctly */
 #ifndef F_CPU
 #define F_CPU 								1000000UL
@@ -20,6 +20,22 @@
 /* For using mcu registers */
 #include "../Mcu/mcu.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#if (UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1)) != 0 || UART_RX_BUFFER_SIZE > 128
+#error "UART_RX_BUFFER_SIZE must be a power of two and not more than 128"
+#endif
+
+#if (UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1)) != 0 || UART_TX_BUFFER_SIZE > 128
+#error "UART_TX_BUFFER_SIZE must be a power of two and not more than 128"
+#endif
+
+/* masks to wrap the free running indices into the buffers */
+#define UART_RX_BUFFER_MASK			(UART_RX_BUFFER_SIZE - 1)
+#define UART_TX_BUFFER_MASK			(UART_TX_BUFFER_SIZE - 1)
+
 /*******************************************************************************
  *                            Global Variables	                               *
  *******************************************************************************/
@@ -30,6 +46,19 @@ static void (* volatile g_uartRxPtrToHandler)(void) = NULL;
 /* pointer to tx interrupt handler */
 static void (* volatile g_uartTxPtrToHandler)(void) = NULL;
 
+/* rx ring buffer, filled by the rx isr and emptied by UART_readByte */
+static volatile uint8_t g_uartRxBuffer[UART_RX_BUFFER_SIZE];
+
+/* tx ring buffer, filled by UART_queueByte and emptied by the data register empty isr */
+static volatile uint8_t g_uartTxBuffer[UART_TX_BUFFER_SIZE];
+
+/* free running indices of the ring buffers, the head is written only by the producer
+ * and the tail only by the consumer, so no critical section is needed,
+ * number of bytes in a buffer = (uint8_t)(head - tail)
+ */
+static volatile uint8_t g_uartRxHead = 0, g_uartRxTail = 0;
+static volatile uint8_t g_uartTxHead = 0, g_uartTxTail = 0;
+
 /*******************************************************************************
  *                          Functions Definition	                           *
  *******************************************************************************/
@@ -51,11 +80,18 @@ void UART_init(const ST_UartConfig * a_uartConfig)
 {
 	uint16_t ubrrValue = 0;
 
+	/* start with empty rx and tx buffers */
+	g_uartRxHead = 0;
+	g_uartRxTail = 0;
+	g_uartTxHead = 0;
+	g_uartTxTail = 0;
+
 	/* U2X = 1 for double transmission speed */
 	UCSRA_R = SELECT_BIT(U2X);
 
 	/************************** UCSRB Description **************************
-	 * UDRIE = 0 Disable USART Data Register Empty Interrupt Enable
+	 * UDRIE = 0 Disable USART Data Register Empty Interrupt Enable,
+	 * 		   it's enabled by UART_queueByte only while the tx buffer has data
 	 * RXEN  = 1 Receiver Enable
 	 * RXEN  = 1 Transmitter Enable
 	 * RXB8 & TXB8 = 0 not used
@@ -127,9 +163,13 @@ void UART_setTxInterruptCallback(void (* volatile a_ptrToHandler)(void))
 
 /*
  * [Function Name]: UART_sendByteBlocking
- * [Function Description]: This function uses busy wait till the send buffer
- * 						   is empty to send the byte. It can be used whether
- * 						   Tx interrupt is enabled or not.
+ * [Function Description]: This function queues the byte in the tx buffer,
+ * 						   It uses busy wait only if the tx buffer is full
+ * 						   till the data register empty interrupt makes room for it,
+ * 						   or if the global interrupt is disabled (inside an interrupt
+ * 						   or a critical section) it sends the oldest queued bytes
+ * 						   itself by polling the data register empty flag.
+ * 						   It can be used whether Tx interrupt is enabled or not.
  * 						   If Tx interrupt is enabled,
  * 						   It will generate Tx interrupt after sending
  * [Args]:
@@ -139,27 +179,26 @@ void UART_setTxInterruptCallback(void (* volatile a_ptrToHandler)(void))
  */
 void UART_sendByteBlocking(const uint8_t a_data)
 {
-	/*
-	 * wait till the transfer buffer is empty
-	 */
-	while(!UART_TxIsEmpty());
-
-	/*
-	 * Put the required data in the UDR register and it also clear the UDRE flag as
-	 * the UDR register is not empty now
-	 */
-	UDR_R = a_data;
+	/* wait till the tx buffer has room for the byte */
+	while(UART_queueByte(a_data) == UART_ERROR)
+	{
+		/* the data register empty interrupt can't drain the buffer
+		 * while the global interrupt is disabled */
+		if(BIT_IS_CLEAR(SREG_R, SREG_I) && BIT_IS_SET(UCSRA_R, UDRE))
+		{
+			UDR_R = g_uartTxBuffer[g_uartTxTail & UART_TX_BUFFER_MASK];
+			g_uartTxTail ++;
+		}
+	}
 }
 
 /*
  * [Function Name]: UART_sendByteNonBlocking
- * [Function Description]: The function checks if the send buffer is ready,
- * 						   It will send the byte, otherwise it will do nothing.
+ * [Function Description]: The function checks if the tx buffer has room,
+ * 						   It will queue the byte, otherwise it will do nothing.
  * 						   It doesn't use any busy wait.
- * 						   The best use of this function is to wait till a flag is changed
- * 						   in the callback of tx interrupt then send data using this function
- * 						   to be sure data is sent. otherwise, you can use
- * 						   UART_sendBytePolling to send data safely
+ * 						   Use UART_queueByte instead if you need to know
+ * 						   whether the byte was queued or not
  * 						   If Tx interrupt is enabled,
  * 						   It will generate Tx interrupt after sending
  * [Args]:
@@ -169,19 +208,14 @@ void UART_sendByteBlocking(const uint8_t a_data)
  */
 void UART_sendByteNonBlocking(const uint8_t a_data)
 {
-	/*
-	 * check if the transfer buffer is empty and ready to receive new data
-	 */
-	if(UART_TxIsEmpty())
-	{
-		/* send data */
-		UDR_R = a_data;
-	}
+	/* the byte is dropped if the tx buffer is full */
+	UART_queueByte(a_data);
 }
 
 /*
  * [Function Name]: UART_receiveByteBlocking
- * [Function Description]: The function uses busy wait till a byte is received
+ * [Function Description]: The function returns the oldest byte in the rx buffer if any,
+ * 						   otherwise it uses busy wait till a byte is received
  * 						   It can be used whether Rx interrupt is enabled or not
  * 						   If rx interrupt is enabled it will be disabled temporarely
  * 						   during the function time then re-enabled again
@@ -205,14 +239,18 @@ uint8_t UART_receiveByteBlocking(void)
 		rxInterruptEnabled = TRUE;
 	}
 
-	/* wait till data is available in receive buffer */
-	while(!UART_DataIsAvailable());
+	/* bytes already received by the rx interrupt come first */
+	if(UART_readByte(&data) == UART_ERROR)
+	{
+		/* wait till data is available in receive register */
+		while(BIT_IS_CLEAR(UCSRA_R, RXC));
 
-	/*
-	 * Read the received data from the Rx buffer (UDR)
-	 * The RXC flag will be cleared after read the data
-	 */
-	data = UDR_R;
+		/*
+		 * Read the received data from the Rx buffer (UDR)
+		 * The RXC flag will be cleared after read the data
+		 */
+		data = UDR_R;
+	}
 
 	/* re-enable rx enterrupt if it was enabled before entering the function */
 	if(rxInterruptEnabled == TRUE)
@@ -226,11 +264,10 @@ uint8_t UART_receiveByteBlocking(void)
 
 /*
  * [Function Name]: UART_receiveByteNonBlocking
- * [Function Description]: The function checks if the receive buffer has data,
+ * [Function Description]: The function checks if the rx buffer or the receive register has data,
  * 						   It will return the data, otherwise it will return 0.
  * 						   It doesn't use any busy wait.
- * 						   The best use of this function is to be called in callback
- * 						   function after an Rx interrupt has occurred to get the received byte.
+ * 						   Use UART_readByte instead if 0 is a valid received byte
  * [Args]:
  * [in]: void
  * [Return]: uint8_t
@@ -238,8 +275,16 @@ uint8_t UART_receiveByteBlocking(void)
  */
 uint8_t UART_receiveByteNonBlocking(void)
 {
-	/* check if data is available in the receive buffer */
-	if(UART_DataIsAvailable())
+	uint8_t data;
+
+	/* bytes already received by the rx interrupt come first */
+	if(UART_readByte(&data) == UART_SUCCESS)
+	{
+		return data;
+	}
+
+	/* check if data is available in the receive register */
+	if(BIT_IS_SET(UCSRA_R, RXC))
 	{
 		/*
 		 * Read the received data from the Rx buffer (UDR)
@@ -328,8 +373,8 @@ void UART_receiveString(uint8_t * a_str, uint8_t a_maxSize)
 
 /*
  * [Function Name]: UART_DataIsAvailable
- * [Function Description]: The function checks if the receive buffer has data
- * 						   available in it or not
+ * [Function Description]: The function checks if the rx buffer or the receive register
+ * 						   has data available in it or not
  * [Args]:
  * [in]: void
  * [Return]: uint8_t
@@ -338,8 +383,8 @@ void UART_receiveString(uint8_t * a_str, uint8_t a_maxSize)
  */
 uint8_t UART_DataIsAvailable(void)
 {
-	/* check if RXC flag is set (the UART receive data) */
-	return BIT_IS_SET(UCSRA_R, RXC);
+	/* check if the rx buffer is not empty or the RXC flag is set (the UART receive data) */
+	return (g_uartRxHead != g_uartRxTail) || BIT_IS_SET(UCSRA_R, RXC);
 }
 
 /*
@@ -357,6 +402,178 @@ uint8_t UART_TxIsEmpty(void)
 	return BIT_IS_SET(UCSRA_R, UDRE);
 }
 
+/*
+ * [Function Name]: UART_queueByte
+ * [Function Description]: queues a byte in the tx buffer and returns immediately,
+ * 						   the byte is sent later by the data register empty interrupt
+ * 						   so the global interrupt must be enabled
+ * [Args]:
+ * [in]: const uint8_t a_data
+ * 		 data to be queued
+ * [Return]: uint8_t
+ * 			 UART_SUCCESS if the byte is queued
+ * 			 UART_ERROR if the tx buffer is full
+ */
+uint8_t UART_queueByte(const uint8_t a_data)
+{
+	/* check if the tx buffer is full */
+	if((uint8_t)(g_uartTxHead - g_uartTxTail) >= UART_TX_BUFFER_SIZE)
+	{
+		return UART_ERROR;
+	}
+
+	/* put the byte in the buffer then publish it by moving the head */
+	g_uartTxBuffer[g_uartTxHead & UART_TX_BUFFER_MASK] = a_data;
+	g_uartTxHead ++;
+
+	/* enable the data register empty interrupt to drain the buffer */
+	SET_BIT(UCSRB_R, UDRIE);
+
+	return UART_SUCCESS;
+}
+
+/*
+ * [Function Name]: UART_queueBytes
+ * [Function Description]: queues an array of bytes in the tx buffer and returns immediately,
+ * 						   either all the bytes are queued or none of them
+ * [Args]:
+ * [in]: const uint8_t * a_data
+ * 		 array of bytes to be queued
+ * [in]: uint8_t a_size
+ * 		 number of bytes in the array
+ * [Return]: uint8_t
+ * 			 UART_SUCCESS if all the bytes are queued
+ * 			 UART_ERROR if the tx buffer has no room for all of them
+ */
+uint8_t UART_queueBytes(const uint8_t * a_data, uint8_t a_size)
+{
+	uint8_t head = g_uartTxHead;
+
+	/* check if the tx buffer has room for all the bytes */
+	if(a_size > UART_txFree())
+	{
+		return UART_ERROR;
+	}
+
+	/* copy all bytes first then publish them at once */
+	while(a_size --)
+	{
+		g_uartTxBuffer[head & UART_TX_BUFFER_MASK] = *a_data;
+		a_data ++;
+		head ++;
+	}
+	g_uartTxHead = head;
+
+	/* enable the data register empty interrupt to drain the buffer */
+	SET_BIT(UCSRB_R, UDRIE);
+
+	return UART_SUCCESS;
+}
+
+/*
+ * [Function Name]: UART_txFree
+ * [Function Description]: gets the number of free bytes in the tx buffer
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 number of bytes that can be queued without blocking
+ */
+uint8_t UART_txFree(void)
+{
+	return UART_TX_BUFFER_SIZE - (uint8_t)(g_uartTxHead - g_uartTxTail);
+}
+
+/*
+ * [Function Name]: UART_flushTx
+ * [Function Description]: busy wait till all the queued bytes are moved
+ * 						   to the transmitter
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void UART_flushTx(void)
+{
+	/* wait till the isr empties the buffer and the data register */
+	while(g_uartTxHead != g_uartTxTail || !UART_TxIsEmpty());
+}
+
+/*
+ * [Function Name]: UART_rxAvailable
+ * [Function Description]: gets the number of received bytes waiting in the rx buffer,
+ * 						   the rx buffer is filled only if the rx interrupt is enabled
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 number of bytes in the rx buffer
+ */
+uint8_t UART_rxAvailable(void)
+{
+	return (uint8_t)(g_uartRxHead - g_uartRxTail);
+}
+
+/*
+ * [Function Name]: UART_readByte
+ * [Function Description]: removes the oldest byte from the rx buffer
+ * [Args]:
+ * [out]: uint8_t * a_data
+ * 		  pointer to the location where the byte will be saved,
+ * 		  not changed if the rx buffer is empty
+ * [Return]: uint8_t
+ * 			 UART_SUCCESS if a byte is read
+ * 			 UART_ERROR if the rx buffer is empty
+ */
+uint8_t UART_readByte(uint8_t * a_data)
+{
+	/* check if the rx buffer is empty */
+	if(g_uartRxHead == g_uartRxTail)
+	{
+		return UART_ERROR;
+	}
+
+	/* get the byte then release its place by moving the tail */
+	*a_data = g_uartRxBuffer[g_uartRxTail & UART_RX_BUFFER_MASK];
+	g_uartRxTail ++;
+
+	return UART_SUCCESS;
+}
+
+/*
+ * [Function Name]: UART_peekByte
+ * [Function Description]: gets the oldest byte in the rx buffer without removing it
+ * [Args]:
+ * [out]: uint8_t * a_data
+ * 		  pointer to the location where the byte will be saved,
+ * 		  not changed if the rx buffer is empty
+ * [Return]: uint8_t
+ * 			 UART_SUCCESS if a byte is available
+ * 			 UART_ERROR if the rx buffer is empty
+ */
+uint8_t UART_peekByte(uint8_t * a_data)
+{
+	/* check if the rx buffer is empty */
+	if(g_uartRxHead == g_uartRxTail)
+	{
+		return UART_ERROR;
+	}
+
+	*a_data = g_uartRxBuffer[g_uartRxTail & UART_RX_BUFFER_MASK];
+
+	return UART_SUCCESS;
+}
+
+/*
+ * [Function Name]: UART_flushRx
+ * [Function Description]: discards all the bytes in the rx buffer
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void UART_flushRx(void)
+{
+	/* the tail is owned by the consumer, so moving it to the head is enough */
+	g_uartRxTail = g_uartRxHead;
+}
+
 /*******************************************************************************
  *                       Interrupt Service Routines                            *
  *******************************************************************************/
@@ -364,18 +581,36 @@ uint8_t UART_TxIsEmpty(void)
 /* ISR for uart Rx */
 ISR(USART_RXC_vect)
 {
+	/* reading the data clears the RX flag */
+	uint8_t data = UDR_R;
+
+	/* push the byte to the rx buffer, it's dropped if the buffer is full */
+	if((uint8_t)(g_uartRxHead - g_uartRxTail) < UART_RX_BUFFER_SIZE)
+	{
+		g_uartRxBuffer[g_uartRxHead & UART_RX_BUFFER_MASK] = data;
+		g_uartRxHead ++;
+	}
+
 	if(g_uartRxPtrToHandler != NULL)
 	{
 		(*g_uartRxPtrToHandler)();
 	}
+}
+
+/* ISR for uart data register empty */
+ISR(USART_UDRE_vect)
+{
+	/* send the oldest queued byte */
+	if(g_uartTxHead != g_uartTxTail)
+	{
+		UDR_R = g_uartTxBuffer[g_uartTxTail & UART_TX_BUFFER_MASK];
+		g_uartTxTail ++;
+	}
 
-	/* The RX flag is cleared only when data is read
-	 * so, this condition checks if it's not cleared (read) in the
-	 * callback, it reads the data to clear it
-	 */
-	if(UART_DataIsAvailable())
+	/* disable the interrupt till new bytes are queued */
+	if(g_uartTxHead == g_uartTxTail)
 	{
-		UART_receiveByteNonBlocking();
+		CLEAR_BIT(UCSRB_R, UDRIE);
 	}
 }
 
@@ -26,6 +26,18 @@
 /* For using common defines and macros */
 #include "../../Lib/common.h"
 
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* returned from the buffer functions if the operation completed successfully */
+#define UART_SUCCESS						1
+
+/* returned from the buffer functions if the tx buffer is full
+ * or the rx buffer is empty
+ */
+#define UART_ERROR							0
+
 /*******************************************************************************
  *                             Types Declaration                               *
  *******************************************************************************/
@@ -133,7 +145,9 @@ void UART_init(const ST_UartConfig * a_uartConfig);
  * [Function Name]: UART_setRxInterruptCallback
  * [Function Description]: sets the callback function of the receive interrupt
  * 						   should be used only if the rx interrupt is enabled.
- * 						   Otherwise it's meaningless
+ * 						   Otherwise it's meaningless.
+ * 						   The received byte is already pushed to the rx buffer
+ * 						   when the callback is called, use UART_readByte to get it
  * [Args]:
  * [in]: void (* volatile a_ptrToHandler)(void)
  * 		 pointer to the callback function
@@ -155,9 +169,13 @@ void UART_setTxInterruptCallback(void (* volatile a_ptrToHandler)(void));
 
 /*
  * [Function Name]: UART_sendByteBlocking
- * [Function Description]: This function uses busy wait till the send buffer
- * 						   is empty to send the byte. It can be used whether
- * 						   Tx interrupt is enabled or not.
+ * [Function Description]: This function queues the byte in the tx buffer,
+ * 						   It uses busy wait only if the tx buffer is full
+ * 						   till the data register empty interrupt makes room for it,
+ * 						   or if the global interrupt is disabled (inside an interrupt
+ * 						   or a critical section) it sends the oldest queued bytes
+ * 						   itself by polling the data register empty flag.
+ * 						   It can be used whether Tx interrupt is enabled or not.
  * 						   If Tx interrupt is enabled,
  * 						   It will generate Tx interrupt after sending
  * [Args]:
@@ -169,13 +187,11 @@ void UART_sendByteBlocking(const uint8_t a_data);
 
 /*
  * [Function Name]: UART_sendByteNonBlocking
- * [Function Description]: The function checks if the send buffer is ready,
- * 						   It will send the byte, otherwise it will do nothing.
+ * [Function Description]: The function checks if the tx buffer has room,
+ * 						   It will queue the byte, otherwise it will do nothing.
  * 						   It doesn't use any busy wait.
- * 						   The best use of this function is to wait till a flag is changed
- * 						   in the callback of tx interrupt then send data using this function
- * 						   to be sure data is sent. otherwise, you can use
- * 						   UART_sendBytePolling to send data safely
+ * 						   Use UART_queueByte instead if you need to know
+ * 						   whether the byte was queued or not
  * 						   If Tx interrupt is enabled,
  * 						   It will generate Tx interrupt after sending
  * [Args]:
@@ -187,7 +203,8 @@ void UART_sendByteNonBlocking(const uint8_t a_data);
 
 /*
  * [Function Name]: UART_receiveByteBlocking
- * [Function Description]: The function uses busy wait till a byte is received
+ * [Function Description]: The function returns the oldest byte in the rx buffer if any,
+ * 						   otherwise it uses busy wait till a byte is received
  * 						   It can be used whether Rx interrupt is enabled or not
  * 						   If rx interrupt is enabled it will be disabled temporarely
  * 						   during the function time then re-enabled again
@@ -202,11 +219,10 @@ uint8_t UART_receiveByteBlocking(void);
 
 /*
  * [Function Name]: UART_receiveByteNonBlocking
- * [Function Description]: The function checks if the receive buffer has data,
+ * [Function Description]: The function checks if the rx buffer or the receive register has data,
  * 						   It will return the data, otherwise it will return 0.
  * 						   It doesn't use any busy wait.
- * 						   The best use of this function is to be called in callback
- * 						   function after an Rx interrupt has occurred to get the received byte.
+ * 						   Use UART_readByte instead if 0 is a valid received byte
  * [Args]:
  * [in]: void
  * [Return]: uint8_t
@@ -244,8 +260,8 @@ void UART_receiveString(uint8_t * a_str, uint8_t a_maxSize);
 
 /*
  * [Function Name]: UART_DataIsAvailable
- * [Function Description]: The function checks if the receive buffer has data
- * 						   available in it or not
+ * [Function Description]: The function checks if the rx buffer or the receive register
+ * 						   has data available in it or not
  * [Args]:
  * [in]: void
  * [Return]: uint8_t
@@ -265,4 +281,99 @@ uint8_t UART_DataIsAvailable(void);
  */
 uint8_t UART_TxIsEmpty(void);
 
+/*
+ * [Function Name]: UART_queueByte
+ * [Function Description]: queues a byte in the tx buffer and returns immediately,
+ * 						   the byte is sent later by the data register empty interrupt
+ * 						   so the global interrupt must be enabled
+ * [Args]:
+ * [in]: const uint8_t a_data
+ * 		 data to be queued
+ * [Return]: uint8_t
+ * 			 UART_SUCCESS if the byte is queued
+ * 			 UART_ERROR if the tx buffer is full
+ */
+uint8_t UART_queueByte(const uint8_t a_data);
+
+/*
+ * [Function Name]: UART_queueBytes
+ * [Function Description]: queues an array of bytes in the tx buffer and returns immediately,
+ * 						   either all the bytes are queued or none of them
+ * [Args]:
+ * [in]: const uint8_t * a_data
+ * 		 array of bytes to be queued
+ * [in]: uint8_t a_size
+ * 		 number of bytes in the array
+ * [Return]: uint8_t
+ * 			 UART_SUCCESS if all the bytes are queued
+ * 			 UART_ERROR if the tx buffer has no room for all of them
+ */
+uint8_t UART_queueBytes(const uint8_t * a_data, uint8_t a_size);
+
+/*
+ * [Function Name]: UART_txFree
+ * [Function Description]: gets the number of free bytes in the tx buffer
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 number of bytes that can be queued without blocking
+ */
+uint8_t UART_txFree(void);
+
+/*
+ * [Function Name]: UART_flushTx
+ * [Function Description]: busy wait till all the queued bytes are moved
+ * 						   to the transmitter
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void UART_flushTx(void);
+
+/*
+ * [Function Name]: UART_rxAvailable
+ * [Function Description]: gets the number of received bytes waiting in the rx buffer,
+ * 						   the rx buffer is filled only if the rx interrupt is enabled
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 number of bytes in the rx buffer
+ */
+uint8_t UART_rxAvailable(void);
+
+/*
+ * [Function Name]: UART_readByte
+ * [Function Description]: removes the oldest byte from the rx buffer
+ * [Args]:
+ * [out]: uint8_t * a_data
+ * 		  pointer to the location where the byte will be saved,
+ * 		  not changed if the rx buffer is empty
+ * [Return]: uint8_t
+ * 			 UART_SUCCESS if a byte is read
+ * 			 UART_ERROR if the rx buffer is empty
+ */
+uint8_t UART_readByte(uint8_t * a_data);
+
+/*
+ * [Function Name]: UART_peekByte
+ * [Function Description]: gets the oldest byte in the rx buffer without removing it
+ * [Args]:
+ * [out]: uint8_t * a_data
+ * 		  pointer to the location where the byte will be saved,
+ * 		  not changed if the rx buffer is empty
+ * [Return]: uint8_t
+ * 			 UART_SUCCESS if a byte is available
+ * 			 UART_ERROR if the rx buffer is empty
+ */
+uint8_t UART_peekByte(uint8_t * a_data);
+
+/*
+ * [Function Name]: UART_flushRx
+ * [Function Description]: discards all the bytes in the rx buffer
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void UART_flushRx(void);
+
 #endif /* __UART_H__ */
@@ -0,0 +1,33 @@
+/******************************************************************************
+ *
+ * Module: CRC8
+ *
+ * File Name: crc8-config.h
+ *
+ * Description: Config file for the crc-8 service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __CRC8_CONFIG_H__
+#define __CRC8_CONFIG_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* For using the crc shared with the other MCU */
+#include "../../../../doorLock_Common/Protocol/protocol.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* polynomial and initial value of the crc, the frames of the link are checked
+ * with it, so it must be the same in both MCUs
+ */
+#define CRC8_POLYNOMIAL						PROTOCOL_CRC8_POLYNOMIAL
+#define CRC8_INIT							PROTOCOL_CRC8_INIT
+
+#endif /* __CRC8_CONFIG_H__ */
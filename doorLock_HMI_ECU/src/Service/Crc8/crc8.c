@@ -0,0 +1,76 @@
+/******************************************************************************
+ *
+ * Module: CRC8
+ *
+ * File Name: crc8.c
+ *
+ * Description: Source file for the crc-8 service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module header file */
+#include "crc8.h"
+
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: CRC8_update
+ * [Function Description]: adds a byte to the crc, the crc of the first byte
+ * 						   starts from CRC8_INIT
+ * [Args]:
+ * [in]: uint8_t a_crc
+ * 		 crc of the previous bytes
+ * [in]: uint8_t a_data
+ * 		 the new byte
+ * [Return]: uint8_t
+ * 			 the updated crc
+ */
+uint8_t CRC8_update(uint8_t a_crc, uint8_t a_data)
+{
+	uint8_t bitIndex;
+
+	a_crc ^= a_data;
+	for(bitIndex = 0; bitIndex < 8; bitIndex ++)
+	{
+		if(a_crc & 0x80)
+		{
+			a_crc = (uint8_t)(a_crc << 1) ^ CRC8_POLYNOMIAL;
+		}
+		else
+		{
+			a_crc <<= 1;
+		}
+	}
+	return a_crc;
+}
+
+/*
+ * [Function Name]: CRC8_calculate
+ * [Function Description]: calculates the crc of a buffer
+ * [Args]:
+ * [in]: const uint8_t * a_data
+ * 		 bytes to check
+ * [in]: uint8_t a_size
+ * 		 number of bytes
+ * [Return]: uint8_t
+ * 			 crc of the bytes
+ */
+uint8_t CRC8_calculate(const uint8_t * a_data, uint8_t a_size)
+{
+	uint8_t crc = CRC8_INIT;
+	uint8_t index;
+
+	for(index = 0; index < a_size; index ++)
+	{
+		crc = CRC8_update(crc, a_data[index]);
+	}
+	return crc;
+}
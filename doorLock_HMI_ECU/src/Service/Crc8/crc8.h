@@ -0,0 +1,62 @@
+/******************************************************************************
+ *
+ * Module: CRC8
+ *
+ * File Name: crc8.h
+ *
+ * Description: Header file for the crc-8 service, it's calculated bit by bit
+ * 				msb first with no final xor, by one call for a buffer or one
+ * 				call per byte for bytes that arrive one at a time
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __CRC8_H__
+#define __CRC8_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module config file */
+#include "crc8-config.h"
+
+/* For using std types */
+#include "../../Lib/types.h"
+
+/* For using common defines and macros */
+#include "../../Lib/common.h"
+
+/*******************************************************************************
+ *                           Function Prototypes                               *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: CRC8_update
+ * [Function Description]: adds a byte to the crc, the crc of the first byte
+ * 						   starts from CRC8_INIT
+ * [Args]:
+ * [in]: uint8_t a_crc
+ * 		 crc of the previous bytes
+ * [in]: uint8_t a_data
+ * 		 the new byte
+ * [Return]: uint8_t
+ * 			 the updated crc
+ */
+uint8_t CRC8_update(uint8_t a_crc, uint8_t a_data);
+
+/*
+ * [Function Name]: CRC8_calculate
+ * [Function Description]: calculates the crc of a buffer
+ * [Args]:
+ * [in]: const uint8_t * a_data
+ * 		 bytes to check
+ * [in]: uint8_t a_size
+ * 		 number of bytes
+ * [Return]: uint8_t
+ * 			 crc of the bytes
+ */
+uint8_t CRC8_calculate(const uint8_t * a_data, uint8_t a_size);
+
+#endif /* __CRC8_H__ */
@@ -0,0 +1,189 @@
+/******************************************************************************
+ *
+ * Module: LINK
+ *
+ * File Name: link.h
+ *
+ * Description: Header file for the framed link between the two MCUs over the uart,
+ * 				frames are built and checked as defined in protocol.h
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __LINK_H__
+#define __LINK_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* For using the frame format */
+#include "../../../../doorLock_Common/Protocol/protocol.h"
+
+/* For using std types */
+#include "../../Lib/types.h"
+
+/* For using common defines and macros */
+#include "../../Lib/common.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* return values of the link functions */
+#define LINK_SUCCESS						1
+#define LINK_ERROR							0
+
+/* time the other MCU has to confirm a sent frame before it's resent */
+#define LINK_RESPONSE_TIMEOUT_MS			250
+
+/* number of times an unconfirmed frame is resent before the link is reported broken,
+ * it also limits the retransmissions for the duplicates of the same frame
+ */
+#define LINK_MAX_RETRIES					3
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Struct Name]: ST_LinkStats
+ * [Struct Description]: counters of the link, used to monitor the line quality
+ */
+typedef struct
+{
+	/* number of sent frames excluding retransmissions and naks */
+	uint16_t txFrames;
+
+	/* number of accepted frames */
+	uint16_t rxFrames;
+
+	/* number of dropped frames with a wrong length or crc */
+	uint16_t crcErrors;
+
+	/* number of dropped frames that were already accepted before */
+	uint16_t duplicates;
+
+	/* number of resent frames, after receiving a nak or a duplicate */
+	uint16_t retransmissions;
+
+	/* number of frames resent as they weren't confirmed in time */
+	uint16_t timeouts;
+
+}ST_LinkStats;
+
+/*******************************************************************************
+ *                           Function Prototypes                               *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: LINK_init
+ * [Function Description]: resets the link state and counters,
+ * 						   the uart must be initialized with rx interrupt enabled
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void LINK_init(void);
+
+/*
+ * [Function Name]: LINK_sendFrame
+ * [Function Description]: builds a frame with the next sequence number around the payload
+ * 						   and queues it in the uart tx buffer, it waits only if the
+ * 						   tx buffer doesn't have room for the whole frame,
+ * 						   the frame is kept to be resent if the other MCU asks for it
+ * [Args]:
+ * [in]: const uint8_t * a_payload
+ * 		 batch of commands to send
+ * [in]: uint8_t a_size
+ * 		 payload size, from 1 to PROTOCOL_MAX_PAYLOAD_SIZE
+ * [Return]: uint8_t
+ * 			 LINK_SUCCESS if the frame is queued
+ * 			 LINK_ERROR if the payload size is not valid
+ */
+uint8_t LINK_sendFrame(const uint8_t * a_payload, uint8_t a_size);
+
+/*
+ * [Function Name]: LINK_frameIsAvailable
+ * [Function Description]: parses the received bytes and checks if a complete frame
+ * 						   is waiting to be read, it doesn't use any busy wait
+ * 						   so it can be used in await loops
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if a frame is available, FALSE otherwise
+ */
+boolean LINK_frameIsAvailable(void);
+
+/*
+ * [Function Name]: LINK_receiveFrame
+ * [Function Description]: takes the payload of the next received frame if any,
+ * 						   it doesn't use any busy wait
+ * [Args]:
+ * [out]: uint8_t * a_payload
+ * 		  array of PROTOCOL_MAX_PAYLOAD_SIZE bytes to store the payload
+ * [out]: uint8_t * a_size
+ * 		  size of the received payload
+ * [Return]: uint8_t
+ * 			 LINK_SUCCESS if a frame is received
+ * 			 LINK_ERROR if no frame is available
+ */
+uint8_t LINK_receiveFrame(uint8_t * a_payload, uint8_t * a_size);
+
+/*
+ * [Function Name]: LINK_isConfirmed
+ * [Function Description]: checks if the other MCU confirmed the last sent frame,
+ * 						   by sending a new frame or a WAIT after it
+ * [Args]:
+ * [in]: void
+ * [Return]: boolean
+ * 			 TRUE if the frame is confirmed or no frame is sent, FALSE otherwise
+ */
+boolean LINK_isConfirmed(void);
+
+/*
+ * [Function Name]: LINK_resendFrame
+ * [Function Description]: resends the last sent frame with the same sequence number,
+ * 						   called when it isn't confirmed in LINK_RESPONSE_TIMEOUT_MS
+ * [Args]:
+ * [in]: void
+ * [Return]: uint8_t
+ * 			 LINK_SUCCESS if the frame is resent
+ * 			 LINK_ERROR if it's already resent LINK_MAX_RETRIES times, so the link is broken
+ */
+uint8_t LINK_resendFrame(void);
+
+/*
+ * [Function Name]: LINK_restartResends
+ * [Function Description]: lets the last sent frame be resent LINK_MAX_RETRIES times again,
+ * 						   used by the MCU that keeps resending its frame till the other
+ * 						   MCU connects again
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void LINK_restartResends(void);
+
+/*
+ * [Function Name]: LINK_confirmFrame
+ * [Function Description]: sends a WAIT for the last received frame if it isn't answered yet,
+ * 						   called before waiting for the user so the other MCU doesn't
+ * 						   resend the frame meanwhile, the WAIT is sent once for each frame
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void LINK_confirmFrame(void);
+
+/*
+ * [Function Name]: LINK_getStats
+ * [Function Description]: copies the link counters
+ * [Args]:
+ * [out]: ST_LinkStats * a_stats
+ * 		  structure to store the counters
+ * [Return]: void
+ */
+void LINK_getStats(ST_LinkStats * a_stats);
+
+#endif /* __LINK_H__ */
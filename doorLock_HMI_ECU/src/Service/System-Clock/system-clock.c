@@ -0,0 +1,249 @@
+/******************************************************************************
+ *
+ * Module: SYSCLK
+ *
+ * File Name: system-clock.c
+ *
+ * Description: Source file for the system clock service
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module header file */
+#include "system-clock.h"
+
+/* For using the free-running timer */
+#include "../../Mcal/Timer/timer.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* timer counts between two overflows */
+#define SYSCLK_COUNTS_PER_OVF				((uint32_t)SYSCLK_TIMER_MAX_COUNT + 1UL)
+
+/* time of one timer count in us */
+#define SYSCLK_US_PER_COUNT					(((uint32_t)SYSCLK_TIMER_PRESCALER_NUMBERS * 1000000UL) / (F_CPU))
+
+/* time between two overflows in us */
+#define SYSCLK_US_PER_OVF					(SYSCLK_COUNTS_PER_OVF * SYSCLK_US_PER_COUNT)
+
+/*******************************************************************************
+ *                      Static Functions Prototypes	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: overflowHandler
+ * [Function Description]: callback of the timer overflow, adds the time of
+ * 						   one overflow to the clock
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void overflowHandler(void);
+
+/*
+ * [Function Name]: readTime
+ * [Function Description]: reads the time of the last overflow and the timer count
+ * 						   without disabling the interrupts, the reads are repeated
+ * 						   if an overflow is handled in the middle, and an overflow
+ * 						   that is not handled yet is added, so it works in an ISR too
+ * [Args]:
+ * [out]: uint32_t * a_ms
+ * 		 the time in ms
+ * [out]: uint16_t * a_us
+ * 		 the us after a_ms, 0 to 999
+ * [Return]: void
+ */
+static void readTime(uint32_t * a_ms, uint16_t * a_us);
+
+/*******************************************************************************
+ *                            Global Variables	                               *
+ *******************************************************************************/
+
+/* time of the last overflow, in ms and the us after them */
+static volatile uint32_t g_overflowMs = 0;
+static volatile uint16_t g_overflowUs = 0;
+
+/* number of overflows handled, used to detect an overflow while reading the time */
+static volatile uint8_t g_overflowsCount = 0;
+
+/* config of the timer, the ticks split is done during compilation */
+static TIMER_config g_timerConfig = { SYSCLK_TIMER, SYSCLK_TIMER_MODE,
+		SYSCLK_TIMER_PRESCALER, SYSCLK_COUNTS_PER_OVF, overflowHandler,
+		TIMER_TICKS_PER_ITERATION(SYSCLK_COUNTS_PER_OVF, SYSCLK_TIMER_MAX_COUNT),
+		TIMER_ITERATIONS(SYSCLK_COUNTS_PER_OVF, SYSCLK_TIMER_MAX_COUNT) };
+
+/*******************************************************************************
+ *                          Functions Definition	                           *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: SYSCLK_init
+ * [Function Description]: starts the clock from 0, the global interrupt must be
+ * 						   enabled for the clock to count more than one timer overflow
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void SYSCLK_init(void)
+{
+	g_overflowMs = 0;
+	g_overflowUs = 0;
+	g_overflowsCount = 0;
+
+	/* a full range of ticks in ovf mode makes the timer free-running */
+	TIMER_init(&g_timerConfig);
+	TIMER_start(SYSCLK_TIMER);
+}
+
+/*
+ * [Function Name]: SYSCLK_nowMs
+ * [Function Description]: gets the time since SYSCLK_init() in ms,
+ * 						   it wraps after 49.7 days, so compare times by
+ * 						   subtracting them: SYSCLK_nowMs() - start >= timeout
+ * [Args]:
+ * [in]: void
+ * [Return]: uint32_t
+ * 			 time in ms
+ */
+uint32_t SYSCLK_nowMs(void)
+{
+	uint32_t ms;
+	uint16_t us;
+
+	readTime(&ms, &us);
+	return ms;
+}
+
+/*
+ * [Function Name]: SYSCLK_nowUs
+ * [Function Description]: gets the time since SYSCLK_init() in us, with the
+ * 						   resolution of one timer count,
+ * 						   it wraps after 71.5 minutes, so compare times by
+ * 						   subtracting them: SYSCLK_nowUs() - start >= timeout
+ * [Args]:
+ * [in]: void
+ * [Return]: uint32_t
+ * 			 time in us
+ */
+uint32_t SYSCLK_nowUs(void)
+{
+	uint32_t ms;
+	uint16_t us;
+
+	readTime(&ms, &us);
+	return ms * 1000UL + us;
+}
+
+/*
+ * [Function Name]: SYSCLK_delayMs
+ * [Function Description]: waits for a time in ms counted by the clock,
+ * 						   at most 71 minutes,
+ * 						   the interrupts keep running during the wait,
+ * 						   don't call it from an ISR
+ * [Args]:
+ * [in]: uint32_t a_timeMs
+ * 		 time to wait in ms
+ * [Return]: void
+ */
+void SYSCLK_delayMs(uint32_t a_timeMs)
+{
+	SYSCLK_delayUs(a_timeMs * 1000UL);
+}
+
+/*
+ * [Function Name]: SYSCLK_delayUs
+ * [Function Description]: waits for at least a time in us counted by the clock,
+ * 						   the wait is one timer count longer so a count that
+ * 						   is about to end isn't counted as a full one,
+ * 						   the interrupts keep running during the wait,
+ * 						   with the global interrupt disabled, as in the init
+ * 						   functions, one timer overflow is counted at most,
+ * 						   don't call it from an ISR
+ * [Args]:
+ * [in]: uint32_t a_timeUs
+ * 		 time to wait in us
+ * [Return]: void
+ */
+void SYSCLK_delayUs(uint32_t a_timeUs)
+{
+	uint32_t start = SYSCLK_nowUs();
+
+	a_timeUs += SYSCLK_US_PER_COUNT;
+	while(SYSCLK_nowUs() - start < a_timeUs)
+	{
+		CPU_IDLE_HINT();
+	}
+}
+
+/*
+ * [Function Name]: overflowHandler
+ * [Function Description]: callback of the timer overflow, adds the time of
+ * 						   one overflow to the clock
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+static void overflowHandler(void)
+{
+	g_overflowMs += SYSCLK_US_PER_OVF / 1000UL;
+	g_overflowUs += SYSCLK_US_PER_OVF % 1000UL;
+
+	if(g_overflowUs >= 1000)
+	{
+		g_overflowUs -= 1000;
+		g_overflowMs ++;
+	}
+
+	g_overflowsCount ++;
+}
+
+/*
+ * [Function Name]: readTime
+ * [Function Description]: reads the time of the last overflow and the timer count
+ * 						   without disabling the interrupts, the reads are repeated
+ * 						   if an overflow is handled in the middle, and an overflow
+ * 						   that is not handled yet is added, so it works in an ISR too
+ * [Args]:
+ * [out]: uint32_t * a_ms
+ * 		 the time in ms
+ * [out]: uint16_t * a_us
+ * 		 the us after a_ms, 0 to 999
+ * [Return]: void
+ */
+static void readTime(uint32_t * a_ms, uint16_t * a_us)
+{
+	uint8_t overflowsCount;
+	uint16_t count;
+	uint32_t ms, us;
+	boolean isOverflowPending;
+
+	do
+	{
+		overflowsCount = g_overflowsCount;
+		ms = g_overflowMs;
+		us = g_overflowUs;
+		count = TIMER_read(SYSCLK_TIMER);
+		isOverflowPending = TIMER_isOverflowPending(SYSCLK_TIMER);
+	}
+	while(overflowsCount != g_overflowsCount);
+
+	us += (uint32_t) count * SYSCLK_US_PER_COUNT;
+
+	/* the timer has overflowed before reading its count, but the interrupts are
+	 * disabled, a count near the max is read before an overflow so it's not added
+	 */
+	if(isOverflowPending && count < SYSCLK_COUNTS_PER_OVF / 2)
+	{
+		us += SYSCLK_US_PER_OVF;
+	}
+
+	*a_ms = ms + us / 1000UL;
+	*a_us = (uint16_t) (us % 1000UL);
+}
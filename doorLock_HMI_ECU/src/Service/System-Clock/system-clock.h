@@ -0,0 +1,100 @@
+/******************************************************************************
+ *
+ * Module: SYSCLK
+ *
+ * File Name: system-clock.h
+ *
+ * Description: Header file for the system clock service, a monotonic time since
+ * 				SYSCLK_init() counted by the overflows of a free-running timer
+ * 				plus its current count, it can be read from the main program
+ * 				and from the ISRs
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SYSCLK_H__
+#define __SYSCLK_H__
+
+/*******************************************************************************
+ *                                Includes	                                   *
+ *******************************************************************************/
+
+/* module config file */
+#include "system-clock-config.h"
+
+/* For using std types */
+#include "../../Lib/types.h"
+
+/* For using common defines and macros */
+#include "../../Lib/common.h"
+
+/*******************************************************************************
+ *                           Function Prototypes                               *
+ *******************************************************************************/
+
+/*
+ * [Function Name]: SYSCLK_init
+ * [Function Description]: starts the clock from 0, the global interrupt must be
+ * 						   enabled for the clock to count more than one timer overflow
+ * [Args]:
+ * [in]: void
+ * [Return]: void
+ */
+void SYSCLK_init(void);
+
+/*
+ * [Function Name]: SYSCLK_nowMs
+ * [Function Description]: gets the time since SYSCLK_init() in ms,
+ * 						   it wraps after 49.7 days, so compare times by
+ * 						   subtracting them: SYSCLK_nowMs() - start >= timeout
+ * [Args]:
+ * [in]: void
+ * [Return]: uint32_t
+ * 			 time in ms
+ */
+uint32_t SYSCLK_nowMs(void);
+
+/*
+ * [Function Name]: SYSCLK_nowUs
+ * [Function Description]: gets the time since SYSCLK_init() in us, with the
+ * 						   resolution of one timer count,
+ * 						   it wraps after 71.5 minutes, so compare times by
+ * 						   subtracting them: SYSCLK_nowUs() - start >= timeout
+ * [Args]:
+ * [in]: void
+ * [Return]: uint32_t
+ * 			 time in us
+ */
+uint32_t SYSCLK_nowUs(void);
+
+/*
+ * [Function Name]: SYSCLK_delayMs
+ * [Function Description]: waits for a time in ms counted by the clock,
+ * 						   at most 71 minutes,
+ * 						   the interrupts keep running during the wait,
+ * 						   don't call it from an ISR
+ * [Args]:
+ * [in]: uint32_t a_timeMs
+ * 		 time to wait in ms
+ * [Return]: void
+ */
+void SYSCLK_delayMs(uint32_t a_timeMs);
+
+/*
+ * [Function Name]: SYSCLK_delayUs
+ * [Function Description]: waits for at least a time in us counted by the clock,
+ * 						   the wait is one timer count longer so a count that
+ * 						   is about to end isn't counted as a full one,
+ * 						   the interrupts keep running during the wait,
+ * 						   with the global interrupt disabled, as in the init
+ * 						   functions, one timer overflow is counted at most,
+ * 						   don't call it from an ISR
+ * [Args]:
+ * [in]: uint32_t a_timeUs
+ * 		 time to wait in us
+ * [Return]: void
+ */
+void SYSCLK_delayUs(uint32_t a_timeUs);
+
+#endif /* __SYSCLK_H__ */
@@ -0,0 +1,428 @@
+/******************************************************************************
+ *
+ * Module: BENCH
+ *
+ * File Name: door-lock-bench.cpp
+ *
+ * Description: Latency benchmarks of the door lock system, run on the host
+ * 				simulation with scripted keypad sequences, the results are
+ * 				printed as csv so they can be compared between commits
+ *
+ * 				benchmarks:
+ * 				- keypress_to_star: key press till its '*' is shown while
+ * 				  entering the password (one sample per password char)
+ * 				- submit_to_unlocking: '=' press till "Unlocking Door" is shown
+ * 				- change_pass_flow: '-' press on the menu till "Pass Changed"
+ * 				  is shown, entering the old, new and confirmation passwords
+ *
+ * 				csv columns:
+ * 				label, benchmark, sample, cycles, time_ms, hmi_busy_cycles, ctrl_busy_cycles
+ * 				- cycles and time_ms are the latency at F_CPU = 8 MHz
+ * 				- busy cycles are the cycles each MCU was not idle during the latency,
+ * 				  both ends are read at the key press and at the lcd change
+ *
+ * 				the scripted user always waits the same times (reaction, key hold
+ * 				and gap), so the differences between commits come from the firmware
+ *
+ * 				usage: door-lock-bench [--label LABEL] [--no-header]
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#include "../src/sim-board.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+const char * const PASSWORD = "12345";
+const char * const NEW_PASSWORD = "54321";
+
+/* scripted user times */
+const double REACTION_MS = 20.0;
+const double KEY_HOLD_MS = 60.0;
+const double KEY_GAP_MS = 60.0;
+
+const double PROMPT_TIMEOUT_MS = 10000.0;
+const double RESPONSE_TIMEOUT_MS = 5000.0;
+const double FLOW_TIMEOUT_MS = 30000.0;
+
+/* number of door openings measured */
+const int UNLOCK_SAMPLES = 3;
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+typedef std::function<bool(const std::string &)> LcdPredicate;
+
+/*
+ * [Struct Name]: Snapshot
+ * [Struct Description]: cycles and idle cycles of both MCUs at one end of a measured
+ * 						 interval, each MCU is read on its own clock as the board runs
+ * 						 them in slices
+ */
+struct Snapshot
+{
+	sim::Cycles hmiCycles;
+	sim::Cycles hmiIdle;
+	sim::Cycles ctrlCycles;
+	sim::Cycles ctrlIdle;
+};
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+
+std::string g_label = "local";
+
+/* snapshot taken at every board event, in the order of the events */
+std::vector<Snapshot> g_eventSnapshots;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+LcdPredicate lcdContains(const std::string & a_text)
+{
+	return [a_text](const std::string & a_lcd) { return a_lcd.find(a_text) != std::string::npos; };
+}
+
+/* the second line starts with a_count password chars */
+LcdPredicate passCharsShown(size_t a_count)
+{
+	return [a_count](const std::string & a_lcd)
+	{
+		size_t line2 = a_lcd.find('|');
+		return line2 != std::string::npos && a_lcd.compare(line2 + 1, a_count, std::string(a_count, '*')) == 0;
+	};
+}
+
+Snapshot takeSnapshot(sim::Board & a_board)
+{
+	return Snapshot{ a_board.hmi().cycles(), a_board.hmi().idleCycles(),
+		a_board.ctrl().cycles(), a_board.ctrl().idleCycles() };
+}
+
+/* snapshots the MCUs at every event, so the end of an interval is read
+ * when the lcd changes and not when the script notices it */
+void trackEvents(sim::Board & a_board)
+{
+	g_eventSnapshots.clear();
+	a_board.onEvent = [&a_board](const sim::BoardEvent &)
+	{
+		g_eventSnapshots.push_back(takeSnapshot(a_board));
+	};
+}
+
+/* the latency is measured on the hmi clock, where the keys and the lcd are */
+void report(sim::Board & a_board, const char * a_benchmark, int a_sample, const Snapshot & a_start,
+		const Snapshot & a_end)
+{
+	sim::Cycles cycles = a_end.hmiCycles - a_start.hmiCycles;
+	sim::Cycles hmiIdle = a_end.hmiIdle - a_start.hmiIdle;
+	sim::Cycles ctrlCycles = a_end.ctrlCycles - a_start.ctrlCycles;
+	sim::Cycles ctrlIdle = a_end.ctrlIdle - a_start.ctrlIdle;
+
+	/* an MCU can't be idle longer than the interval on its own clock */
+	assert(hmiIdle <= cycles);
+	assert(ctrlIdle <= ctrlCycles);
+
+	std::printf("%s,%s,%d,%llu,%.3f,%llu,%llu\n", g_label.c_str(), a_benchmark, a_sample,
+			(unsigned long long) cycles, a_board.cyclesToMs(cycles),
+			(unsigned long long) (cycles - hmiIdle),
+			(unsigned long long) (ctrlCycles - ctrlIdle));
+}
+
+/*
+ * runs until an lcd change after the event a_fromEvent matches the predicate,
+ * releases a_heldKey after the hold time if it's not 0,
+ * returns the time of the matching change or NEVER on timeout,
+ * and the snapshot of the change in a_shown
+ */
+sim::Cycles waitLcd(sim::Board & a_board, size_t a_fromEvent, const LcdPredicate & a_predicate,
+		double a_timeoutMs, Snapshot * a_shown, char a_heldKey = 0, sim::Cycles a_releaseAt = 0)
+{
+	sim::Cycles deadline = a_board.now() + a_board.msToCycles(a_timeoutMs);
+	size_t eventIndex = a_fromEvent;
+
+	while(a_board.now() < deadline)
+	{
+		const std::vector<sim::BoardEvent> & events = a_board.events();
+
+		for(; eventIndex < events.size(); eventIndex ++)
+		{
+			if(events[eventIndex].device == "LCD" && a_predicate(events[eventIndex].text))
+			{
+				*a_shown = g_eventSnapshots[eventIndex];
+				return events[eventIndex].at;
+			}
+		}
+
+		if(a_heldKey != 0 && a_board.hmi().cycles() >= a_releaseAt)
+		{
+			a_board.releaseKey(a_heldKey);
+			a_heldKey = 0;
+		}
+
+		a_board.step();
+	}
+	return sim::NEVER;
+}
+
+/*
+ * presses a key like a user would do and returns the time when the lcd
+ * matches the predicate, NEVER on timeout, with the snapshots of both ends
+ */
+sim::Cycles pressAndMeasure(sim::Board & a_board, char a_key, const LcdPredicate & a_predicate,
+		double a_timeoutMs, Snapshot * a_pressed, Snapshot * a_shown)
+{
+	size_t fromEvent = a_board.events().size();
+
+	a_board.pressKey(a_key);
+	*a_pressed = takeSnapshot(a_board);
+	sim::Cycles releaseAt = a_pressed->hmiCycles + a_board.msToCycles(KEY_HOLD_MS);
+
+	sim::Cycles matchedAt = waitLcd(a_board, fromEvent, a_predicate, a_timeoutMs, a_shown, a_key, releaseAt);
+
+	/* complete the key stroke */
+	if(a_board.keypad().isPressed(a_key))
+	{
+		a_board.runUntil([&a_board, releaseAt]() { return a_board.hmi().cycles() >= releaseAt; }, KEY_HOLD_MS);
+		a_board.releaseKey(a_key);
+	}
+	a_board.runForMs(KEY_GAP_MS);
+
+	return matchedAt;
+}
+
+bool waitPrompt(sim::Board & a_board, const std::string & a_text)
+{
+	if(!a_board.runUntilLcdShows(a_text, PROMPT_TIMEOUT_MS))
+	{
+		std::fprintf(stderr, "timeout waiting for \"%s\"\n", a_text.c_str());
+		return false;
+	}
+	a_board.runForMs(REACTION_MS);
+	return true;
+}
+
+void typeKeys(sim::Board & a_board, const std::string & a_keys)
+{
+	a_board.typeKeys(a_keys, KEY_HOLD_MS, KEY_GAP_MS);
+}
+
+/* sets the first password and waits for the menu */
+bool firstTimeSetup(sim::Board & a_board)
+{
+	if(!waitPrompt(a_board, "Enter a new Pass"))
+	{
+		return false;
+	}
+	typeKeys(a_board, std::string(PASSWORD) + "=");
+
+	if(!waitPrompt(a_board, "Confirm Pass"))
+	{
+		return false;
+	}
+	typeKeys(a_board, std::string(PASSWORD) + "=");
+
+	return waitPrompt(a_board, "-: Change Pass");
+}
+
+/******************************** benchmarks *********************************/
+
+bool keypressToStar(sim::Board & a_board)
+{
+	if(!firstTimeSetup(a_board))
+	{
+		return false;
+	}
+
+	typeKeys(a_board, "+");
+
+	if(!waitPrompt(a_board, "Enter Pass :"))
+	{
+		return false;
+	}
+
+	for(size_t index = 0; PASSWORD[index] != '\0'; index ++)
+	{
+		Snapshot pressed, shown;
+		sim::Cycles shownAt = pressAndMeasure(a_board, PASSWORD[index], passCharsShown(index + 1),
+				RESPONSE_TIMEOUT_MS, &pressed, &shown);
+
+		if(shownAt == sim::NEVER)
+		{
+			std::fprintf(stderr, "keypress_to_star: char %zu is not shown\n", index + 1);
+			return false;
+		}
+		report(a_board, "keypress_to_star", (int) index + 1, pressed, shown);
+	}
+	return true;
+}
+
+bool submitToUnlocking(sim::Board & a_board)
+{
+	if(!firstTimeSetup(a_board))
+	{
+		return false;
+	}
+
+	for(int sample = 1; sample <= UNLOCK_SAMPLES; sample ++)
+	{
+		typeKeys(a_board, "+");
+
+		if(!waitPrompt(a_board, "Enter Pass :"))
+		{
+			return false;
+		}
+		typeKeys(a_board, PASSWORD);
+
+		Snapshot pressed, shown;
+		sim::Cycles shownAt = pressAndMeasure(a_board, '=', lcdContains("Unlocking Door"),
+				RESPONSE_TIMEOUT_MS, &pressed, &shown);
+
+		if(shownAt == sim::NEVER)
+		{
+			std::fprintf(stderr, "submit_to_unlocking: door is not unlocked\n");
+			return false;
+		}
+		report(a_board, "submit_to_unlocking", sample, pressed, shown);
+
+		/* wait for the door to be locked again */
+		if(!a_board.runUntilLcdShows("-: Change Pass", FLOW_TIMEOUT_MS + FLOW_TIMEOUT_MS))
+		{
+			std::fprintf(stderr, "submit_to_unlocking: menu is not shown after locking\n");
+			return false;
+		}
+		a_board.runForMs(REACTION_MS);
+	}
+	return true;
+}
+
+bool changePassFlow(sim::Board & a_board)
+{
+	if(!firstTimeSetup(a_board))
+	{
+		return false;
+	}
+
+	size_t fromEvent = a_board.events().size();
+	a_board.pressKey('-');
+	Snapshot pressed = takeSnapshot(a_board);
+	a_board.runForMs(KEY_HOLD_MS);
+	a_board.releaseKey('-');
+	a_board.runForMs(KEY_GAP_MS);
+
+	static const struct
+	{
+		const char * prompt;
+		const char * keys;
+	} steps[] =
+	{
+		{ "Enter Pass :", PASSWORD },
+		{ "Enter a new Pass", NEW_PASSWORD },
+		{ "Confirm Pass", NEW_PASSWORD }
+	};
+
+	for(const auto & step : steps)
+	{
+		if(!waitPrompt(a_board, step.prompt))
+		{
+			return false;
+		}
+		typeKeys(a_board, std::string(step.keys) + "=");
+	}
+
+	Snapshot shown;
+	sim::Cycles changedAt = waitLcd(a_board, fromEvent, lcdContains("Pass Changed"), FLOW_TIMEOUT_MS, &shown);
+
+	if(changedAt == sim::NEVER)
+	{
+		std::fprintf(stderr, "change_pass_flow: password is not changed\n");
+		return false;
+	}
+	report(a_board, "change_pass_flow", 1, pressed, shown);
+	return true;
+}
+
+/*
+ * runs a benchmark in a child process, the firmware images have a single
+ * global state so every benchmark needs a fresh process
+ */
+bool runIsolated(bool (*a_benchmark)(sim::Board &))
+{
+	std::fflush(stdout);
+	pid_t pid = fork();
+
+	if(pid < 0)
+	{
+		std::perror("fork");
+		return false;
+	}
+
+	if(pid == 0)
+	{
+		bool passed;
+		{
+			sim::Board board;
+			trackEvents(board);
+			passed = a_benchmark(board);
+		}
+		std::fflush(stdout);
+		_exit(passed ? 0 : 1);
+	}
+
+	int status = 0;
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+} /* namespace */
+
+int main(int argc, char ** argv)
+{
+	bool header = true;
+
+	for(int argIndex = 1; argIndex < argc; argIndex ++)
+	{
+		if(std::strcmp(argv[argIndex], "--label") == 0 && argIndex + 1 < argc)
+		{
+			g_label = argv[++ argIndex];
+		}
+		else if(std::strcmp(argv[argIndex], "--no-header") == 0)
+		{
+			header = false;
+		}
+		else
+		{
+			std::fprintf(stderr, "usage: %s [--label LABEL] [--no-header]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	if(header)
+	{
+		std::printf("label,benchmark,sample,cycles,time_ms,hmi_busy_cycles,ctrl_busy_cycles\n");
+	}
+
+	bool passed = runIsolated(keypressToStar);
+	passed = runIsolated(submitToUnlocking) && passed;
+	passed = runIsolated(changePassFlow) && passed;
+
+	return passed ? 0 : 1;
+}
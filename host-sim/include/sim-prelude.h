@@ -0,0 +1,129 @@
+/******************************************************************************
+ *
+ * Module: SIM
+ *
+ * File Name: sim-prelude.h
+ *
+ * Description: Force included before every firmware source in the host build,
+ * 				it maps the register, interrupt and main macros of the firmware
+ * 				to the simulated MCU, so the firmware sources are compiled
+ * 				without any change
+ *
+ * 				- every register access is a call to the simulated MCU, which
+ * 				  advances the virtual time and runs the peripheral models
+ * 				- ISR(vector) defines a static function and registers it
+ * 				  for the vector of the image being compiled (SIM_IMAGE)
+ * 				- main is renamed by the makefile to the image entry point
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SIM_PRELUDE_H__
+#define __SIM_PRELUDE_H__
+
+#ifndef SIM_IMAGE
+#error "SIM_IMAGE must be defined as the index of the MCU being compiled"
+#endif
+
+/*******************************************************************************
+ *                             Simulator Interface                             *
+ *******************************************************************************/
+
+extern "C"
+{
+unsigned char sim_read8(unsigned short a_addr);
+void sim_write8(unsigned short a_addr, unsigned char a_value);
+unsigned short sim_read16(unsigned short a_addr);
+void sim_write16(unsigned short a_addr, unsigned short a_value);
+void sim_enableInterrupts(void);
+void sim_disableInterrupts(void);
+void sim_idle(void);
+void sim_delayCycles(unsigned long a_cycles);
+void sim_sleep(void);
+int sim_registerVector(int a_image, int a_vector, void (*a_isr)(void));
+
+/* entry point of the image, the makefile renames main to it */
+int main(void);
+}
+
+#define SIM_INLINE __attribute__((always_inline, no_instrument_function)) inline
+
+namespace sim_fw
+{
+
+/*
+ * [Class Name]: Reg8
+ * [Class Description]: proxy of an 8 bit register, behaves like an lvalue
+ * 						of the register, reads and writes go to the simulator
+ */
+class Reg8
+{
+public:
+	SIM_INLINE explicit Reg8(unsigned int a_addr) : m_addr((unsigned short) a_addr) {}
+
+	SIM_INLINE operator unsigned char() const { return sim_read8(m_addr); }
+
+	SIM_INLINE const Reg8 & operator=(unsigned int a_value) const { sim_write8(m_addr, (unsigned char) a_value); return *this; }
+	SIM_INLINE const Reg8 & operator=(const Reg8 & a_other) const { sim_write8(m_addr, (unsigned char) a_other); return *this; }
+
+	SIM_INLINE const Reg8 & operator|=(unsigned int a_value) const { return *this = (sim_read8(m_addr) | a_value); }
+	SIM_INLINE const Reg8 & operator&=(unsigned int a_value) const { return *this = (sim_read8(m_addr) & a_value); }
+	SIM_INLINE const Reg8 & operator^=(unsigned int a_value) const { return *this = (sim_read8(m_addr) ^ a_value); }
+
+private:
+	unsigned short m_addr;
+};
+
+/*
+ * [Class Name]: Reg16
+ * [Class Description]: proxy of a 16 bit register (TCNT1, OCR1A, ...)
+ */
+class Reg16
+{
+public:
+	SIM_INLINE explicit Reg16(unsigned int a_addr) : m_addr((unsigned short) a_addr) {}
+
+	SIM_INLINE operator unsigned short() const { return sim_read16(m_addr); }
+
+	SIM_INLINE const Reg16 & operator=(unsigned int a_value) const { sim_write16(m_addr, (unsigned short) a_value); return *this; }
+	SIM_INLINE const Reg16 & operator=(const Reg16 & a_other) const { sim_write16(m_addr, (unsigned short) a_other); return *this; }
+
+	SIM_INLINE const Reg16 & operator|=(unsigned int a_value) const { return *this = (sim_read16(m_addr) | a_value); }
+	SIM_INLINE const Reg16 & operator&=(unsigned int a_value) const { return *this = (sim_read16(m_addr) & a_value); }
+	SIM_INLINE const Reg16 & operator^=(unsigned int a_value) const { return *this = (sim_read16(m_addr) ^ a_value); }
+
+private:
+	unsigned short m_addr;
+};
+
+} /* namespace sim_fw */
+
+/*******************************************************************************
+ *                             Firmware Overrides                              *
+ *******************************************************************************/
+
+#define MCU_REG8(ADDR)				(sim_fw::Reg8(ADDR))
+#define MCU_REG16(ADDR)				(sim_fw::Reg16(ADDR))
+
+#define ENABLE_GLOBAL_INTERRUPT()	sim_enableInterrupts()
+#define DISABLE_GLOBAL_INTERRUPT()	sim_disableInterrupts()
+#define CPU_IDLE_HINT()				sim_idle()
+#define CPU_DELAY_CYCLES(cycles)	sim_delayCycles(cycles)
+#define CPU_SLEEP()					sim_sleep()
+
+/* the host has a single address space, the flash data is ordinary constant data */
+#define FLASH_CONST
+#define FLASH_READ_BYTE(addr)		(*(const unsigned char *)(addr))
+
+/* vectors are plain numbers, so ISR can build unique names from them */
+#define _VECTOR(N)					N
+
+#define ISR(vector, ...)			SIM_ISR_DEFINE(vector)
+#define SIM_ISR_DEFINE(n)			SIM_ISR_DEFINE_(n)
+#define SIM_ISR_DEFINE_(n)															\
+	static void sim_isr_##n(void);													\
+	static const int sim_isrRegistered_##n = sim_registerVector(SIM_IMAGE, n, sim_isr_##n);	\
+	static void sim_isr_##n(void)
+
+#endif /* __SIM_PRELUDE_H__ */
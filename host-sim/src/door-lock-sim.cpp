@@ -0,0 +1,276 @@
+/******************************************************************************
+ *
+ * Module: SIM
+ *
+ * File Name: door-lock-sim.cpp
+ *
+ * Description: Runs the door lock system on the host with a script of steps
+ * 				and prints what happens on the board with its time
+ *
+ * 				usage: door-lock-sim [options] [steps...]
+ * 				options:
+ * 					--eeprom FILE	load the eeprom from FILE and save it back at exit
+ * 					--noise RATE	probability of corrupting each byte on the uart lines
+ * 					--seed N		seed of the line noise
+ * 					--verbose		print every lcd write, not only the settled text
+ * 				steps:
+ * 					wait:TEXT[@MS]	run till the lcd shows TEXT, fails after MS (10000)
+ * 					keys:KEYS		press and release each key (60 ms hold, 60 ms gap)
+ * 					press:KEY		press a key and keep it pressed
+ * 					release:KEY		release a key
+ * 					run:MS			run for MS
+ *
+ * 				e.g. first time password setup and opening the door:
+ * 				door-lock-sim "wait:Enter a new Pass" keys:12345= "wait:Confirm Pass" keys:12345= \
+ * 							  "wait:-: Change Pass" keys:+ "wait:Enter Pass :" keys:12345= \
+ * 							  "wait:Unlocking Door"
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#include "sim-board.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace
+{
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+const double DEFAULT_WAIT_TIMEOUT_MS = 10000.0;
+const double KEY_HOLD_MS = 60.0;
+const double KEY_GAP_MS = 60.0;
+
+/* lcd writes closer than this are printed as one change */
+const double LCD_SETTLE_MS = 20.0;
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+
+sim::Board * g_board = nullptr;
+bool g_verbose = false;
+bool g_lcdPending = false;
+sim::BoardEvent g_lcdPendingEvent;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+void printEvent(const sim::BoardEvent & a_event)
+{
+	std::printf("%12.3f ms  %-7s %s\n", g_board->cyclesToMs(a_event.at), a_event.device.c_str(), a_event.text.c_str());
+}
+
+void flushLcd(void)
+{
+	if(g_lcdPending)
+	{
+		g_lcdPending = false;
+		printEvent(g_lcdPendingEvent);
+	}
+}
+
+void handleEvent(const sim::BoardEvent & a_event)
+{
+	if(g_verbose)
+	{
+		printEvent(a_event);
+		return;
+	}
+
+	if(g_lcdPending && (a_event.device != "LCD" ||
+			g_board->cyclesToMs(a_event.at - g_lcdPendingEvent.at) > LCD_SETTLE_MS))
+	{
+		flushLcd();
+	}
+
+	if(a_event.device == "LCD")
+	{
+		g_lcdPending = true;
+		g_lcdPendingEvent = a_event;
+	}
+	else
+	{
+		printEvent(a_event);
+	}
+}
+
+bool runStep(const std::string & a_step)
+{
+	size_t colon = a_step.find(':');
+
+	if(colon == std::string::npos)
+	{
+		std::fprintf(stderr, "invalid step: %s\n", a_step.c_str());
+		return false;
+	}
+
+	std::string command = a_step.substr(0, colon);
+	std::string argument = a_step.substr(colon + 1);
+
+	if(command == "wait")
+	{
+		double timeoutMs = DEFAULT_WAIT_TIMEOUT_MS;
+		size_t at = argument.rfind('@');
+
+		if(at != std::string::npos)
+		{
+			timeoutMs = std::atof(argument.c_str() + at + 1);
+			argument = argument.substr(0, at);
+		}
+
+		if(!g_board->runUntilLcdShows(argument, timeoutMs))
+		{
+			flushLcd();
+			std::fprintf(stderr, "timeout waiting for \"%s\"\n", argument.c_str());
+			return false;
+		}
+	}
+	else if(command == "keys")
+	{
+		g_board->typeKeys(argument, KEY_HOLD_MS, KEY_GAP_MS);
+	}
+	else if(command == "press" && argument.size() == 1)
+	{
+		g_board->pressKey(argument[0]);
+	}
+	else if(command == "release" && argument.size() == 1)
+	{
+		g_board->releaseKey(argument[0]);
+	}
+	else if(command == "run")
+	{
+		g_board->runForMs(std::atof(argument.c_str()));
+	}
+	else
+	{
+		std::fprintf(stderr, "invalid step: %s\n", a_step.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+/* time spent in the sleep modes used by the firmware, the sleep instruction
+ * of the other modes is counted as idle time only */
+void printSleepResidency(const char * a_name, const sim::Mcu & a_mcu)
+{
+	static const struct
+	{
+		int mode;
+		const char * name;
+	} modes[] =
+	{
+		{ 0, "idle" }, { 1, "adc noise reduction" }, { 2, "power-down" }, { 3, "power-save" }
+	};
+
+	sim::Cycles cycles = std::max<sim::Cycles>(a_mcu.cycles(), 1);
+
+	std::printf("%s sleep", a_name);
+	for(const auto & mode : modes)
+	{
+		std::printf("%s %s %.1f%%", mode.mode == 0 ? "" : ",", mode.name,
+				100.0 * a_mcu.sleepCycles(mode.mode) / cycles);
+	}
+	std::printf("\n");
+}
+
+void printSummary(void)
+{
+	sim::Board & board = *g_board;
+	const sim::Hd44780::Stats & lcdStats = board.lcd().stats();
+
+	std::printf("\nsimulated time: %.3f ms (%llu modeled cycles)\n",
+			board.nowMs(), (unsigned long long) board.now());
+	std::printf("CTRL: %llu interrupts, idle %.1f%%, %llu uart bytes sent\n",
+			(unsigned long long) board.ctrl().interruptsCount(),
+			100.0 * board.ctrl().idleCycles() / std::max<sim::Cycles>(board.ctrl().cycles(), 1),
+			(unsigned long long) board.ctrlBytesSent());
+	std::printf("HMI:  %llu interrupts, idle %.1f%%, %llu uart bytes sent\n",
+			(unsigned long long) board.hmi().interruptsCount(),
+			100.0 * board.hmi().idleCycles() / std::max<sim::Cycles>(board.hmi().cycles(), 1),
+			(unsigned long long) board.hmiBytesSent());
+	printSleepResidency("CTRL:", board.ctrl());
+	printSleepResidency("HMI: ", board.hmi());
+	std::printf("LCD:  %u commands, %u chars, %u busy reads, %u writes while busy, %u short enable pulses\n",
+			lcdStats.commands, lcdStats.characters, lcdStats.busyReads,
+			lcdStats.writesWhileBusy, lcdStats.shortPulses);
+	std::printf("EEPROM: %u write cycles\n", board.eeprom().writeCycles());
+}
+
+} /* namespace */
+
+int main(int argc, char ** argv)
+{
+	sim::Board board;
+	g_board = &board;
+
+	std::string eepromPath;
+	double noise = 0.0;
+	unsigned seed = 1;
+	int argIndex = 1;
+
+	for(; argIndex < argc && std::strncmp(argv[argIndex], "--", 2) == 0; argIndex ++)
+	{
+		std::string option = argv[argIndex];
+
+		if(option == "--verbose")
+		{
+			g_verbose = true;
+		}
+		else if(option == "--eeprom" && argIndex + 1 < argc)
+		{
+			eepromPath = argv[++ argIndex];
+		}
+		else if(option == "--noise" && argIndex + 1 < argc)
+		{
+			noise = std::atof(argv[++ argIndex]);
+		}
+		else if(option == "--seed" && argIndex + 1 < argc)
+		{
+			seed = (unsigned) std::atoi(argv[++ argIndex]);
+		}
+		else
+		{
+			std::fprintf(stderr, "unknown option: %s\n", option.c_str());
+			return 2;
+		}
+	}
+
+	if(!eepromPath.empty())
+	{
+		board.eeprom().load(eepromPath);
+	}
+
+	board.setLineNoise(noise, seed);
+	board.onEvent = handleEvent;
+
+	bool passed = true;
+
+	if(argIndex == argc)
+	{
+		board.runForMs(2000.0);
+	}
+
+	for(; argIndex < argc && passed; argIndex ++)
+	{
+		passed = runStep(argv[argIndex]);
+	}
+
+	flushLcd();
+	printSummary();
+
+	if(!eepromPath.empty())
+	{
+		board.eeprom().save(eepromPath);
+	}
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,275 @@
+/******************************************************************************
+ *
+ * Module: SIM
+ *
+ * File Name: sim-board.cpp
+ *
+ * Description: Source file for the simulated door lock system
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#include "sim-board.h"
+
+#include <algorithm>
+
+/* entry points of the firmware images */
+extern "C" int sim_main_ctrl(void);
+extern "C" int sim_main_hmi(void);
+
+namespace sim
+{
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+namespace
+{
+
+/* image indices, must match SIM_IMAGE in the makefile */
+const int CTRL_IMAGE = 0;
+const int HMI_IMAGE = 1;
+
+/* M24C16 write cycle time */
+const double EEPROM_WRITE_CYCLE_MS = 5.0;
+
+/* CTRL outputs */
+const Pin MOTOR_PIN_1 = { PORT_D, 6 };
+const Pin MOTOR_PIN_2 = { PORT_D, 7 };
+const Pin BUZZER_PIN = { PORT_B, 7 };
+
+bool outputLevel(const Mcu & a_mcu, const Pin & a_pin)
+{
+	uint8_t driven = a_mcu.portOutput(a_pin.port) & a_mcu.portDirection(a_pin.port);
+	return (driven >> a_pin.pin) & 0x01;
+}
+
+} /* namespace */
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Class Name]: OutputsMonitor
+ * [Class Description]: watches the motor and buzzer pins of the CTRL
+ */
+class Board::OutputsMonitor : public PinDevice
+{
+public:
+	explicit OutputsMonitor(Board & a_board) : m_board(a_board), m_motor("stopped"), m_buzzer(false) {}
+
+	void pinsChanged(Mcu & a_mcu, int a_port, Cycles a_now) override
+	{
+		(void) a_port;
+
+		bool pin1 = outputLevel(a_mcu, MOTOR_PIN_1);
+		bool pin2 = outputLevel(a_mcu, MOTOR_PIN_2);
+		std::string motor = (pin1 == pin2) ? "stopped" : (pin1 ? "forward" : "reverse");
+
+		if(motor != m_motor)
+		{
+			m_motor = motor;
+			int duty = a_mcu.pwmDuty(1, 0);
+
+			if(motor != "stopped" && duty >= 0)
+			{
+				motor += " " + std::to_string(duty) + "%";
+			}
+			m_board.addEvent(a_now, "MOTOR", motor);
+		}
+
+		bool buzzer = outputLevel(a_mcu, BUZZER_PIN);
+
+		if(buzzer != m_buzzer)
+		{
+			m_buzzer = buzzer;
+			m_board.addEvent(a_now, "BUZZER", buzzer ? "on" : "off");
+		}
+	}
+
+	uint8_t drivenPins(const Mcu & a_mcu, int a_port, uint8_t * a_levels) const override
+	{
+		(void) a_mcu;
+		(void) a_port;
+		(void) a_levels;
+		return 0;
+	}
+
+private:
+	Board & m_board;
+	std::string m_motor;
+	bool m_buzzer;
+};
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+Board::Board() :
+	m_byteErrorRate(0.0), m_random(1), m_ctrlBytes(0), m_hmiBytes(0)
+{
+	m_ctrl.reset(new Mcu("CTRL", CTRL_IMAGE, sim_main_ctrl, BOARD_CLOCK_HZ));
+	m_hmi.reset(new Mcu("HMI", HMI_IMAGE, sim_main_hmi, BOARD_CLOCK_HZ));
+
+	Hd44780::Wiring lcdWiring;
+	lcdWiring.rs = Pin{ PORT_B, 2 };
+	lcdWiring.rw = Pin{ PORT_B, 1 };
+	lcdWiring.e = Pin{ PORT_B, 0 };
+	lcdWiring.dataPort = PORT_A;
+	lcdWiring.dataFirstPin = 4;
+	lcdWiring.fourBitBus = true;
+	m_lcd.reset(new Hd44780(lcdWiring, BOARD_CLOCK_HZ));
+
+	Keypad::Wiring keypadWiring;
+	keypadWiring.port = PORT_C;
+	keypadWiring.firstRowPin = 0;
+	keypadWiring.firstColPin = 4;
+	keypadWiring.rows = 4;
+	keypadWiring.cols = 4;
+	keypadWiring.keys = "789/456x123-c0=+";
+	keypadWiring.wake = Pin{ PORT_D, 2 };
+	m_keypad.reset(new Keypad(keypadWiring));
+
+	m_eeprom.reset(new M24c16(msToCycles(EEPROM_WRITE_CYCLE_MS)));
+	m_outputs.reset(new OutputsMonitor(*this));
+
+	m_hmi->attachPinDevice(m_lcd.get());
+	m_hmi->attachPinDevice(m_keypad.get());
+	m_ctrl->attachPinDevice(m_outputs.get());
+	m_ctrl->attachTwiDevice(m_eeprom.get());
+
+	m_ctrl->uartTransmit = [this](uint8_t a_data, Cycles a_arrival)
+	{
+		m_ctrlBytes ++;
+		m_hmi->uartReceive(lineByte(a_data), a_arrival);
+	};
+
+	m_hmi->uartTransmit = [this](uint8_t a_data, Cycles a_arrival)
+	{
+		m_hmiBytes ++;
+		m_ctrl->uartReceive(lineByte(a_data), a_arrival);
+	};
+
+	m_lcd->onDisplayChanged = [this](Cycles a_now)
+	{
+		std::string text = m_lcd->displayIsOn() ? (m_lcd->line(0) + "|" + m_lcd->line(1)) : "(off)";
+
+		if(text != m_lastLcdText)
+		{
+			m_lastLcdText = text;
+			addEvent(a_now, "LCD", text);
+		}
+	};
+}
+
+Board::~Board()
+{
+}
+
+Cycles Board::now(void) const
+{
+	return std::min(m_ctrl->cycles(), m_hmi->cycles());
+}
+
+void Board::step(void)
+{
+	Mcu & behind = (m_ctrl->cycles() <= m_hmi->cycles()) ? *m_ctrl : *m_hmi;
+	Mcu & ahead = (&behind == m_ctrl.get()) ? *m_hmi : *m_ctrl;
+
+	behind.runUntil(ahead.cycles() + BOARD_SLICE_CYCLES);
+}
+
+void Board::runForMs(double a_ms)
+{
+	Cycles end = now() + msToCycles(a_ms);
+
+	while(now() < end)
+	{
+		step();
+	}
+}
+
+bool Board::runUntil(const std::function<bool()> & a_predicate, double a_timeoutMs)
+{
+	Cycles end = now() + msToCycles(a_timeoutMs);
+
+	while(!a_predicate())
+	{
+		if(now() >= end)
+		{
+			return false;
+		}
+		step();
+	}
+	return true;
+}
+
+bool Board::lcdShows(const std::string & a_text) const
+{
+	return m_lcd->line(0).find(a_text) != std::string::npos ||
+			m_lcd->line(1).find(a_text) != std::string::npos;
+}
+
+bool Board::runUntilLcdShows(const std::string & a_text, double a_timeoutMs)
+{
+	return runUntil([this, &a_text]() { return lcdShows(a_text); }, a_timeoutMs);
+}
+
+void Board::pressKey(char a_key)
+{
+	if(m_keypad->press(a_key))
+	{
+		m_hmi->externalPinsChanged();
+		addEvent(m_hmi->cycles(), "KEYPAD", std::string("press ") + a_key);
+	}
+}
+
+void Board::releaseKey(char a_key)
+{
+	if(m_keypad->release(a_key))
+	{
+		m_hmi->externalPinsChanged();
+		addEvent(m_hmi->cycles(), "KEYPAD", std::string("release ") + a_key);
+	}
+}
+
+void Board::typeKeys(const std::string & a_keys, double a_holdMs, double a_gapMs)
+{
+	for(char key : a_keys)
+	{
+		pressKey(key);
+		runForMs(a_holdMs);
+		releaseKey(key);
+		runForMs(a_gapMs);
+	}
+}
+
+void Board::setLineNoise(double a_byteErrorRate, unsigned a_seed)
+{
+	m_byteErrorRate = a_byteErrorRate;
+	m_random.seed(a_seed);
+}
+
+uint8_t Board::lineByte(uint8_t a_data)
+{
+	if(m_byteErrorRate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(m_random) < m_byteErrorRate)
+	{
+		a_data ^= (uint8_t) (1 << std::uniform_int_distribution<int>(0, 7)(m_random));
+	}
+	return a_data;
+}
+
+void Board::addEvent(Cycles a_at, const std::string & a_device, const std::string & a_text)
+{
+	m_events.push_back(BoardEvent{ a_at, a_device, a_text });
+
+	if(onEvent)
+	{
+		onEvent(m_events.back());
+	}
+}
+
+} /* namespace sim */
@@ -0,0 +1,147 @@
+/******************************************************************************
+ *
+ * Module: SIM
+ *
+ * File Name: sim-board.h
+ *
+ * Description: The simulated door lock system, the CTRL and HMI MCUs connected
+ * 				by their uart lines, with the devices of each ECU:
+ * 				- HMI: HD44780 lcd (RS PB2, RW PB1, E PB0, data PORTA)
+ * 				  and 4x4 keypad (rows PC0 - PC3, cols PC4 - PC7, rows wake
+ * 				  INT0 / PD2 through diodes)
+ * 				- CTRL: M24C16 eeprom on the twi, dc motor (PD6, PD7, enable
+ * 				  PD5 / OC1A) and buzzer (PB7)
+ *
+ * 				The two MCUs run in turns of short time slices, the MCU that
+ * 				is behind always runs first, so a byte sent by one of them is
+ * 				always received in the future of the other one
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SIM_BOARD_H__
+#define __SIM_BOARD_H__
+
+#include "sim-devices.h"
+#include "sim-mcu.h"
+
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace sim
+{
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+/* clock of both MCUs */
+const Cycles BOARD_CLOCK_HZ = 8000000;
+
+/* length of a time slice, must be shorter than one uart frame */
+const Cycles BOARD_SLICE_CYCLES = 2000;
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Struct Name]: BoardEvent
+ * [Struct Description]: visible change on the board
+ */
+struct BoardEvent
+{
+	Cycles at;
+	/* LCD, KEYPAD, MOTOR, BUZZER */
+	std::string device;
+	std::string text;
+};
+
+/*
+ * [Class Name]: Board
+ * [Class Description]: the door lock system, only one board can run at a time
+ */
+class Board
+{
+public:
+	Board();
+	~Board();
+
+	Board(const Board &) = delete;
+	Board & operator=(const Board &) = delete;
+
+	Mcu & ctrl(void) { return *m_ctrl; }
+	Mcu & hmi(void) { return *m_hmi; }
+	Hd44780 & lcd(void) { return *m_lcd; }
+	Keypad & keypad(void) { return *m_keypad; }
+	M24c16 & eeprom(void) { return *m_eeprom; }
+
+	/* time reached by both MCUs */
+	Cycles now(void) const;
+	double nowMs(void) const { return cyclesToMs(now()); }
+	Cycles msToCycles(double a_ms) const { return (Cycles) (a_ms * BOARD_CLOCK_HZ / 1000.0); }
+	double cyclesToMs(Cycles a_cycles) const { return a_cycles * 1000.0 / BOARD_CLOCK_HZ; }
+
+	/* runs one time slice of the MCU that is behind */
+	void step(void);
+
+	void runForMs(double a_ms);
+
+	/* runs until the predicate is true, returns false on timeout */
+	bool runUntil(const std::function<bool()> & a_predicate, double a_timeoutMs);
+
+	/* runs until one of the lcd lines contains the text */
+	bool runUntilLcdShows(const std::string & a_text, double a_timeoutMs);
+
+	bool lcdShows(const std::string & a_text) const;
+
+	/* the keypad changes are applied at the current time of the HMI */
+	void pressKey(char a_key);
+	void releaseKey(char a_key);
+
+	/* presses and releases every key, waiting a_holdMs and a_gapMs */
+	void typeKeys(const std::string & a_keys, double a_holdMs, double a_gapMs);
+
+	/* each byte on the uart lines is corrupted with this probability */
+	void setLineNoise(double a_byteErrorRate, unsigned a_seed);
+
+	const std::vector<BoardEvent> & events(void) const { return m_events; }
+	void clearEvents(void) { m_events.clear(); }
+
+	/* called for every new event */
+	std::function<void(const BoardEvent &)> onEvent;
+
+	/* uart bytes sent by each MCU */
+	uint64_t ctrlBytesSent(void) const { return m_ctrlBytes; }
+	uint64_t hmiBytesSent(void) const { return m_hmiBytes; }
+
+private:
+	class OutputsMonitor;
+
+	void addEvent(Cycles a_at, const std::string & a_device, const std::string & a_text);
+	uint8_t lineByte(uint8_t a_data);
+
+	std::unique_ptr<Mcu> m_ctrl;
+	std::unique_ptr<Mcu> m_hmi;
+	std::unique_ptr<Hd44780> m_lcd;
+	std::unique_ptr<Keypad> m_keypad;
+	std::unique_ptr<M24c16> m_eeprom;
+	std::unique_ptr<OutputsMonitor> m_outputs;
+
+	std::vector<BoardEvent> m_events;
+	std::string m_lastLcdText;
+
+	double m_byteErrorRate;
+	std::mt19937 m_random;
+
+	uint64_t m_ctrlBytes;
+	uint64_t m_hmiBytes;
+};
+
+} /* namespace sim */
+
+#endif /* __SIM_BOARD_H__ */
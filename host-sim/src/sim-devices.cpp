@@ -0,0 +1,604 @@
+/******************************************************************************
+ *
+ * Module: SIM
+ *
+ * File Name: sim-devices.cpp
+ *
+ * Description: Source file for the models of the board devices
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#include "sim-devices.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace sim
+{
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+namespace
+{
+
+/* HD44780 execution times in ns */
+const Cycles LCD_CLEAR_HOME_TIME_NS = 1520000;
+const Cycles LCD_COMMAND_TIME_NS = 37000;
+const Cycles LCD_DATA_TIME_NS = 41000;
+
+/* minimum width of the enable pulse in ns */
+const Cycles LCD_ENABLE_PULSE_WIDTH_NS = 450;
+
+/* the ddram addresses of the 2 lines */
+const uint8_t LCD_LINE_1_START = 0x00;
+const uint8_t LCD_LINE_1_END = 0x27;
+const uint8_t LCD_LINE_2_START = 0x40;
+const uint8_t LCD_LINE_2_END = 0x67;
+
+bool outputLevel(const Mcu & a_mcu, const Pin & a_pin)
+{
+	uint8_t driven = a_mcu.portOutput(a_pin.port) & a_mcu.portDirection(a_pin.port);
+	return (driven >> a_pin.pin) & 0x01;
+}
+
+Cycles nsToCycles(Cycles a_ns, Cycles a_clockHz)
+{
+	return (a_ns * a_clockHz + 999999999) / 1000000000;
+}
+
+} /* namespace */
+
+/*******************************************************************************
+ *                                  M24C16                                     *
+ *******************************************************************************/
+
+M24c16::M24c16(Cycles a_writeCycleTime) :
+	m_writeCycles(0), m_writeCycleTime(a_writeCycleTime), m_busyUntil(0),
+	m_phase(IDLE), m_block(0), m_address(0)
+{
+	fill(0xFF);
+	std::fill(m_pageWriteCycles, m_pageWriteCycles + SIZE / PAGE_SIZE, 0);
+}
+
+void M24c16::fill(uint8_t a_data)
+{
+	std::fill(m_memory, m_memory + SIZE, a_data);
+}
+
+bool M24c16::load(const std::string & a_path)
+{
+	FILE * file = std::fopen(a_path.c_str(), "rb");
+
+	if(file == nullptr)
+	{
+		return false;
+	}
+
+	size_t count = std::fread(m_memory, 1, SIZE, file);
+	std::fclose(file);
+	return count == SIZE;
+}
+
+bool M24c16::save(const std::string & a_path) const
+{
+	FILE * file = std::fopen(a_path.c_str(), "wb");
+
+	if(file == nullptr)
+	{
+		return false;
+	}
+
+	size_t count = std::fwrite(m_memory, 1, SIZE, file);
+	std::fclose(file);
+	return count == SIZE;
+}
+
+void M24c16::start(Cycles a_now)
+{
+	(void) a_now;
+
+	/* a start before the stop aborts the write */
+	m_pendingWrites.clear();
+	m_phase = IDLE;
+}
+
+bool M24c16::address(uint8_t a_sla, Cycles a_now)
+{
+	if((a_sla & 0xF0) != 0xA0 || a_now < m_busyUntil)
+	{
+		return false;
+	}
+
+	m_block = (a_sla >> 1) & 0x07;
+	m_phase = (a_sla & 0x01) ? READING : WORD_ADDRESS;
+	return true;
+}
+
+bool M24c16::write(uint8_t a_data, Cycles a_now)
+{
+	(void) a_now;
+
+	switch(m_phase)
+	{
+	case WORD_ADDRESS:
+		m_address = (m_block << 8) | a_data;
+		m_phase = WRITING;
+		return true;
+
+	case WRITING:
+		/* the address rolls over inside the page */
+		m_pendingWrites.push_back(std::make_pair(m_address, a_data));
+		m_address = (m_address & ~(PAGE_SIZE - 1)) | ((m_address + 1) & (PAGE_SIZE - 1));
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+uint8_t M24c16::read(bool a_ack, Cycles a_now)
+{
+	(void) a_ack;
+	(void) a_now;
+
+	if(m_phase != READING)
+	{
+		return 0xFF;
+	}
+
+	uint8_t data = m_memory[m_address];
+	m_address = (m_address + 1) % SIZE;
+	return data;
+}
+
+void M24c16::stop(Cycles a_now)
+{
+	if(m_phase == WRITING && !m_pendingWrites.empty())
+	{
+		for(const auto & pendingWrite : m_pendingWrites)
+		{
+			m_memory[pendingWrite.first] = pendingWrite.second;
+		}
+
+		m_writeCycles ++;
+		m_pageWriteCycles[m_pendingWrites.front().first / PAGE_SIZE] ++;
+		m_busyUntil = a_now + m_writeCycleTime;
+	}
+
+	m_pendingWrites.clear();
+	m_phase = IDLE;
+}
+
+/*******************************************************************************
+ *                                  HD44780                                    *
+ *******************************************************************************/
+
+Hd44780::Hd44780(const Wiring & a_wiring, Cycles a_clockHz) :
+	m_wiring(a_wiring), m_clockHz(a_clockHz),
+	m_addressCounter(0), m_cgramSelected(false), m_increment(true), m_displayOn(false),
+	m_eightBit(true), m_lowNibblePending(false), m_highNibble(0), m_readLowNibble(false),
+	m_enable(false), m_enableRise(0), m_driving(false), m_drivenValue(0),
+	m_busyUntil(0), m_stats()
+{
+	std::fill(m_ddram, m_ddram + sizeof(m_ddram), ' ');
+	std::fill(m_cgram, m_cgram + sizeof(m_cgram), 0);
+}
+
+std::string Hd44780::line(unsigned a_row) const
+{
+	uint8_t start = a_row == 0 ? LCD_LINE_1_START : LCD_LINE_2_START;
+	std::string text;
+
+	for(unsigned col = 0; col < COLUMNS; col ++)
+	{
+		uint8_t code = m_ddram[start + col];
+		if(code < 0x10)
+		{
+			text += (char) ('0' + (code & 0x07));
+		}
+		else
+		{
+			text += (code == 0xFF) ? '#' : (char) code;
+		}
+	}
+
+	return text;
+}
+
+uint8_t Hd44780::readBus(const Mcu & a_mcu) const
+{
+	uint8_t levels = a_mcu.pinLevels(m_wiring.dataPort) >> m_wiring.dataFirstPin;
+	return m_wiring.fourBitBus ? (levels & 0x0F) : levels;
+}
+
+uint8_t Hd44780::busValue(void) const
+{
+	return m_addressCounter & 0x7F;
+}
+
+void Hd44780::pinsChanged(Mcu & a_mcu, int a_port, Cycles a_now)
+{
+	if(a_port != m_wiring.e.port)
+	{
+		return;
+	}
+
+	bool enable = outputLevel(a_mcu, m_wiring.e);
+
+	if(enable == m_enable)
+	{
+		return;
+	}
+
+	m_enable = enable;
+	bool dataRegister = outputLevel(a_mcu, m_wiring.rs);
+	bool reading = m_wiring.rw.port >= 0 && outputLevel(a_mcu, m_wiring.rw);
+
+	if(enable)
+	{
+		m_enableRise = a_now;
+
+		if(reading)
+		{
+			uint8_t value;
+
+			if(dataRegister)
+			{
+				value = m_cgramSelected ? m_cgram[m_addressCounter & 0x3F] : m_ddram[m_addressCounter & 0x7F];
+			}
+			else
+			{
+				m_stats.busyReads ++;
+				value = busValue() | ((a_now < m_busyUntil) ? 0x80 : 0x00);
+			}
+
+			if(!m_eightBit)
+			{
+				value = m_readLowNibble ? (value & 0x0F) : (value >> 4);
+			}
+
+			m_driving = true;
+			m_drivenValue = value;
+		}
+		return;
+	}
+
+	if(a_now - m_enableRise < nsToCycles(LCD_ENABLE_PULSE_WIDTH_NS, m_clockHz))
+	{
+		m_stats.shortPulses ++;
+	}
+
+	if(reading)
+	{
+		m_driving = false;
+
+		if(!m_eightBit)
+		{
+			m_readLowNibble = !m_readLowNibble;
+		}
+
+		if(dataRegister && (m_eightBit || !m_readLowNibble))
+		{
+			moveAddress();
+		}
+		return;
+	}
+
+	uint8_t value = readBus(a_mcu);
+
+	if(m_wiring.fourBitBus && m_eightBit)
+	{
+		/* D0 - D3 are not connected, the upper nibble is a whole instruction */
+		execute(dataRegister, value << 4, a_now);
+	}
+	else if(m_eightBit)
+	{
+		execute(dataRegister, value, a_now);
+	}
+	else if(!m_lowNibblePending)
+	{
+		m_highNibble = value & 0x0F;
+		m_lowNibblePending = true;
+	}
+	else
+	{
+		m_lowNibblePending = false;
+		execute(dataRegister, (m_highNibble << 4) | (value & 0x0F), a_now);
+	}
+}
+
+uint8_t Hd44780::drivenPins(const Mcu & a_mcu, int a_port, uint8_t * a_levels) const
+{
+	(void) a_mcu;
+
+	if(!m_driving || a_port != m_wiring.dataPort)
+	{
+		return 0;
+	}
+
+	uint8_t mask = (m_wiring.fourBitBus ? 0x0F : 0xFF) << m_wiring.dataFirstPin;
+	*a_levels = m_drivenValue << m_wiring.dataFirstPin;
+	return mask;
+}
+
+void Hd44780::moveAddress(void)
+{
+	if(m_cgramSelected)
+	{
+		m_addressCounter = (m_addressCounter + (m_increment ? 1 : -1)) & 0x3F;
+		return;
+	}
+
+	if(m_increment)
+	{
+		if(m_addressCounter == LCD_LINE_1_END)
+		{
+			m_addressCounter = LCD_LINE_2_START;
+		}
+		else if(m_addressCounter == LCD_LINE_2_END)
+		{
+			m_addressCounter = LCD_LINE_1_START;
+		}
+		else
+		{
+			m_addressCounter ++;
+		}
+	}
+	else
+	{
+		if(m_addressCounter == LCD_LINE_2_START)
+		{
+			m_addressCounter = LCD_LINE_1_END;
+		}
+		else if(m_addressCounter == LCD_LINE_1_START)
+		{
+			m_addressCounter = LCD_LINE_2_END;
+		}
+		else
+		{
+			m_addressCounter --;
+		}
+	}
+}
+
+void Hd44780::execute(bool a_data, uint8_t a_value, Cycles a_now)
+{
+	if(a_now < m_busyUntil)
+	{
+		m_stats.writesWhileBusy ++;
+	}
+
+	m_readLowNibble = false;
+
+	if(a_data)
+	{
+		m_stats.characters ++;
+
+		if(m_cgramSelected)
+		{
+			m_cgram[m_addressCounter & 0x3F] = a_value;
+		}
+		else
+		{
+			m_ddram[m_addressCounter & 0x7F] = a_value;
+		}
+
+		moveAddress();
+		m_busyUntil = a_now + nsToCycles(LCD_DATA_TIME_NS, m_clockHz);
+
+		if(onDisplayChanged)
+		{
+			onDisplayChanged(a_now);
+		}
+		return;
+	}
+
+	m_stats.commands ++;
+	m_busyUntil = a_now + nsToCycles(LCD_COMMAND_TIME_NS, m_clockHz);
+
+	if(a_value & 0x80)
+	{
+		/* set ddram address */
+		m_cgramSelected = false;
+		m_addressCounter = a_value & 0x7F;
+	}
+	else if(a_value & 0x40)
+	{
+		/* set cgram address */
+		m_cgramSelected = true;
+		m_addressCounter = a_value & 0x3F;
+	}
+	else if(a_value & 0x20)
+	{
+		/* function set */
+		bool eightBit = a_value & 0x10;
+
+		if(eightBit != m_eightBit)
+		{
+			m_eightBit = eightBit;
+			m_lowNibblePending = false;
+		}
+	}
+	else if(a_value & 0x10)
+	{
+		/* cursor or display shift, only the cursor move is modeled */
+		if(!(a_value & 0x08))
+		{
+			bool increment = m_increment;
+			m_increment = a_value & 0x04;
+			moveAddress();
+			m_increment = increment;
+		}
+	}
+	else if(a_value & 0x08)
+	{
+		/* display on/off control */
+		m_displayOn = a_value & 0x04;
+
+		if(onDisplayChanged)
+		{
+			onDisplayChanged(a_now);
+		}
+	}
+	else if(a_value & 0x04)
+	{
+		/* entry mode set */
+		m_increment = a_value & 0x02;
+	}
+	else if(a_value & 0x02)
+	{
+		/* return home */
+		m_cgramSelected = false;
+		m_addressCounter = 0;
+		m_busyUntil = a_now + nsToCycles(LCD_CLEAR_HOME_TIME_NS, m_clockHz);
+	}
+	else if(a_value & 0x01)
+	{
+		/* clear display */
+		std::fill(m_ddram, m_ddram + sizeof(m_ddram), ' ');
+		m_cgramSelected = false;
+		m_addressCounter = 0;
+		m_increment = true;
+		m_busyUntil = a_now + nsToCycles(LCD_CLEAR_HOME_TIME_NS, m_clockHz);
+
+		if(onDisplayChanged)
+		{
+			onDisplayChanged(a_now);
+		}
+	}
+}
+
+/*******************************************************************************
+ *                                   Keypad                                    *
+ *******************************************************************************/
+
+Keypad::Keypad(const Wiring & a_wiring) :
+	m_wiring(a_wiring), m_pressed(a_wiring.rows * a_wiring.cols, false)
+{
+}
+
+void Keypad::pinsChanged(Mcu & a_mcu, int a_port, Cycles a_now)
+{
+	(void) a_mcu;
+	(void) a_port;
+	(void) a_now;
+}
+
+uint8_t Keypad::drivenPins(const Mcu & a_mcu, int a_port, uint8_t * a_levels) const
+{
+	if(a_port == m_wiring.wake.port && a_port != m_wiring.port)
+	{
+		if(rowsPulledLow(a_mcu) == 0)
+		{
+			return 0;
+		}
+		*a_levels = ~(1 << m_wiring.wake.pin);
+		return 1 << m_wiring.wake.pin;
+	}
+
+	if(a_port != m_wiring.port)
+	{
+		return 0;
+	}
+
+	uint8_t direction = a_mcu.portDirection(a_port);
+	uint8_t output = a_mcu.portOutput(a_port);
+	uint8_t mask = 0;
+	uint8_t levels = 0xFF;
+
+	for(unsigned row = 0; row < m_wiring.rows; row ++)
+	{
+		for(unsigned col = 0; col < m_wiring.cols; col ++)
+		{
+			if(!m_pressed[row * m_wiring.cols + col])
+			{
+				continue;
+			}
+
+			uint8_t rowBit = 1 << (m_wiring.firstRowPin + row);
+			uint8_t colBit = 1 << (m_wiring.firstColPin + col);
+
+			if((direction & colBit) && !(output & colBit))
+			{
+				mask |= rowBit;
+				levels &= ~rowBit;
+			}
+			if((direction & rowBit) && !(output & rowBit))
+			{
+				mask |= colBit;
+				levels &= ~colBit;
+			}
+		}
+	}
+
+	*a_levels = levels;
+	return mask;
+}
+
+uint8_t Keypad::rowsPulledLow(const Mcu & a_mcu) const
+{
+	uint8_t direction = a_mcu.portDirection(m_wiring.port);
+	uint8_t output = a_mcu.portOutput(m_wiring.port);
+	uint8_t rows = 0;
+
+	for(unsigned row = 0; row < m_wiring.rows; row ++)
+	{
+		for(unsigned col = 0; col < m_wiring.cols; col ++)
+		{
+			uint8_t colBit = 1 << (m_wiring.firstColPin + col);
+
+			if(m_pressed[row * m_wiring.cols + col] && (direction & colBit) && !(output & colBit))
+			{
+				rows |= 1 << row;
+			}
+		}
+	}
+	return rows;
+}
+
+int Keypad::keyIndex(char a_key) const
+{
+	size_t index = m_wiring.keys.find(a_key);
+	return index == std::string::npos ? -1 : (int) index;
+}
+
+bool Keypad::press(char a_key)
+{
+	int index = keyIndex(a_key);
+
+	if(index < 0)
+	{
+		return false;
+	}
+	m_pressed[index] = true;
+	return true;
+}
+
+bool Keypad::release(char a_key)
+{
+	int index = keyIndex(a_key);
+
+	if(index < 0)
+	{
+		return false;
+	}
+	m_pressed[index] = false;
+	return true;
+}
+
+void Keypad::releaseAll(void)
+{
+	std::fill(m_pressed.begin(), m_pressed.end(), false);
+}
+
+bool Keypad::isPressed(char a_key) const
+{
+	int index = keyIndex(a_key);
+	return index >= 0 && m_pressed[index];
+}
+
+} /* namespace sim */
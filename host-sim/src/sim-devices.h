@@ -0,0 +1,220 @@
+/******************************************************************************
+ *
+ * Module: SIM
+ *
+ * File Name: sim-devices.h
+ *
+ * Description: Models of the devices connected to the simulated MCUs
+ * 				- M24C16 2KB i2c eeprom, with 16 bytes pages and 5ms write cycle
+ * 				- HD44780 character lcd, 8 or 4 bit interface, with the
+ * 				  execution times and the busy flag
+ * 				- 4x4 matrix keypad
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SIM_DEVICES_H__
+#define __SIM_DEVICES_H__
+
+#include "sim-mcu.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace sim
+{
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+/*
+ * [Struct Name]: Pin
+ * [Struct Description]: pin of an MCU port
+ */
+struct Pin
+{
+	int port;
+	int pin;
+};
+
+/*
+ * [Class Name]: M24c16
+ * [Class Description]: 2KB i2c eeprom, 8 blocks of 256 bytes selected by
+ * 						the address bits of the device select code,
+ * 						it doesn't acknowledge while an internal write is running
+ */
+class M24c16 : public TwiDevice
+{
+public:
+	static const unsigned SIZE = 2048;
+	static const unsigned PAGE_SIZE = 16;
+
+	explicit M24c16(Cycles a_writeCycleTime);
+
+	void start(Cycles a_now) override;
+	bool address(uint8_t a_sla, Cycles a_now) override;
+	bool write(uint8_t a_data, Cycles a_now) override;
+	uint8_t read(bool a_ack, Cycles a_now) override;
+	void stop(Cycles a_now) override;
+
+	uint8_t peek(unsigned a_addr) const { return m_memory[a_addr % SIZE]; }
+	void poke(unsigned a_addr, uint8_t a_data) { m_memory[a_addr % SIZE] = a_data; }
+	void fill(uint8_t a_data);
+
+	bool load(const std::string & a_path);
+	bool save(const std::string & a_path) const;
+
+	/* number of internal write cycles, in total and per page */
+	unsigned writeCycles(void) const { return m_writeCycles; }
+	unsigned pageWriteCycles(unsigned a_page) const { return m_pageWriteCycles[a_page]; }
+
+private:
+	enum Phase
+	{
+		IDLE, WORD_ADDRESS, WRITING, READING
+	};
+
+	uint8_t m_memory[SIZE];
+	unsigned m_pageWriteCycles[SIZE / PAGE_SIZE];
+	unsigned m_writeCycles;
+	Cycles m_writeCycleTime;
+	Cycles m_busyUntil;
+	Phase m_phase;
+	unsigned m_block;
+	unsigned m_address;
+	std::vector<std::pair<unsigned, uint8_t>> m_pendingWrites;
+};
+
+/*
+ * [Class Name]: Hd44780
+ * [Class Description]: character lcd on the pins of an MCU, the controller
+ * 						latches written data on the falling edge of E and
+ * 						drives the data pins while E is high in read mode
+ */
+class Hd44780 : public PinDevice
+{
+public:
+	struct Wiring
+	{
+		Pin rs;
+		/* port -1 => R/W is tied to the ground */
+		Pin rw;
+		Pin e;
+		/* data port, first pin connected to D0 (8 bit) or D4 (4 bit) */
+		int dataPort;
+		int dataFirstPin;
+		bool fourBitBus;
+	};
+
+	struct Stats
+	{
+		/* commands and characters written */
+		unsigned commands;
+		unsigned characters;
+		/* busy flag reads */
+		unsigned busyReads;
+		/* writes received while the lcd was still busy, they may be lost on a real lcd */
+		unsigned writesWhileBusy;
+		/* enable pulses shorter than the minimum width */
+		unsigned shortPulses;
+	};
+
+	static const unsigned COLUMNS = 16;
+	static const unsigned ROWS = 2;
+
+	Hd44780(const Wiring & a_wiring, Cycles a_clockHz);
+
+	void pinsChanged(Mcu & a_mcu, int a_port, Cycles a_now) override;
+	uint8_t drivenPins(const Mcu & a_mcu, int a_port, uint8_t * a_levels) const override;
+
+	/* visible text of a row, custom characters (codes 0x00 - 0x0F) are shown as
+	 * their slot 0 - 7 and the full block as '#' */
+	std::string line(unsigned a_row) const;
+	uint8_t cursorAddress(void) const { return m_addressCounter; }
+	bool displayIsOn(void) const { return m_displayOn; }
+	const uint8_t * cgram(void) const { return m_cgram; }
+	const Stats & stats(void) const { return m_stats; }
+
+	/* called after every change of the visible text */
+	std::function<void(Cycles)> onDisplayChanged;
+
+private:
+	void execute(bool a_data, uint8_t a_value, Cycles a_now);
+	void moveAddress(void);
+	uint8_t readBus(const Mcu & a_mcu) const;
+	uint8_t busValue(void) const;
+
+	Wiring m_wiring;
+	Cycles m_clockHz;
+
+	uint8_t m_ddram[0x80];
+	uint8_t m_cgram[64];
+	uint8_t m_addressCounter;
+	bool m_cgramSelected;
+	bool m_increment;
+	bool m_displayOn;
+	bool m_eightBit;
+	bool m_lowNibblePending;
+	uint8_t m_highNibble;
+	bool m_readLowNibble;
+
+	bool m_enable;
+	Cycles m_enableRise;
+	bool m_driving;
+	uint8_t m_drivenValue;
+	Cycles m_busyUntil;
+	Cycles m_lastDataRead;
+
+	Stats m_stats;
+};
+
+/*
+ * [Class Name]: Keypad
+ * [Class Description]: matrix keypad, a pressed key connects its row and
+ * 						column pins, so a pin driven low on one side pulls
+ * 						the other side low
+ */
+class Keypad : public PinDevice
+{
+public:
+	struct Wiring
+	{
+		int port;
+		int firstRowPin;
+		int firstColPin;
+		unsigned rows;
+		unsigned cols;
+		/* key chars row by row */
+		std::string keys;
+		/* pin connected to all the rows through diodes, it's pulled low when
+		 * any row is pulled low by a key, port -1 if it's not connected */
+		Pin wake;
+	};
+
+	explicit Keypad(const Wiring & a_wiring);
+
+	void pinsChanged(Mcu & a_mcu, int a_port, Cycles a_now) override;
+	uint8_t drivenPins(const Mcu & a_mcu, int a_port, uint8_t * a_levels) const override;
+
+	/* returns false if the key doesn't exist */
+	bool press(char a_key);
+	bool release(char a_key);
+	void releaseAll(void);
+	bool isPressed(char a_key) const;
+
+private:
+	int keyIndex(char a_key) const;
+
+	/* rows pulled low by the pressed keys of the cols driven low */
+	uint8_t rowsPulledLow(const Mcu & a_mcu) const;
+
+	Wiring m_wiring;
+	std::vector<bool> m_pressed;
+};
+
+} /* namespace sim */
+
+#endif /* __SIM_DEVICES_H__ */
@@ -0,0 +1,1346 @@
+/******************************************************************************
+ *
+ * Module: SIM
+ *
+ * File Name: sim-mcu.cpp
+ *
+ * Description: Source file for the simulated ATmega16
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#include "sim-mcu.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace sim
+{
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+namespace
+{
+
+/* register addresses, as used by the firmware (data space) */
+enum Register
+{
+	REG_TWBR = 0x20, REG_TWSR = 0x21, REG_TWAR = 0x22, REG_TWDR = 0x23,
+	REG_UBRRL = 0x29, REG_UCSRB = 0x2A, REG_UCSRA = 0x2B, REG_UDR = 0x2C,
+	REG_PIND = 0x30, REG_DDRD = 0x31, REG_PORTD = 0x32,
+	REG_PINC = 0x33, REG_DDRC = 0x34, REG_PORTC = 0x35,
+	REG_PINB = 0x36, REG_DDRB = 0x37, REG_PORTB = 0x38,
+	REG_PINA = 0x39, REG_DDRA = 0x3A, REG_PORTA = 0x3B,
+	REG_UBRRH_UCSRC = 0x40,
+	REG_OCR2 = 0x43, REG_TCNT2 = 0x44, REG_TCCR2 = 0x45,
+	REG_ICR1L = 0x46, REG_ICR1H = 0x47, REG_OCR1BL = 0x48, REG_OCR1BH = 0x49,
+	REG_OCR1AL = 0x4A, REG_OCR1AH = 0x4B, REG_TCNT1L = 0x4C, REG_TCNT1H = 0x4D,
+	REG_TCCR1B = 0x4E, REG_TCCR1A = 0x4F,
+	REG_SFIOR = 0x50, REG_TCNT0 = 0x52, REG_TCCR0 = 0x53,
+	REG_MCUCR = 0x55, REG_TWCR = 0x56, REG_TIFR = 0x58, REG_TIMSK = 0x59,
+	REG_GIFR = 0x5A, REG_GICR = 0x5B, REG_OCR0 = 0x5C, REG_SREG = 0x5F
+};
+
+/* TIFR / TIMSK bits */
+enum TimerFlag
+{
+	TOV0 = 0, OCF0 = 1, TOV1 = 2, OCF1B = 3, OCF1A = 4, ICF1 = 5, TOV2 = 6, OCF2 = 7
+};
+
+/* UCSRA, UCSRB, UCSRC bits */
+enum UartBit
+{
+	MPCM = 0, U2X = 1, DOR = 3, UDRE = 5, TXC = 6, RXC = 7,
+	UCSZ2 = 2, TXEN = 3, RXEN = 4, UDRIE = 5, TXCIE = 6, RXCIE = 7,
+	USBS = 3, URSEL = 7
+};
+
+/* SREG global interrupt bit, the other flags are not modeled */
+const int SREG_I = 7;
+
+/* MCUCR sleep bits of the ATmega16 */
+enum SleepBit
+{
+	SM0 = 4, SM1 = 5, SE = 6, SM2 = 7
+};
+
+/* GICR / GIFR bits of INT0 and INT1, their pins are PD2 and PD3 and their
+ * sense bits are 2 bits each in MCUCR, INT2 is not connected on the board */
+enum ExtIntBit
+{
+	INT0 = 6, INT1 = 7, INTF0 = 6, INTF1 = 7
+};
+
+const int EXT_INT_PORT = 3;
+const int EXT_INT_FIRST_PIN = 2;
+const int EXT_INT_COUNT = 2;
+
+/* ISCn1:0 of MCUCR */
+enum ExtIntSense
+{
+	SENSE_LOW_LEVEL = 0, SENSE_ANY_CHANGE = 1, SENSE_FALLING_EDGE = 2, SENSE_RISING_EDGE = 3
+};
+
+/* TWCR bits */
+enum TwiBit
+{
+	TWIE = 0, TWEN = 2, TWWC = 3, TWSTO = 4, TWSTA = 5, TWEA = 6, TWINT = 7
+};
+
+/* TWI master status codes */
+enum TwiStatus
+{
+	TWI_START = 0x08, TWI_REP_START = 0x10,
+	TWI_MT_SLA_W_ACK = 0x18, TWI_MT_SLA_W_NACK = 0x20,
+	TWI_MT_DATA_ACK = 0x28, TWI_MT_DATA_NACK = 0x30,
+	TWI_MR_SLA_R_ACK = 0x40, TWI_MR_SLA_R_NACK = 0x48,
+	TWI_MR_DATA_ACK = 0x50, TWI_MR_DATA_NACK = 0x58,
+	TWI_NO_INFO = 0xF8
+};
+
+/* SFIOR pull up disable bit */
+const int PUD = 2;
+
+const size_t COROUTINE_STACK_SIZE = 1024 * 1024;
+
+/* flags of each timer: overflow, compare A, compare B */
+const int TIMER_OVERFLOW_FLAG[3] = { TOV0, TOV1, TOV2 };
+const int TIMER_COMPARE_FLAG[3][2] = { { OCF0, -1 }, { OCF1A, OCF1B }, { OCF2, -1 } };
+
+const uint16_t TIMER_PRESCALERS_0_1[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+const uint16_t TIMER_PRESCALERS_2[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+
+/* isr of every vector of every image, filled before main by the ISR macro */
+void (*g_vectors[MAX_IMAGES][VECTORS_COUNT])(void);
+
+/* port of a PORTx or DDRx register */
+int portOfRegister(uint16_t a_addr)
+{
+	return (REG_PORTA + 1 - a_addr) / 3;
+}
+
+} /* namespace */
+
+/*******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************/
+
+Mcu * Mcu::s_current = nullptr;
+Mcu * Mcu::s_starting = nullptr;
+
+/*******************************************************************************
+ *                      Functions Definitions                                  *
+ *******************************************************************************/
+
+Mcu::Mcu(const std::string & a_name, int a_image, Entry a_entry, Cycles a_clockHz) :
+	m_name(a_name), m_image(a_image), m_entry(a_entry), m_clockHz(a_clockHz),
+	m_cycles(0), m_limit(0), m_stack(COROUTINE_STACK_SIZE), m_started(false), m_halted(false),
+	m_interruptsEnabled(false), m_interruptsCount(0), m_idleCycles(0), m_sleepCycles(),
+	m_lastReadAddr(0xFFFF), m_lastReadValue(0), m_repeatedReads(0), m_extIntLevels(0),
+	m_ucsrc(0x86), m_ubrrh(0), m_uartTxBufferFull(false), m_uartTxBuffer(0), m_uartTxShiftEnd(NEVER),
+	m_twint(false), m_twiStatus(TWI_NO_INFO), m_twiOperation(OPERATION_NONE), m_twiCompletion(NEVER),
+	m_twiBusOwned(false), m_twiSelected(nullptr), m_twiReading(false)
+{
+	std::fill(m_io, m_io + sizeof(m_io), 0);
+	m_io[REG_UCSRA] = (1 << UDRE);
+	m_io[REG_TWDR] = 0xFF;
+
+	for(Timer & timer : m_timers)
+	{
+		timer = Timer();
+	}
+}
+
+Mcu::~Mcu()
+{
+}
+
+int Mcu::registerVector(int a_image, int a_vector, void (*a_isr)(void))
+{
+	if(a_image < 0 || a_image >= MAX_IMAGES || a_vector <= 0 || a_vector >= VECTORS_COUNT)
+	{
+		std::fprintf(stderr, "sim: invalid vector %d for image %d\n", a_vector, a_image);
+		std::abort();
+	}
+	g_vectors[a_image][a_vector] = a_isr;
+	return a_vector;
+}
+
+/******************************** scheduling *********************************/
+
+void Mcu::runUntil(Cycles a_limit)
+{
+	if(m_halted)
+	{
+		/* firmware returned from main, only the peripherals keep running */
+		advanceTo(std::max(m_cycles, a_limit + 1));
+		return;
+	}
+
+	m_limit = a_limit;
+
+	Mcu * previous = s_current;
+	s_current = this;
+
+	if(!m_started)
+	{
+		m_started = true;
+		getcontext(&m_context);
+		m_context.uc_stack.ss_sp = m_stack.data();
+		m_context.uc_stack.ss_size = m_stack.size();
+		m_context.uc_link = &m_boardContext;
+		s_starting = this;
+		makecontext(&m_context, &Mcu::coroutineEntry, 0);
+	}
+
+	swapcontext(&m_boardContext, &m_context);
+
+	s_current = previous;
+}
+
+void Mcu::coroutineEntry(void)
+{
+	Mcu * mcu = s_starting;
+	mcu->m_entry();
+	mcu->m_halted = true;
+}
+
+void Mcu::yieldToBoard(void)
+{
+	swapcontext(&m_context, &m_boardContext);
+}
+
+void Mcu::charge(Cycles a_cycles)
+{
+	advanceTo(m_cycles + a_cycles);
+
+	if(m_cycles > m_limit)
+	{
+		yieldToBoard();
+	}
+
+	serviceInterrupts();
+}
+
+void Mcu::idle(void)
+{
+	if(m_interruptsEnabled && pendingVector() >= 0)
+	{
+		serviceInterrupts();
+		return;
+	}
+	skipIdleTime(true);
+}
+
+/*
+ * sleeps like the sleep instruction, till an interrupt is serviced, the skipped
+ * time is idle time and it's counted for the sleep mode in MCUCR too, the clocks
+ * stopped by the deeper modes are not modelled, only the residency is counted
+ */
+void Mcu::sleep(void)
+{
+	uint8_t mcucr = m_io[REG_MCUCR];
+
+	/* sleep enable is clear, the instruction does nothing */
+	if(!(mcucr & (1 << SE)))
+	{
+		charge(1);
+		return;
+	}
+
+	int mode = ((mcucr >> SM0) & 1) | (((mcucr >> SM1) & 1) << 1) | (((mcucr >> SM2) & 1) << 2);
+	uint64_t interruptsBefore = m_interruptsCount;
+	Cycles idleBefore = m_idleCycles;
+
+	/* with the interrupts disabled nothing wakes the cpu up, idle once so the time still runs */
+	do
+	{
+		idle();
+	}
+	while(m_interruptsEnabled && m_interruptsCount == interruptsBefore);
+
+	m_sleepCycles[mode] += m_idleCycles - idleBefore;
+}
+
+void Mcu::skipIdleTime(bool a_idle)
+{
+	Cycles target = nextEvent();
+
+	for(const PinDevice * device : m_pinDevices)
+	{
+		target = std::min(target, device->nextChange());
+	}
+
+	/* stop at the end of the time slice, so the board can run the other MCU */
+	target = std::min(target, m_limit + 1);
+
+	if(target > m_cycles)
+	{
+		/* polling keeps the cpu busy, only the idle hint is counted as idle time */
+		if(a_idle)
+		{
+			m_idleCycles += target - m_cycles;
+		}
+		advanceTo(target);
+	}
+
+	if(m_cycles > m_limit)
+	{
+		yieldToBoard();
+	}
+
+	serviceInterrupts();
+}
+
+void Mcu::advanceTo(Cycles a_target)
+{
+	Cycles event;
+
+	while((event = nextEvent()) <= a_target)
+	{
+		m_cycles = std::max(m_cycles, event);
+		processEvents();
+	}
+
+	m_cycles = std::max(m_cycles, a_target);
+}
+
+Cycles Mcu::nextEvent(void) const
+{
+	Cycles event = std::min(m_uartTxShiftEnd, m_twiCompletion);
+
+	if(!m_uartRxPending.empty())
+	{
+		event = std::min(event, m_uartRxPending.front().arrival);
+	}
+
+	for(int timer = 0; timer < 3; timer ++)
+	{
+		event = std::min(event, timerNextEvent(timer));
+	}
+
+	return event;
+}
+
+void Mcu::processEvents(void)
+{
+	timersSync();
+
+	if(m_uartTxShiftEnd <= m_cycles)
+	{
+		m_uartTxShiftEnd = NEVER;
+
+		if(m_uartTxBufferFull)
+		{
+			m_uartTxBufferFull = false;
+			uartStartShift(m_uartTxBuffer);
+		}
+		else
+		{
+			m_io[REG_UCSRA] |= (1 << TXC);
+		}
+	}
+
+	while(!m_uartRxPending.empty() && m_uartRxPending.front().arrival <= m_cycles)
+	{
+		uint8_t data = m_uartRxPending.front().data;
+		m_uartRxPending.pop_front();
+
+		if(m_io[REG_UCSRB] & (1 << RXEN))
+		{
+			if(m_uartRxFifo.size() < 2)
+			{
+				m_uartRxFifo.push_back(data);
+			}
+			else
+			{
+				m_io[REG_UCSRA] |= (1 << DOR);
+			}
+		}
+	}
+
+	if(m_twiCompletion <= m_cycles)
+	{
+		twiComplete();
+	}
+}
+
+/******************************** interrupts *********************************/
+
+int Mcu::pendingVector(void) const
+{
+	static const int extIntVectors[EXT_INT_COUNT] = { VECTOR_INT0, VECTOR_INT1 };
+
+	for(int extInt = 0; extInt < EXT_INT_COUNT; extInt ++)
+	{
+		if(!(m_io[REG_GICR] & (1 << (INT0 + extInt))))
+		{
+			continue;
+		}
+
+		/* the low level keeps the interrupt pending without a flag */
+		if(extIntSense(extInt) == SENSE_LOW_LEVEL ?
+				!(m_extIntLevels & (1 << extInt)) : (m_io[REG_GIFR] & (1 << (INTF0 + extInt))))
+		{
+			return extIntVectors[extInt];
+		}
+	}
+
+	static const struct
+	{
+		int vector;
+		int flag;
+	} timerVectors[] =
+	{
+		{ VECTOR_TIMER2_COMP, OCF2 }, { VECTOR_TIMER2_OVF, TOV2 },
+		{ VECTOR_TIMER1_CAPT, ICF1 }, { VECTOR_TIMER1_COMPA, OCF1A },
+		{ VECTOR_TIMER1_COMPB, OCF1B }, { VECTOR_TIMER1_OVF, TOV1 },
+		{ VECTOR_TIMER0_OVF, TOV0 }
+	};
+
+	uint8_t timerPending = m_io[REG_TIFR] & m_io[REG_TIMSK];
+
+	for(const auto & timerVector : timerVectors)
+	{
+		if(timerPending & (1 << timerVector.flag))
+		{
+			return timerVector.vector;
+		}
+	}
+
+	uint8_t ucsrb = m_io[REG_UCSRB];
+
+	if((ucsrb & (1 << RXCIE)) && !m_uartRxFifo.empty())
+	{
+		return VECTOR_USART_RXC;
+	}
+	if((ucsrb & (1 << UDRIE)) && !m_uartTxBufferFull)
+	{
+		return VECTOR_USART_UDRE;
+	}
+	if((ucsrb & (1 << TXCIE)) && (m_io[REG_UCSRA] & (1 << TXC)))
+	{
+		return VECTOR_USART_TXC;
+	}
+	if((m_io[REG_TWCR] & (1 << TWIE)) && m_twint)
+	{
+		return VECTOR_TWI;
+	}
+	if(timerPending & (1 << OCF0))
+	{
+		return VECTOR_TIMER0_COMP;
+	}
+
+	return -1;
+}
+
+void Mcu::serviceInterrupts(void)
+{
+	while(m_interruptsEnabled)
+	{
+		int vector = pendingVector();
+
+		if(vector < 0)
+		{
+			return;
+		}
+
+		void (*isr)(void) = g_vectors[m_image][vector];
+
+		if(isr == nullptr)
+		{
+			std::fprintf(stderr, "sim: %s: interrupt %d is enabled without an ISR\n", m_name.c_str(), vector);
+			std::abort();
+		}
+
+		/* the flags cleared by the hardware when the vector is executed */
+		switch(vector)
+		{
+		case VECTOR_INT0: m_io[REG_GIFR] &= ~(1 << INTF0); break;
+		case VECTOR_INT1: m_io[REG_GIFR] &= ~(1 << INTF1); break;
+		case VECTOR_TIMER2_COMP: m_io[REG_TIFR] &= ~(1 << OCF2); break;
+		case VECTOR_TIMER2_OVF: m_io[REG_TIFR] &= ~(1 << TOV2); break;
+		case VECTOR_TIMER1_CAPT: m_io[REG_TIFR] &= ~(1 << ICF1); break;
+		case VECTOR_TIMER1_COMPA: m_io[REG_TIFR] &= ~(1 << OCF1A); break;
+		case VECTOR_TIMER1_COMPB: m_io[REG_TIFR] &= ~(1 << OCF1B); break;
+		case VECTOR_TIMER1_OVF: m_io[REG_TIFR] &= ~(1 << TOV1); break;
+		case VECTOR_TIMER0_OVF: m_io[REG_TIFR] &= ~(1 << TOV0); break;
+		case VECTOR_TIMER0_COMP: m_io[REG_TIFR] &= ~(1 << OCF0); break;
+		case VECTOR_USART_TXC: m_io[REG_UCSRA] &= ~(1 << TXC); break;
+		default: break;
+		}
+
+		m_interruptsEnabled = false;
+		m_interruptsCount ++;
+		charge(INTERRUPT_CYCLES);
+		isr();
+		m_interruptsEnabled = true;
+	}
+}
+
+void Mcu::enableInterrupts(void)
+{
+	m_interruptsEnabled = true;
+	charge(1);
+}
+
+void Mcu::disableInterrupts(void)
+{
+	m_interruptsEnabled = false;
+	charge(1);
+}
+
+/******************************** registers **********************************/
+
+uint8_t Mcu::read8(uint16_t a_addr)
+{
+	charge(REGISTER_ACCESS_CYCLES);
+
+	uint8_t value;
+
+	switch(a_addr)
+	{
+	case REG_PINA: case REG_PINB: case REG_PINC: case REG_PIND:
+		value = pinLevels(portOfRegister(a_addr + 2));
+		break;
+
+	case REG_UDR:
+		value = 0;
+		if(!m_uartRxFifo.empty())
+		{
+			value = m_uartRxFifo.front();
+			m_uartRxFifo.pop_front();
+			m_io[REG_UCSRA] &= ~(1 << DOR);
+		}
+		break;
+
+	case REG_TIFR:
+		timersSync();
+		value = m_io[REG_TIFR];
+		break;
+
+	case REG_SREG:
+		value = m_interruptsEnabled ? (1 << SREG_I) : 0;
+		break;
+
+	case REG_TCNT0: case REG_TCNT2:
+	case REG_TCNT1L: case REG_TCNT1H:
+		timersSync();
+		value = peek(a_addr);
+		break;
+
+	default:
+		value = peek(a_addr);
+		break;
+	}
+
+	/* a register read again and again with the same value is polled,
+	 * skip the time till something can change it
+	 */
+	if(a_addr == m_lastReadAddr && value == m_lastReadValue)
+	{
+		if(++ m_repeatedReads >= POLLING_READS_THRESHOLD)
+		{
+			m_repeatedReads = 0;
+			skipIdleTime(false);
+		}
+	}
+	else
+	{
+		m_lastReadAddr = a_addr;
+		m_lastReadValue = value;
+		m_repeatedReads = 0;
+	}
+
+	return value;
+}
+
+uint8_t Mcu::peek(uint16_t a_addr) const
+{
+	switch(a_addr)
+	{
+	case REG_PINA: case REG_PINB: case REG_PINC: case REG_PIND:
+		return pinLevels(portOfRegister(a_addr + 2));
+
+	case REG_UCSRA:
+	{
+		uint8_t value = m_io[REG_UCSRA] & ~((1 << RXC) | (1 << UDRE));
+		if(!m_uartRxFifo.empty())
+		{
+			value |= (1 << RXC);
+		}
+		if(!m_uartTxBufferFull)
+		{
+			value |= (1 << UDRE);
+		}
+		return value;
+	}
+
+	case REG_UDR:
+		return m_uartRxFifo.empty() ? 0 : m_uartRxFifo.front();
+
+	case REG_UBRRH_UCSRC:
+		return m_ucsrc;
+
+	case REG_TWCR:
+		return (m_io[REG_TWCR] & ~(1 << TWINT)) | (m_twint ? (1 << TWINT) : 0);
+
+	case REG_TWSR:
+		return (m_twiStatus & 0xF8) | (m_io[REG_TWSR] & 0x03);
+
+	case REG_TCNT0: return (uint8_t) m_timers[0].count;
+	case REG_TCNT2: return (uint8_t) m_timers[2].count;
+	case REG_OCR0: return (uint8_t) m_timers[0].compare[0];
+	case REG_OCR2: return (uint8_t) m_timers[2].compare[0];
+
+	case REG_TCNT1L: case REG_TCNT1H:
+	case REG_OCR1AL: case REG_OCR1AH:
+	case REG_OCR1BL: case REG_OCR1BH:
+	case REG_ICR1L: case REG_ICR1H:
+	{
+		uint16_t value = peek16(a_addr & ~1);
+		return (a_addr & 1) ? (value >> 8) : (value & 0xFF);
+	}
+
+	default:
+		return a_addr < sizeof(m_io) ? m_io[a_addr] : 0;
+	}
+}
+
+uint16_t Mcu::peek16(uint16_t a_addr) const
+{
+	switch(a_addr)
+	{
+	case REG_TCNT1L: return m_timers[1].count;
+	case REG_OCR1AL: return m_timers[1].compare[0];
+	case REG_OCR1BL: return m_timers[1].compare[1];
+	case REG_ICR1L: return m_timers[1].capture;
+	default: return peek(a_addr) | (peek(a_addr + 1) << 8);
+	}
+}
+
+void Mcu::write8(uint16_t a_addr, uint8_t a_value)
+{
+	charge(REGISTER_ACCESS_CYCLES);
+
+	m_lastReadAddr = 0xFFFF;
+
+	switch(a_addr)
+	{
+	case REG_PORTA: case REG_PORTB: case REG_PORTC: case REG_PORTD:
+	case REG_DDRA: case REG_DDRB: case REG_DDRC: case REG_DDRD:
+		if(m_io[a_addr] != a_value)
+		{
+			m_io[a_addr] = a_value;
+			pinsChanged(portOfRegister(a_addr));
+		}
+		break;
+
+	case REG_PINA: case REG_PINB: case REG_PINC: case REG_PIND:
+		/* read only on the ATmega16 */
+		break;
+
+	case REG_SREG:
+		m_interruptsEnabled = (a_value & (1 << SREG_I)) != 0;
+		break;
+
+	case REG_SFIOR:
+		m_io[a_addr] = a_value;
+		for(int port = 0; port < PORTS_COUNT; port ++)
+		{
+			pinsChanged(port);
+		}
+		break;
+
+	case REG_UDR:
+		if(m_io[REG_UCSRB] & (1 << TXEN))
+		{
+			if(m_uartTxShiftEnd == NEVER)
+			{
+				uartStartShift(a_value);
+			}
+			else if(!m_uartTxBufferFull)
+			{
+				m_uartTxBufferFull = true;
+				m_uartTxBuffer = a_value;
+			}
+		}
+		break;
+
+	case REG_UCSRA:
+		/* TXC is cleared by writing one to it */
+		m_io[REG_UCSRA] &= ~(a_value & (1 << TXC));
+		m_io[REG_UCSRA] = (m_io[REG_UCSRA] & ~((1 << U2X) | (1 << MPCM))) | (a_value & ((1 << U2X) | (1 << MPCM)));
+		break;
+
+	case REG_UCSRB:
+		m_io[REG_UCSRB] = a_value;
+		if(!(a_value & (1 << RXEN)))
+		{
+			m_uartRxFifo.clear();
+		}
+		break;
+
+	case REG_UBRRH_UCSRC:
+		if(a_value & (1 << URSEL))
+		{
+			m_ucsrc = a_value;
+		}
+		else
+		{
+			m_ubrrh = a_value & 0x0F;
+		}
+		break;
+
+	case REG_TWCR:
+		twiControl(a_value);
+		break;
+
+	case REG_TWDR:
+		if(!m_twint && m_twiOperation != OPERATION_NONE)
+		{
+			m_io[REG_TWCR] |= (1 << TWWC);
+		}
+		else
+		{
+			m_io[REG_TWDR] = a_value;
+		}
+		break;
+
+	case REG_TWSR:
+		/* only the prescaler bits are writable */
+		m_io[REG_TWSR] = a_value & 0x03;
+		break;
+
+	case REG_TIFR:
+		timersSync();
+		/* flags are cleared by writing one to them */
+		m_io[REG_TIFR] &= ~a_value;
+		break;
+
+	case REG_GIFR:
+		m_io[REG_GIFR] &= ~a_value;
+		break;
+
+	case REG_TCCR0: case REG_TCCR2: case REG_TCCR1A: case REG_TCCR1B:
+		timersSync();
+		/* force output compare bits are strobes, they always read as zero */
+		if(a_addr == REG_TCCR0 || a_addr == REG_TCCR2)
+		{
+			a_value &= ~0x80;
+		}
+		else if(a_addr == REG_TCCR1A)
+		{
+			a_value &= ~0x0C;
+		}
+		m_io[a_addr] = a_value;
+		break;
+
+	case REG_TCNT0: timersSync(); m_timers[0].count = a_value; break;
+	case REG_TCNT2: timersSync(); m_timers[2].count = a_value; break;
+	case REG_OCR0: timersSync(); m_timers[0].compare[0] = a_value; break;
+	case REG_OCR2: timersSync(); m_timers[2].compare[0] = a_value; break;
+
+	case REG_TCNT1L: case REG_TCNT1H:
+	case REG_OCR1AL: case REG_OCR1AH:
+	case REG_OCR1BL: case REG_OCR1BH:
+	case REG_ICR1L: case REG_ICR1H:
+	{
+		uint16_t value = peek16(a_addr & ~1);
+		value = (a_addr & 1) ? ((value & 0x00FF) | (a_value << 8)) : ((value & 0xFF00) | a_value);
+		timersSync();
+		timer1Store(a_addr & ~1, value);
+		break;
+	}
+
+	default:
+		if(a_addr < sizeof(m_io))
+		{
+			m_io[a_addr] = a_value;
+		}
+		break;
+	}
+}
+
+uint16_t Mcu::read16(uint16_t a_addr)
+{
+	switch(a_addr)
+	{
+	case REG_TCNT1L: case REG_OCR1AL: case REG_OCR1BL: case REG_ICR1L:
+		charge(2 * REGISTER_ACCESS_CYCLES);
+		timersSync();
+		m_lastReadAddr = 0xFFFF;
+		return peek16(a_addr);
+
+	default:
+		return read8(a_addr) | (read8(a_addr + 1) << 8);
+	}
+}
+
+void Mcu::write16(uint16_t a_addr, uint16_t a_value)
+{
+	switch(a_addr)
+	{
+	case REG_TCNT1L: case REG_OCR1AL: case REG_OCR1BL: case REG_ICR1L:
+		charge(2 * REGISTER_ACCESS_CYCLES);
+		timersSync();
+		m_lastReadAddr = 0xFFFF;
+		timer1Store(a_addr, a_value);
+		break;
+
+	default:
+		write8(a_addr + 1, a_value >> 8);
+		write8(a_addr, a_value & 0xFF);
+		break;
+	}
+}
+
+/*********************************** dio *************************************/
+
+uint8_t Mcu::portDirection(int a_port) const
+{
+	return m_io[REG_DDRA - 3 * a_port];
+}
+
+uint8_t Mcu::portOutput(int a_port) const
+{
+	return m_io[REG_PORTA - 3 * a_port];
+}
+
+uint8_t Mcu::pinLevels(int a_port) const
+{
+	uint8_t direction = portDirection(a_port);
+	uint8_t output = portOutput(a_port);
+
+	/* devices driving the same pin act as wired and */
+	uint8_t drivenMask = 0;
+	uint8_t drivenLevels = 0xFF;
+
+	for(const PinDevice * device : m_pinDevices)
+	{
+		uint8_t levels = 0xFF;
+		uint8_t mask = device->drivenPins(*this, a_port, &levels);
+		drivenMask |= mask;
+		drivenLevels &= (levels | ~mask);
+	}
+
+	uint8_t pullUps = (m_io[REG_SFIOR] & (1 << PUD)) ? 0 : (output & ~direction);
+
+	/* floating inputs read as low */
+	return (output & direction) |
+			(~direction & drivenMask & drivenLevels) |
+			(~direction & ~drivenMask & pullUps);
+}
+
+void Mcu::pinsChanged(int a_port)
+{
+	for(PinDevice * device : m_pinDevices)
+	{
+		device->pinsChanged(*this, a_port, m_cycles);
+	}
+	extIntSync();
+}
+
+void Mcu::externalPinsChanged(void)
+{
+	m_lastReadAddr = 0xFFFF;
+	extIntSync();
+}
+
+/**************************** external interrupts ****************************/
+
+int Mcu::extIntSense(int a_extInt) const
+{
+	return (m_io[REG_MCUCR] >> (2 * a_extInt)) & 0x03;
+}
+
+/*
+ * samples the external interrupt pins after any change of the port levels, the edges set
+ * the flags even if the interrupts are disabled, like the hardware does
+ */
+void Mcu::extIntSync(void)
+{
+	uint8_t levels = (pinLevels(EXT_INT_PORT) >> EXT_INT_FIRST_PIN) & ((1 << EXT_INT_COUNT) - 1);
+	uint8_t changed = levels ^ m_extIntLevels;
+
+	m_extIntLevels = levels;
+
+	for(int extInt = 0; extInt < EXT_INT_COUNT; extInt ++)
+	{
+		if(!(changed & (1 << extInt)))
+		{
+			continue;
+		}
+
+		bool rising = (levels & (1 << extInt)) != 0;
+
+		switch(extIntSense(extInt))
+		{
+		case SENSE_ANY_CHANGE: break;
+		case SENSE_FALLING_EDGE: if(rising) continue; break;
+		case SENSE_RISING_EDGE: if(!rising) continue; break;
+		default: continue;
+		}
+		m_io[REG_GIFR] |= (1 << (INTF0 + extInt));
+	}
+}
+
+/********************************** timers ***********************************/
+
+uint8_t Mcu::timerClockSelect(int a_timer) const
+{
+	switch(a_timer)
+	{
+	case 0: return m_io[REG_TCCR0] & 0x07;
+	case 1: return m_io[REG_TCCR1B] & 0x07;
+	default: return m_io[REG_TCCR2] & 0x07;
+	}
+}
+
+Cycles Mcu::timerDivisor(int a_timer) const
+{
+	uint8_t clockSelect = timerClockSelect(a_timer);
+	return a_timer == 2 ? TIMER_PRESCALERS_2[clockSelect] : TIMER_PRESCALERS_0_1[clockSelect];
+}
+
+bool Mcu::timerIsCtc(int a_timer) const
+{
+	if(a_timer == 1)
+	{
+		uint8_t mode = (m_io[REG_TCCR1A] & 0x03) | ((m_io[REG_TCCR1B] >> 1) & 0x0C);
+		return mode == 4 || mode == 12;
+	}
+
+	uint8_t control = m_io[a_timer == 0 ? REG_TCCR0 : REG_TCCR2];
+	return (control & 0x48) == 0x08;
+}
+
+uint16_t Mcu::timerMax(int a_timer) const
+{
+	return a_timer == 1 ? 0xFFFF : 0xFF;
+}
+
+uint16_t Mcu::timerTop(int a_timer) const
+{
+	if(a_timer != 1)
+	{
+		return timerIsCtc(a_timer) ? m_timers[a_timer].compare[0] : 0xFF;
+	}
+
+	uint8_t mode = (m_io[REG_TCCR1A] & 0x03) | ((m_io[REG_TCCR1B] >> 1) & 0x0C);
+
+	switch(mode)
+	{
+	case 1: case 5: return 0x00FF;
+	case 2: case 6: return 0x01FF;
+	case 3: case 7: return 0x03FF;
+	case 4: case 9: case 11: case 15: return m_timers[1].compare[0];
+	case 8: case 10: case 12: case 14: return m_timers[1].capture;
+	default: return 0xFFFF;
+	}
+}
+
+uint32_t Mcu::timerTicksToNextEvent(int a_timer) const
+{
+	const Timer & timer = m_timers[a_timer];
+	uint32_t top = timerTop(a_timer);
+
+	/* a counter above top (top moved below it) counts till max */
+	uint32_t wrapAt = timer.count <= top ? top : timerMax(a_timer);
+	uint32_t ticks = wrapAt - timer.count + 1;
+
+	for(int channel = 0; channel < timerCompareCount(a_timer); channel ++)
+	{
+		uint32_t compare = timer.compare[channel];
+
+		if(compare > timer.count && compare <= wrapAt)
+		{
+			ticks = std::min(ticks, compare - timer.count);
+		}
+	}
+
+	return ticks;
+}
+
+Cycles Mcu::timerNextEvent(int a_timer) const
+{
+	Cycles divisor = timerDivisor(a_timer);
+
+	if(divisor == 0)
+	{
+		return NEVER;
+	}
+
+	const Timer & timer = m_timers[a_timer];
+	return timer.lastSync + timerTicksToNextEvent(a_timer) * divisor - timer.phase;
+}
+
+void Mcu::timerSync(int a_timer)
+{
+	Timer & timer = m_timers[a_timer];
+	Cycles divisor = timerDivisor(a_timer);
+	Cycles elapsed = m_cycles - timer.lastSync;
+
+	timer.lastSync = m_cycles;
+
+	if(divisor == 0)
+	{
+		timer.phase = 0;
+		return;
+	}
+
+	Cycles total = timer.phase + elapsed;
+	Cycles ticks = total / divisor;
+	timer.phase = total % divisor;
+
+	while(ticks > 0)
+	{
+		uint32_t toEvent = timerTicksToNextEvent(a_timer);
+
+		if(ticks < toEvent)
+		{
+			timer.count += (uint16_t) ticks;
+			break;
+		}
+
+		ticks -= toEvent;
+
+		uint32_t top = timerTop(a_timer);
+		uint32_t wrapAt = timer.count <= top ? top : timerMax(a_timer);
+
+		if(timer.count + toEvent > wrapAt)
+		{
+			timer.count = 0;
+			if(!timerIsCtc(a_timer) || wrapAt == timerMax(a_timer))
+			{
+				timerSetFlag(a_timer, TIMER_OVERFLOW_FLAG[a_timer]);
+			}
+		}
+		else
+		{
+			timer.count += (uint16_t) toEvent;
+		}
+
+		for(int channel = 0; channel < timerCompareCount(a_timer); channel ++)
+		{
+			if(timer.count == timer.compare[channel])
+			{
+				timerSetFlag(a_timer, TIMER_COMPARE_FLAG[a_timer][channel]);
+			}
+		}
+	}
+}
+
+void Mcu::timer1Store(uint16_t a_addr, uint16_t a_value)
+{
+	switch(a_addr)
+	{
+	case REG_TCNT1L: m_timers[1].count = a_value; break;
+	case REG_OCR1AL: m_timers[1].compare[0] = a_value; break;
+	case REG_OCR1BL: m_timers[1].compare[1] = a_value; break;
+	default: m_timers[1].capture = a_value; break;
+	}
+}
+
+void Mcu::timersSync(void)
+{
+	for(int timer = 0; timer < 3; timer ++)
+	{
+		timerSync(timer);
+	}
+}
+
+void Mcu::timerSetFlag(int a_timer, int a_flag)
+{
+	(void) a_timer;
+	m_io[REG_TIFR] |= (1 << a_flag);
+}
+
+int Mcu::pwmDuty(int a_timer, int a_channel) const
+{
+	uint8_t compareMode;
+
+	switch(a_timer)
+	{
+	case 0: compareMode = (m_io[REG_TCCR0] >> 4) & 0x03; break;
+	case 2: compareMode = (m_io[REG_TCCR2] >> 4) & 0x03; break;
+	default: compareMode = (m_io[REG_TCCR1A] >> (a_channel == 0 ? 6 : 4)) & 0x03; break;
+	}
+
+	if(compareMode < 2 || timerIsCtc(a_timer) || timerDivisor(a_timer) == 0)
+	{
+		return -1;
+	}
+
+	uint32_t top = timerTop(a_timer);
+	uint32_t compare = std::min<uint32_t>(m_timers[a_timer].compare[a_channel], top);
+	int duty = (int) ((compare + 1) * 100 / (top + 1));
+
+	return compareMode == 3 ? 100 - duty : duty;
+}
+
+/*********************************** uart ************************************/
+
+Cycles Mcu::uartFrameCycles(void) const
+{
+	uint16_t ubrr = (m_ubrrh << 8) | m_io[REG_UBRRL];
+	Cycles bitCycles = ((m_io[REG_UCSRA] & (1 << U2X)) ? 8 : 16) * (Cycles) (ubrr + 1);
+
+	uint8_t characterSize = ((m_ucsrc >> 1) & 0x03) | (m_io[REG_UCSRB] & (1 << UCSZ2));
+	unsigned dataBits = characterSize == 7 ? 9 : 5 + (characterSize & 0x03);
+	unsigned parityBits = (m_ucsrc & 0x30) ? 1 : 0;
+	unsigned stopBits = (m_ucsrc & (1 << USBS)) ? 2 : 1;
+
+	return bitCycles * (1 + dataBits + parityBits + stopBits);
+}
+
+void Mcu::uartStartShift(uint8_t a_data)
+{
+	m_uartTxShiftEnd = m_cycles + uartFrameCycles();
+
+	if(uartTransmit)
+	{
+		uartTransmit(a_data, m_uartTxShiftEnd);
+	}
+}
+
+void Mcu::uartReceive(uint8_t a_data, Cycles a_arrival)
+{
+	if(a_arrival < m_cycles)
+	{
+		std::fprintf(stderr, "sim: %s: uart byte arrived %llu cycles late\n",
+				m_name.c_str(), (unsigned long long) (m_cycles - a_arrival));
+		a_arrival = m_cycles;
+	}
+	m_uartRxPending.push_back(UartRx{ a_data, a_arrival });
+}
+
+/*********************************** twi *************************************/
+
+Cycles Mcu::twiBitCycles(void) const
+{
+	static const Cycles prescalers[4] = { 1, 4, 16, 64 };
+	return 16 + 2 * (Cycles) m_io[REG_TWBR] * prescalers[m_io[REG_TWSR] & 0x03];
+}
+
+void Mcu::twiControl(uint8_t a_value)
+{
+	/* TWINT is cleared by writing one, TWWC is read only */
+	m_io[REG_TWCR] = (m_io[REG_TWCR] & (1 << TWWC)) | (a_value & ~((1 << TWINT) | (1 << TWWC) | 0x02));
+
+	if(!(a_value & (1 << TWEN)))
+	{
+		m_twiOperation = OPERATION_NONE;
+		m_twiCompletion = NEVER;
+		m_twiBusOwned = false;
+		m_twiSelected = nullptr;
+		m_twint = false;
+		return;
+	}
+
+	if(!(a_value & (1 << TWINT)))
+	{
+		return;
+	}
+
+	m_twint = false;
+	m_io[REG_TWCR] &= ~(1 << TWWC);
+
+	if(a_value & (1 << TWSTO))
+	{
+		for(TwiDevice * device : m_twiDevices)
+		{
+			device->stop(m_cycles);
+		}
+		m_twiBusOwned = false;
+		m_twiSelected = nullptr;
+		m_twiStatus = TWI_NO_INFO;
+		m_io[REG_TWCR] &= ~(1 << TWSTO);
+
+		if(!(a_value & (1 << TWSTA)))
+		{
+			return;
+		}
+	}
+
+	if(a_value & (1 << TWSTA))
+	{
+		m_twiOperation = OPERATION_START;
+		m_twiCompletion = m_cycles + twiBitCycles();
+		return;
+	}
+
+	switch(m_twiStatus)
+	{
+	case TWI_START:
+	case TWI_REP_START:
+		m_twiOperation = OPERATION_ADDRESS;
+		break;
+
+	case TWI_MT_SLA_W_ACK:
+	case TWI_MT_DATA_ACK:
+		m_twiOperation = OPERATION_WRITE;
+		break;
+
+	case TWI_MR_SLA_R_ACK:
+	case TWI_MR_DATA_ACK:
+		m_twiOperation = OPERATION_READ;
+		break;
+
+	default:
+		/* nothing to do in this state, TWINT is never set again */
+		m_twiOperation = OPERATION_NONE;
+		return;
+	}
+
+	/* 8 data bits and the acknowledge bit */
+	m_twiCompletion = m_cycles + 9 * twiBitCycles();
+}
+
+void Mcu::twiComplete(void)
+{
+	m_twiCompletion = NEVER;
+
+	switch(m_twiOperation)
+	{
+	case OPERATION_START:
+		m_twiStatus = m_twiBusOwned ? TWI_REP_START : TWI_START;
+		m_twiBusOwned = true;
+		m_twiSelected = nullptr;
+		for(TwiDevice * device : m_twiDevices)
+		{
+			device->start(m_cycles);
+		}
+		break;
+
+	case OPERATION_ADDRESS:
+	{
+		uint8_t sla = m_io[REG_TWDR];
+		m_twiReading = sla & 0x01;
+		m_twiSelected = nullptr;
+
+		for(TwiDevice * device : m_twiDevices)
+		{
+			if(device->address(sla, m_cycles))
+			{
+				m_twiSelected = device;
+				break;
+			}
+		}
+
+		if(m_twiReading)
+		{
+			m_twiStatus = m_twiSelected ? TWI_MR_SLA_R_ACK : TWI_MR_SLA_R_NACK;
+		}
+		else
+		{
+			m_twiStatus = m_twiSelected ? TWI_MT_SLA_W_ACK : TWI_MT_SLA_W_NACK;
+		}
+		break;
+	}
+
+	case OPERATION_WRITE:
+		m_twiStatus = (m_twiSelected && m_twiSelected->write(m_io[REG_TWDR], m_cycles)) ?
+				TWI_MT_DATA_ACK : TWI_MT_DATA_NACK;
+		break;
+
+	case OPERATION_READ:
+	{
+		bool ack = m_io[REG_TWCR] & (1 << TWEA);
+		m_io[REG_TWDR] = m_twiSelected ? m_twiSelected->read(ack, m_cycles) : 0xFF;
+		m_twiStatus = ack ? TWI_MR_DATA_ACK : TWI_MR_DATA_NACK;
+		break;
+	}
+
+	default:
+		return;
+	}
+
+	m_twiOperation = OPERATION_NONE;
+	m_twint = true;
+}
+
+} /* namespace sim */
+
+/*******************************************************************************
+ *                             Firmware Interface                              *
+ *******************************************************************************/
+
+extern "C"
+{
+
+unsigned char sim_read8(unsigned short a_addr)
+{
+	return sim::Mcu::current()->read8(a_addr);
+}
+
+void sim_write8(unsigned short a_addr, unsigned char a_value)
+{
+	sim::Mcu::current()->write8(a_addr, a_value);
+}
+
+unsigned short sim_read16(unsigned short a_addr)
+{
+	return sim::Mcu::current()->read16(a_addr);
+}
+
+void sim_write16(unsigned short a_addr, unsigned short a_value)
+{
+	sim::Mcu::current()->write16(a_addr, a_value);
+}
+
+void sim_enableInterrupts(void)
+{
+	sim::Mcu::current()->enableInterrupts();
+}
+
+void sim_disableInterrupts(void)
+{
+	sim::Mcu::current()->disableInterrupts();
+}
+
+void sim_idle(void)
+{
+	sim::Mcu::current()->idle();
+}
+
+void sim_delayCycles(unsigned long a_cycles)
+{
+	sim::Mcu::current()->charge(a_cycles);
+}
+
+void sim_sleep(void)
+{
+	sim::Mcu::current()->sleep();
+}
+
+int sim_registerVector(int a_image, int a_vector, void (*a_isr)(void))
+{
+	return sim::Mcu::registerVector(a_image, a_vector, a_isr);
+}
+
+/* the firmware is built with -finstrument-functions, every call is charged */
+void __cyg_profile_func_enter(void * a_function, void * a_caller)
+{
+	(void) a_function;
+	(void) a_caller;
+
+	sim::Mcu * mcu = sim::Mcu::current();
+
+	if(mcu != nullptr)
+	{
+		mcu->charge(sim::FUNCTION_CALL_CYCLES);
+	}
+}
+
+void __cyg_profile_func_exit(void * a_function, void * a_caller)
+{
+	(void) a_function;
+	(void) a_caller;
+}
+
+}
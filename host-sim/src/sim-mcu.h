@@ -0,0 +1,331 @@
+/******************************************************************************
+ *
+ * Module: SIM
+ *
+ * File Name: sim-mcu.h
+ *
+ * Description: Simulated ATmega16, the firmware runs natively in a coroutine
+ * 				and every register access goes through this model, which keeps
+ * 				a virtual cycle counter and runs the peripherals against it:
+ * 				- DIO ports, with pins that can be driven by board devices
+ * 				- TIMER 0, 1, 2 (normal, CTC and PWM modes, flags and interrupts)
+ * 				- UART (baud rate and frame timing, 2 bytes rx fifo, tx buffer)
+ * 				- TWI master, with slave devices attached to the bus
+ *
+ * 				The firmware code itself is not cycle accurate, every register
+ * 				access and function call is charged a fixed number of cycles,
+ * 				so the times are "modeled cycles": the peripheral waits (delays,
+ * 				serial, eeprom, lcd) are exact and the cpu work is estimated
+ *
+ * Author: Kirollos Ashraf
+ *
+ *******************************************************************************/
+
+#ifndef __SIM_MCU_H__
+#define __SIM_MCU_H__
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include <ucontext.h>
+
+namespace sim
+{
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+typedef uint64_t Cycles;
+
+const Cycles NEVER = ~(Cycles) 0;
+
+/* cycles charged for each register access, the instruction and the code around it */
+const Cycles REGISTER_ACCESS_CYCLES = 2;
+
+/* cycles charged for each firmware function call, call, ret, prologue and epilogue */
+const Cycles FUNCTION_CALL_CYCLES = 8;
+
+/* cycles charged for each interrupt, vector jump, context save, restore and reti */
+const Cycles INTERRUPT_CYCLES = 20;
+
+/* number of identical consecutive reads of a register before the read is
+ * considered polling, and the time is skipped to the next peripheral event
+ */
+const unsigned POLLING_READS_THRESHOLD = 8;
+
+/* ATmega16 interrupt vectors, the lower the number the higher the priority */
+enum Vector
+{
+	VECTOR_INT0 = 1,
+	VECTOR_INT1 = 2,
+	VECTOR_TIMER2_COMP = 3,
+	VECTOR_TIMER2_OVF = 4,
+	VECTOR_TIMER1_CAPT = 5,
+	VECTOR_TIMER1_COMPA = 6,
+	VECTOR_TIMER1_COMPB = 7,
+	VECTOR_TIMER1_OVF = 8,
+	VECTOR_TIMER0_OVF = 9,
+	VECTOR_SPI_STC = 10,
+	VECTOR_USART_RXC = 11,
+	VECTOR_USART_UDRE = 12,
+	VECTOR_USART_TXC = 13,
+	VECTOR_ADC = 14,
+	VECTOR_EE_RDY = 15,
+	VECTOR_ANA_COMP = 16,
+	VECTOR_TWI = 17,
+	VECTOR_INT2 = 18,
+	VECTOR_TIMER0_COMP = 19,
+	VECTOR_SPM_RDY = 20,
+	VECTORS_COUNT = 21
+};
+
+/* maximum number of firmware images linked in the simulator */
+const int MAX_IMAGES = 4;
+
+enum Port
+{
+	PORT_A = 0, PORT_B = 1, PORT_C = 2, PORT_D = 3, PORTS_COUNT = 4
+};
+
+/*******************************************************************************
+ *                             Types Declaration                               *
+ *******************************************************************************/
+
+class Mcu;
+
+/*
+ * [Class Name]: TwiDevice
+ * [Class Description]: slave device on the TWI bus of an MCU,
+ * 						the times passed are the cycles of the master
+ */
+class TwiDevice
+{
+public:
+	virtual ~TwiDevice() {}
+
+	/* start or repeated start condition */
+	virtual void start(Cycles a_now) = 0;
+
+	/* address byte (SLA+R/W), returns true if the device acknowledges it */
+	virtual bool address(uint8_t a_sla, Cycles a_now) = 0;
+
+	/* data byte written by the master, returns true if acknowledged */
+	virtual bool write(uint8_t a_data, Cycles a_now) = 0;
+
+	/* data byte read by the master, a_ack is the master acknowledge */
+	virtual uint8_t read(bool a_ack, Cycles a_now) = 0;
+
+	/* stop condition */
+	virtual void stop(Cycles a_now) = 0;
+};
+
+/*
+ * [Class Name]: PinDevice
+ * [Class Description]: board device connected to the MCU pins
+ */
+class PinDevice
+{
+public:
+	virtual ~PinDevice() {}
+
+	/* called after the MCU changes the direction or output of a port */
+	virtual void pinsChanged(Mcu & a_mcu, int a_port, Cycles a_now) = 0;
+
+	/* levels driven by the device on a port, returns the mask of driven pins */
+	virtual uint8_t drivenPins(const Mcu & a_mcu, int a_port, uint8_t * a_levels) const = 0;
+
+	/* next time the driven levels change by themselves, NEVER if they don't */
+	virtual Cycles nextChange(void) const { return NEVER; }
+};
+
+/*
+ * [Class Name]: Mcu
+ * [Class Description]: simulated ATmega16 running one firmware image
+ */
+class Mcu
+{
+public:
+	typedef int (*Entry)(void);
+
+	Mcu(const std::string & a_name, int a_image, Entry a_entry, Cycles a_clockHz);
+	~Mcu();
+
+	Mcu(const Mcu &) = delete;
+	Mcu & operator=(const Mcu &) = delete;
+
+	/****************************** board side *******************************/
+
+	const std::string & name(void) const { return m_name; }
+	Cycles cycles(void) const { return m_cycles; }
+	Cycles clockHz(void) const { return m_clockHz; }
+	Cycles msToCycles(double a_ms) const { return (Cycles) (a_ms * m_clockHz / 1000.0); }
+	double cyclesToMs(Cycles a_cycles) const { return a_cycles * 1000.0 / m_clockHz; }
+	bool halted(void) const { return m_halted; }
+
+	/* runs the firmware until its time passes a_limit */
+	void runUntil(Cycles a_limit);
+
+	void attachPinDevice(PinDevice * a_device) { m_pinDevices.push_back(a_device); }
+	void attachTwiDevice(TwiDevice * a_device) { m_twiDevices.push_back(a_device); }
+
+	/* resolved levels of a port pins, as read from the PINx register */
+	uint8_t pinLevels(int a_port) const;
+	uint8_t portDirection(int a_port) const;
+	uint8_t portOutput(int a_port) const;
+
+	/* must be called by devices when their driven levels change */
+	void externalPinsChanged(void);
+
+	/* byte sent by the uart with the time its stop bit ends */
+	std::function<void(uint8_t, Cycles)> uartTransmit;
+
+	/* byte arriving to the uart rx at a_arrival, must not be in the past */
+	void uartReceive(uint8_t a_data, Cycles a_arrival);
+
+	/* register value without any side effects */
+	uint8_t peek(uint16_t a_addr) const;
+	uint16_t peek16(uint16_t a_addr) const;
+
+	/* pwm duty of a timer compare output in percent, -1 if the output is not connected */
+	int pwmDuty(int a_timer, int a_channel) const;
+
+	/* counters */
+	uint64_t interruptsCount(void) const { return m_interruptsCount; }
+	/* cycles skipped by the idle hint, polling loops are not counted */
+	Cycles idleCycles(void) const { return m_idleCycles; }
+	/* idle cycles spent in the sleep instruction in every SM2:0 mode of MCUCR */
+	Cycles sleepCycles(int a_mode) const { return m_sleepCycles[a_mode & 7]; }
+
+	/****************************** firmware side ****************************/
+
+	static Mcu * current(void) { return s_current; }
+
+	uint8_t read8(uint16_t a_addr);
+	void write8(uint16_t a_addr, uint8_t a_value);
+	uint16_t read16(uint16_t a_addr);
+	void write16(uint16_t a_addr, uint16_t a_value);
+	void enableInterrupts(void);
+	void disableInterrupts(void);
+	void idle(void);
+	void sleep(void);
+	void charge(Cycles a_cycles);
+
+	static int registerVector(int a_image, int a_vector, void (*a_isr)(void));
+
+private:
+	struct Timer
+	{
+		uint16_t count;
+		uint16_t compare[2];
+		uint16_t capture;
+		Cycles lastSync;
+		Cycles phase;
+	};
+
+	struct UartRx
+	{
+		uint8_t data;
+		Cycles arrival;
+	};
+
+	enum TwiOperation
+	{
+		OPERATION_NONE, OPERATION_START, OPERATION_ADDRESS, OPERATION_WRITE, OPERATION_READ
+	};
+
+	static void coroutineEntry(void);
+	void yieldToBoard(void);
+
+	void advanceTo(Cycles a_target);
+	Cycles nextEvent(void) const;
+	void processEvents(void);
+	void serviceInterrupts(void);
+	int pendingVector(void) const;
+	void skipIdleTime(bool a_idle);
+	void pinsChanged(int a_port);
+
+	/* external interrupts */
+	int extIntSense(int a_extInt) const;
+	void extIntSync(void);
+
+	/* timers */
+	uint8_t timerClockSelect(int a_timer) const;
+	Cycles timerDivisor(int a_timer) const;
+	bool timerIsCtc(int a_timer) const;
+	uint16_t timerTop(int a_timer) const;
+	uint16_t timerMax(int a_timer) const;
+	int timerCompareCount(int a_timer) const { return a_timer == 1 ? 2 : 1; }
+	uint32_t timerTicksToNextEvent(int a_timer) const;
+	void timerSync(int a_timer);
+	void timersSync(void);
+	void timer1Store(uint16_t a_addr, uint16_t a_value);
+	void timerSetFlag(int a_timer, int a_flag);
+	Cycles timerNextEvent(int a_timer) const;
+
+	/* uart */
+	Cycles uartFrameCycles(void) const;
+	void uartStartShift(uint8_t a_data);
+
+	/* twi */
+	Cycles twiBitCycles(void) const;
+	void twiControl(uint8_t a_value);
+	void twiComplete(void);
+
+	std::string m_name;
+	int m_image;
+	Entry m_entry;
+	Cycles m_clockHz;
+	Cycles m_cycles;
+	Cycles m_limit;
+
+	ucontext_t m_context;
+	ucontext_t m_boardContext;
+	std::vector<char> m_stack;
+	bool m_started;
+	bool m_halted;
+
+	bool m_interruptsEnabled;
+	uint64_t m_interruptsCount;
+	Cycles m_idleCycles;
+	Cycles m_sleepCycles[8];
+
+	uint16_t m_lastReadAddr;
+	uint8_t m_lastReadValue;
+	unsigned m_repeatedReads;
+
+	uint8_t m_io[0x60];
+
+	/* last sampled levels of the INT0 and INT1 pins */
+	uint8_t m_extIntLevels;
+
+	std::vector<PinDevice *> m_pinDevices;
+	std::vector<TwiDevice *> m_twiDevices;
+
+	Timer m_timers[3];
+
+	uint8_t m_ucsrc;
+	uint8_t m_ubrrh;
+	std::deque<uint8_t> m_uartRxFifo;
+	std::deque<UartRx> m_uartRxPending;
+	bool m_uartTxBufferFull;
+	uint8_t m_uartTxBuffer;
+	Cycles m_uartTxShiftEnd;
+
+	bool m_twint;
+	uint8_t m_twiStatus;
+	TwiOperation m_twiOperation;
+	Cycles m_twiCompletion;
+	bool m_twiBusOwned;
+	TwiDevice * m_twiSelected;
+	bool m_twiReading;
+
+	static Mcu * s_current;
+	static Mcu * s_starting;
+};
+
+} /* namespace sim */
+
+#endif /* __SIM_MCU_H__ */